@@ -264,18 +264,23 @@ endfunction()
 # name normalization and links in libsouffle
 function(SOUFFLE_ADD_BINARY_TEST TEST_NAME CATEGORY)
     # PARAM_SOUFFLE_HEADERS_ONLY - don't depend on compiling `libsouffle`; saves time and allows independent tests
+    # PARAM_VARIANT - suffix of another build of the same test, e.g. with other compile options
+    # PARAM_COMPILE_OPTIONS - additional options to compile the test with
     cmake_parse_arguments(
         PARSE_ARGV 2
         PARAM
         "SOUFFLE_HEADERS_ONLY" # Options
-        "" #Single valued options
-        "" #Multi-value options
+        "VARIANT" #Single valued options
+        "COMPILE_OPTIONS" #Multi-value options
     )
 
     # The naming of the test targets is inconsistent in souffle
     # Keep the file name the same (for now) but rename the rest
     string(REGEX REPLACE "^test_" "" SHORT_TEST_NAME ${TEST_NAME})
     string(REGEX REPLACE "_test$" "" SHORT_TEST_NAME ${SHORT_TEST_NAME})
+    if (PARAM_VARIANT)
+        set(SHORT_TEST_NAME "${SHORT_TEST_NAME}_${PARAM_VARIANT}")
+    endif()
     set(TARGET_NAME "test_${SHORT_TEST_NAME}")
 
     add_executable(${TARGET_NAME} ${TEST_NAME}.cpp)
@@ -307,6 +312,8 @@ function(SOUFFLE_ADD_BINARY_TEST TEST_NAME CATEGORY)
       target_link_libraries(${TARGET_NAME} libsouffle)
     endif()
 
+    target_compile_options(${TARGET_NAME} PRIVATE ${PARAM_COMPILE_OPTIONS})
+
     set(QUALIFIED_TEST_NAME ${SHORT_TEST_NAME})
     add_test(NAME ${QUALIFIED_TEST_NAME} COMMAND ${TARGET_NAME})
     set_tests_properties(${QUALIFIED_TEST_NAME} PROPERTIES LABELS "unit_test;${CATEGORY}")
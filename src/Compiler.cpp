@@ -0,0 +1,297 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2022, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file Compiler.cpp
+ *
+ * Stages of the compiler shared by the souffle executable and programs
+ * embedding the interpreter.
+ *
+ ***********************************************************************/
+
+#include "Compiler.h"
+#include "Global.h"
+#include "ast/transform/AddNullariesToAtomlessAggregates.h"
+#include "ast/transform/ComponentChecker.h"
+#include "ast/transform/ComponentInstantiation.h"
+#include "ast/transform/Conditional.h"
+#include "ast/transform/ExecutionPlanChecker.h"
+#include "ast/transform/ExpandEqrels.h"
+#include "ast/transform/Fixpoint.h"
+#include "ast/transform/FoldAnonymousRecords.h"
+#include "ast/transform/GroundWitnesses.h"
+#include "ast/transform/GroundedTermsChecker.h"
+#include "ast/transform/IOAttributes.h"
+#include "ast/transform/IODefaults.h"
+#include "ast/transform/InlineRelations.h"
+#include "ast/transform/MagicSet.h"
+#include "ast/transform/MaterializeAggregationQueries.h"
+#include "ast/transform/MaterializeSingletonAggregation.h"
+#include "ast/transform/MinimiseProgram.h"
+#include "ast/transform/NameUnnamedVariables.h"
+#include "ast/transform/NormaliseGenerators.h"
+#include "ast/transform/PartitionBodyLiterals.h"
+#include "ast/transform/PragmaChecker.h"
+#include "ast/transform/ReduceExistentials.h"
+#include "ast/transform/RemoveBooleanConstraints.h"
+#include "ast/transform/RemoveEmptyRelations.h"
+#include "ast/transform/RemoveRedundantRelations.h"
+#include "ast/transform/RemoveRedundantSums.h"
+#include "ast/transform/RemoveRelationCopies.h"
+#include "ast/transform/ReplaceSingletonVariables.h"
+#include "ast/transform/ResolveAliases.h"
+#include "ast/transform/ResolveAnonymousRecordAliases.h"
+#include "ast/transform/SemanticChecker.h"
+#include "ast/transform/SimplifyAggregateTargetExpression.h"
+#include "ast/transform/SubsumptionQualifier.h"
+#include "ast/transform/UniqueAggregationVariables.h"
+#include "ast2ram/TranslationStrategy.h"
+#include "ast2ram/UnitTranslator.h"
+#include "ast2ram/provenance/TranslationStrategy.h"
+#include "ast2ram/provenance/UnitTranslator.h"
+#include "ast2ram/seminaive/TranslationStrategy.h"
+#include "ast2ram/seminaive/UnitTranslator.h"
+#include "ast2ram/utility/TranslatorContext.h"
+#include "interpreter/Engine.h"
+#include "interpreter/ProgInterface.h"
+#include "parser/ParserDriver.h"
+#include "ram/transform/CollapseFilters.h"
+#include "ram/transform/Conditional.h"
+#include "ram/transform/EliminateDuplicates.h"
+#include "ram/transform/ExpandFilter.h"
+#include "ram/transform/HoistAggregate.h"
+#include "ram/transform/HoistConditions.h"
+#include "ram/transform/IfConversion.h"
+#include "ram/transform/IfExistsConversion.h"
+#include "ram/transform/Leapfrog.h"
+#include "ram/transform/Loop.h"
+#include "ram/transform/MakeIndex.h"
+#include "ram/transform/Parallel.h"
+#include "ram/transform/ReorderConditions.h"
+#include "ram/transform/ReorderFilterBreak.h"
+#include "ram/transform/ReportIndex.h"
+#include "ram/transform/Sequence.h"
+#include "ram/transform/TupleId.h"
+#include "reports/DebugReport.h"
+#include "reports/ErrorReport.h"
+#include "souffle/io/Spill.h"
+#include "souffle/utility/StringUtil.h"
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace souffle {
+
+Own<ast::transform::PipelineTransformer> makeAstPipeline() {
+    // Equivalence pipeline
+    auto equivalencePipeline =
+            mk<ast::transform::PipelineTransformer>(mk<ast::transform::NameUnnamedVariablesTransformer>(),
+                    mk<ast::transform::FixpointTransformer>(mk<ast::transform::MinimiseProgramTransformer>()),
+                    mk<ast::transform::ReplaceSingletonVariablesTransformer>(),
+                    mk<ast::transform::RemoveRelationCopiesTransformer>(),
+                    mk<ast::transform::RemoveEmptyRelationsTransformer>(),
+                    mk<ast::transform::RemoveRedundantRelationsTransformer>());
+
+    // Magic-Set pipeline
+    auto magicPipeline = mk<ast::transform::PipelineTransformer>(
+            mk<ast::transform::ConditionalTransformer>(
+                    Global::config().has("magic-transform"), mk<ast::transform::ExpandEqrelsTransformer>()),
+            mk<ast::transform::MagicSetTransformer>(), mk<ast::transform::ResolveAliasesTransformer>(),
+            mk<ast::transform::RemoveRelationCopiesTransformer>(),
+            mk<ast::transform::RemoveEmptyRelationsTransformer>(),
+            mk<ast::transform::RemoveRedundantRelationsTransformer>(), clone(equivalencePipeline));
+
+    // Partitioning pipeline
+    auto partitionPipeline =
+            mk<ast::transform::PipelineTransformer>(mk<ast::transform::NameUnnamedVariablesTransformer>(),
+                    mk<ast::transform::PartitionBodyLiteralsTransformer>(),
+                    mk<ast::transform::ReplaceSingletonVariablesTransformer>());
+
+    // Provenance pipeline
+    auto provenancePipeline = mk<ast::transform::ConditionalTransformer>(Global::config().has("provenance"),
+            mk<ast::transform::PipelineTransformer>(mk<ast::transform::ExpandEqrelsTransformer>(),
+                    mk<ast::transform::NameUnnamedVariablesTransformer>()));
+
+    // Main pipeline
+    auto pipeline = mk<ast::transform::PipelineTransformer>(mk<ast::transform::ComponentChecker>(),
+            mk<ast::transform::ComponentInstantiationTransformer>(),
+            mk<ast::transform::IODefaultsTransformer>(),
+            mk<ast::transform::SimplifyAggregateTargetExpressionTransformer>(),
+            mk<ast::transform::UniqueAggregationVariablesTransformer>(),
+            mk<ast::transform::FixpointTransformer>(mk<ast::transform::PipelineTransformer>(
+                    mk<ast::transform::ResolveAnonymousRecordAliasesTransformer>(),
+                    mk<ast::transform::FoldAnonymousRecords>())),
+            mk<ast::transform::SubsumptionQualifierTransformer>(), mk<ast::transform::SemanticChecker>(),
+            mk<ast::transform::GroundWitnessesTransformer>(),
+            mk<ast::transform::UniqueAggregationVariablesTransformer>(),
+            mk<ast::transform::MaterializeSingletonAggregationTransformer>(),
+            mk<ast::transform::FixpointTransformer>(
+                    mk<ast::transform::MaterializeAggregationQueriesTransformer>()),
+            mk<ast::transform::RemoveRedundantSumsTransformer>(),
+            mk<ast::transform::NormaliseGeneratorsTransformer>(),
+            mk<ast::transform::ResolveAliasesTransformer>(),
+            mk<ast::transform::RemoveBooleanConstraintsTransformer>(),
+            mk<ast::transform::ResolveAliasesTransformer>(), mk<ast::transform::MinimiseProgramTransformer>(),
+            mk<ast::transform::InlineUnmarkExcludedTransform>(),
+            mk<ast::transform::InlineRelationsTransformer>(), mk<ast::transform::GroundedTermsChecker>(),
+            mk<ast::transform::ResolveAliasesTransformer>(),
+            mk<ast::transform::RemoveRedundantRelationsTransformer>(),
+            mk<ast::transform::RemoveRelationCopiesTransformer>(),
+            mk<ast::transform::RemoveEmptyRelationsTransformer>(),
+            mk<ast::transform::ReplaceSingletonVariablesTransformer>(),
+            mk<ast::transform::FixpointTransformer>(mk<ast::transform::PipelineTransformer>(
+                    mk<ast::transform::ReduceExistentialsTransformer>(),
+                    mk<ast::transform::RemoveRedundantRelationsTransformer>())),
+            mk<ast::transform::RemoveRelationCopiesTransformer>(), std::move(partitionPipeline),
+            std::move(equivalencePipeline), mk<ast::transform::RemoveRelationCopiesTransformer>(),
+            std::move(magicPipeline), mk<ast::transform::RemoveEmptyRelationsTransformer>(),
+            mk<ast::transform::AddNullariesToAtomlessAggregatesTransformer>(),
+            mk<ast::transform::ExecutionPlanChecker>(), std::move(provenancePipeline),
+            mk<ast::transform::IOAttributesTransformer>());
+
+    // Disable unwanted transformations
+    if (Global::config().has("disable-transformers")) {
+        std::vector<std::string> givenTransformers =
+                splitString(Global::config().get("disable-transformers"), ',');
+        pipeline->disableTransformers(
+                std::set<std::string>(givenTransformers.begin(), givenTransformers.end()));
+    }
+
+    return pipeline;
+}
+
+Own<ram::transform::Transformer> makeRamPipeline() {
+    using namespace ram::transform;
+    return mk<TransformerSequence>(
+            mk<LoopTransformer>(mk<TransformerSequence>(mk<ExpandFilterTransformer>(),
+                    mk<HoistConditionsTransformer>(), mk<MakeIndexTransformer>())),
+            mk<IfConversionTransformer>(), mk<IfExistsConversionTransformer>(),
+            mk<CollapseFiltersTransformer>(), mk<TupleIdTransformer>(),
+            mk<LoopTransformer>(
+                    mk<TransformerSequence>(mk<HoistAggregateTransformer>(), mk<TupleIdTransformer>())),
+            mk<ExpandFilterTransformer>(), mk<HoistConditionsTransformer>(),
+            mk<CollapseFiltersTransformer>(), mk<EliminateDuplicatesTransformer>(),
+            mk<ReorderConditionsTransformer>(),
+            mk<ConditionalTransformer>(
+                    []() -> bool { return Global::config().has("leapfrog"); }, mk<LeapfrogTransformer>()),
+            mk<LoopTransformer>(mk<ReorderFilterBreak>()),
+            mk<ConditionalTransformer>(
+                    // job count of 0 means all cores are used.
+                    []() -> bool { return std::stoi(Global::config().get("jobs")) != 1; },
+                    mk<ParallelTransformer>()),
+            mk<ReportIndexTransformer>());
+}
+
+void checkOptions() {
+    auto& config = Global::config();
+
+    /* check that the memory limit is a size */
+    if (config.has("memory-limit")) {
+        try {
+            spill::parseSize(config.get("memory-limit"));
+        } catch (const std::exception&) {
+            throw std::runtime_error("--memory-limit must be a size such as 512M or 200G.");
+        }
+    }
+
+    /* check that the batch size is a number of tuples */
+    if (config.has("batch")) {
+        const auto& size = config.get("batch");
+        if (size.empty() || !isNumber(size.c_str()) || std::stoi(size) < 1) {
+            throw std::runtime_error("--batch may only be set to an integer greater than 0.");
+        }
+    }
+}
+
+Own<ram::TranslationUnit> translateToRam(ast::TranslationUnit& astTranslationUnit) {
+    auto translationStrategy =
+            Global::config().has("provenance")
+                    ? mk<ast2ram::TranslationStrategy, ast2ram::provenance::TranslationStrategy>()
+                    : mk<ast2ram::TranslationStrategy, ast2ram::seminaive::TranslationStrategy>();
+    auto unitTranslator = Own<ast2ram::UnitTranslator>(translationStrategy->createUnitTranslator());
+    return unitTranslator->translateUnit(astTranslationUnit);
+}
+
+namespace {
+
+/** Everything a compiled program refers to; the reports are referenced by the translation unit */
+struct CompiledUnits {
+    Own<ErrorReport> errorReport;
+    Own<DebugReport> debugReport;
+    Own<ram::TranslationUnit> ramTranslationUnit;
+    Own<interpreter::Engine> engine;
+};
+
+/** Installs a configuration for the lifetime of the object, and then restores the previous one */
+class ScopedConfig {
+public:
+    explicit ScopedConfig(MainConfig config) : saved(std::move(Global::config())) {
+        Global::config() = std::move(config);
+    }
+
+    ScopedConfig(const ScopedConfig&) = delete;
+    ScopedConfig& operator=(const ScopedConfig&) = delete;
+
+    ~ScopedConfig() {
+        Global::config() = std::move(saved);
+    }
+
+private:
+    MainConfig saved;
+};
+
+/** Interpreted program that owns the translation unit and engine it evaluates */
+class InterpretedProgram : private CompiledUnits, public interpreter::ProgInterface {
+public:
+    InterpretedProgram(CompiledUnits units)
+            : CompiledUnits(std::move(units)), interpreter::ProgInterface(*engine) {}
+};
+
+}  // namespace
+
+Own<SouffleProgram> compileProgram(
+        const std::string& source, const std::map<std::string, std::string>& options) {
+    // every program starts from the defaults of the command line options that the compiler relies on
+    MainConfig programConfig;
+    const std::map<std::string, std::string> defaults{
+            {"jobs", "1"}, {"fact-dir", "."}, {"output-dir", "."}, {"include-dir", "."}};
+    for (const auto& [key, value] : defaults) {
+        programConfig.set(key, value);
+    }
+    for (const auto& [key, value] : options) {
+        programConfig.set(key, value);
+    }
+    ScopedConfig scope(std::move(programConfig));
+    const auto& config = Global::config();
+
+    CompiledUnits units;
+    units.errorReport = mk<ErrorReport>(config.has("no-warn"));
+    units.errorReport->setThrowOnErrors();
+    units.debugReport = mk<DebugReport>();
+
+    auto astTranslationUnit =
+            ParserDriver::parseTranslationUnit(source, *units.errorReport, *units.debugReport);
+    astTranslationUnit->getErrorReport().exitIfErrors();
+
+    (mk<ast::transform::PragmaChecker>())->apply(*astTranslationUnit);
+    checkOptions();
+    makeAstPipeline()->apply(*astTranslationUnit);
+
+    units.ramTranslationUnit = translateToRam(*astTranslationUnit);
+    makeRamPipeline()->apply(*units.ramTranslationUnit);
+
+    // the engine keeps a copy of the configuration for its runs
+    units.engine = mk<interpreter::Engine>(*units.ramTranslationUnit);
+    units.engine->setThrowOnErrors();
+    return mk<InterpretedProgram>(std::move(units));
+}
+
+}  // namespace souffle
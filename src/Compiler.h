@@ -0,0 +1,63 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2022, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file Compiler.h
+ *
+ * Stages of the compiler shared by the souffle executable and programs
+ * embedding the interpreter.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ast/TranslationUnit.h"
+#include "ast/transform/Pipeline.h"
+#include "ram/TranslationUnit.h"
+#include "ram/transform/Transformer.h"
+#include "souffle/SouffleInterface.h"
+#include "souffle/utility/MiscUtil.h"
+#include <map>
+#include <string>
+
+namespace souffle {
+
+/** Construct the AST transformation pipeline, honouring `disable-transformers` */
+Own<ast::transform::PipelineTransformer> makeAstPipeline();
+
+/** Construct the RAM transformation pipeline */
+Own<ram::transform::Transformer> makeRamPipeline();
+
+/**
+ * Check the options that may also be given by pragmas, and so can only be checked once they are applied.
+ * Throws a std::runtime_error describing the first invalid option.
+ */
+void checkOptions();
+
+/** Translate a transformed AST into RAM, using the provenance translation if requested */
+Own<ram::TranslationUnit> translateToRam(ast::TranslationUnit& astTranslationUnit);
+
+/**
+ * Compile a Datalog program in-process into a program evaluated by the interpreter.
+ *
+ * The options take the long names of the command line options, e.g. `jobs` or `fact-dir`. Every call
+ * starts from the default options; the global configuration is replaced while the program is compiled
+ * and restored afterwards, and the program keeps its own copy for its runs. Compiling is therefore not
+ * thread-safe, but compiled programs are independent of each other and of later calls.
+ * The source is not preprocessed. Errors in the program, invalid options and failures to read or write
+ * facts are reported by a std::runtime_error.
+ *
+ * The returned program can be run repeatedly: run() evaluates the rules on the tuples inserted
+ * into its relations, and runAll() additionally reads and writes facts as specified by the program.
+ * The interpreter's node tree is generated once and reused by every run.
+ */
+Own<SouffleProgram> compileProgram(
+        const std::string& source, const std::map<std::string, std::string>& options = {});
+
+}  // namespace souffle
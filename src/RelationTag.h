@@ -38,6 +38,8 @@ enum class RelationTag {
     BTREE_MAX,     // use btree_max data-structure
     BTREE_SUM,     // use btree_sum data-structure
     BTREE_DELETE,  // use btree_delete data-structure
+    COMPRESSED,    // use btree data-structure, compressed once complete
+    HASH,          // use btree data-structure, tested for membership by hashing
     EQREL,         // use union data-structure
 };
 
@@ -63,6 +65,8 @@ enum class RelationRepresentation {
     BTREE_MAX,     // use btree_max data-structure
     BTREE_SUM,     // use btree_sum data-structure
     BTREE_DELETE,  // use btree_delete data-structure
+    COMPRESSED,    // use btree data-structure, compressed once complete
+    HASH,          // use btree data-structure, tested for membership by hashing
     EQREL,         // use union data-structure
     PROVENANCE,    // use custom btree data-structure with provenance extras
     INFO,          // info relation for provenance
@@ -79,6 +83,8 @@ inline bool isRelationRepresentationTag(const RelationTag& tag) {
         case RelationTag::BTREE_MAX:
         case RelationTag::BTREE_SUM:
         case RelationTag::BTREE_DELETE:
+        case RelationTag::COMPRESSED:
+        case RelationTag::HASH:
         case RelationTag::EQREL: return true;
         default: return false;
     }
@@ -131,6 +137,8 @@ inline RelationRepresentation getRelationRepresentationFromTag(const RelationTag
         case RelationTag::BTREE_MAX: return RelationRepresentation::BTREE_MAX;
         case RelationTag::BTREE_SUM: return RelationRepresentation::BTREE_SUM;
         case RelationTag::BTREE_DELETE: return RelationRepresentation::BTREE_DELETE;
+        case RelationTag::COMPRESSED: return RelationRepresentation::COMPRESSED;
+        case RelationTag::HASH: return RelationRepresentation::HASH;
         case RelationTag::EQREL: return RelationRepresentation::EQREL;
         default: fatal("invalid relation tag");
     }
@@ -155,6 +163,8 @@ inline std::ostream& operator<<(std::ostream& os, RelationTag qualifier) {
         case RelationTag::BTREE_MAX: return os << "btree_max";
         case RelationTag::BTREE_SUM: return os << "btree_sum";
         case RelationTag::BTREE_DELETE: return os << "btree_delete";
+        case RelationTag::COMPRESSED: return os << "compressed";
+        case RelationTag::HASH: return os << "hash";
         case RelationTag::EQREL: return os << "eqrel";
     }
 
@@ -184,6 +194,8 @@ inline std::ostream& operator<<(std::ostream& os, RelationRepresentation represe
         case RelationRepresentation::BTREE_MAX: return os << "btree_max";
         case RelationRepresentation::BTREE_SUM: return os << "btree_sum";
         case RelationRepresentation::BTREE_DELETE: return os << "btree_delete";
+        case RelationRepresentation::COMPRESSED: return os << "compressed";
+        case RelationRepresentation::HASH: return os << "hash";
         case RelationRepresentation::BRIE: return os << "brie";
         case RelationRepresentation::EQREL: return os << "eqrel";
         case RelationRepresentation::PROVENANCE: return os << "provenance";
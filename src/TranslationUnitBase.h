@@ -20,6 +20,7 @@
 #include "reports/ErrorReport.h"
 #include "souffle/utility/DynamicCasting.h"
 #include "souffle/utility/Types.h"
+#include <algorithm>
 #include <cassert>
 #include <map>
 #include <memory>
@@ -28,6 +29,7 @@
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace souffle::detail {
 
@@ -82,13 +84,20 @@ struct TranslationUnitBase {
     A& getAnalysis() const {
         static_assert(std::is_same_v<char const* const, decltype(A::name)>,
                 "`name` member must be a static literal");
+        // an analysis requested while running another one is a dependency of the latter
+        if (!running.empty()) {
+            dependencies[running.back()].insert(A::name);
+        }
+
         auto it = analyses.find(A::name);
         if (it == analyses.end()) {
             it = analyses.insert({A::name, mk<A>()}).first;
 
             auto& analysis = *it->second;
             assert(analysis.getName() == A::name && "must be same pointer");
+            running.push_back(A::name);
             analysis.run(static_cast<Impl const&>(*this));
+            running.pop_back();
             logAnalysis(analysis);
         }
 
@@ -107,6 +116,47 @@ struct TranslationUnitBase {
     /** @brief Invalidate all alive analyses of the translation unit */
     void invalidateAnalyses() {
         analyses.clear();
+        dependencies.clear();
+    }
+
+    /**
+     * @brief Invalidate all alive analyses of the translation unit except the preserved ones.
+     *
+     * A preserved analysis is invalidated nevertheless if one of the analyses it was
+     * computed from is invalidated, since it may refer to the results of the latter.
+     */
+    void invalidateAnalyses(const std::set<std::string>& preserved) {
+        std::set<std::string> kept;
+        for (auto const& a : analyses) {
+            if (preserved.count(a.first) > 0) {
+                kept.insert(a.first);
+            }
+        }
+
+        // drop analyses depending on dropped analyses until nothing changes
+        for (bool changed = true; changed;) {
+            changed = false;
+            for (auto it = kept.begin(); it != kept.end();) {
+                auto const& deps = dependencies[*it];
+                bool valid = std::all_of(
+                        deps.begin(), deps.end(), [&](auto const& dep) { return kept.count(dep) > 0; });
+                if (valid) {
+                    ++it;
+                } else {
+                    it = kept.erase(it);
+                    changed = true;
+                }
+            }
+        }
+
+        for (auto it = analyses.begin(); it != analyses.end();) {
+            if (kept.count(it->first) > 0) {
+                ++it;
+            } else {
+                dependencies.erase(it->first);
+                it = analyses.erase(it);
+            }
+        }
     }
 
     /** @brief Get the RAM Program of the translation unit  */
@@ -133,6 +183,12 @@ protected:
     //       Using `std::string` appears to suppress the issue (bug?).
     mutable std::map<std::string, Own<Analysis>> analyses;
 
+    /* Analyses requested by each cached analysis while it was running */
+    mutable std::map<std::string, std::set<std::string>> dependencies;
+
+    /* Analyses currently running, innermost last */
+    mutable std::vector<std::string> running;
+
     /* RAM program */
     Own<Program> program;
 
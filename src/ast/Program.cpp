@@ -21,13 +21,12 @@ using RelationInfo = ast::Program::RelationInfo;
 using RelationInfoMap = ast::Program::RelationInfoMap;
 
 template <typename SeqOwnT>
-auto toPtrVector(RelationInfoMap const& map, SeqOwnT RelationInfo::*member, ast::QualifiedName const& name) {
+auto toPtrVector(RelationInfo const* info, SeqOwnT RelationInfo::*member, ast::QualifiedName const& name) {
     using A = typename SeqOwnT::value_type::element_type;
     std::vector<A*> ys;
 
-    auto it = map.find(name);
-    if (it != map.end()) {
-        for (auto&& x : it->second.*member) {
+    if (info != nullptr) {
+        for (auto&& x : info->*member) {
             assert(name == getName(*x));
             ys.push_back(x.get());
         }
@@ -53,16 +52,14 @@ auto toPtrVector(RelationInfoMap const& map, SeqOwnT RelationInfo::*member) {
 
 namespace {
 template <typename A, typename SeqOwnT>
-auto erase(RelationInfoMap& map, SeqOwnT RelationInfo::*member, A const& elem) {
-    auto it = map.find(getName(elem));
-    if (it == map.end()) {
+auto erase(RelationInfo* info, SeqOwnT RelationInfo::*member, A const& elem) {
+    if (info == nullptr) {
         assert(false &&
                 "attempted to remove something not owned by the program. this is symptomatic of a bug");
         return false;
     }
 
-    auto&& [_, info] = *it;
-    auto& xs = info.*member;
+    auto& xs = info->*member;
     auto xs_it = std::remove_if(xs.begin(), xs.end(), [&](auto&& x) { return x.get() == &elem; });
     if (xs_it == xs.end()) {
         assert(false &&
@@ -71,12 +68,6 @@ auto erase(RelationInfoMap& map, SeqOwnT RelationInfo::*member, A const& elem) {
     }
 
     xs.erase(xs_it);
-
-    if (info.decls.empty() && info.clauses.empty() && info.directives.empty()) {
-        // everything was removed. can drop the bucket.
-        map.erase(it);
-    }
-
     return true;
 }
 }  // namespace
@@ -123,13 +114,10 @@ std::vector<Relation*> Program::getRelations() const {
 }
 
 Relation* Program::getRelation(QualifiedName const& name) const {
-    auto it = relations.find(name);
-    if (it == relations.end()) return nullptr;
-
-    auto&& [_, info] = *it;
-    if (info.decls.empty()) return nullptr;
+    auto* info = getRelationInfo(name);
+    if (info == nullptr || info->decls.empty()) return nullptr;
 
-    return info.decls.front().get();
+    return info->decls.front().get();
 }
 
 Relation* Program::getRelation(Atom const& x) const {
@@ -145,7 +133,7 @@ Relation* Program::getRelation(Directive const& x) const {
 }
 
 std::vector<Relation*> Program::getRelationAll(QualifiedName const& name) const {
-    return toPtrVector(relations, &RelationInfo::decls, name);
+    return toPtrVector(getRelationInfo(name), &RelationInfo::decls, name);
 }
 
 std::vector<Clause*> Program::getClauses() const {
@@ -153,7 +141,7 @@ std::vector<Clause*> Program::getClauses() const {
 }
 
 std::vector<Clause*> Program::getClauses(QualifiedName const& name) const {
-    return toPtrVector(relations, &RelationInfo::clauses, name);
+    return toPtrVector(getRelationInfo(name), &RelationInfo::clauses, name);
 }
 
 std::vector<FunctorDeclaration*> Program::getFunctorDeclarations() const {
@@ -165,36 +153,36 @@ std::vector<Directive*> Program::getDirectives() const {
 }
 
 std::vector<Directive*> Program::getDirectives(QualifiedName const& name) const {
-    return toPtrVector(relations, &RelationInfo::directives, name);
+    return toPtrVector(getRelationInfo(name), &RelationInfo::directives, name);
 }
 
 void Program::addDirective(Own<Directive> directive) {
     assert(directive && "NULL directive");
-    auto& info = relations[directive->getQualifiedName()];
+    auto& info = addRelationInfo(directive->getQualifiedName());
     info.directives.push_back(std::move(directive));
 }
 
 void Program::addRelation(Own<Relation> relation) {
     assert(relation != nullptr);
-    auto& info = relations[relation->getQualifiedName()];
+    auto& info = addRelationInfo(relation->getQualifiedName());
     assert(info.decls.empty() && "Redefinition of relation!");
     info.decls.push_back(std::move(relation));
 }
 
 bool Program::removeRelation(QualifiedName const& name) {
-    return 0 < relations.erase(name);
+    return removeRelationInfo(name);
 }
 
 void Program::removeRelation(Relation const& r) {
     auto name = r.getQualifiedName();
-    erase(relations, &RelationInfo::decls, r);  // run just for assert/sancheck
+    erase(getRelationInfo(name), &RelationInfo::decls, r);  // run just for assert/sancheck
     removeRelation(name);
 }
 
 void Program::addClause(Own<Clause> clause) {
     assert(clause != nullptr && "Undefined clause");
     assert(clause_visit_in_progress == 0 && "Don't modify program clause collection mid-traversal");
-    auto& info = relations[getName(*clause)];
+    auto& info = addRelationInfo(getName(*clause));
     info.clauses.push_back(std::move(clause));
 }
 
@@ -205,7 +193,8 @@ void Program::addClauses(VecOwn<Clause> clauses) {
 
 void Program::removeClause(const Clause& clause) {
     assert(clause_visit_in_progress == 0 && "Don't modify program clause collection mid-traversal");
-    erase(relations, &RelationInfo::clauses, clause);
+    erase(getRelationInfo(getName(clause)), &RelationInfo::clauses, clause);
+    removeRelationInfoIfEmpty(getName(clause));
 }
 
 void Program::removeClauses(span<Clause const* const> clauses) {
@@ -216,7 +205,8 @@ void Program::removeClauses(span<Clause const* const> clauses) {
 }
 
 void Program::removeDirective(const Directive& directive) {
-    erase(relations, &RelationInfo::directives, directive);
+    erase(getRelationInfo(getName(directive)), &RelationInfo::directives, directive);
+    removeRelationInfoIfEmpty(getName(directive));
 }
 
 std::vector<Component*> Program::getComponents() const {
@@ -326,7 +316,31 @@ Program* Program::cloning() const {
     res->types = clone(types);
     res->functors = clone(functors);
     res->relations = clone(relations);
+    for (auto& [name, info] : res->relations) {
+        res->relationIndex[name] = &info;
+    }
     return res;
 }
 
+Program::RelationInfo& Program::addRelationInfo(QualifiedName const& name) {
+    auto& info = relationIndex[name];
+    if (info == nullptr) {
+        info = &relations[name];
+    }
+    return *info;
+}
+
+bool Program::removeRelationInfo(QualifiedName const& name) {
+    relationIndex.erase(name);
+    return 0 < relations.erase(name);
+}
+
+void Program::removeRelationInfoIfEmpty(QualifiedName const& name) {
+    auto* info = getRelationInfo(name);
+    if (info != nullptr && info->decls.empty() && info->clauses.empty() && info->directives.empty()) {
+        // everything was removed. can drop the bucket.
+        removeRelationInfo(name);
+    }
+}
+
 }  // namespace souffle::ast
@@ -31,6 +31,7 @@
 #include "souffle/utility/Visitor.h"
 #include "souffle/utility/span.h"
 #include <iosfwd>
+#include <unordered_map>
 #include <vector>
 
 namespace souffle {
@@ -77,6 +78,9 @@ public:
     //
     // The downside is that the name must not be changed after the
     // node is added to the program. This is sanchecked by assertions.
+    //
+    // The map is ordered for a stable traversal. Lookups by name go through
+    // an index hashing the interned names instead, so they take constant time.
     struct RelationInfo {
         // A well formed program has exactly one declaration per relation.
         // TODO:  Reject duplicate relation declarations in `SemanticChecker` instead of in the parser.
@@ -87,6 +91,7 @@ public:
 
     using RelationInfoMap = std::map<QualifiedName, RelationInfo>;
 
+    /** The entries of the map may be modified, but none may be added or removed */
     RelationInfoMap& getRelationInfo() {
         return relations;
     }
@@ -96,13 +101,13 @@ public:
     }
 
     RelationInfo* getRelationInfo(QualifiedName const& name) {
-        auto it = relations.find(name);
-        return it == relations.end() ? nullptr : &it->second;
+        auto it = relationIndex.find(name);
+        return it == relationIndex.end() ? nullptr : it->second;
     }
 
     RelationInfo const* getRelationInfo(QualifiedName const& name) const {
-        auto it = relations.find(name);
-        return it == relations.end() ? nullptr : &it->second;
+        auto it = relationIndex.find(name);
+        return it == relationIndex.end() ? nullptr : it->second;
     }
 
     /** Return types */
@@ -235,6 +240,15 @@ private:
 
     Program* cloning() const override;
 
+    /** Return the entry of a relation, adding an empty one if there is none */
+    RelationInfo& addRelationInfo(QualifiedName const& name);
+
+    /** Remove the entry of a relation */
+    bool removeRelationInfo(QualifiedName const& name);
+
+    /** Remove the entry of a relation if it has no declarations, clauses or directives left */
+    void removeRelationInfoIfEmpty(QualifiedName const& name);
+
 private:
     /** Program types  */
     VecOwn<Type> types;
@@ -242,6 +256,9 @@ private:
     /** Program relation declartions, clauses, and directives */
     RelationInfoMap relations;
 
+    /** Entries of `relations` by name */
+    std::unordered_map<QualifiedName, RelationInfo*> relationIndex;
+
     /** External Functors */
     VecOwn<FunctorDeclaration> functors;
 
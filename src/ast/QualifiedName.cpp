@@ -7,43 +7,86 @@
  */
 
 #include "ast/QualifiedName.h"
+#include "souffle/utility/MiscUtil.h"
 #include "souffle/utility/StreamUtil.h"
 #include <algorithm>
+#include <memory>
+#include <mutex>
 #include <ostream>
 #include <sstream>
+#include <unordered_map>
 #include <utility>
 
 namespace souffle::ast {
 
-QualifiedName::QualifiedName() {}
-QualifiedName::QualifiedName(std::string name) {
-    qualifiers.emplace_back(std::move(name));
+QualifiedName::QualifiedName() {
+    static const std::shared_ptr<const Data> empty = intern({});
+    data = empty;
 }
+QualifiedName::QualifiedName(const std::string& name) : data(intern({name})) {}
 QualifiedName::QualifiedName(const char* name) : QualifiedName(std::string(name)) {}
-QualifiedName::QualifiedName(std::vector<std::string> qualifiers) : qualifiers(std::move(qualifiers)) {}
+QualifiedName::QualifiedName(std::vector<std::string> qualifiers) : data(intern(std::move(qualifiers))) {}
 
 void QualifiedName::append(std::string name) {
+    auto qualifiers = data->qualifiers;
     qualifiers.push_back(std::move(name));
+    data = intern(std::move(qualifiers));
 }
 
 void QualifiedName::prepend(std::string name) {
+    auto qualifiers = data->qualifiers;
     qualifiers.insert(qualifiers.begin(), std::move(name));
+    data = intern(std::move(qualifiers));
 }
 
-/** convert to a string separated by fullstop */
-std::string QualifiedName::toString() const {
-    std::stringstream ss;
-    print(ss);
-    return ss.str();
+std::shared_ptr<const QualifiedName::Data> QualifiedName::intern(std::vector<std::string> qualifiers) {
+    struct Table {
+        std::mutex mutex;
+        std::unordered_map<std::string, std::weak_ptr<const Data>> entries;
+    };
+    // not destroyed, so that names in static storage may outlive it
+    static Table* table = new Table();
+
+    // qualifiers do not contain null characters, so the key is unique
+    std::string key;
+    for (const auto& qualifier : qualifiers) {
+        key += qualifier;
+        key += '\0';
+    }
+
+    std::lock_guard<std::mutex> guard(table->mutex);
+    auto& entry = table->entries[key];
+    if (auto live = entry.lock()) {
+        return live;
+    }
+
+    std::stringstream name;
+    name << join(qualifiers, ".");
+    // the last name removes the entry, unless it has been replaced by a new live entry already
+    std::shared_ptr<const Data> live(new Data{std::move(qualifiers), name.str()}, [key](const Data* data) {
+        {
+            std::lock_guard<std::mutex> guard(table->mutex);
+            auto pos = table->entries.find(key);
+            if (pos != table->entries.end() && pos->second.expired()) {
+                table->entries.erase(pos);
+            }
+        }
+        delete data;
+    });
+    entry = live;
+    return live;
 }
 
 bool QualifiedName::operator<(const QualifiedName& other) const {
-    return std::lexicographical_compare(
-            qualifiers.begin(), qualifiers.end(), other.qualifiers.begin(), other.qualifiers.end());
+    if (data == other.data) {
+        return false;
+    }
+    return std::lexicographical_compare(data->qualifiers.begin(), data->qualifiers.end(),
+            other.data->qualifiers.begin(), other.data->qualifiers.end());
 }
 
 void QualifiedName::print(std::ostream& out) const {
-    out << join(qualifiers, ".");
+    out << data->name;
 }
 
 std::ostream& operator<<(std::ostream& out, const QualifiedName& id) {
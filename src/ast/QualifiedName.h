@@ -16,7 +16,10 @@
 
 #pragma once
 
+#include <cstddef>
+#include <functional>
 #include <iosfwd>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -26,11 +29,16 @@ namespace souffle::ast {
  * @class QualifiedName
  * @brief Qualified Name class defines fully/partially qualified names
  * to identify objects in components.
+ *
+ * Qualified names are interned: equal names share their qualifiers, so
+ * that copying, comparing for equality and hashing take constant time.
+ * Entries are reference counted, and removed from the table once the
+ * last name referring to them is destroyed.
  */
 class QualifiedName {
 public:
     QualifiedName();
-    QualifiedName(std::string name);
+    QualifiedName(const std::string& name);
     QualifiedName(const char* name);
     QualifiedName(std::vector<std::string> qualifiers);
     QualifiedName(const QualifiedName&) = default;
@@ -46,35 +54,52 @@ public:
 
     /** check for emptiness */
     bool empty() const {
-        return qualifiers.empty();
+        return data->qualifiers.empty();
     }
 
     /** get qualifiers */
     const std::vector<std::string>& getQualifiers() const {
-        return qualifiers;
+        return data->qualifiers;
     }
 
     /** convert to a string separated by fullstop */
-    std::string toString() const;
+    const std::string& toString() const {
+        return data->name;
+    }
 
     bool operator==(const QualifiedName& other) const {
-        return qualifiers == other.qualifiers;
+        return data == other.data;
     }
 
     bool operator!=(const QualifiedName& other) const {
         return !(*this == other);
     }
 
+    /** lexicographical order of the qualifiers */
     bool operator<(const QualifiedName& other) const;
 
+    std::size_t hash() const {
+        return std::hash<const Data*>()(data.get());
+    }
+
     /** print qualified name */
     void print(std::ostream& out) const;
 
     friend std::ostream& operator<<(std::ostream& out, const QualifiedName& id);
 
 private:
-    /* array of name qualifiers */
-    std::vector<std::string> qualifiers;
+    struct Data {
+        /* array of name qualifiers */
+        std::vector<std::string> qualifiers;
+
+        /* qualifiers separated by fullstop */
+        std::string name;
+    };
+
+    /** get the unique live entry of the interning table for the given qualifiers */
+    static std::shared_ptr<const Data> intern(std::vector<std::string> qualifiers);
+
+    std::shared_ptr<const Data> data;
 };
 
 inline QualifiedName operator+(const std::string& name, const QualifiedName& id) {
@@ -84,3 +109,12 @@ inline QualifiedName operator+(const std::string& name, const QualifiedName& id)
 }
 
 }  // namespace souffle::ast
+
+namespace std {
+template <>
+struct hash<souffle::ast::QualifiedName> {
+    std::size_t operator()(const souffle::ast::QualifiedName& name) const {
+        return name.hash();
+    }
+};
+}  // namespace std
@@ -25,6 +25,7 @@
 #include "ast/Literal.h"
 #include "ast/Node.h"
 #include "ast/Program.h"
+#include "ast/QualifiedName.h"
 #include "ast/Relation.h"
 #include "ast/TranslationUnit.h"
 #include "ast/Variable.h"
@@ -33,6 +34,7 @@
 #include "reports/DebugReport.h"
 #include "reports/ErrorReport.h"
 #include <algorithm>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -247,4 +249,53 @@ TEST(Program, RemoveRelation) {
     EXPECT_EQ(tu1->getProgram(), tu2->getProgram());
 }
 
+TEST(Program, LookupAfterRemoval) {
+    auto tu = makeATU(".decl A,B(x:number) \n A(1). \n B(x) :- A(x).");
+    auto& program = tu->getProgram();
+    EXPECT_TRUE(program.removeRelation("B"));
+    EXPECT_TRUE(program.getRelation("B") == nullptr);
+    EXPECT_EQ(0, program.getClauses("B").size());
+
+    program.removeClause(*program.getClauses("A")[0]);
+    EXPECT_TRUE(program.getRelation("A") != nullptr);
+
+    auto clone = souffle::clone(program);
+    EXPECT_TRUE(clone->getRelation("A") != nullptr);
+    EXPECT_TRUE(clone->getRelation("A") != program.getRelation("A"));
+}
+
+TEST(QualifiedName, Interning) {
+    QualifiedName a("A");
+    a.append("b");
+    QualifiedName b(std::vector<std::string>{"A", "b"});
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(&a.getQualifiers(), &b.getQualifiers());
+    EXPECT_EQ(std::hash<QualifiedName>()(a), std::hash<QualifiedName>()(b));
+    EXPECT_EQ("A.b", a.toString());
+
+    // names that print alike are still distinct
+    EXPECT_NE(a, QualifiedName("A.b"));
+    EXPECT_NE(QualifiedName(), QualifiedName(""));
+
+    // the order is lexicographic in the qualifiers
+    EXPECT_TRUE(QualifiedName("A") < a);
+    EXPECT_TRUE(a < QualifiedName("B"));
+    EXPECT_FALSE(a < b);
+}
+
+TEST(QualifiedName, Release) {
+    auto a = std::make_unique<QualifiedName>(std::vector<std::string>{"released", "name"});
+    QualifiedName copy = *a;
+    a.reset();
+    // the entry is kept alive by the copy
+    EXPECT_EQ(copy, QualifiedName(std::vector<std::string>{"released", "name"}));
+    EXPECT_EQ("released.name", copy.toString());
+
+    // once the last name is gone the entry is removed, and interned anew afterwards
+    copy = QualifiedName();
+    QualifiedName again(std::vector<std::string>{"released", "name"});
+    EXPECT_EQ("released.name", again.toString());
+    EXPECT_EQ(again, std::string("released") + QualifiedName("name"));
+}
+
 }  // namespace souffle::ast::test
@@ -23,8 +23,13 @@
 #include "ast/Relation.h"
 #include "ast/TranslationUnit.h"
 #include "ast/analysis/ClauseNormalisation.h"
+#include "ast/analysis/IOType.h"
+#include "ast/analysis/PrecedenceGraph.h"
+#include "ast/analysis/RecursiveClauses.h"
+#include "ast/analysis/SCCGraph.h"
 #include "ast/transform/MagicSet.h"
 #include "ast/transform/MinimiseProgram.h"
+#include "ast/transform/NameUnnamedVariables.h"
 #include "ast/transform/RemoveRedundantRelations.h"
 #include "ast/transform/RemoveRelationCopies.h"
 #include "ast/transform/ResolveAliases.h"
@@ -33,6 +38,7 @@
 #include "reports/DebugReport.h"
 #include "reports/ErrorReport.h"
 #include "souffle/utility/ContainerUtil.h"
+#include "souffle/utility/FunctionalUtil.h"
 #include "souffle/utility/StringUtil.h"
 #include <map>
 #include <memory>
@@ -783,4 +789,44 @@ TEST(Transformers, MagicSetComprehensive) {
     });
     checkRelMapEq(finalProgram, mappifyRelations(program));
 }
+
+/**
+ * Test that analyses preserved by a transformer survive its changes,
+ * unless an analysis they were computed from is invalidated.
+ */
+TEST(Transformers, PreservedAnalyses) {
+    ErrorReport errorReport;
+    DebugReport debugReport;
+    Own<TranslationUnit> tu = ParserDriver::parseTranslationUnit(
+            R"(
+                .decl a(x:number)
+                .input a
+                .decl b(x:number)
+                .output b
+                b(x) :- a(x), _ = x.
+                b(x) :- b(x), a(y), x = y.
+            )",
+            errorReport, debugReport);
+
+    auto* ioTypes = &tu->getAnalysis<IOTypeAnalysis>();
+    auto* sccGraph = &tu->getAnalysis<SCCGraphAnalysis>();
+    tu->getAnalysis<RecursiveClausesAnalysis>();
+    auto alive = [&](const char* name) {
+        return any_of(tu->getAliveAnalyses(), [&](auto* a) { return std::string(a->getName()) == name; });
+    };
+    EXPECT_TRUE(alive(PrecedenceGraphAnalysis::name));
+
+    // the rewritten clauses refer to the same relations
+    EXPECT_TRUE(NameUnnamedVariablesTransformer().apply(*tu));
+    EXPECT_TRUE(ResolveAliasesTransformer().apply(*tu));
+    EXPECT_FALSE(alive(RecursiveClausesAnalysis::name));
+    EXPECT_EQ(ioTypes, &tu->getAnalysis<IOTypeAnalysis>());
+    EXPECT_EQ(sccGraph, &tu->getAnalysis<SCCGraphAnalysis>());
+
+    // the SCC graph depends on the precedence graph
+    tu->invalidateAnalyses({IOTypeAnalysis::name, SCCGraphAnalysis::name});
+    EXPECT_TRUE(alive(IOTypeAnalysis::name));
+    EXPECT_FALSE(alive(PrecedenceGraphAnalysis::name));
+    EXPECT_FALSE(alive(SCCGraphAnalysis::name));
+}
 }  // namespace souffle::ast::transform::test
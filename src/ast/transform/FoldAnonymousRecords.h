@@ -23,6 +23,7 @@
 #include "ast/transform/Transformer.h"
 #include "souffle/utility/ContainerUtil.h"
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -51,6 +52,11 @@ public:
         return "FoldAnonymousRecords";
     }
 
+    /** Splitting clauses may drop some, which changes the relation dependencies */
+    std::set<std::string> getPreservedAnalyses() const override {
+        return declarationAnalyses();
+    }
+
 private:
     FoldAnonymousRecords* cloning() const override {
         return new FoldAnonymousRecords();
@@ -159,7 +159,7 @@ private:
     }
 
     std::string getRelationName(const Directive* node) {
-        return toString(join(node->getQualifiedName().getQualifiers(), "."));
+        return node->getQualifiedName().toString();
     }
 
     /**
@@ -123,7 +123,7 @@ private:
      * @return Valid relation name from the concatenated qualified name.
      */
     std::string getRelationName(const Directive* node) {
-        return toString(join(node->getQualifiedName().getQualifiers(), "."));
+        return node->getQualifiedName().toString();
     }
 };
 
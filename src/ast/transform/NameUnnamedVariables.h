@@ -20,6 +20,7 @@
 
 #include "ast/TranslationUnit.h"
 #include "ast/transform/Transformer.h"
+#include <set>
 #include <string>
 
 namespace souffle::ast::transform {
@@ -35,6 +36,11 @@ public:
         return "NameUnnamedVariablesTransformer";
     }
 
+    /** Only renames variables */
+    std::set<std::string> getPreservedAnalyses() const override {
+        return dependencyAnalyses();
+    }
+
 private:
     NameUnnamedVariablesTransformer* cloning() const override {
         return new NameUnnamedVariablesTransformer();
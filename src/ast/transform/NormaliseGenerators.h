@@ -18,6 +18,8 @@
 #pragma once
 
 #include "ast/transform/Transformer.h"
+#include <set>
+#include <string>
 
 namespace souffle::ast::transform {
 
@@ -28,6 +30,11 @@ public:
         return "NormaliseGeneratorsTransformer";
     }
 
+    /** Generators move into constraints, atoms are unaffected */
+    std::set<std::string> getPreservedAnalyses() const override {
+        return dependencyAnalyses();
+    }
+
 private:
     bool transform(TranslationUnit& translationUnit) override;
 
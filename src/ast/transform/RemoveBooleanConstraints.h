@@ -16,6 +16,7 @@
 
 #include "ast/TranslationUnit.h"
 #include "ast/transform/Transformer.h"
+#include <set>
 #include <string>
 
 namespace souffle::ast::transform {
@@ -30,6 +31,11 @@ public:
         return "RemoveBooleanConstraintsTransformer";
     }
 
+    /** Removing clauses with false constraints changes the relation dependencies */
+    std::set<std::string> getPreservedAnalyses() const override {
+        return declarationAnalyses();
+    }
+
 private:
     RemoveBooleanConstraintsTransformer* cloning() const override {
         return new RemoveBooleanConstraintsTransformer();
@@ -16,6 +16,7 @@
 
 #include "ast/TranslationUnit.h"
 #include "ast/transform/Transformer.h"
+#include <set>
 #include <string>
 
 namespace souffle::ast::transform {
@@ -32,6 +33,11 @@ public:
         return "RemoveRedundantSumsTransformer";
     }
 
+    /** Sums become counts over the same bodies */
+    std::set<std::string> getPreservedAnalyses() const override {
+        return dependencyAnalyses();
+    }
+
 private:
     RemoveRedundantSumsTransformer* cloning() const override {
         return new RemoveRedundantSumsTransformer();
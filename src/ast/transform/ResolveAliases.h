@@ -19,6 +19,7 @@
 #include "ast/transform/Transformer.h"
 #include "souffle/utility/ContainerUtil.h"
 #include <memory>
+#include <set>
 #include <string>
 
 namespace souffle::ast::transform {
@@ -34,6 +35,11 @@ public:
         return "ResolveAliasesTransformer";
     }
 
+    /** Atoms of the rewritten clauses still refer to the same relations */
+    std::set<std::string> getPreservedAnalyses() const override {
+        return dependencyAnalyses();
+    }
+
     /**
      * ResolveAliasesTransformer cannot be disabled.
      */
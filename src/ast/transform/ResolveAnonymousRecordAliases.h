@@ -19,6 +19,7 @@
 #include "ast/TranslationUnit.h"
 #include "ast/transform/Transformer.h"
 #include <map>
+#include <set>
 #include <string>
 
 namespace souffle::ast::transform {
@@ -38,6 +39,11 @@ public:
         return "ResolveAnonymousRecordAliases";
     }
 
+    /** Substitutes records for variables, leaving atoms in place */
+    std::set<std::string> getPreservedAnalyses() const override {
+        return dependencyAnalyses();
+    }
+
 private:
     ResolveAnonymousRecordAliasesTransformer* cloning() const override {
         return new ResolveAnonymousRecordAliasesTransformer();
@@ -16,16 +16,31 @@
 
 #include "ast/transform/Transformer.h"
 #include "ast/TranslationUnit.h"
+#include "ast/analysis/Functor.h"
+#include "ast/analysis/IOType.h"
+#include "ast/analysis/PrecedenceGraph.h"
+#include "ast/analysis/RedundantRelations.h"
+#include "ast/analysis/RelationSchedule.h"
+#include "ast/analysis/SCCGraph.h"
+#include "ast/analysis/TopologicallySortedSCCGraph.h"
+#include "ast/analysis/typesystem/SumTypeBranches.h"
+#include "ast/analysis/typesystem/TypeEnvironment.h"
+#include "ast/transform/Meta.h"
 #include "reports/ErrorReport.h"
+#include "reports/PassTimes.h"
 
 namespace souffle::ast::transform {
 
 bool Transformer::apply(TranslationUnit& translationUnit) {
+    PassTimer timer("ast", getName(), !isA<MetaTransformer>(this));
+
     // invoke the transformation
     bool changed = transform(translationUnit);
+    timer.setChanged(changed);
 
-    if (changed) {
-        translationUnit.invalidateAnalyses();
+    // sub-transformers of a meta-transformer have already invalidated the affected analyses
+    if (changed && !isA<MetaTransformer>(this)) {
+        translationUnit.invalidateAnalyses(getPreservedAnalyses());
     }
 
     /* Abort evaluation of the program if errors were encountered */
@@ -34,4 +49,17 @@ bool Transformer::apply(TranslationUnit& translationUnit) {
     return changed;
 }
 
+std::set<std::string> Transformer::declarationAnalyses() {
+    return {analysis::TypeEnvironmentAnalysis::name, analysis::SumTypeBranchesAnalysis::name,
+            analysis::FunctorAnalysis::name, analysis::IOTypeAnalysis::name};
+}
+
+std::set<std::string> Transformer::dependencyAnalyses() {
+    auto res = declarationAnalyses();
+    res.insert({analysis::PrecedenceGraphAnalysis::name, analysis::SCCGraphAnalysis::name,
+            analysis::TopologicallySortedSCCGraphAnalysis::name, analysis::RelationScheduleAnalysis::name,
+            analysis::RedundantRelationsAnalysis::name});
+    return res;
+}
+
 }  // namespace souffle::ast::transform
@@ -18,6 +18,7 @@
 
 #include "ast/TranslationUnit.h"
 #include "souffle/utility/Types.h"
+#include <set>
 #include <string>
 
 namespace souffle::ast::transform {
@@ -42,10 +43,26 @@ public:
         return true;
     }
 
+    /**
+     * Names of the analyses whose results remain valid when the
+     * transformer changes the program. By default, all analyses
+     * are invalidated.
+     */
+    virtual std::set<std::string> getPreservedAnalyses() const {
+        return {};
+    }
+
     Own<Transformer> cloneImpl() const {
         return Own<Transformer>(cloning());
     }
 
+protected:
+    /** Analyses of the type, functor, relation and IO declarations */
+    static std::set<std::string> declarationAnalyses();
+
+    /** Declaration analyses, plus those of the dependencies between relations */
+    static std::set<std::string> dependencyAnalyses();
+
 private:
     virtual Transformer* cloning() const = 0;
 };
@@ -54,6 +54,7 @@
 #include "ram/Negation.h"
 #include "ram/NestedIntrinsicOperator.h"
 #include "ram/Query.h"
+#include "ram/RelationSize.h"
 #include "ram/Scan.h"
 #include "ram/Sequence.h"
 #include "ram/SignedConstant.h"
@@ -63,6 +64,7 @@
 #include "ram/UnsignedConstant.h"
 #include "ram/utility/Utils.h"
 #include "souffle/utility/StringUtil.h"
+#include <algorithm>
 #include <map>
 #include <unordered_set>
 #include <vector>
@@ -108,6 +110,9 @@ Own<ram::Statement> ClauseTranslator::translateRecursiveClause(
 
     // Translate the resultant clause as would be done normally
     Own<ram::Statement> rule = translateNonRecursiveClause(clause);
+    if (Global::config().has("adaptive-plans")) {
+        rule = addDeltaFirstPlan(clause, std::move(rule));
+    }
 
     // Add logging
     if (Global::config().has("profile")) {
@@ -132,6 +137,50 @@ Own<ram::Statement> ClauseTranslator::translateRecursiveClause(
     return mk<ram::Sequence>(std::move(rule));
 }
 
+Own<ram::Statement> ClauseTranslator::addDeltaFirstPlan(const ast::Clause& clause, Own<ram::Statement> rule) {
+    const auto* query = as<ram::Query>(rule);
+    if (query == nullptr || mode != DEFAULT || isA<ast::SubsumptiveClause>(clause) ||
+            Global::config().has("provenance")) {
+        return rule;
+    }
+    auto* plan = clause.getExecutionPlan();
+    if (plan != nullptr && contains(plan->getOrders(), version)) {
+        return rule;
+    }
+
+    // nothing to choose if the delta is scanned first anyway
+    const ast::Atom* delta = sccAtoms.at(version);
+    auto atoms = getAtomOrdering(clause);
+    if (atoms.size() < 2 || atoms.front() == delta) {
+        return rule;
+    }
+    std::string outerName = getClauseAtomName(clause, atoms.front());
+    std::string deltaName = getClauseAtomName(clause, delta);
+
+    // translate the clause again, scanning the delta first
+    valueIndex = mk<ValueIndex>();
+    operators.clear();
+    generators.clear();
+    deltaFirst = true;
+    auto deltaRule = translateNonRecursiveClause(clause);
+    deltaFirst = false;
+    const auto* deltaQuery = as<ram::Query>(deltaRule);
+    if (deltaQuery == nullptr) {
+        return rule;
+    }
+
+    // choose the plan whose outermost loop scans fewer tuples at the start of each iteration
+    auto deltaSmaller = [&](BinaryConstraintOp op) {
+        return mk<ram::Constraint>(op, mk<ram::RelationSize>(deltaName), mk<ram::RelationSize>(outerName));
+    };
+    VecOwn<ram::Statement> plans;
+    plans.push_back(mk<ram::Query>(
+            mk<ram::Filter>(deltaSmaller(BinaryConstraintOp::LT), clone(deltaQuery->getOperation()))));
+    plans.push_back(mk<ram::Query>(
+            mk<ram::Filter>(deltaSmaller(BinaryConstraintOp::GE), clone(query->getOperation()))));
+    return mk<ram::Sequence>(std::move(plans));
+}
+
 Own<ram::Statement> ClauseTranslator::translateNonRecursiveClause(const ast::Clause& clause) {
     // Create the appropriate query
     if (isFact(clause)) {
@@ -720,7 +769,14 @@ std::vector<ast::Atom*> ClauseTranslator::getAtomOrdering(const ast::Clause& cla
     }
 
     auto newOrder = context.getSipsMetric()->getReordering(&clause, version, mode);
-    return reorderAtoms(atoms, newOrder);
+    auto ordered = reorderAtoms(atoms, newOrder);
+    if (deltaFirst) {
+        // keep the order of the other atoms
+        const ast::Atom* delta = sccAtoms.at(version);
+        std::stable_partition(
+                ordered.begin(), ordered.end(), [&](const ast::Atom* atom) { return atom == delta; });
+    }
+    return ordered;
 }
 
 std::size_t ClauseTranslator::addOperatorLevel(const ast::Node* node) {
@@ -62,6 +62,8 @@ public:
 protected:
     std::size_t version{0};
     std::vector<ast::Atom*> sccAtoms{};
+    /** whether the atoms are ordered to scan the delta relation first */
+    bool deltaFirst{false};
 
     bool isRecursive() const;
 
@@ -69,6 +71,13 @@ protected:
 
     std::string getClauseAtomName(const ast::Clause& clause, const ast::Atom* atom) const;
 
+    /**
+     * Add a plan scanning the delta relation first to the translated rule,
+     * and choose between the plans by the sizes of the relations at the
+     * start of each iteration.
+     */
+    Own<ram::Statement> addDeltaFirstPlan(const ast::Clause& clause, Own<ram::Statement> rule);
+
     virtual Own<ram::Operation> addNegatedAtom(
             Own<ram::Operation> op, const ast::Clause& clause, const ast::Atom* atom) const;
     virtual Own<ram::Operation> addNegatedDeltaAtom(Own<ram::Operation> op, const ast::Atom* atom) const;
@@ -20,14 +20,17 @@
 #include "ast/Relation.h"
 #include "ast/SubsumptiveClause.h"
 #include "ast/TranslationUnit.h"
+#include "ast/analysis/SCCGraph.h"
 #include "ast/analysis/TopologicallySortedSCCGraph.h"
 #include "ast/utility/Utils.h"
 #include "ast/utility/Visitor.h"
 #include "ast2ram/ClauseTranslator.h"
 #include "ast2ram/utility/TranslatorContext.h"
 #include "ast2ram/utility/Utils.h"
+#include "ram/AbstractExistenceCheck.h"
 #include "ram/Call.h"
 #include "ram/Clear.h"
+#include "ram/Compress.h"
 #include "ram/Condition.h"
 #include "ram/Conjunction.h"
 #include "ram/Constraint.h"
@@ -44,12 +47,14 @@
 #include "ram/LogSize.h"
 #include "ram/LogTimer.h"
 #include "ram/Loop.h"
+#include "ram/Merge.h"
 #include "ram/MergeExtend.h"
 #include "ram/Negation.h"
 #include "ram/Parallel.h"
 #include "ram/Program.h"
 #include "ram/Query.h"
 #include "ram/Relation.h"
+#include "ram/RelationOperation.h"
 #include "ram/RelationSize.h"
 #include "ram/Scan.h"
 #include "ram/Sequence.h"
@@ -59,6 +64,7 @@
 #include "ram/TranslationUnit.h"
 #include "ram/TupleElement.h"
 #include "ram/utility/Utils.h"
+#include "ram/utility/Visitor.h"
 #include "reports/DebugReport.h"
 #include "reports/ErrorReport.h"
 #include "souffle/BinaryConstraintOps.h"
@@ -67,6 +73,7 @@
 #include "souffle/utility/FunctionalUtil.h"
 #include "souffle/utility/MiscUtil.h"
 #include "souffle/utility/StringUtil.h"
+#include "souffle/utility/json11.h"
 #include <algorithm>
 #include <cassert>
 #include <chrono>
@@ -249,9 +256,18 @@ Own<ram::Statement> UnitTranslator::generateMergeRelations(
     }
 
     // Predicate - insert all values
-    if (rel->getRepresentation() == RelationRepresentation::EQREL) {
+    auto representation = rel->getRepresentation();
+    if (representation == RelationRepresentation::EQREL) {
         return mk<ram::MergeExtend>(destRelation, srcRelation);
     }
+    // relations and their delta and new versions share the representation
+    // unless only complete relations use it, see createRamRelation
+    if (representation == RelationRepresentation::DEFAULT ||
+            representation == RelationRepresentation::BTREE ||
+            representation == RelationRepresentation::BRIE ||
+            representation == RelationRepresentation::HASH) {
+        return mk<ram::Merge>(destRelation, srcRelation);
+    }
     for (std::size_t i = 0; i < rel->getArity(); i++) {
         values.push_back(mk<ram::TupleElement>(0, i));
     }
@@ -506,11 +522,45 @@ Own<ram::Statement> UnitTranslator::generateStratumLoopBody(const std::set<const
     };
 
     // first translate regular recursive clauses
+    VecOwn<ram::Statement> recursiveRules;
     for (const ast::Relation* rel : scc) {
         auto relClauses = translateRecursiveClauses(scc, rel);
         // add profiling information
         relClauses = addProfiling(rel, std::move(relClauses));
-        appendStmt(loopBody, mk<ram::Sequence>(std::move(relClauses)));
+        appendStmt(recursiveRules, mk<ram::Sequence>(std::move(relClauses)));
+    }
+
+    // the rules of each relation only write its @new relation, which the
+    // rules of the other relations do not read, so they may run concurrently
+    std::vector<std::set<std::string>> written(recursiveRules.size());
+    std::vector<std::set<std::string>> accessed(recursiveRules.size());
+    for (std::size_t i = 0; i < recursiveRules.size(); i++) {
+        const auto& rules = *recursiveRules[i];
+        auto& writes = written[i];
+        auto& accesses = accessed[i];
+        visit(rules, [&](const ram::Insert& insert) { writes.insert(insert.getRelation()); });
+        visit(rules, [&](const ram::Erase& erase) { writes.insert(erase.getRelation()); });
+        visit(rules, [&](const ram::RelationOperation& op) { accesses.insert(op.getRelation()); });
+        visit(rules, [&](const ram::AbstractExistenceCheck& check) { accesses.insert(check.getRelation()); });
+        visit(rules, [&](const ram::EmptinessCheck& check) { accesses.insert(check.getRelation()); });
+        visit(rules, [&](const ram::RelationSize& size) { accesses.insert(size.getRelation()); });
+        accesses.insert(writes.begin(), writes.end());
+    }
+    bool independent = true;
+    for (std::size_t i = 0; i < recursiveRules.size(); i++) {
+        for (std::size_t j = 0; j < recursiveRules.size(); j++) {
+            auto accessedByOther = [&](const std::string& name) { return contains(accessed[j], name); };
+            if (i != j && any_of(written[i], accessedByOther)) {
+                independent = false;
+            }
+        }
+    }
+    if (recursiveRules.size() > 1 && independent) {
+        appendStmt(loopBody, mk<ram::Parallel>(std::move(recursiveRules)));
+    } else {
+        for (auto& rules : recursiveRules) {
+            appendStmt(loopBody, std::move(rules));
+        }
     }
 
     // translating subsumptive clauses
@@ -639,6 +689,32 @@ Own<ram::Statement> UnitTranslator::generateStoreRelation(const ast::Relation* r
     return mk<ram::Sequence>(std::move(storeStmts));
 }
 
+Own<ram::Statement> UnitTranslator::generateSpillRelation(
+        const ast::Relation* relation, const std::string& operation) const {
+    std::string ramRelationName = getConcreteRelationName(relation->getQualifiedName());
+    std::map<std::string, std::string> directives;
+    directives.insert(std::make_pair("IO", "spill"));
+    directives.insert(std::make_pair("operation", operation));
+    directives.insert(std::make_pair("name", ramRelationName));
+    directives.insert(std::make_pair("memory-limit", Global::config().get("memory-limit")));
+
+    // Tuples are stored in their internal representation, so every column is written
+    std::vector<std::string> attributeTypes;
+    for (const auto& attribute : relation->getAttributes()) {
+        attributeTypes.push_back(context->getAttributeTypeQualifier(attribute->getTypeName()));
+    }
+    long long arity{static_cast<long long>(relation->getArity())};
+    json11::Json relJson = json11::Json::object{
+            {"arity", arity}, {"types", json11::Json::array(attributeTypes.begin(), attributeTypes.end())}};
+    json11::Json types = json11::Json::object{
+            {"relation", relJson}, {"records", json11::Json::object()}, {"ADTs", json11::Json::object()}};
+    directives.insert(std::make_pair("types", types.dump()));
+
+    directives.insert(std::make_pair("auxArity", "0"));
+
+    return mk<ram::IO>(ramRelationName, directives);
+}
+
 Own<ram::Relation> UnitTranslator::createRamRelation(
         const ast::Relation* baseRelation, std::string ramRelationName) const {
     auto arity = baseRelation->getArity();
@@ -646,6 +722,13 @@ Own<ram::Relation> UnitTranslator::createRamRelation(
     auto representation = baseRelation->getRepresentation();
     if (representation == RelationRepresentation::BTREE_DELETE && ramRelationName[0] == '@') {
         representation = RelationRepresentation::DEFAULT;
+    } else if (representation == RelationRepresentation::COMPRESSED &&
+               (ramRelationName[0] == '@' || arity == 0)) {
+        // only complete relations are compressed
+        representation = RelationRepresentation::DEFAULT;
+    } else if (representation == RelationRepresentation::HASH && arity == 0) {
+        // a nullary relation holds a single tuple at most
+        representation = RelationRepresentation::DEFAULT;
     } else if (
         representation == RelationRepresentation::BTREE_MIN 
         || representation == RelationRepresentation::BTREE_MAX 
@@ -712,14 +795,85 @@ Own<ram::Sequence> UnitTranslator::generateProgram(const ast::TranslationUnit& t
     const auto& sccOrdering =
             translationUnit.getAnalysis<ast::analysis::TopologicallySortedSCCGraphAnalysis>().order();
 
+    // Relations read by a later stratum expire after their last use
+    std::set<const ast::Relation*> consumedRelations;
+    for (std::size_t i = 0; i < sccOrdering.size(); i++) {
+        const auto& expiredRelations = context->getExpiredRelations(i);
+        consumedRelations.insert(expiredRelations.begin(), expiredRelations.end());
+    }
+
+    // With a memory limit, relations are moved to disk between distant uses; provenance keeps all
+    // relations (and their provenance columns) resident
+    std::vector<VecOwn<ram::Statement>> spillStmts(sccOrdering.size());
+    std::vector<VecOwn<ram::Statement>> restoreStmts(sccOrdering.size());
+    if (Global::config().has("memory-limit") && !Global::config().has("provenance")) {
+        const auto& sccGraph = translationUnit.getAnalysis<ast::analysis::SCCGraphAnalysis>();
+        std::map<const ast::Relation*, std::size_t> computedIn;
+        std::map<const ast::Relation*, std::set<std::size_t>> usedIn;
+        for (std::size_t i = 0; i < sccOrdering.size(); i++) {
+            for (const auto* relation : context->getRelationsInSCC(sccOrdering.at(i))) {
+                computedIn[relation] = i;
+            }
+            for (const auto* relation : sccGraph.getExternalPredecessorRelations(sccOrdering.at(i))) {
+                usedIn[relation].insert(i);
+            }
+        }
+
+        // Only gaps of several strata are worth the round trip to disk
+        const std::size_t spillDistance = 2;
+        for (const auto& [relation, steps] : usedIn) {
+            std::size_t last = computedIn.at(relation);
+            for (std::size_t step : steps) {
+                if (step > last + spillDistance) {
+                    appendStmt(spillStmts[last], generateSpillRelation(relation, "spill"));
+                    appendStmt(restoreStmts[step], generateSpillRelation(relation, "restore"));
+                    if (relation->getRepresentation() == RelationRepresentation::COMPRESSED &&
+                            !Global::config().has("provenance")) {
+                        appendStmt(restoreStmts[step],
+                                mk<ram::Compress>(getConcreteRelationName(relation->getQualifiedName())));
+                    }
+                }
+                last = step;
+            }
+        }
+    }
+
     // Create subroutines for each SCC according to topological order
     for (std::size_t i = 0; i < sccOrdering.size(); i++) {
         // Generate the main stratum code
         auto stratum = generateStratum(sccOrdering.at(i));
+        if (!restoreStmts[i].empty()) {
+            stratum = mk<ram::Sequence>(mk<ram::Sequence>(std::move(restoreStmts[i])), std::move(stratum));
+        }
 
         // Clear expired relations
-        const auto& expiredRelations = context->getExpiredRelations(i);
+        auto expiredRelations = context->getExpiredRelations(i);
+        if (Global::config().has("async-output")) {
+            // Output relations without a later consumer can be dropped once written
+            for (const auto* relation : context->getOutputRelationsInSCC(sccOrdering.at(i))) {
+                if (!contains(consumedRelations, relation)) {
+                    expiredRelations.insert(relation);
+                }
+            }
+        }
+
+        // Compress relations completed by this stratum which are still needed
+        VecOwn<ram::Statement> compressStmts;
+        for (const auto* relation : context->getRelationsInSCC(sccOrdering.at(i))) {
+            if (relation->getRepresentation() == RelationRepresentation::COMPRESSED &&
+                    relation->getArity() > 0 && !contains(expiredRelations, relation) &&
+                    !Global::config().has("provenance")) {
+                appendStmt(compressStmts,
+                        mk<ram::Compress>(getConcreteRelationName(relation->getQualifiedName())));
+            }
+        }
+        if (!compressStmts.empty()) {
+            stratum = mk<ram::Sequence>(std::move(stratum), mk<ram::Sequence>(std::move(compressStmts)));
+        }
         stratum = mk<ram::Sequence>(std::move(stratum), generateClearExpiredRelations(expiredRelations));
+        if (!spillStmts[i].empty()) {
+            stratum = mk<ram::Sequence>(std::move(stratum), mk<ram::Sequence>(std::move(spillStmts[i])));
+        }
 
         // Add the subroutine
         std::string stratumID = "stratum_" + toString(i);
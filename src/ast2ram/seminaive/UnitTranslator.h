@@ -72,6 +72,8 @@ protected:
     /** IO translation */
     Own<ram::Statement> generateStoreRelation(const ast::Relation* relation) const;
     Own<ram::Statement> generateLoadRelation(const ast::Relation* relation) const;
+    Own<ram::Statement> generateSpillRelation(
+            const ast::Relation* relation, const std::string& operation) const;
 
     /** Low-level stratum translation */
     Own<ram::Statement> generateStratum(std::size_t scc) const;
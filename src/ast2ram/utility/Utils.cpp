@@ -56,7 +56,7 @@ std::string getDeleteRelationName(const ast::QualifiedName& name) {
 }
 
 std::string getRelationName(const ast::QualifiedName& name) {
-    return toString(join(name.getQualifiers(), "."));
+    return name.toString();
 }
 
 std::string getBaseRelationName(const ast::QualifiedName& name) {
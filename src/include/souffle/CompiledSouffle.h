@@ -23,7 +23,10 @@
 #include "souffle/SymbolTable.h"
 #include "souffle/datastructure/BTreeDelete.h"
 #include "souffle/datastructure/Brie.h"
+#include "souffle/datastructure/CompressedBTree.h"
 #include "souffle/datastructure/EquivalenceRelation.h"
+#include "souffle/datastructure/HashedBTree.h"
+#include "souffle/datastructure/KeyStatistics.h"
 #include "souffle/datastructure/RecordTableImpl.h"
 #include "souffle/datastructure/SymbolTableImpl.h"
 #include "souffle/datastructure/Table.h"
@@ -236,6 +239,10 @@ public:
         data = false;
     }
     void printStatistics(std::ostream& /* o */) const {}
+    void makeIndexEvents(const std::string& /* relation */) const {}
+    void recycleNodes() {}
+    void interleaveNodes() {}
+    void releaseNodes() {}
 };
 
 /** Info relations */
@@ -319,6 +326,10 @@ public:
         data.clear();
     }
     void printStatistics(std::ostream& /* o */) const {}
+    void makeIndexEvents(const std::string& /* relation */) const {}
+    void recycleNodes() {}
+    void interleaveNodes() {}
+    void releaseNodes() {}
 
 private:
     std::vector<Tuple<RamDomain, Arity>> data;
@@ -477,6 +488,10 @@ struct t_eqrel {
         return res;
     }
     void printStatistics(std::ostream& /* o */) const {}
+    void makeIndexEvents(const std::string& /* relation */) const {}
+    void recycleNodes() {}
+    void interleaveNodes() {}
+    void releaseNodes() {}
 };
 
 }  // namespace souffle
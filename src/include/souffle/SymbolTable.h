@@ -18,6 +18,8 @@
 
 #include "souffle/RamTypes.h"
 
+#include <atomic>
+#include <cstddef>
 #include <memory>
 #include <string>
 
@@ -44,8 +46,25 @@ public:
  */
 class SymbolTable {
 public:
+    SymbolTable() = default;
+
+    /** @brief A copy is a distinct symbol table with an identity of its own. */
+    SymbolTable(const SymbolTable&) {}
+
+    SymbolTable& operator=(const SymbolTable&) {
+        return *this;
+    }
+
     virtual ~SymbolTable() {}
 
+    /**
+     * @brief Identity of the symbol table, distinct from that of every other
+     * symbol table created by the process, even one at the same address.
+     */
+    std::size_t getIdentity() const {
+        return identity;
+    }
+
     /**
      * @brief Iterator on a symbol table.
      *
@@ -124,6 +143,14 @@ public:
      * happened.
      */
     virtual std::pair<RamDomain, bool> findOrInsert(const std::string& symbol) = 0;
+
+private:
+    static std::size_t nextIdentity() {
+        static std::atomic<std::size_t> counter{0};
+        return ++counter;
+    }
+
+    std::size_t identity = nextIdentity();
 };
 
 }  // namespace souffle
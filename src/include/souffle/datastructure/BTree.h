@@ -28,6 +28,8 @@
 #include <cstdint>
 #include <iostream>
 #include <iterator>
+#include <memory>
+#include <new>
 #include <string>
 #include <tuple>
 #include <type_traits>
@@ -186,12 +188,13 @@ protected:
         node(bool inner) : base(inner) {}
 
         /**
-         * A deep-copy operation creating a clone of this node.
+         * A deep-copy operation creating a clone of this node, taking the
+         * new nodes from the given arena if there is one.
          */
-        node* clone() const {
+        node* clone(node_arena* arena = nullptr) const {
             // create a clone of this node
-            node* res = (this->isInner()) ? static_cast<node*>(new inner_node())
-                                          : static_cast<node*>(new leaf_node());
+            node* res = (this->isInner()) ? static_cast<node*>(create_inner(arena))
+                                          : static_cast<node*>(create_leaf(arena));
 
             // copy basic fields
             res->position = this->position;
@@ -209,7 +212,7 @@ protected:
             // copy child nodes recursively
             auto* ires = (inner_node*)res;
             for (size_type i = 0; i <= this->numElements; ++i) {
-                ires->children[i] = this->getChild(i)->clone();
+                ires->children[i] = this->getChild(i)->clone(arena);
                 ires->children[i]->parent = res;
             }
 
@@ -344,17 +347,19 @@ protected:
          *
          * @param root .. a pointer to the root-pointer of the enclosing b-tree
          *                 (might have to be updated if the root-node needs to be split)
+         * @param arena .. the storage of new nodes, if the tree recycles them
          * @param idx  .. the position of the insert causing the split
          */
 #ifdef IS_PARALLEL
-        void split(node** root, lock_type& root_lock, int idx, std::vector<node*>& locked_nodes) {
+        void split(node** root, lock_type& root_lock, node_arena* arena, int idx,
+                std::vector<node*>& locked_nodes) {
             assert(this->lock.is_write_locked());
             assert(!this->parent || this->parent->lock.is_write_locked());
             assert((this->parent != nullptr) || root_lock.is_write_locked());
             assert(this->isLeaf() || souffle::contains(locked_nodes, this));
             assert(!this->parent || souffle::contains(locked_nodes, const_cast<node*>(this->parent)));
 #else
-        void split(node** root, lock_type& root_lock, int idx) {
+        void split(node** root, lock_type& root_lock, node_arena* arena, int idx) {
 #endif
             assert(this->numElements == maxKeys);
 
@@ -362,8 +367,8 @@ protected:
             int split_point = getSplitPoint(idx);
 
             // create a new sibling node
-            node* sibling = (this->inner) ? static_cast<node*>(new inner_node())
-                                          : static_cast<node*>(new leaf_node());
+            node* sibling = (this->inner) ? static_cast<node*>(create_inner(arena))
+                                          : static_cast<node*>(create_leaf(arena));
 
 #ifdef IS_PARALLEL
             // lock sibling
@@ -393,9 +398,9 @@ protected:
 
             // update parent
 #ifdef IS_PARALLEL
-            grow_parent(root, root_lock, sibling, locked_nodes);
+            grow_parent(root, root_lock, arena, sibling, locked_nodes);
 #else
-            grow_parent(root, root_lock, sibling);
+            grow_parent(root, root_lock, arena, sibling);
 #endif
         }
 
@@ -412,14 +417,15 @@ protected:
          */
         // TODO: remove root_lock ... no longer needed
 #ifdef IS_PARALLEL
-        int rebalance_or_split(node** root, lock_type& root_lock, int idx, std::vector<node*>& locked_nodes) {
+        int rebalance_or_split(node** root, lock_type& root_lock, node_arena* arena, int idx,
+                std::vector<node*>& locked_nodes) {
             assert(this->lock.is_write_locked());
             assert(!this->parent || this->parent->lock.is_write_locked());
             assert((this->parent != nullptr) || root_lock.is_write_locked());
             assert(this->isLeaf() || souffle::contains(locked_nodes, this));
             assert(!this->parent || souffle::contains(locked_nodes, const_cast<node*>(this->parent)));
 #else
-        int rebalance_or_split(node** root, lock_type& root_lock, int idx) {
+        int rebalance_or_split(node** root, lock_type& root_lock, node_arena* arena, int idx) {
 #endif
 
             // this node is full ... and needs some space
@@ -437,7 +443,7 @@ protected:
                 // lock access to left sibling
                 if (!left->lock.try_start_write()) {
                     // left node is currently updated => skip balancing and split
-                    split(root, root_lock, idx, locked_nodes);
+                    split(root, root_lock, arena, idx, locked_nodes);
                     return 0;
                 }
 #endif
@@ -510,9 +516,9 @@ protected:
 
             // Option B) split node
 #ifdef IS_PARALLEL
-            split(root, root_lock, idx, locked_nodes);
+            split(root, root_lock, arena, idx, locked_nodes);
 #else
-            split(root, root_lock, idx);
+            split(root, root_lock, arena, idx);
 #endif
             return 0;  // = no re-balancing
         }
@@ -527,21 +533,22 @@ protected:
          * @param sibling .. the new right-sibling to be add to the parent node
          */
 #ifdef IS_PARALLEL
-        void grow_parent(node** root, lock_type& root_lock, node* sibling, std::vector<node*>& locked_nodes) {
+        void grow_parent(node** root, lock_type& root_lock, node_arena* arena, node* sibling,
+                std::vector<node*>& locked_nodes) {
             assert(this->lock.is_write_locked());
             assert(!this->parent || this->parent->lock.is_write_locked());
             assert((this->parent != nullptr) || root_lock.is_write_locked());
             assert(this->isLeaf() || souffle::contains(locked_nodes, this));
             assert(!this->parent || souffle::contains(locked_nodes, const_cast<node*>(this->parent)));
 #else
-        void grow_parent(node** root, lock_type& root_lock, node* sibling) {
+        void grow_parent(node** root, lock_type& root_lock, node_arena* arena, node* sibling) {
 #endif
 
             if (this->parent == nullptr) {
                 assert(*root == this);
 
                 // create a new root node
-                auto* new_root = new inner_node();
+                auto* new_root = create_inner(arena);
                 new_root->numElements = 1;
                 new_root->keys[0] = keys[this->numElements];
 
@@ -563,9 +570,9 @@ protected:
 
 #ifdef IS_PARALLEL
                 parent->insert_inner(
-                        root, root_lock, pos, this, keys[this->numElements], sibling, locked_nodes);
+                        root, root_lock, arena, pos, this, keys[this->numElements], sibling, locked_nodes);
 #else
-                parent->insert_inner(root, root_lock, pos, this, keys[this->numElements], sibling);
+                parent->insert_inner(root, root_lock, arena, pos, this, keys[this->numElements], sibling);
 #endif
             }
         }
@@ -579,13 +586,13 @@ protected:
          * @param newNode .. the new right-child of the inserted key
          */
 #ifdef IS_PARALLEL
-        void insert_inner(node** root, lock_type& root_lock, unsigned pos, node* predecessor, const Key& key,
-                node* newNode, std::vector<node*>& locked_nodes) {
+        void insert_inner(node** root, lock_type& root_lock, node_arena* arena, unsigned pos,
+                node* predecessor, const Key& key, node* newNode, std::vector<node*>& locked_nodes) {
             assert(this->lock.is_write_locked());
             assert(souffle::contains(locked_nodes, this));
 #else
-        void insert_inner(node** root, lock_type& root_lock, unsigned pos, node* predecessor, const Key& key,
-                node* newNode) {
+        void insert_inner(node** root, lock_type& root_lock, node_arena* arena, unsigned pos,
+                node* predecessor, const Key& key, node* newNode) {
 #endif
 
             // check capacity
@@ -598,9 +605,9 @@ protected:
 
                 // split this node
 #ifdef IS_PARALLEL
-                pos -= rebalance_or_split(root, root_lock, pos, locked_nodes);
+                pos -= rebalance_or_split(root, root_lock, arena, pos, locked_nodes);
 #else
-                pos -= rebalance_or_split(root, root_lock, pos);
+                pos -= rebalance_or_split(root, root_lock, arena, pos);
 #endif
 
                 // complete insertion within new sibling if necessary
@@ -625,9 +632,9 @@ protected:
                     }
 
                     pos = (i > static_cast<unsigned>(other->numElements)) ? 0 : static_cast<unsigned>(i);
-                    other->insert_inner(root, root_lock, pos, predecessor, key, newNode, locked_nodes);
+                    other->insert_inner(root, root_lock, arena, pos, predecessor, key, newNode, locked_nodes);
 #else
-                    other->insert_inner(root, root_lock, pos, predecessor, key, newNode);
+                    other->insert_inner(root, root_lock, arena, pos, predecessor, key, newNode);
 #endif
                     return;
                 }
@@ -1038,6 +1045,9 @@ protected:
     // a pointer to the left-most node of this tree (initial note for iteration)
     leaf_node* leftmost;
 
+    // the storage of the nodes of this tree if it recycles them, null otherwise
+    std::unique_ptr<node_arena> arena;
+
     /* -------------- operator hint statistics ----------------- */
 
     // an aggregation of statistical values of the hint utilization
@@ -1076,7 +1086,8 @@ public:
 
     // a move constructor
     btree(btree&& other)
-            : comp(other.comp), weak_comp(other.weak_comp), root(other.root), leftmost(other.leftmost) {
+            : comp(other.comp), weak_comp(other.weak_comp), root(other.root), leftmost(other.leftmost),
+              arena(std::move(other.arena)) {
         other.root = nullptr;
         other.leftmost = nullptr;
     }
@@ -1112,6 +1123,52 @@ public:
         return (root) ? root->countEntries() : 0;
     }
 
+    /**
+     * Makes this tree keep the memory of its nodes when it is cleared, to
+     * reuse it for new nodes. Clearing then takes constant time. Intended
+     * for temporary trees filled and cleared over and over, such as in the
+     * iterations of a fixpoint loop; the tree keeps as much memory as it
+     * needed at its largest, until releaseNodes() is called.
+     * The tree must be empty.
+     */
+    void recycleNodes() {
+        assert(empty() && "nodes can only be recycled from an empty tree");
+        if (!arena) {
+            arena = std::make_unique<node_arena>(std::max<std::size_t>(1 << 16, 16 * sizeof(inner_node)));
+        }
+    }
+
+    /**
+     * Makes this tree take its nodes from memory spread over all NUMA nodes,
+     * for large trees read by the threads of all NUMA nodes alike. Like
+     * recycled nodes, the memory is kept until releaseNodes() is called.
+     * The tree must be empty.
+     */
+    void interleaveNodes() {
+        assert(empty() && "nodes can only be interleaved in an empty tree");
+        if (!arena) {
+            arena = std::make_unique<node_arena>(
+                    std::max<std::size_t>(1 << 21, 16 * sizeof(inner_node)), true);
+        }
+    }
+
+    /**
+     * Clears this tree and returns the memory kept for its nodes, e.g. once
+     * the loop filling a recycling tree is done. The tree still takes new
+     * nodes the same way afterwards.
+     */
+    void releaseNodes() {
+        clear();
+        if (arena) {
+            arena->release();
+        }
+    }
+
+    // determines whether this tree recycles its nodes
+    bool recyclesNodes() const {
+        return arena != nullptr;
+    }
+
     /**
      * Inserts the given key into this tree.
      */
@@ -1142,7 +1199,7 @@ public:
             }
 
             // create new node
-            leftmost = new leaf_node();
+            leftmost = create_leaf(arena.get());
             leftmost->numElements = 1;
             leftmost->keys[0] = k;
             root = leftmost;
@@ -1343,7 +1400,7 @@ public:
                 // split this node
                 auto old_root = root;
                 idx -= cur->rebalance_or_split(
-                        const_cast<node**>(&root), root_lock, static_cast<int>(idx), parents);
+                        const_cast<node**>(&root), root_lock, arena.get(), static_cast<int>(idx), parents);
 
                 // release parent lock
                 for (auto it = parents.rbegin(); it != parents.rend(); ++it) {
@@ -1395,7 +1452,7 @@ public:
         // special handling for inserting first element
         if (empty()) {
             // create new node
-            leftmost = new leaf_node();
+            leftmost = create_leaf(arena.get());
             leftmost->numElements = 1;
             leftmost->keys[0] = k;
             root = leftmost;
@@ -1468,7 +1525,7 @@ public:
 
             if (cur->numElements >= node::maxKeys) {
                 // split this node
-                idx -= cur->rebalance_or_split(&root, root_lock, static_cast<int>(idx));
+                idx -= cur->rebalance_or_split(&root, root_lock, arena.get(), static_cast<int>(idx));
 
                 // insert element in right fragment
                 if (((size_type)idx) > cur->numElements) {
@@ -1577,9 +1634,9 @@ public:
         node* cur = root;
 
         auto checkHints = [&](node* last_find_end) {
-            if (!last_find_end) return false;
-            if (!covers(last_find_end, k)) return false;
-            cur = last_find_end;
+            node* start = closestCovering(last_find_end, [&](const node* n) { return covers(n, k); });
+            if (!start) return false;
+            cur = start;
             return true;
         };
 
@@ -1612,6 +1669,7 @@ public:
 
             // continue search in child node
             cur = cur->getChild(pos - a);
+            prefetch(cur);
         }
     }
 
@@ -1638,9 +1696,9 @@ public:
         node* cur = root;
 
         auto checkHints = [&](node* last_lower_bound_end) {
-            if (!last_lower_bound_end) return false;
-            if (!covers(last_lower_bound_end, k)) return false;
-            cur = last_lower_bound_end;
+            node* start = closestCovering(last_lower_bound_end, [&](const node* n) { return covers(n, k); });
+            if (!start) return false;
+            cur = start;
             return true;
         };
 
@@ -1673,6 +1731,7 @@ public:
             }
 
             cur = cur->getChild(idx);
+            prefetch(cur);
         }
     }
 
@@ -1699,9 +1758,10 @@ public:
         node* cur = root;
 
         auto checkHints = [&](node* last_upper_bound_end) {
-            if (!last_upper_bound_end) return false;
-            if (!coversUpperBound(last_upper_bound_end, k)) return false;
-            cur = last_upper_bound_end;
+            node* start = closestCovering(
+                    last_upper_bound_end, [&](const node* n) { return coversUpperBound(n, k); });
+            if (!start) return false;
+            cur = start;
             return true;
         };
 
@@ -1730,6 +1790,7 @@ public:
             }
 
             cur = cur->getChild(idx);
+            prefetch(cur);
         }
     }
 
@@ -1737,7 +1798,10 @@ public:
      * Clears this tree.
      */
     void clear() {
-        if (root != nullptr) {
+        if (arena) {
+            // all nodes are forgotten at once
+            arena->reset();
+        } else if (root != nullptr) {
             if (root->isLeaf()) {
                 delete static_cast<leaf_node*>(root);
             } else {
@@ -1757,6 +1821,7 @@ public:
         // swap the content
         std::swap(root, other.root);
         std::swap(leftmost, other.leftmost);
+        std::swap(arena, other.arena);
     }
 
     // Implementation of the assignment operation for trees.
@@ -1773,7 +1838,7 @@ public:
         }
 
         // clone content (deep copy)
-        root = other.root->clone();
+        root = other.root->clone(arena.get());
 
         // update leftmost reference
         auto tmp = root;
@@ -1822,6 +1887,18 @@ public:
         return (empty()) ? 0 : root->getDepth();
     }
 
+    // Obtains the utilization of the operation hints of this tree.
+    HintStatistics getHintStatistics() const {
+        HintStatistics res;
+        res.insertHits = hint_stats.inserts.getHits();
+        res.insertMisses = hint_stats.inserts.getMisses();
+        res.lookupHits = hint_stats.contains.getHits() + hint_stats.lower_bound.getHits() +
+                         hint_stats.upper_bound.getHits();
+        res.lookupMisses = hint_stats.contains.getMisses() + hint_stats.lower_bound.getMisses() +
+                           hint_stats.upper_bound.getMisses();
+        return res;
+    }
+
     // Determines the number of nodes contained in this tree.
     size_type getNumNodes() const {
         return (empty()) ? 0 : root->countNodes();
@@ -1930,6 +2007,38 @@ protected:
         return !node->isEmpty() && less(node->keys[0], k) && less(k, node->keys[node->numElements - 1]);
     }
 
+    /**
+     * Obtains the closest node covering a key from the node a previous search
+     * ended in: the node itself or its lowest ancestor whose keys cover the
+     * key, or null if there is none. Searches for keys in increasing order
+     * thereby sweep the tree once, rather than descending from the root for
+     * every key that is not in the last leaf.
+     */
+    template <typename Covers>
+    static node* closestCovering(node* last, const Covers& covers) {
+        for (node* cur = last; cur != nullptr; cur = cur->getParent()) {
+            if (covers(cur)) {
+                return cur;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * Prefetches the keys of a node a search descends to, such that the
+     * cache misses of the search within the node overlap.
+     */
+    static void prefetch(const node* node) {
+#if defined(__GNUC__) || defined(__clang__)
+        const char* keys = reinterpret_cast<const char*>(node->keys);
+        for (std::size_t offset = 0; offset < sizeof(node->keys); offset += 64) {
+            __builtin_prefetch(keys + offset);
+        }
+#else
+        (void)node;
+#endif
+    }
+
     /**
      * Determines whether the range covered by the given node is also
      * covering the given key value.
@@ -1945,6 +2054,17 @@ protected:
                weak_less(k, node->keys[node->numElements - 1]);
     }
 
+protected:
+    // creates a leaf node, taken from the given arena if there is one
+    static leaf_node* create_leaf(node_arena* arena) {
+        return (arena) ? new (arena->allocate(sizeof(leaf_node))) leaf_node() : new leaf_node();
+    }
+
+    // creates an inner node, taken from the given arena if there is one
+    static inner_node* create_inner(node_arena* arena) {
+        return (arena) ? new (arena->allocate(sizeof(inner_node))) inner_node() : new inner_node();
+    }
+
 private:
     /**
      * Determines whether the range covered by this node covers
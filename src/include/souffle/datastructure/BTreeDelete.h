@@ -2372,6 +2372,18 @@ public:
         return (empty()) ? 0 : root->getDepth();
     }
 
+    // Obtains the utilization of the operation hints of this tree.
+    HintStatistics getHintStatistics() const {
+        HintStatistics res;
+        res.insertHits = hint_stats.inserts.getHits();
+        res.insertMisses = hint_stats.inserts.getMisses();
+        res.lookupHits = hint_stats.contains.getHits() + hint_stats.lower_bound.getHits() +
+                         hint_stats.upper_bound.getHits();
+        res.lookupMisses = hint_stats.contains.getMisses() + hint_stats.lower_bound.getMisses() +
+                           hint_stats.upper_bound.getMisses();
+        return res;
+    }
+
     // Determines the number of nodes contained in this tree.
     size_type getNumNodes() const {
         return (empty()) ? 0 : root->countNodes();
@@ -16,6 +16,23 @@
 
 #pragma once
 
+#include "souffle/utility/NumaUtil.h"
+#include "souffle/utility/ParallelUtil.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
 namespace souffle {
 
 namespace detail {
@@ -186,6 +203,123 @@ struct binary_search : public search_strategy {
     }
 };
 
+/**
+ * Determines whether a comparator orders keys by the column given by its
+ * static member leading_column first, comparing the values of the column
+ * as the signed numbers they are stored as.
+ */
+template <typename Comp, typename = void>
+struct has_leading_column : public std::false_type {};
+
+template <typename Comp>
+struct has_leading_column<Comp, std::void_t<decltype(Comp::leading_column)>> : public std::true_type {};
+
+/**
+ * A search strategy for b-tree nodes of tuples, vectorizing the comparisons
+ * of their leading column.
+ *
+ * The keys of a node are sorted by the leading column of their comparator,
+ * so the keys whose leading value is less than the one of the searched key
+ * precede all others. They are counted without branches, comparing the
+ * leading values of several keys at once by SSE2 instructions, which every
+ * x86-64 build has, or by gathering them with AVX2 if the build enables it.
+ * The keys sharing the leading value of the searched key are then compared
+ * by the comparator like in a linear search, which is all that is left in
+ * builds without these instructions. Comparators without a leading column
+ * are searched by a binary search.
+ */
+struct simd_search : public search_strategy {
+    /**
+     * Required user-defined default constructor.
+     */
+    simd_search() = default;
+
+    /**
+     * Obtains an iterator referencing an element equivalent to the
+     * given key in the given range. If no such element is present,
+     * a reference to the first element not less than the given key
+     * is returned.
+     */
+    template <typename Key, typename Iter, typename Comp>
+    inline Iter operator()(const Key& k, Iter a, Iter b, Comp& comp) const {
+        return lower_bound(k, a, b, comp);
+    }
+
+    /**
+     * Obtains a reference to the first element in the given range that
+     * is not less than the given key.
+     */
+    template <typename Key, typename Iter, typename Comp>
+    inline Iter lower_bound(const Key& k, Iter a, Iter b, Comp& comp) const {
+        if constexpr (has_leading_column<Comp>::value) {
+            return linear_search().lower_bound(k, skipLess<Comp::leading_column>(k, a, b), b, comp);
+        } else {
+            return binary_search().lower_bound(k, a, b, comp);
+        }
+    }
+
+    /**
+     * Obtains a reference to the first element in the given range that
+     * such that the given key is less than the referenced element.
+     */
+    template <typename Key, typename Iter, typename Comp>
+    inline Iter upper_bound(const Key& k, Iter a, Iter b, Comp& comp) const {
+        if constexpr (has_leading_column<Comp>::value) {
+            return linear_search().upper_bound(k, skipLess<Comp::leading_column>(k, a, b), b, comp);
+        } else {
+            return binary_search().upper_bound(k, a, b, comp);
+        }
+    }
+
+private:
+    /**
+     * Obtains a reference to the first element in the given range whose
+     * value of the given column is not less than the one of the given key.
+     */
+    template <std::size_t Column, typename Key, typename Iter>
+    static Iter skipLess([[maybe_unused]] const Key& k, Iter a, [[maybe_unused]] Iter b) {
+#if defined(__SSE2__)
+        using value_type = typename Key::value_type;
+        if constexpr (std::is_same_v<value_type, std::int32_t>) {
+            constexpr int stride = sizeof(Key) / sizeof(value_type);
+            static_assert(sizeof(Key) == stride * sizeof(value_type), "keys must be arrays of values");
+
+            const std::size_t count = b - a;
+            const value_type* values = &(*a)[Column];
+            std::size_t i = 0;
+            // lanes of comparisons that hold are -1, so subtracting them counts the keys
+#if defined(__AVX2__)
+            const __m256i offsets = _mm256_setr_epi32(
+                    0, stride, 2 * stride, 3 * stride, 4 * stride, 5 * stride, 6 * stride, 7 * stride);
+            const __m256i searched = _mm256_set1_epi32(k[Column]);
+            __m256i counts = _mm256_setzero_si256();
+            for (; i + 8 <= count; i += 8) {
+                __m256i cur = _mm256_i32gather_epi32(values + i * stride, offsets, sizeof(value_type));
+                counts = _mm256_sub_epi32(counts, _mm256_cmpgt_epi32(searched, cur));
+            }
+            __m128i sums = _mm_add_epi32(_mm256_castsi256_si128(counts), _mm256_extracti128_si256(counts, 1));
+#else
+            const __m128i searched = _mm_set1_epi32(k[Column]);
+            __m128i sums = _mm_setzero_si128();
+            for (; i + 4 <= count; i += 4) {
+                const value_type* cur = values + i * stride;
+                __m128i leading = _mm_setr_epi32(cur[0], cur[stride], cur[2 * stride], cur[3 * stride]);
+                sums = _mm_sub_epi32(sums, _mm_cmplt_epi32(leading, searched));
+            }
+#endif
+            sums = _mm_add_epi32(sums, _mm_shuffle_epi32(sums, _MM_SHUFFLE(1, 0, 3, 2)));
+            sums = _mm_add_epi32(sums, _mm_shuffle_epi32(sums, _MM_SHUFFLE(2, 3, 0, 1)));
+            std::size_t less = _mm_cvtsi128_si32(sums);
+            for (; i < count; ++i) {
+                less += (values[i * stride] < k[Column]);
+            }
+            return a + less;
+        }
+#endif
+        return a;
+    }
+};
+
 // ---------- search strategies selection --------------
 
 /**
@@ -199,6 +333,7 @@ struct strategy_selection {
 
 struct linear : public strategy_selection<linear_search> {};
 struct binary : public strategy_selection<binary_search> {};
+struct simd : public strategy_selection<simd_search> {};
 
 // by default every key utilizes binary search
 template <typename Key>
@@ -210,6 +345,12 @@ struct default_strategy<int> : public linear {};
 template <typename... Ts>
 struct default_strategy<std::tuple<Ts...>> : public linear {};
 
+#if defined(__SSE2__)
+// tuples of 32-bit numbers compare the leading values of node keys at once
+template <std::size_t N>
+struct default_strategy<std::array<std::int32_t, N>> : public simd {};
+#endif
+
 /**
  * The default non-updater
  */
@@ -220,5 +361,129 @@ struct updater {
     }
 };
 
+// ---------- node storage --------------
+
+/**
+ * The storage of the nodes of a b-tree that recycles them. Nodes are carved
+ * out of large chunks, which are kept when the tree is cleared and handed
+ * out again, so clearing the tree takes constant time and refilling it does
+ * not allocate. The chunks are only returned by release(), or when the
+ * arena is destroyed. Nodes taken from an arena are never destroyed one by one.
+ * The chunks of an interleaved arena are mapped on their own and spread
+ * over the NUMA nodes.
+ */
+class node_arena {
+public:
+    explicit node_arena(std::size_t chunkSize, bool interleaved = false)
+            : chunkSize(chunkSize), interleaved(interleaved),
+              laneCount(static_cast<std::size_t>(std::max(1, MAX_THREADS))),
+              lanes(std::make_unique<lane[]>(laneCount)) {}
+
+    node_arena(const node_arena&) = delete;
+    node_arena& operator=(const node_arena&) = delete;
+
+    /**
+     * Obtains memory for a node of the given size, at most the chunk size.
+     * May be called concurrently: each thread fills a chunk of its own, and
+     * only taking the next chunk is synchronised between threads.
+     */
+    void* allocate(std::size_t size) {
+        size = (size + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+        // the lane lock is only contended by threads sharing a thread number,
+        // e.g. within parallel regions of different tasks
+        lane& current = lanes[threadLane()];
+        std::lock_guard<SpinLock> guard(current.lock);
+        if (current.chunk == nullptr || current.offset + size > chunkSize) {
+            current.chunk = nextChunk();
+            current.offset = 0;
+        }
+        void* res = current.chunk + current.offset;
+        current.offset += size;
+        return res;
+    }
+
+    /**
+     * Forgets all nodes, keeping their memory for the next ones.
+     */
+    void reset() {
+        for (std::size_t i = 0; i < laneCount; ++i) {
+            lanes[i].chunk = nullptr;
+            lanes[i].offset = 0;
+        }
+        used = 0;
+    }
+
+    /**
+     * Forgets all nodes and returns their memory to the global allocator.
+     */
+    void release() {
+        reset();
+        chunks.clear();
+        chunks.shrink_to_fit();
+    }
+
+    /** The number of chunks obtained from the global allocator so far */
+    std::size_t getChunkCount() const {
+        return chunks.size();
+    }
+
+private:
+    /** Returns a chunk as it was obtained */
+    struct chunk_deleter {
+        std::size_t size;
+        bool mapped;
+
+        void operator()(unsigned char* chunk) const {
+            if (mapped) {
+                numa::unmapInterleaved(chunk, size);
+            } else {
+                delete[] chunk;
+            }
+        }
+    };
+
+    /** The chunk a thread currently places its nodes in, and the end of the nodes in it */
+    struct lane {
+        alignas(hardware_destructive_interference_size) SpinLock lock;
+        unsigned char* chunk = nullptr;
+        std::size_t offset = 0;
+    };
+
+    std::size_t threadLane() const {
+#ifdef IS_PARALLEL
+        return static_cast<std::size_t>(omp_get_thread_num()) % laneCount;
+#else
+        return 0;
+#endif
+    }
+
+    /** Hands out the next unused chunk, allocating it if it was not used before */
+    unsigned char* nextChunk() {
+        std::lock_guard<SpinLock> guard(chunksLock);
+        if (used == chunks.size()) {
+            // not initialised, so that the pages are placed when a node is written first
+            if (interleaved) {
+                void* chunk = numa::mapInterleaved(chunkSize);
+                if (chunk == nullptr) {
+                    throw std::bad_alloc();
+                }
+                chunks.emplace_back(static_cast<unsigned char*>(chunk), chunk_deleter{chunkSize, true});
+            } else {
+                chunks.emplace_back(new unsigned char[chunkSize], chunk_deleter{chunkSize, false});
+            }
+        }
+        return chunks[used++].get();
+    }
+
+    const std::size_t chunkSize;
+    const bool interleaved;
+    const std::size_t laneCount;
+    std::unique_ptr<lane[]> lanes;
+    std::vector<std::unique_ptr<unsigned char[], chunk_deleter>> chunks;
+    /** the number of chunks handed out to the threads */
+    std::size_t used = 0;
+    SpinLock chunksLock;
+};
+
 }  // end of namespace detail
 }  // end of namespace souffle
@@ -2151,6 +2151,15 @@ protected:
     mutable hint_statistics hint_stats;
 
 public:
+    HintStatistics getHintStatistics() const {
+        HintStatistics res;
+        res.insertHits = hint_stats.inserts.getHits();
+        res.insertMisses = hint_stats.inserts.getMisses();
+        res.lookupHits = hint_stats.contains.getHits() + hint_stats.get_boundaries.getHits();
+        res.lookupMisses = hint_stats.contains.getMisses() + hint_stats.get_boundaries.getMisses();
+        return res;
+    }
+
     void printStats(std::ostream& out) const {
         out << "---------------------------------\n";
         out << "  insert-hint (hits/misses/total): " << hint_stats.inserts.getHits() << "/"
@@ -0,0 +1,539 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2022, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file CompressedBTree.h
+ *
+ * A b-tree based set which can be compressed into a compact, read-only
+ * representation once no more elements are inserted.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "souffle/datastructure/BTree.h"
+#include "souffle/utility/ContainerUtil.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace souffle {
+
+namespace detail {
+
+/**
+ * A read-only sorted sequence of keys, stored in blocks of delta-coded entries.
+ *
+ * The first key of each block is kept in full and serves as a one-level search index. Every
+ * other key is encoded relative to its predecessor: a bit mask marks the columns that differ,
+ * and only those columns are stored, as variable-length zig-zag encoded differences. Keys in
+ * sorted order share long prefixes and differ by small amounts, so most keys take a few bytes.
+ *
+ * @tparam Key        .. the element type, a fixed-size array of integral values
+ * @tparam Comparator .. the order of the stored elements
+ */
+template <typename Key, typename Comparator>
+class compressed_key_sequence {
+    using value_type = std::decay_t<decltype(std::declval<Key>()[0])>;
+    using unsigned_type = std::make_unsigned_t<value_type>;
+    static constexpr std::size_t arity = std::tuple_size<Key>::value;
+    static constexpr std::size_t maskBytes = (arity + 7) / 8;
+    static constexpr unsigned valueBits = sizeof(value_type) * 8;
+
+public:
+    // the number of keys per block; the granularity of searches
+    static constexpr std::size_t keysPerBlock = 64;
+
+    class iterator {
+        const compressed_key_sequence* seq = nullptr;
+        std::size_t block = 0;
+        std::size_t pos = 0;
+        std::size_t offset = 0;
+        Key cur{};
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Key;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Key*;
+        using reference = const Key&;
+
+        iterator() = default;
+
+        // positions the iterator at the start of the given block
+        iterator(const compressed_key_sequence* seq, std::size_t block) : seq(seq), block(block) {
+            if (block < seq->firstKeys.size()) {
+                cur = seq->firstKeys[block];
+                offset = seq->blockOffsets[block];
+            }
+        }
+
+        const Key& operator*() const {
+            return cur;
+        }
+
+        const Key* operator->() const {
+            return &cur;
+        }
+
+        iterator& operator++() {
+            if (++pos == seq->getBlockSize(block)) {
+                *this = iterator(seq, block + 1);
+            } else {
+                seq->decode(cur, offset);
+            }
+            return *this;
+        }
+
+        iterator operator++(int) {
+            auto res = *this;
+            ++(*this);
+            return res;
+        }
+
+        bool operator==(const iterator& other) const {
+            return block == other.block && pos == other.pos;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return !(*this == other);
+        }
+
+        std::size_t getBlock() const {
+            return block;
+        }
+    };
+
+    compressed_key_sequence(Comparator comp = Comparator()) : comp(std::move(comp)) {}
+
+    /** Replaces the content of this sequence by the given keys, which must be sorted */
+    template <typename Iter>
+    void assign(const Iter& a, const Iter& b) {
+        clear();
+        Key prev{};
+        for (auto it = a; it != b; ++it) {
+            const Key& key = *it;
+            if (numKeys % keysPerBlock == 0) {
+                firstKeys.push_back(key);
+                blockOffsets.push_back(data.size());
+            } else {
+                encode(prev, key);
+            }
+            prev = key;
+            numKeys++;
+        }
+        data.shrink_to_fit();
+        firstKeys.shrink_to_fit();
+        blockOffsets.shrink_to_fit();
+    }
+
+    void clear() {
+        numKeys = 0;
+        data.clear();
+        data.shrink_to_fit();
+        firstKeys.clear();
+        firstKeys.shrink_to_fit();
+        blockOffsets.clear();
+        blockOffsets.shrink_to_fit();
+    }
+
+    bool empty() const {
+        return numKeys == 0;
+    }
+
+    std::size_t size() const {
+        return numKeys;
+    }
+
+    iterator begin() const {
+        return iterator(this, 0);
+    }
+
+    iterator end() const {
+        return iterator(this, firstKeys.size());
+    }
+
+    /** Obtains the first element not less than the given key */
+    iterator lower_bound(const Key& k) const {
+        auto next = std::partition_point(firstKeys.begin(), firstKeys.end(),
+                [&](const Key& first) { return comp.less(first, k); });
+        return scanBlock(next, [&](const Key& cur) { return comp.less(cur, k); });
+    }
+
+    /** Obtains the first element greater than the given key */
+    iterator upper_bound(const Key& k) const {
+        auto next = std::partition_point(firstKeys.begin(), firstKeys.end(),
+                [&](const Key& first) { return !comp.less(k, first); });
+        return scanBlock(next, [&](const Key& cur) { return !comp.less(k, cur); });
+    }
+
+    iterator find(const Key& k) const {
+        auto pos = lower_bound(k);
+        if (pos != end() && comp.equal(*pos, k)) {
+            return pos;
+        }
+        return end();
+    }
+
+    bool contains(const Key& k) const {
+        return find(k) != end();
+    }
+
+    /** Partitions the sequence into up to the given number of chunks, at block boundaries */
+    std::vector<range<iterator>> getChunks(std::size_t num) const {
+        std::vector<range<iterator>> res;
+        const std::size_t numBlocks = firstKeys.size();
+        const std::size_t chunks = std::max<std::size_t>(1, num);
+        const std::size_t step = std::max<std::size_t>(1, (numBlocks + chunks - 1) / chunks);
+        for (std::size_t block = 0; block < numBlocks; block += step) {
+            res.push_back({iterator(this, block), iterator(this, std::min(block + step, numBlocks))});
+        }
+        return res;
+    }
+
+    /** Obtains the number of bytes occupied by this sequence */
+    std::size_t getMemoryUsage() const {
+        return sizeof(*this) + data.capacity() + firstKeys.capacity() * sizeof(Key) +
+               blockOffsets.capacity() * sizeof(std::size_t);
+    }
+
+private:
+    Comparator comp;
+
+    // the first key of each block, in full
+    std::vector<Key> firstKeys;
+
+    // the position of each block's encoded keys in data
+    std::vector<std::size_t> blockOffsets;
+
+    // the encoded keys following the first key of each block
+    std::vector<uint8_t> data;
+
+    std::size_t numKeys = 0;
+
+    std::size_t getBlockSize(std::size_t block) const {
+        return std::min(keysPerBlock, numKeys - block * keysPerBlock);
+    }
+
+    /** Advances from the block preceding the given first key while the predicate holds */
+    template <typename Predicate>
+    iterator scanBlock(typename std::vector<Key>::const_iterator next, const Predicate& skip) const {
+        const std::size_t block = next - firstKeys.begin();
+        if (block == 0) {
+            return begin();
+        }
+        iterator pos(this, block - 1);
+        while (pos.getBlock() < block && skip(*pos)) {
+            ++pos;
+        }
+        return pos;
+    }
+
+    void encode(const Key& prev, const Key& key) {
+        const std::size_t maskPos = data.size();
+        data.resize(maskPos + maskBytes, 0);
+        for (std::size_t i = 0; i < arity; i++) {
+            if (key[i] == prev[i]) {
+                continue;
+            }
+            data[maskPos + i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+            // zig-zag encode the wrapping difference, so small steps in either direction are short
+            const unsigned_type delta =
+                    static_cast<unsigned_type>(key[i]) - static_cast<unsigned_type>(prev[i]);
+            unsigned_type zigzag = static_cast<unsigned_type>(delta << 1) ^
+                                   static_cast<unsigned_type>(-(delta >> (valueBits - 1)));
+            while (zigzag >= 0x80) {
+                data.push_back(static_cast<uint8_t>(zigzag | 0x80));
+                zigzag >>= 7;
+            }
+            data.push_back(static_cast<uint8_t>(zigzag));
+        }
+    }
+
+    void decode(Key& cur, std::size_t& offset) const {
+        const uint8_t* mask = &data[offset];
+        offset += maskBytes;
+        for (std::size_t i = 0; i < arity; i++) {
+            if ((mask[i / 8] & (1u << (i % 8))) == 0) {
+                continue;
+            }
+            unsigned_type zigzag = 0;
+            unsigned shift = 0;
+            uint8_t byte;
+            do {
+                byte = data[offset++];
+                zigzag |= static_cast<unsigned_type>(byte & 0x7f) << shift;
+                shift += 7;
+            } while ((byte & 0x80) != 0);
+            const unsigned_type delta = (zigzag >> 1) ^ static_cast<unsigned_type>(-(zigzag & 1));
+            cur[i] = static_cast<value_type>(static_cast<unsigned_type>(cur[i]) + delta);
+        }
+    }
+};
+
+/**
+ * A b-tree which can be compressed once its content is complete.
+ *
+ * Until compress() is called, all operations are forwarded to a regular b-tree. Afterwards the
+ * elements are held in a compressed_key_sequence and the b-tree is released. Inserting into a
+ * compressed tree decompresses it first; this is correct, but neither cheap nor thread-safe,
+ * and is only expected for relations that are reloaded after their stratum.
+ */
+template <typename Key, typename Comparator, bool isSet>
+class compressible_btree {
+    using live_type = std::conditional_t<isSet, btree_set<Key, Comparator>, btree_multiset<Key, Comparator>>;
+    using compressed_type = compressed_key_sequence<Key, Comparator>;
+
+public:
+    using key_type = Key;
+    using element_type = Key;
+    using operation_hints = typename live_type::operation_hints;
+
+    class iterator {
+        typename live_type::iterator live;
+        typename compressed_type::iterator compressed;
+        bool isCompressed = false;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Key;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Key*;
+        using reference = const Key&;
+
+        iterator() = default;
+        iterator(typename live_type::iterator live) : live(std::move(live)) {}
+        iterator(typename compressed_type::iterator compressed)
+                : compressed(std::move(compressed)), isCompressed(true) {}
+
+        const Key& operator*() const {
+            return isCompressed ? *compressed : *live;
+        }
+
+        const Key* operator->() const {
+            return &**this;
+        }
+
+        iterator& operator++() {
+            if (isCompressed) {
+                ++compressed;
+            } else {
+                ++live;
+            }
+            return *this;
+        }
+
+        iterator operator++(int) {
+            auto res = *this;
+            ++(*this);
+            return res;
+        }
+
+        bool operator==(const iterator& other) const {
+            return isCompressed ? compressed == other.compressed : live == other.live;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return !(*this == other);
+        }
+    };
+
+    using chunk = range<iterator>;
+
+    compressible_btree(const Comparator& comp = Comparator()) : comp(comp), live(comp), compressed(comp) {}
+
+    compressible_btree(const compressible_btree& other) : comp(other.comp), compressed(other.comp) {
+        insert(other.begin(), other.end());
+    }
+
+    /** Converts the content into the compact, read-only representation */
+    void compress() {
+        if (isCompressed) {
+            return;
+        }
+        compressed.assign(live.begin(), live.end());
+        live.clear();
+        isCompressed = true;
+    }
+
+    bool compressedState() const {
+        return isCompressed;
+    }
+
+    bool empty() const {
+        return isCompressed ? compressed.empty() : live.empty();
+    }
+
+    std::size_t size() const {
+        return isCompressed ? compressed.size() : live.size();
+    }
+
+    bool insert(const Key& k) {
+        decompress();
+        return live.insert(k);
+    }
+
+    bool insert(const Key& k, operation_hints& hints) {
+        decompress();
+        return live.insert(k, hints);
+    }
+
+    template <typename Iter>
+    void insert(const Iter& a, const Iter& b) {
+        decompress();
+        operation_hints hints;
+        for (auto it = a; it != b; ++it) {
+            live.insert(*it, hints);
+        }
+    }
+
+    iterator begin() const {
+        return isCompressed ? iterator(compressed.begin()) : iterator(live.begin());
+    }
+
+    iterator end() const {
+        return isCompressed ? iterator(compressed.end()) : iterator(live.end());
+    }
+
+    bool contains(const Key& k) const {
+        return isCompressed ? compressed.contains(k) : live.contains(k);
+    }
+
+    bool contains(const Key& k, operation_hints& hints) const {
+        return isCompressed ? compressed.contains(k) : live.contains(k, hints);
+    }
+
+    iterator find(const Key& k) const {
+        return isCompressed ? iterator(compressed.find(k)) : iterator(live.find(k));
+    }
+
+    iterator find(const Key& k, operation_hints& hints) const {
+        return isCompressed ? iterator(compressed.find(k)) : iterator(live.find(k, hints));
+    }
+
+    iterator lower_bound(const Key& k) const {
+        return isCompressed ? iterator(compressed.lower_bound(k)) : iterator(live.lower_bound(k));
+    }
+
+    iterator lower_bound(const Key& k, operation_hints& hints) const {
+        return isCompressed ? iterator(compressed.lower_bound(k)) : iterator(live.lower_bound(k, hints));
+    }
+
+    iterator upper_bound(const Key& k) const {
+        return isCompressed ? iterator(compressed.upper_bound(k)) : iterator(live.upper_bound(k));
+    }
+
+    iterator upper_bound(const Key& k, operation_hints& hints) const {
+        return isCompressed ? iterator(compressed.upper_bound(k)) : iterator(live.upper_bound(k, hints));
+    }
+
+    std::vector<chunk> partition(std::size_t num) const {
+        return getChunks(num);
+    }
+
+    std::vector<chunk> getChunks(std::size_t num) const {
+        std::vector<chunk> res;
+        if (isCompressed) {
+            for (const auto& cur : compressed.getChunks(num)) {
+                res.push_back({iterator(cur.begin()), iterator(cur.end())});
+            }
+        } else {
+            for (const auto& cur : live.getChunks(num)) {
+                res.push_back({iterator(cur.begin()), iterator(cur.end())});
+            }
+        }
+        return res;
+    }
+
+    void clear() {
+        live.clear();
+        compressed.clear();
+        isCompressed = false;
+    }
+
+    void swap(compressible_btree& other) {
+        std::swap(comp, other.comp);
+        live.swap(other.live);
+        std::swap(compressed, other.compressed);
+        std::swap(isCompressed, other.isCompressed);
+    }
+
+    std::size_t getMemoryUsage() const {
+        return isCompressed ? compressed.getMemoryUsage() : live.getMemoryUsage();
+    }
+
+    void printStats(std::ostream& out = std::cout) const {
+        if (!isCompressed) {
+            live.printStats(out);
+            return;
+        }
+        out << " ---------------------------------\n";
+        out << "  Elements: " << size() << "\n";
+        out << "  Compressed bytes: " << compressed.getMemoryUsage() << "\n";
+        out << "  Uncompressed bytes: " << size() * sizeof(Key) << "\n";
+        out << " ---------------------------------\n";
+    }
+
+private:
+    Comparator comp;
+    live_type live;
+    compressed_type compressed;
+    bool isCompressed = false;
+
+    void decompress() {
+        if (!isCompressed) {
+            return;
+        }
+        isCompressed = false;
+        operation_hints hints;
+        for (const auto& key : compressed) {
+            live.insert(key, hints);
+        }
+        compressed.clear();
+    }
+};
+
+}  // end namespace detail
+
+/**
+ * A b-tree based set that can be compressed once it is complete.
+ *
+ * @tparam Key        .. the element type to be stored in this set
+ * @tparam Comparator .. a class defining an order on the stored elements
+ */
+template <typename Key, typename Comparator = detail::comparator<Key>>
+class compressed_btree_set : public detail::compressible_btree<Key, Comparator, true> {
+    using super = detail::compressible_btree<Key, Comparator, true>;
+
+public:
+    using super::super;
+};
+
+/**
+ * A b-tree based multi-set that can be compressed once it is complete.
+ *
+ * @tparam Key        .. the element type to be stored in this set
+ * @tparam Comparator .. a class defining an order on the stored elements
+ */
+template <typename Key, typename Comparator = detail::comparator<Key>>
+class compressed_btree_multiset : public detail::compressible_btree<Key, Comparator, false> {
+    using super = detail::compressible_btree<Key, Comparator, false>;
+
+public:
+    using super::super;
+};
+
+}  // end namespace souffle
@@ -0,0 +1,453 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2022, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file HashedBTree.h
+ *
+ * A b-tree based set whose membership tests are answered by a concurrent
+ * hash table instead of a descent of the tree.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "souffle/datastructure/BTree.h"
+#include "souffle/utility/ParallelUtil.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace souffle {
+
+namespace detail {
+
+/**
+ * A hash of fixed-size arrays of integral values, mixing all of their elements.
+ *
+ * The sign bit alone, which is the pattern of -0.0 in float columns, is hashed like 0, since
+ * the comparators of float columns consider both zeros equal.
+ */
+template <typename Key>
+struct array_hash {
+    std::size_t operator()(const Key& k) const {
+        std::uint64_t h = 0x9e3779b97f4a7c15ULL;
+        for (const auto& x : k) {
+            using value_type = std::make_unsigned_t<std::decay_t<decltype(x)>>;
+            constexpr value_type negativeZero = value_type(1) << (8 * sizeof(value_type) - 1);
+            const auto v = static_cast<value_type>(x);
+            h = (h ^ static_cast<std::uint64_t>(v == negativeZero ? 0 : v)) * 0xbf58476d1ce4e5b9ULL;
+            h ^= h >> 31;
+        }
+        // the high bits select the shard and the tag, the low bits the slot
+        h ^= h >> 29;
+        h *= 0x94d049bb133111ebULL;
+        h ^= h >> 32;
+        return static_cast<std::size_t>(h);
+    }
+};
+
+/**
+ * A concurrent, insert-only set of keys, hashed into open-addressing tables with linear probing.
+ *
+ * The keys are spread over shards by the high bits of their hash, each shard growing its own
+ * table. Every slot has a tag byte, which is empty, busy while a key is written to the slot,
+ * or holds 7 bits of the hash of the key in the slot; probes compare keys only if the tags match.
+ *
+ * Keys are compared by the equality of the given comparator, which must agree with the hash.
+ *
+ * Insertions and lookups share the lock of their shard, and insertions claim slots by setting
+ * their tags atomically. Growing a table takes the lock exclusively, so that the table it grew
+ * from is freed right away. Lookups may miss keys being inserted concurrently.
+ */
+template <typename Key, typename Comparator = comparator<Key>, typename Hash = array_hash<Key>>
+class concurrent_hash_set {
+    static constexpr std::size_t shardBits = 6;
+    static constexpr std::size_t numShards = std::size_t(1) << shardBits;
+    static constexpr std::size_t minCapacity = 16;
+
+    static constexpr std::uint8_t emptyTag = 0;
+    static constexpr std::uint8_t busyTag = 1;
+
+    struct Table {
+        explicit Table(std::size_t capacity)
+                : mask(capacity - 1), tags(std::make_unique<std::atomic<std::uint8_t>[]>(capacity)),
+                  keys(std::make_unique<Key[]>(capacity)) {
+            for (std::size_t i = 0; i < capacity; ++i) {
+                tags[i].store(emptyTag, std::memory_order_relaxed);
+            }
+        }
+
+        std::size_t capacity() const {
+            return mask + 1;
+        }
+
+        /** The number of keys the table takes before it grows, for a load of 3/4 */
+        std::size_t limit() const {
+            return capacity() / 4 * 3;
+        }
+
+        std::size_t mask;
+        std::unique_ptr<std::atomic<std::uint8_t>[]> tags;
+        std::unique_ptr<Key[]> keys;
+    };
+
+    struct alignas(hardware_destructive_interference_size) Shard {
+        /** shared by insertions and lookups, exclusive to replace the table */
+        mutable ReadWriteLock lock;
+        std::unique_ptr<Table> table;
+        /** the keys of the shard, including those being inserted */
+        std::atomic<std::size_t> size{0};
+    };
+
+public:
+    concurrent_hash_set(const Comparator& comp = Comparator())
+            : shards(std::make_unique<Shard[]>(numShards)), comp(comp) {}
+
+    concurrent_hash_set(const concurrent_hash_set&) = delete;
+    concurrent_hash_set& operator=(const concurrent_hash_set&) = delete;
+
+    /**
+     * Inserts the given key, returning whether it was not contained before.
+     */
+    bool insert(const Key& k) {
+        const std::size_t h = hash(k);
+        Shard& shard = shards[h >> (64 - shardBits)];
+        shard.lock.start_read();
+        Table* table = shard.table.get();
+        // reserve a slot, so that concurrent insertions never fill the table
+        while (table == nullptr || shard.size.fetch_add(1, std::memory_order_relaxed) >= table->limit()) {
+            if (table != nullptr) {
+                shard.size.fetch_sub(1, std::memory_order_relaxed);
+            }
+            const std::size_t capacity = table == nullptr ? 0 : table->capacity();
+            shard.lock.end_read();
+            grow(shard, capacity);
+            shard.lock.start_read();
+            table = shard.table.get();
+        }
+
+        const std::uint8_t tag = getTag(h);
+        for (std::size_t pos = h & table->mask;; pos = (pos + 1) & table->mask) {
+            auto& slot = table->tags[pos];
+            std::uint8_t cur = slot.load(std::memory_order_acquire);
+            if (cur == emptyTag) {
+                if (slot.compare_exchange_strong(cur, busyTag, std::memory_order_acquire)) {
+                    table->keys[pos] = k;
+                    slot.store(tag, std::memory_order_release);
+                    shard.lock.end_read();
+                    return true;
+                }
+                // another key took the slot, which may be this key
+            }
+            if (cur == busyTag) {
+                cur = await(slot);
+            }
+            if (cur == tag && comp.equal(table->keys[pos], k)) {
+                shard.size.fetch_sub(1, std::memory_order_relaxed);
+                shard.lock.end_read();
+                return false;
+            }
+        }
+    }
+
+    /**
+     * Tests whether the given key is contained in this set.
+     */
+    bool contains(const Key& k) const {
+        const std::size_t h = hash(k);
+        const Shard& shard = shards[h >> (64 - shardBits)];
+        shard.lock.start_read();
+        const Table* table = shard.table.get();
+        const bool res = table != nullptr && find(*table, h, k);
+        shard.lock.end_read();
+        return res;
+    }
+
+    /** The number of keys, only exact if no insertion is in progress */
+    std::size_t size() const {
+        std::size_t res = 0;
+        for (std::size_t i = 0; i < numShards; ++i) {
+            res += shards[i].size.load(std::memory_order_relaxed);
+        }
+        return res;
+    }
+
+    void clear() {
+        for (std::size_t i = 0; i < numShards; ++i) {
+            shards[i].table.reset();
+            shards[i].size.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void swap(concurrent_hash_set& other) {
+        std::swap(shards, other.shards);
+        std::swap(comp, other.comp);
+    }
+
+    /** The memory of the shards and their tables */
+    std::size_t getMemoryUsage() const {
+        std::size_t res = sizeof(*this) + numShards * sizeof(Shard);
+        for (std::size_t i = 0; i < numShards; ++i) {
+            if (const Table* table = shards[i].table.get()) {
+                res += sizeof(Table) + table->capacity() * (sizeof(std::uint8_t) + sizeof(Key));
+            }
+        }
+        return res;
+    }
+
+    /** The number of slots of the current tables */
+    std::size_t getCapacity() const {
+        std::size_t res = 0;
+        for (std::size_t i = 0; i < numShards; ++i) {
+            if (const Table* table = shards[i].table.get()) {
+                res += table->capacity();
+            }
+        }
+        return res;
+    }
+
+private:
+    std::unique_ptr<Shard[]> shards;
+    Comparator comp;
+
+    static std::size_t hash(const Key& k) {
+        static_assert(sizeof(std::size_t) == 8, "the shard is selected by the top bits of a 64-bit hash");
+        return Hash()(k);
+    }
+
+    /** The tag of a key in its slot, marked by the top bit to differ from the empty and busy tags */
+    static std::uint8_t getTag(std::size_t h) {
+        return static_cast<std::uint8_t>(0x80 | ((h >> (56 - shardBits)) & 0x7f));
+    }
+
+    /** Waits until the key of a busy slot is written, returning its tag */
+    static std::uint8_t await(const std::atomic<std::uint8_t>& slot) {
+        std::uint8_t cur;
+        while ((cur = slot.load(std::memory_order_acquire)) == busyTag) {
+        }
+        return cur;
+    }
+
+    /** Probes the given table for a key of the given hash */
+    bool find(const Table& table, std::size_t h, const Key& k) const {
+        const std::uint8_t tag = getTag(h);
+        for (std::size_t pos = h & table.mask;; pos = (pos + 1) & table.mask) {
+            auto& slot = table.tags[pos];
+            std::uint8_t cur = slot.load(std::memory_order_acquire);
+            if (cur == emptyTag) {
+                return false;
+            }
+            if (cur == busyTag) {
+                cur = await(slot);
+            }
+            if (cur == tag && comp.equal(table.keys[pos], k)) {
+                return true;
+            }
+        }
+    }
+
+    /**
+     * Replaces the table of the shard, of the given capacity or 0 if it has none, by one of
+     * twice its capacity and frees it, unless another insertion replaced it already.
+     */
+    void grow(Shard& shard, std::size_t capacity) {
+        shard.lock.start_write();
+        const Table* table = shard.table.get();
+        if ((table == nullptr ? 0 : table->capacity()) == capacity) {
+            auto next = std::make_unique<Table>(table == nullptr ? minCapacity : 2 * capacity);
+            if (table != nullptr) {
+                for (std::size_t i = 0; i < table->capacity(); ++i) {
+                    if (table->tags[i].load(std::memory_order_relaxed) == emptyTag) {
+                        continue;
+                    }
+                    const Key& k = table->keys[i];
+                    std::size_t pos = hash(k) & next->mask;
+                    while (next->tags[pos].load(std::memory_order_relaxed) != emptyTag) {
+                        pos = (pos + 1) & next->mask;
+                    }
+                    next->keys[pos] = k;
+                    next->tags[pos].store(table->tags[i].load(std::memory_order_relaxed),
+                            std::memory_order_relaxed);
+                }
+            }
+            shard.table = std::move(next);
+        }
+        shard.lock.end_write();
+    }
+};
+
+}  // end namespace detail
+
+/**
+ * A b-tree based set whose membership tests are answered by a concurrent hash set of its keys.
+ *
+ * Every key is inserted into the hash set first, which also detects duplicates, and then into
+ * the b-tree. Range queries, scans and their partitions are forwarded to the b-tree. The hash
+ * set may be disabled before any key is inserted, for indexes of a relation that are never
+ * tested for membership, making this a plain b-tree.
+ *
+ * @tparam Key        .. the element type to be stored in this set
+ * @tparam Comparator .. a class defining an order on the stored elements
+ */
+template <typename Key, typename Comparator = detail::comparator<Key>>
+class hashed_btree_set {
+    using ordered_type = btree_set<Key, Comparator>;
+
+public:
+    using key_type = Key;
+    using element_type = Key;
+    using operation_hints = typename ordered_type::operation_hints;
+    using iterator = typename ordered_type::iterator;
+    using chunk = range<iterator>;
+
+    hashed_btree_set(const Comparator& comp = Comparator()) : ordered(comp), hashed(comp) {}
+
+    /** Answers membership tests by the b-tree, and keeps no hash set */
+    void disableHashing() {
+        hashing = false;
+        hashed.clear();
+    }
+
+    bool empty() const {
+        return ordered.empty();
+    }
+
+    std::size_t size() const {
+        return hashing ? hashed.size() : ordered.size();
+    }
+
+    bool insert(const Key& k) {
+        operation_hints hints;
+        return insert(k, hints);
+    }
+
+    bool insert(const Key& k, operation_hints& hints) {
+        if (!hashing) {
+            return ordered.insert(k, hints);
+        }
+        if (!hashed.insert(k)) {
+            return false;
+        }
+        ordered.insert(k, hints);
+        return true;
+    }
+
+    template <typename Iter>
+    void insert(const Iter& a, const Iter& b) {
+        operation_hints hints;
+        for (auto it = a; it != b; ++it) {
+            insert(*it, hints);
+        }
+    }
+
+    iterator begin() const {
+        return ordered.begin();
+    }
+
+    iterator end() const {
+        return ordered.end();
+    }
+
+    bool contains(const Key& k) const {
+        return hashing ? hashed.contains(k) : ordered.contains(k);
+    }
+
+    bool contains(const Key& k, operation_hints& hints) const {
+        return hashing ? hashed.contains(k) : ordered.contains(k, hints);
+    }
+
+    iterator find(const Key& k) const {
+        return ordered.find(k);
+    }
+
+    iterator find(const Key& k, operation_hints& hints) const {
+        return ordered.find(k, hints);
+    }
+
+    iterator lower_bound(const Key& k) const {
+        return ordered.lower_bound(k);
+    }
+
+    iterator lower_bound(const Key& k, operation_hints& hints) const {
+        return ordered.lower_bound(k, hints);
+    }
+
+    iterator upper_bound(const Key& k) const {
+        return ordered.upper_bound(k);
+    }
+
+    iterator upper_bound(const Key& k, operation_hints& hints) const {
+        return ordered.upper_bound(k, hints);
+    }
+
+    std::vector<chunk> partition(std::size_t num) const {
+        return ordered.partition(num);
+    }
+
+    std::vector<chunk> getChunks(std::size_t num) const {
+        return ordered.getChunks(num);
+    }
+
+    void recycleNodes() {
+        ordered.recycleNodes();
+    }
+
+    void interleaveNodes() {
+        ordered.interleaveNodes();
+    }
+
+    void releaseNodes() {
+        clear();
+        ordered.releaseNodes();
+    }
+
+    void clear() {
+        ordered.clear();
+        hashed.clear();
+    }
+
+    void swap(hashed_btree_set& other) {
+        ordered.swap(other.ordered);
+        hashed.swap(other.hashed);
+        std::swap(hashing, other.hashing);
+    }
+
+    std::size_t getDepth() const {
+        return ordered.getDepth();
+    }
+
+    HintStatistics getHintStatistics() const {
+        return ordered.getHintStatistics();
+    }
+
+    std::size_t getMemoryUsage() const {
+        return ordered.getMemoryUsage() + (hashing ? hashed.getMemoryUsage() : 0);
+    }
+
+    void printStats(std::ostream& out = std::cout) const {
+        ordered.printStats(out);
+        if (hashing) {
+            out << "  Hash slots: " << hashed.getCapacity() << "\n";
+            out << "  Hash bytes: " << hashed.getMemoryUsage() << "\n";
+            out << " ---------------------------------\n";
+        }
+    }
+
+private:
+    ordered_type ordered;
+    detail::concurrent_hash_set<Key, Comparator> hashed;
+    bool hashing = true;
+};
+
+}  // end namespace souffle
@@ -0,0 +1,187 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2022, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file KeyStatistics.h
+ *
+ * Estimates the number of unique keys of large relations for the index
+ * statistics from a sample of their indexes.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "souffle/RamTypes.h"
+#include "souffle/utility/ParallelUtil.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace souffle {
+
+/** Number of tuples and (estimated) unique keys among them */
+struct KeyStatistics {
+    /** Indexes up to this size are counted exactly; larger ones are sampled about this many tuples */
+    static constexpr std::size_t exactCountLimit = std::size_t(1) << 16;
+
+    /** The smallest number of tuples sampled from a chunk */
+    static constexpr std::size_t minSampleSize = 64;
+
+    /** The smallest number of chunks a sampled index is split into, so that the sample spans the index */
+    static constexpr std::size_t minSampleChunks = 64;
+
+    std::size_t total = 0;
+    std::size_t unique = 0;
+
+    /** Hash a single value into a running key hash */
+    static uint64_t hash(uint64_t seed, RamDomain value) {
+        // splitmix64 finaliser
+        uint64_t x = seed ^ (static_cast<uint64_t>(static_cast<RamUnsigned>(value)) + 0x9e3779b97f4a7c15ULL);
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    /** Hash a key consisting of several values */
+    static uint64_t hash(std::initializer_list<RamDomain> key) {
+        uint64_t res = 0;
+        for (auto value : key) {
+            res = hash(res, value);
+        }
+        return res;
+    }
+};
+
+/**
+ * Estimate the keys of the tuples in the given chunks that satisfy the filter from a sample.
+ *
+ * The chunks must partition, in order, an index of the given size whose order starts with the key
+ * columns, so that the number of unique keys is one more than the number of key changes between
+ * adjacent tuples. Only a prefix of every chunk is scanned, in parallel. Changes in the rest of a
+ * chunk are extrapolated from the rate in its prefix, unless the last key of the prefix is also the
+ * first key of the next chunk, in which case there are none. As keys larger than a prefix are
+ * missed by the extrapolation, the estimate is at least the number of changes known to exist.
+ * Chunks that are scanned completely contribute exact counts.
+ *
+ * The filter must pass tuples all over the index. Tuples selected by constants on a prefix of the
+ * index order form a range of their own, which the prefixes of the chunks miss or take for the whole
+ * chunk; such ranges are counted with countKeys instead.
+ */
+template <typename Chunks, typename Filter, typename Hash>
+KeyStatistics sampleKeys(const Chunks& chunks, std::size_t size, const Filter& filter, const Hash& hashKey) {
+    /** What the sampled prefix of a chunk has seen */
+    struct Sample {
+        std::size_t scanned = 0;
+        std::size_t matched = 0;
+        std::size_t changes = 0;
+        bool complete = true;
+        uint64_t first = 0;
+        uint64_t last = 0;
+    };
+
+    const int numChunks = static_cast<int>(chunks.size());
+    if (numChunks == 0) {
+        return {};
+    }
+    const double chunkSize = static_cast<double>(size) / numChunks;
+    const std::size_t sampleSize =
+            std::max(KeyStatistics::minSampleSize, KeyStatistics::exactCountLimit / chunks.size());
+    std::vector<Sample> samples(numChunks);
+
+    PARALLEL_START
+        pfor(int i = 0; i < numChunks; i++) {
+            Sample& sample = samples[i];
+            for (const auto& tuple : chunks[i]) {
+                if (sample.scanned == sampleSize) {
+                    sample.complete = false;
+                    break;
+                }
+                ++sample.scanned;
+                if (!filter(tuple)) {
+                    continue;
+                }
+                const uint64_t key = hashKey(tuple);
+                if (sample.matched == 0) {
+                    sample.first = key;
+                } else if (key != sample.last) {
+                    ++sample.changes;
+                }
+                sample.last = key;
+                ++sample.matched;
+            }
+        }
+    PARALLEL_END
+
+    double total = 0;
+    // changes extrapolated from the rate in each prefix, and changes known to exist
+    double extrapolated = 0;
+    double observed = 0;
+    const Sample* next = nullptr;
+    for (int i = numChunks - 1; i >= 0; i--) {
+        const Sample& sample = samples[i];
+        const double scale = sample.complete ? 1.0 : std::max(1.0, chunkSize / sample.scanned);
+        total += sample.matched * scale;
+        if (sample.matched == 0) {
+            continue;
+        }
+
+        // changes after the prefix, up to the first key of the next chunk
+        const bool changesUntilNext = (next != nullptr) && (next->first != sample.last);
+        observed += sample.changes + changesUntilNext;
+        extrapolated += sample.changes;
+        if (sample.complete) {
+            extrapolated += changesUntilNext;
+        } else if (next == nullptr || changesUntilNext) {
+            const double rate =
+                    sample.matched > 1 ? static_cast<double>(sample.changes) / (sample.matched - 1) : 0;
+            extrapolated += rate * sample.matched * (scale - 1);
+        }
+        next = &sample;
+    }
+
+    KeyStatistics res;
+    res.total = static_cast<std::size_t>(std::llround(total));
+    if (res.total > 0) {
+        const double changes = std::max(extrapolated, observed);
+        res.unique = std::min(res.total, static_cast<std::size_t>(std::llround(1 + changes)));
+    }
+    return res;
+}
+
+/**
+ * Count the keys of the tuples in the given range that satisfy the filter.
+ *
+ * The range must be ordered by an index order starting with the key columns, so that every key
+ * change between adjacent tuples starts a new key. Keys are compared by the values of their columns,
+ * copied by keyOf from the tuples, so that the count is exact.
+ */
+template <typename Range, typename Filter, typename KeyOf>
+KeyStatistics countKeys(const Range& tuples, const Filter& filter, const KeyOf& keyOf) {
+    KeyStatistics res;
+    decltype(keyOf(*std::declval<std::decay_t<decltype(tuples.begin())>&>())) last{};
+    for (const auto& tuple : tuples) {
+        if (!filter(tuple)) {
+            continue;
+        }
+        auto key = keyOf(tuple);
+        if (res.total == 0 || key != last) {
+            ++res.unique;
+        }
+        last = key;
+        ++res.total;
+    }
+    return res;
+}
+
+}  // namespace souffle
@@ -0,0 +1,252 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2022, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file Spill.h
+ *
+ * Moves relations that are not needed for a while to disk when the
+ * program exceeds its memory limit, and reloads them on demand.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "souffle/RamTypes.h"
+#include "souffle/RecordTable.h"
+#include "souffle/SymbolTable.h"
+#include "souffle/io/ReadStream.h"
+#include "souffle/io/WriteStream.h"
+#include "souffle/utility/ContainerUtil.h"
+#include "souffle/utility/MiscUtil.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#ifdef WIN32
+#include <Psapi.h>
+#include <process.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif  // WIN32
+
+namespace souffle {
+
+namespace spill {
+
+/** Return the resident memory of the process in bytes */
+inline std::size_t residentMemory() {
+#ifdef WIN32
+    PROCESS_MEMORY_COUNTERS processMemoryCounters;
+    GetProcessMemoryInfo(GetCurrentProcess(), &processMemoryCounters, sizeof(processMemoryCounters));
+    return processMemoryCounters.WorkingSetSize;
+#else
+    std::ifstream statm("/proc/self/statm");
+    std::size_t totalPages = 0;
+    std::size_t residentPages = 0;
+    if (statm >> totalPages >> residentPages) {
+        return residentPages * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    }
+    // without /proc, the peak resident set size is the best estimate available
+    struct rusage ru {};
+    getrusage(RUSAGE_SELF, &ru);
+#ifdef __APPLE__
+    return static_cast<std::size_t>(ru.ru_maxrss);
+#else
+    return static_cast<std::size_t>(ru.ru_maxrss) * 1024;
+#endif
+#endif  // WIN32
+}
+
+/** Parse a memory size such as `512M` or `200G` into bytes */
+inline std::size_t parseSize(const std::string& size) {
+    std::size_t pos = 0;
+    const std::size_t value = std::stoull(size, &pos);
+    const std::string unit = size.substr(pos);
+    if (unit.empty() || unit == "B") return value;
+    if (unit == "K" || unit == "k") return value << 10;
+    if (unit == "M" || unit == "m") return value << 20;
+    if (unit == "G" || unit == "g") return value << 30;
+    if (unit == "T" || unit == "t") return value << 40;
+    throw std::invalid_argument("invalid memory size: " + size);
+}
+
+/**
+ * Writes tuples in their internal representation.
+ *
+ * Symbols and records are kept as their indices, as the symbol and record tables remain in memory;
+ * the file is only meaningful to the program that wrote it.
+ */
+class WriteStreamSpill : public WriteStream {
+public:
+    WriteStreamSpill(const std::string& fileName, const std::map<std::string, std::string>& rwOperation,
+            const SymbolTable& symbolTable, const RecordTable& recordTable)
+            : WriteStream(rwOperation, symbolTable, recordTable), fileName(fileName),
+              file(std::fopen(fileName.c_str(), "wb")) {
+        if (file == nullptr) {
+            throw std::invalid_argument("Cannot open spill file " + fileName);
+        }
+    }
+
+    ~WriteStreamSpill() override {
+        std::fclose(file);
+    }
+
+    /** Return the number of bytes written so far */
+    std::size_t getBytesWritten() const {
+        return bytesWritten;
+    }
+
+protected:
+    void writeNullary() override {
+        const RamDomain marker = 0;
+        std::fwrite(&marker, sizeof(RamDomain), 1, file);
+    }
+
+    void writeNextTuple(const RamDomain* tuple) override {
+        const std::size_t columns = typeAttributes.size();
+        if (std::fwrite(tuple, sizeof(RamDomain), columns, file) != columns) {
+            throw std::runtime_error("Cannot write spill file " + fileName);
+        }
+        bytesWritten += columns * sizeof(RamDomain);
+    }
+
+    const std::string fileName;
+    std::FILE* file;
+    std::size_t bytesWritten = 0;
+};
+
+/** Reads tuples written by WriteStreamSpill */
+class ReadStreamSpill : public ReadStream {
+public:
+    ReadStreamSpill(const std::string& fileName, const std::map<std::string, std::string>& rwOperation,
+            SymbolTable& symbolTable, RecordTable& recordTable)
+            : ReadStream(rwOperation, symbolTable, recordTable), fileName(fileName),
+              file(std::fopen(fileName.c_str(), "rb")) {
+        if (file == nullptr) {
+            throw std::invalid_argument("Cannot open spill file " + fileName);
+        }
+    }
+
+    ~ReadStreamSpill() override {
+        std::fclose(file);
+    }
+
+protected:
+    Own<RamDomain[]> readNextTuple() override {
+        // nullary relations are stored as a single marker value
+        const std::size_t columns = std::max<std::size_t>(1, typeAttributes.size());
+        Own<RamDomain[]> tuple = mk<RamDomain[]>(columns);
+        if (std::fread(tuple.get(), sizeof(RamDomain), columns, file) != columns) {
+            return nullptr;
+        }
+        return tuple;
+    }
+
+    const std::string fileName;
+    std::FILE* file;
+};
+
+/**
+ * Moves the relations of one program to disk and back.
+ *
+ * Only relations spilled by this object are ever restored, so stale files of other runs are
+ * never read. The resident size of a process rarely shrinks once a relation is purged, as the
+ * allocator keeps the pages; the bytes spilled are therefore deducted from the resident size
+ * before it is compared against the limit.
+ */
+class Spiller {
+public:
+    Spiller() : prefix(nextPrefix()) {}
+
+    Spiller(const Spiller&) = delete;
+    Spiller& operator=(const Spiller&) = delete;
+
+    ~Spiller() {
+        for (const auto& [name, bytes] : spilled) {
+            std::error_code ec;
+            std::filesystem::remove(name, ec);
+        }
+    }
+
+    /** Check whether the program exceeds the memory limit given by the `memory-limit` directive */
+    bool exceedsMemoryLimit(const std::map<std::string, std::string>& rwOperation) const {
+        const std::size_t resident = residentMemory();
+        const std::size_t accounted = resident > spilledBytes ? resident - spilledBytes : 0;
+        return accounted > parseSize(rwOperation.at("memory-limit"));
+    }
+
+    /** Write the relation to disk and purge it */
+    template <typename Rel>
+    void spill(Rel& relation, const std::map<std::string, std::string>& rwOperation,
+            const SymbolTable& symbolTable, const RecordTable& recordTable) {
+        const std::string fileName = getFileName(rwOperation);
+        assert(!contains(spilled, fileName) && "relation spilled twice");
+        WriteStreamSpill stream(fileName, rwOperation, symbolTable, recordTable);
+        stream.writeAll(relation);
+        relation.purge();
+        spilled[fileName] = stream.getBytesWritten();
+        spilledBytes += stream.getBytesWritten();
+    }
+
+    /** Reload the relation if it has been spilled by this object */
+    template <typename Rel>
+    void restore(Rel& relation, const std::map<std::string, std::string>& rwOperation,
+            SymbolTable& symbolTable, RecordTable& recordTable) {
+        const std::string fileName = getFileName(rwOperation);
+        auto pos = spilled.find(fileName);
+        if (pos == spilled.end()) {
+            return;
+        }
+        ReadStreamSpill(fileName, rwOperation, symbolTable, recordTable).readAll(relation);
+        std::filesystem::remove(fileName);
+        spilledBytes -= pos->second;
+        spilled.erase(pos);
+    }
+
+private:
+    /** Return a file name prefix unique to this object in this process */
+    static std::string nextPrefix() {
+        static std::atomic<std::size_t> counter{0};
+#ifdef WIN32
+        const auto pid = _getpid();
+#else
+        const auto pid = getpid();
+#endif
+        return "souffle-" + std::to_string(pid) + "-" + std::to_string(counter++) + "-";
+    }
+
+    /** Return the file a relation is spilled to */
+    std::string getFileName(const std::map<std::string, std::string>& rwOperation) const {
+        std::filesystem::path dir = getOr(rwOperation, "spill-dir", "");
+        if (dir.empty()) {
+            dir = std::filesystem::temp_directory_path();
+        }
+        return (dir / (prefix + rwOperation.at("name") + ".spill")).string();
+    }
+
+    const std::string prefix;
+
+    /** Files written and not yet restored, with the bytes they hold */
+    std::map<std::string, std::size_t> spilled;
+
+    /** Total bytes held on disk */
+    std::size_t spilledBytes = 0;
+};
+
+}  // namespace spill
+
+}  // namespace souffle
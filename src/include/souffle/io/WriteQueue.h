@@ -0,0 +1,119 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2022, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file WriteQueue.h
+ *
+ * A background queue for output jobs, so that relations can be written
+ * while evaluation continues with later strata.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace souffle {
+
+/**
+ * @class WriteQueue
+ *
+ * Executes jobs on a background thread, one at a time and in submission order.
+ *
+ * Output jobs only read relations whose stratum has completed, so they may run concurrently
+ * with evaluation. Jobs purging a relation after its last output are queued behind the output.
+ * Without OpenMP, the symbol and record tables are not safe for concurrent use, and jobs are
+ * executed immediately on the calling thread. An exception thrown by a job is rethrown by the
+ * next call to wait(); the remaining jobs are still executed.
+ */
+class WriteQueue {
+public:
+    WriteQueue() = default;
+    WriteQueue(const WriteQueue&) = delete;
+    WriteQueue& operator=(const WriteQueue&) = delete;
+
+    ~WriteQueue() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        changed.notify_all();
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+
+    /** Queue a job for execution on the background thread */
+    void push(std::function<void()> job) {
+#ifdef _OPENMP
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            jobs.push_back(std::move(job));
+            if (!worker.joinable()) {
+                worker = std::thread([this]() { run(); });
+            }
+        }
+        changed.notify_all();
+#else
+        job();
+#endif
+    }
+
+    /** Block until all queued jobs have been executed, and rethrow the first exception of a job */
+    void wait() {
+        std::unique_lock<std::mutex> guard(lock);
+        changed.wait(guard, [this]() { return jobs.empty() && !busy; });
+        if (error) {
+            std::rethrow_exception(std::exchange(error, nullptr));
+        }
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> guard(lock);
+        while (true) {
+            changed.wait(guard, [this]() { return !jobs.empty() || stopping; });
+            if (jobs.empty()) {
+                return;
+            }
+            auto job = std::move(jobs.front());
+            jobs.pop_front();
+            busy = true;
+            guard.unlock();
+            std::exception_ptr failure;
+            try {
+                job();
+            } catch (...) {
+                failure = std::current_exception();
+            }
+            guard.lock();
+            if (failure && !error) {
+                error = failure;
+            }
+            busy = false;
+            changed.notify_all();
+        }
+    }
+
+    std::mutex lock;
+    std::condition_variable changed;
+    std::deque<std::function<void()>> jobs;
+    std::thread worker;
+    std::exception_ptr error;
+    bool busy = false;
+    bool stopping = false;
+};
+
+}  // namespace souffle
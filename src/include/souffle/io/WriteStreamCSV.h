@@ -131,7 +131,7 @@ public:
             : WriteStreamCSV(rwOperation, symbolTable, recordTable),
               file(getFileName(rwOperation), std::ios::out | std::ios::binary) {
         if (getOr(rwOperation, "headers", "false") == "true") {
-            file << rwOperation.at("attributeNames") << std::endl;
+            file << rwOperation.at("attributeNames") << '\n';
         }
         file << std::setprecision(std::numeric_limits<RamFloat>::max_digits10);
     }
@@ -172,8 +172,9 @@ public:
             const RecordTable& recordTable)
             : WriteStreamCSV(rwOperation, symbolTable, recordTable),
               file(getFileName(rwOperation), std::ios::out | std::ios::binary) {
+        file.setThreads(std::stoul(getOr(rwOperation, "jobs", "1")));
         if (getOr(rwOperation, "headers", "false") == "true") {
-            file << rwOperation.at("attributeNames") << std::endl;
+            file << rwOperation.at("attributeNames") << '\n';
         }
         file << std::setprecision(std::numeric_limits<RamFloat>::max_digits10);
     }
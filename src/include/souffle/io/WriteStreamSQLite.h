@@ -18,11 +18,14 @@
 #include "souffle/RecordTable.h"
 #include "souffle/SymbolTable.h"
 #include "souffle/io/WriteStream.h"
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <iostream>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -37,19 +40,33 @@ public:
     WriteStreamSQLite(const std::map<std::string, std::string>& rwOperation, const SymbolTable& symbolTable,
             const RecordTable& recordTable)
             : WriteStream(rwOperation, symbolTable, recordTable), dbFilename(getFileName(rwOperation)),
-              relationName(rwOperation.at("name")) {
+              relationName(rwOperation.at("name")),
+              bulkSymbols(getOr(rwOperation, "symbols", "incremental") == "bulk") {
         openDB();
+        // a writer that fails to open leaves the database as it was
+        executeSQL("BEGIN TRANSACTION", db);
         createTables();
+        checkSymbolMode();
         prepareStatements();
-        executeSQL("BEGIN TRANSACTION", db);
+        if (bulkSymbols) {
+            try {
+                writeSymbolTable();
+            } catch (...) {
+                closeDB();
+                throw;
+            }
+        }
     }
 
     ~WriteStreamSQLite() override {
-        executeSQL("COMMIT", db);
-        sqlite3_finalize(insertStatement);
-        sqlite3_finalize(symbolInsertStatement);
-        sqlite3_finalize(symbolSelectStatement);
-        sqlite3_close(db);
+        // a destructor must not throw: report errors of the remaining writes instead
+        try {
+            flushBatch();
+            executeSQL("COMMIT", db);
+        } catch (const std::exception& e) {
+            std::cerr << e.what();
+        }
+        closeDB();
     }
 
 protected:
@@ -57,31 +74,46 @@ protected:
 
     void writeNextTuple(const RamDomain* tuple) override {
         for (std::size_t i = 0; i < arity; i++) {
-            RamDomain value = 0;  // Silence warning
-
             switch (typeAttributes.at(i)[0]) {
-                case 's': value = getSymbolTableID(tuple[i]); break;
-                default: value = tuple[i]; break;
+                case 's': batch.push_back(getSymbolTableID(tuple[i])); break;
+                default: batch.push_back(tuple[i]); break;
             }
+        }
+        if (batch.size() == batchRows * arity) {
+            insertRows(batchInsertStatement, batchRows);
+            batch.clear();
+        }
+    }
 
+private:
+    /** Bind the first `rows` buffered tuples to the given statement and execute it */
+    void insertRows(sqlite3_stmt* statement, std::size_t rows, std::size_t offset = 0) {
+        for (std::size_t i = 0; i < rows * arity; i++) {
+            const RamDomain value = batch[offset + i];
 #if RAM_DOMAIN_SIZE == 64
-            if (sqlite3_bind_int64(insertStatement, static_cast<int>(i + 1),
-                        static_cast<sqlite3_int64>(value)) != SQLITE_OK) {
-#else
-            if (sqlite3_bind_int(insertStatement, static_cast<int>(i + 1), static_cast<int>(value)) !=
+            if (sqlite3_bind_int64(statement, static_cast<int>(i + 1), static_cast<sqlite3_int64>(value)) !=
                     SQLITE_OK) {
+#else
+            if (sqlite3_bind_int(statement, static_cast<int>(i + 1), static_cast<int>(value)) != SQLITE_OK) {
 #endif
                 throwError("SQLite error in sqlite3_bind_text: ");
             }
         }
-        if (sqlite3_step(insertStatement) != SQLITE_DONE) {
+        if (sqlite3_step(statement) != SQLITE_DONE) {
             throwError("SQLite error in sqlite3_step: ");
         }
-        sqlite3_clear_bindings(insertStatement);
-        sqlite3_reset(insertStatement);
+        sqlite3_clear_bindings(statement);
+        sqlite3_reset(statement);
+    }
+
+    /** Write the tuples remaining in a partially filled batch one row at a time */
+    void flushBatch() {
+        for (std::size_t offset = 0; offset < batch.size(); offset += arity) {
+            insertRows(insertStatement, 1, offset);
+        }
+        batch.clear();
     }
 
-private:
     void executeSQL(const std::string& sql, sqlite3* db) {
         assert(db && "Database connection is closed");
 
@@ -117,9 +149,15 @@ private:
         sqlite3_reset(symbolSelectStatement);
         return rowid;
     }
-    uint64_t getSymbolTableID(std::size_t index) {
-        if (dbSymbolTable.count(index) != 0) {
-            return dbSymbolTable[index];
+    RamDomain getSymbolTableID(RamDomain index) {
+        // In bulk mode the symbol table rows use the interned index as their id
+        if (bulkSymbols) {
+            return index;
+        }
+
+        auto pos = dbSymbolTable.find(index);
+        if (pos != dbSymbolTable.end()) {
+            return pos->second;
         }
 
         if (sqlite3_bind_text(symbolInsertStatement, 1, symbolTable.decode(index).c_str(), -1,
@@ -137,8 +175,139 @@ private:
         sqlite3_clear_bindings(symbolInsertStatement);
         sqlite3_reset(symbolInsertStatement);
 
-        dbSymbolTable[index] = rowid;
-        return rowid;
+        dbSymbolTable[index] = static_cast<RamDomain>(rowid);
+        return static_cast<RamDomain>(rowid);
+    }
+
+    /**
+     * Symbols already written to a database in bulk mode.
+     *
+     * All writers of one program share a single symbol table, so its symbols only have to be
+     * written once per database; later writers only add the symbols created since. The state
+     * belongs to the symbol table of the given identity, which tells the programs of a process
+     * apart, and is dropped when the database holds no symbols, as it does once it is replaced.
+     */
+    struct BulkSymbolState {
+        std::size_t symbolTable = 0;
+        std::vector<bool> written;
+    };
+
+    static std::mutex& bulkSymbolLock() {
+        static std::mutex lock;
+        return lock;
+    }
+
+    static std::map<std::string, BulkSymbolState>& bulkSymbolStates() {
+        static std::map<std::string, BulkSymbolState> states;
+        return states;
+    }
+
+    /** Write all not yet written symbols of the program symbol table, keyed by their interned index */
+    void writeSymbolTable() {
+        std::lock_guard<std::mutex> guard(bulkSymbolLock());
+        auto& state = bulkSymbolStates()[dbFilename];
+        if (state.symbolTable != symbolTable.getIdentity() ||
+                selectValue("SELECT id FROM '" + symbolTableName + "' LIMIT 1;").empty()) {
+            state.symbolTable = symbolTable.getIdentity();
+            state.written.clear();
+        }
+
+        // Symbols of other symbol tables are kept, as the tables of their relations refer to them.
+        // They may only coincide with the symbols of this program, or else the database is rejected.
+        sqlite3_stmt* statement = nullptr;
+        std::stringstream insertSQL;
+        insertSQL << "INSERT OR IGNORE INTO '" << symbolTableName << "' VALUES(@V0,@V1);";
+        if (sqlite3_prepare_v2(db, insertSQL.str().c_str(), -1, &statement, nullptr) != SQLITE_OK) {
+            throwError("SQLite error in sqlite3_prepare_v2: ");
+        }
+        for (const auto& symbol : symbolTable) {
+            const std::size_t index = symbol.second;
+            if (index < state.written.size() && state.written[index]) {
+                continue;
+            }
+            if (sqlite3_bind_int64(statement, 1, static_cast<sqlite3_int64>(index)) != SQLITE_OK ||
+                    sqlite3_bind_text(statement, 2, symbol.first.c_str(), -1, SQLITE_STATIC) != SQLITE_OK) {
+                sqlite3_finalize(statement);
+                throwError("SQLite error in sqlite3_bind: ");
+            }
+            if (sqlite3_step(statement) != SQLITE_DONE) {
+                sqlite3_finalize(statement);
+                throwError("SQLite error in sqlite3_step: ");
+            }
+            sqlite3_reset(statement);
+            // the symbol is prefixed to tell an empty symbol from a missing row
+            if (sqlite3_changes(db) == 0 &&
+                    selectValue("SELECT '.' || symbol FROM '" + symbolTableName +
+                                "' WHERE id = " + std::to_string(index) + ";") != "." + symbol.first) {
+                sqlite3_finalize(statement);
+                throw std::invalid_argument("SQLite database " + dbFilename +
+                                            " holds symbols written in bulk mode by another program and "
+                                            "cannot be written with symbols=bulk for relation " +
+                                            relationName + "\n");
+            }
+            if (index >= state.written.size()) {
+                state.written.resize(index + 1, false);
+            }
+            state.written[index] = true;
+        }
+        sqlite3_finalize(statement);
+    }
+
+    /**
+     * Check that the symbols of the database are written in the mode of this writer.
+     *
+     * Bulk mode keys the symbols by their interned index and replaces the symbols clashing with
+     * them, while the incremental mode appends symbols with fresh row ids. Relations
+     * written in one mode would lose their symbols to a writer in the other mode, so the
+     * mode is recorded in the database by its first writer and other modes are rejected.
+     */
+    void checkSymbolMode() {
+        const std::string mode = bulkSymbols ? "bulk" : "incremental";
+        std::lock_guard<std::mutex> guard(bulkSymbolLock());
+        std::string recorded = selectValue("SELECT mode FROM '" + symbolModeTableName + "';");
+        if (recorded.empty()) {
+            // databases written before modes were recorded only hold incremental symbols
+            bool hasSymbols = !selectValue("SELECT id FROM '" + symbolTableName + "' LIMIT 1;").empty();
+            recorded = hasSymbols ? "incremental" : mode;
+            executeSQL("INSERT INTO '" + symbolModeTableName + "' VALUES('" + recorded + "');", db);
+        }
+        if (recorded != mode) {
+            sqlite3_close(db);
+            db = nullptr;
+            throw std::invalid_argument("SQLite database " + dbFilename + " holds symbols written in " +
+                                        recorded + " mode and cannot be written with symbols=" + mode +
+                                        " for relation " + relationName + "\n");
+        }
+    }
+
+    /** Return the first column of the first row selected by the query, or an empty string */
+    std::string selectValue(const std::string& sql) {
+        sqlite3_stmt* statement = nullptr;
+        if (sqlite3_prepare_v2(db, sql.c_str(), -1, &statement, nullptr) != SQLITE_OK) {
+            throwError("SQLite error in sqlite3_prepare_v2: ");
+        }
+        std::string value;
+        int rc = sqlite3_step(statement);
+        if (rc == SQLITE_ROW) {
+            const auto* text = sqlite3_column_text(statement, 0);
+            value = text != nullptr ? reinterpret_cast<const char*>(text) : "";
+        }
+        sqlite3_finalize(statement);
+        if (rc != SQLITE_ROW && rc != SQLITE_DONE) {
+            throwError("SQLite error in sqlite3_step: ");
+        }
+        return value;
+    }
+
+    /** Close the connection, which rolls back a transaction that is not committed */
+    void closeDB() {
+        sqlite3_finalize(insertStatement);
+        sqlite3_finalize(batchInsertStatement);
+        sqlite3_finalize(symbolInsertStatement);
+        sqlite3_finalize(symbolSelectStatement);
+        insertStatement = batchInsertStatement = symbolInsertStatement = symbolSelectStatement = nullptr;
+        sqlite3_close(db);
+        db = nullptr;
     }
 
     void openDB() {
@@ -153,6 +322,7 @@ private:
 
     void prepareStatements() {
         prepareInsertStatement();
+        prepareBatchInsertStatement();
         prepareSymbolInsertStatement();
         prepareSymbolSelectStatement();
     }
@@ -177,17 +347,36 @@ private:
     }
 
     void prepareInsertStatement() {
+        insertStatement = prepareRowsInsertStatement(1);
+    }
+
+    /** Prepare a multi-row insert, sized to stay within the variable limit of the connection */
+    void prepareBatchInsertStatement() {
+        const auto maxVariables =
+                static_cast<std::size_t>(sqlite3_limit(db, SQLITE_LIMIT_VARIABLE_NUMBER, -1));
+        const std::size_t maxRows = maxVariables / std::max<std::size_t>(1, arity);
+        batchRows = std::max<std::size_t>(1, std::min<std::size_t>(maxBatchRows, maxRows));
+        batch.reserve(batchRows * arity);
+        batchInsertStatement = prepareRowsInsertStatement(batchRows);
+    }
+
+    sqlite3_stmt* prepareRowsInsertStatement(std::size_t rows) {
         std::stringstream insertSQL;
         insertSQL << "INSERT INTO '_" << relationName << "' VALUES ";
-        insertSQL << "(@V0";
-        for (unsigned int i = 1; i < arity; i++) {
-            insertSQL << ",@V" << i;
+        for (std::size_t row = 0; row < rows; row++) {
+            insertSQL << (row == 0 ? "(" : ",(");
+            for (std::size_t i = 0; i < arity; i++) {
+                insertSQL << (i == 0 ? "?" : ",?");
+            }
+            insertSQL << ")";
         }
-        insertSQL << ");";
+        insertSQL << ";";
+        sqlite3_stmt* statement = nullptr;
         const char* tail = nullptr;
-        if (sqlite3_prepare_v2(db, insertSQL.str().c_str(), -1, &insertStatement, &tail) != SQLITE_OK) {
+        if (sqlite3_prepare_v2(db, insertSQL.str().c_str(), -1, &statement, &tail) != SQLITE_OK) {
             throwError("SQLite error in sqlite3_prepare_v2: ");
         }
+        return statement;
     }
 
     void createTables() {
@@ -258,6 +447,7 @@ private:
         createTableText << "CREATE TABLE IF NOT EXISTS '" << symbolTableName << "' ";
         createTableText << "(id INTEGER PRIMARY KEY, symbol TEXT UNIQUE);";
         executeSQL(createTableText.str(), db);
+        executeSQL("CREATE TABLE IF NOT EXISTS '" + symbolModeTableName + "' (mode TEXT);", db);
     }
 
     /**
@@ -286,9 +476,19 @@ private:
     const std::string dbFilename;
     const std::string relationName;
     const std::string symbolTableName = "__SymbolTable";
+    const std::string symbolModeTableName = "__SymbolTableMode";
+
+    /** Write the whole symbol table up front (symbols="bulk") instead of symbol by symbol */
+    const bool bulkSymbols;
+
+    /** Upper bound on the number of rows per multi-row insert */
+    static constexpr std::size_t maxBatchRows = 256;
 
-    std::unordered_map<uint64_t, uint64_t> dbSymbolTable;
+    std::size_t batchRows = 1;
+    std::vector<RamDomain> batch;
+    std::unordered_map<RamDomain, RamDomain> dbSymbolTable;
     sqlite3_stmt* insertStatement = nullptr;
+    sqlite3_stmt* batchInsertStatement = nullptr;
     sqlite3_stmt* symbolInsertStatement = nullptr;
     sqlite3_stmt* symbolSelectStatement = nullptr;
     sqlite3* db = nullptr;
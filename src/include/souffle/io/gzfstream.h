@@ -15,10 +15,18 @@
 
 #pragma once
 
+#include <algorithm>
+#include <condition_variable>
 #include <cstdio>
 #include <cstring>
+#include <deque>
+#include <future>
 #include <iostream>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 #include <zlib.h>
 
 namespace souffle {
@@ -27,16 +35,27 @@ namespace gzfstream {
 
 namespace internal {
 
+/**
+ * Stream buffer reading and writing gzip files.
+ *
+ * Compression is block parallel: every full block is deflated into an independent gzip member
+ * by a pool of worker threads and the members are written in order, which yields a valid
+ * (multi-member) gzip file. At most one block per worker is in flight at any time. With a
+ * single thread, the default, blocks are deflated by the writing thread itself.
+ * Decompression is pipelined: the next block is inflated on a helper thread while the current
+ * one is consumed.
+ */
 class gzfstreambuf : public std::streambuf {
 public:
-    gzfstreambuf() {
-        setp(buffer, buffer + (bufferSize - 1));
-        setg(buffer + reserveSize, buffer + reserveSize, buffer + reserveSize);
+    gzfstreambuf() : buffer(reserveSize + blockSize) {
+        setp(buffer.data(), buffer.data() + (blockSize - 1));
+        setg(buffer.data() + reserveSize, buffer.data() + reserveSize, buffer.data() + reserveSize);
     }
 
     gzfstreambuf(const gzfstreambuf&) = delete;
 
-    gzfstreambuf(gzfstreambuf&& old) = default;
+    // the helper threads refer to this buffer
+    gzfstreambuf(gzfstreambuf&&) = delete;
 
     gzfstreambuf* open(const std::string& filename, std::ios_base::openmode mode) {
         if (is_open()) {
@@ -47,11 +66,17 @@ public:
         }
 
         this->mode = mode;
-        std::string gzmode((mode & std::ios::in) != 0 ? "rb" : "wb");
-        fileHandle = gzopen(filename.c_str(), gzmode.c_str());
-
-        if (fileHandle == nullptr) {
-            return nullptr;
+        if ((mode & std::ios::in) != 0) {
+            fileHandle = gzopen(filename.c_str(), "rb");
+            if (fileHandle == nullptr) {
+                return nullptr;
+            }
+            prefetch();
+        } else {
+            outputFile = std::fopen(filename.c_str(), "wb");
+            if (outputFile == nullptr) {
+                return nullptr;
+            }
         }
         isOpen = true;
 
@@ -59,20 +84,35 @@ public:
     }
 
     gzfstreambuf* close() {
-        if (is_open()) {
-            sync();
-            isOpen = false;
-            if (gzclose(fileHandle) == Z_OK) {
-                return this;
+        if (!is_open()) {
+            return nullptr;
+        }
+        isOpen = false;
+        if ((mode & std::ios::in) != 0) {
+            // the helper thread must be done with the handle before it is closed
+            if (nextBlock.valid()) {
+                nextBlock.wait();
             }
+            return gzclose(fileHandle) == Z_OK ? this : nullptr;
         }
-        return nullptr;
+
+        // the last, possibly empty, block is always emitted so that the file is a valid gzip file
+        bool ok = compressBlock(pbase(), pptr()) && drainBlocks(0);
+        pbump(static_cast<int>(pbase() - pptr()));
+        stopWorkers();
+        ok = (std::fclose(outputFile) == 0) && ok;
+        return ok ? this : nullptr;
     }
 
     bool is_open() const {
         return isOpen;
     }
 
+    /** Set the number of threads deflating blocks; zero uses one per hardware thread */
+    void setThreads(std::size_t count) {
+        threads = count > 0 ? count : std::max(1u, std::thread::hardware_concurrency());
+    }
+
     ~gzfstreambuf() override {
         try {
             close();
@@ -91,11 +131,10 @@ protected:
             *pptr() = c;
             pbump(1);
         }
-        const int toWrite = static_cast<int>(pptr() - pbase());
-        if (gzwrite(fileHandle, pbase(), static_cast<unsigned int>(toWrite)) != toWrite) {
+        if (!compressBlock(pbase(), pptr())) {
             return EOF;
         }
-        pbump(-toWrite);
+        pbump(static_cast<int>(pbase() - pptr()));
 
         return c;
     }
@@ -107,41 +146,149 @@ protected:
         if ((gptr() != nullptr) && (gptr() < egptr())) {
             return traits_type::to_int_type(*gptr());
         }
+        if (!nextBlock.valid()) {
+            return EOF;
+        }
+
+        std::vector<char> block = nextBlock.get();
+        if (block.size() <= reserveSize) {
+            return EOF;
+        }
+        const std::size_t charsRead = block.size() - reserveSize;
 
         std::size_t charsPutBack = gptr() - eback();
         if (charsPutBack > reserveSize) {
             charsPutBack = reserveSize;
         }
-        memcpy(buffer + reserveSize - charsPutBack, gptr() - charsPutBack, charsPutBack);
+        memcpy(block.data() + reserveSize - charsPutBack, gptr() - charsPutBack, charsPutBack);
 
-        int charsRead =
-                gzread(fileHandle, buffer + reserveSize, static_cast<unsigned int>(bufferSize - reserveSize));
-        if (charsRead <= 0) {
-            return EOF;
-        }
+        // hand the consumed buffer back to the helper thread
+        std::swap(buffer, block);
+        prefetch(std::move(block));
 
-        setg(buffer + reserveSize - charsPutBack, buffer + reserveSize, buffer + reserveSize + charsRead);
+        setg(buffer.data() + reserveSize - charsPutBack, buffer.data() + reserveSize,
+                buffer.data() + reserveSize + charsRead);
 
         return traits_type::to_int_type(*gptr());
     }
 
     int sync() override {
-        if ((pptr() != nullptr) && pptr() > pbase()) {
-            const int toWrite = static_cast<int>(pptr() - pbase());
-            if (gzwrite(fileHandle, pbase(), static_cast<unsigned int>(toWrite)) != toWrite) {
-                return -1;
-            }
-            pbump(-toWrite);
+        if (((mode & std::ios::out) == 0) || !isOpen) {
+            return 0;
+        }
+        // the partial block becomes a (short) gzip member of its own
+        bool ok = true;
+        if (pptr() > pbase()) {
+            ok = compressBlock(pbase(), pptr());
+            pbump(static_cast<int>(pbase() - pptr()));
         }
-        return 0;
+        ok = drainBlocks(0) && ok;
+        ok = (std::fflush(outputFile) == 0) && ok;
+        return ok ? 0 : -1;
     }
 
 private:
-    static constexpr std::size_t bufferSize = 65536;
+    /** Inflate the next block on a helper thread; the result is empty at the end of the file */
+    void prefetch(std::vector<char> block = {}) {
+        nextBlock = std::async(std::launch::async, [this, block = std::move(block)]() mutable {
+            block.resize(reserveSize + blockSize);
+            const int charsRead =
+                    gzread(fileHandle, block.data() + reserveSize, static_cast<unsigned int>(blockSize));
+            block.resize(charsRead > 0 ? reserveSize + charsRead : 0);
+            return block;
+        });
+    }
+
+    /** Deflate the given characters into a gzip member on a worker thread */
+    bool compressBlock(const char* begin, const char* end) {
+        std::packaged_task<std::string()> job([input = std::string(begin, end)]() mutable {
+            z_stream stream = {};
+            if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) !=
+                    Z_OK) {
+                return std::string();
+            }
+            std::string output(deflateBound(&stream, static_cast<uLong>(input.size())), '\0');
+            stream.next_in = reinterpret_cast<Bytef*>(input.data());
+            stream.avail_in = static_cast<uInt>(input.size());
+            stream.next_out = reinterpret_cast<Bytef*>(output.data());
+            stream.avail_out = static_cast<uInt>(output.size());
+            const int rc = deflate(&stream, Z_FINISH);
+            output.resize(rc == Z_STREAM_END ? stream.total_out : 0);
+            deflateEnd(&stream);
+            return output;
+        });
+        pendingBlocks.push_back(job.get_future());
+        if (threads == 1) {
+            job();
+            return drainBlocks(0);
+        }
+        {
+            std::lock_guard<std::mutex> guard(jobLock);
+            jobs.push_back(std::move(job));
+        }
+        jobReady.notify_one();
+        if (workers.size() < threads) {
+            workers.emplace_back([this]() { runJobs(); });
+        }
+        return drainBlocks(threads - 1);
+    }
+
+    /** Worker loop deflating queued blocks until the stream is closed */
+    void runJobs() {
+        while (true) {
+            std::packaged_task<std::string()> job;
+            {
+                std::unique_lock<std::mutex> guard(jobLock);
+                jobReady.wait(guard, [&]() { return stopping || !jobs.empty(); });
+                if (jobs.empty()) {
+                    return;
+                }
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            job();
+        }
+    }
+
+    void stopWorkers() {
+        {
+            std::lock_guard<std::mutex> guard(jobLock);
+            stopping = true;
+        }
+        jobReady.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+        stopping = false;
+    }
+
+    /** Write compressed members, in order, until at most `pending` blocks are in flight */
+    bool drainBlocks(std::size_t pending) {
+        bool ok = true;
+        while (pendingBlocks.size() > pending) {
+            const std::string member = pendingBlocks.front().get();
+            pendingBlocks.pop_front();
+            ok = ok && !member.empty() &&
+                 std::fwrite(member.data(), 1, member.size(), outputFile) == member.size();
+        }
+        return ok;
+    }
+
+    static constexpr std::size_t blockSize = 1 << 18;
     static constexpr std::size_t reserveSize = 16;
 
-    char buffer[bufferSize] = {};
+    std::vector<char> buffer;
     gzFile fileHandle = {};
+    std::FILE* outputFile = nullptr;
+    std::future<std::vector<char>> nextBlock;
+    std::deque<std::future<std::string>> pendingBlocks;
+    std::deque<std::packaged_task<std::string()>> jobs;
+    std::vector<std::thread> workers;
+    std::mutex jobLock;
+    std::condition_variable jobReady;
+    std::size_t threads = 1;
+    bool stopping = false;
     bool isOpen = false;
     std::ios_base::openmode mode = std::ios_base::in;
 };
@@ -229,6 +376,10 @@ public:
     void open(const std::string& filename, std::ios_base::openmode mode = std::ios::out) {
         internal::gzfstream::open(filename, mode);
     }
+
+    void setThreads(std::size_t count) {
+        buf.setThreads(count);
+    }
 };
 
 } /* namespace gzfstream */
@@ -32,7 +32,7 @@ public:
         int c;
         option longOptions[1];
         longOptions[0] = {nullptr, 0, nullptr, 0};
-        while ((c = getopt_long(argc, argv, "c:hj::", longOptions, nullptr)) != EOF) {
+        while ((c = getopt_long(argc, argv, "c:hj::l:", longOptions, nullptr)) != EOF) {
             // An invalid argument was given
             if (c == '?') {
                 exit(EXIT_FAILURE);
@@ -58,9 +58,10 @@ public:
             exit(EXIT_FAILURE);
         }
 
-        if (args.count('h') != 0 || args.count('f') == 0) {
+        if (args.count('h') != 0 || (args.count('f') == 0 && args.count('l') == 0)) {
             std::cout << "Souffle Profiler" << std::endl
                       << "Usage: souffle-profile <log-file> [ -h | -c <command> [options] | -j ]" << std::endl
+                      << "       souffle-profile -l <socket>" << std::endl
                       << "<log-file>            The log file to profile." << std::endl
                       << "-c <command>          Run the given command on the log file, try with  "
                          "'-c help' for a list"
@@ -69,9 +70,17 @@ public:
                       << "-j[filename]          Generate a GUI (html/js) version of the profiler."
                       << std::endl
                       << "                      Default filename is profiler_html/[num].html" << std::endl
+                      << "-l <socket>           Follow a running program that publishes its profile on"
+                      << std::endl
+                      << "                      <socket>, see souffle --profile-stream." << std::endl
                       << "-h                    Print this help message." << std::endl;
             exit(0);
         }
+
+        if (args.count('l') != 0) {
+            Tui(args['l']).runProf();
+            return;
+        }
         std::string filename = args['f'];
 
         if (args.count('c') != 0) {
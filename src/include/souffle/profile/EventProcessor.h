@@ -17,6 +17,9 @@
 
 #pragma once
 
+#include "souffle/profile/IndexStatistics.h"
+#include "souffle/profile/ParallelProfile.h"
+#include "souffle/profile/PerfCounters.h"
 #include "souffle/profile/ProfileDatabase.h"
 #include "souffle/utility/MiscUtil.h"
 #include "souffle/utility/StreamUtil.h"
@@ -45,6 +48,49 @@ public:
     }
 };
 
+/**
+ * Add the hardware counters passed as the last argument of a timing event,
+ * if any, to the counters directory below the given path.
+ */
+inline void addPerfCounters(ProfileDatabase& db, std::vector<std::string> path, va_list& args) {
+    const auto* counters = va_arg(args, const PerfCounterValues*);
+    if (counters == nullptr) {
+        return;
+    }
+    path.push_back("counters");
+    path.emplace_back();
+    for (std::size_t i = 0; i < counters->size(); ++i) {
+        if (PerfCounters::instance().isSupported(i)) {
+            path.back() = PerfCounters::names()[i];
+            db.addSizeEntry(path, (*counters)[i]);
+        }
+    }
+}
+
+/**
+ * Add the parallel loops and lock contention passed after the hardware
+ * counters of a timing event, if any, to the parallel directory below the
+ * given path.
+ */
+inline void addParallelProfile(ProfileDatabase& db, std::vector<std::string> path, va_list& args) {
+    const auto* parallel = va_arg(args, const ParallelProfileValues*);
+    if (parallel == nullptr || parallel->empty()) {
+        return;
+    }
+    path.push_back("parallel");
+    path.emplace_back();
+    auto add = [&](const char* key, std::size_t value) {
+        path.back() = key;
+        db.addSizeEntry(path, value);
+    };
+    add("regions", parallel->regions);
+    add("busy", parallel->busy);
+    add("capacity", parallel->capacity);
+    add("max-busy", parallel->maxBusy);
+    add("lock-restarts", parallel->lockRestarts);
+    add("lane-waits", parallel->laneWaits);
+}
+
 /**
  * Event Processor Singleton
  *
@@ -200,6 +246,9 @@ public:
         db.addDurationEntry(
                 {"program", "relation", relation, "non-recursive-rule", rule, "runtime"}, start, end);
         db.addSizeEntry({"program", "relation", relation, "non-recursive-rule", rule, "num-tuples"}, size);
+        va_arg(args, std::size_t);
+        addPerfCounters(db, {"program", "relation", relation, "non-recursive-rule", rule}, args);
+        addParallelProfile(db, {"program", "relation", relation, "non-recursive-rule", rule}, args);
     }
 } nonRecursiveRuleTimingProcessor;
 
@@ -298,6 +347,12 @@ public:
         db.addSizeEntry({"program", "relation", relation, "iteration", iteration, "recursive-rule", rule,
                                 version, "num-tuples"},
                 size);
+        addPerfCounters(db,
+                {"program", "relation", relation, "iteration", iteration, "recursive-rule", rule, version},
+                args);
+        addParallelProfile(db,
+                {"program", "relation", relation, "iteration", iteration, "recursive-rule", rule, version},
+                args);
     }
 } recursiveRuleTimingProcessor;
 
@@ -347,6 +402,9 @@ public:
         db.addSizeEntry({"program", "relation", relation, "num-tuples"}, size);
         db.addTextEntry({"program", "relation", relation, "source-locator"}, srcLocator);
         db.addDurationEntry({"program", "relation", relation, "runtime"}, start, end);
+        va_arg(args, std::size_t);
+        addPerfCounters(db, {"program", "relation", relation}, args);
+        addParallelProfile(db, {"program", "relation", relation}, args);
     }
 } nonRecursiveRelationTimingProcessor;
 
@@ -393,6 +451,8 @@ public:
         db.addSizeEntry(
                 {"program", "relation", relation, "iteration", iteration, "maxRSS", "post"}, endMaxRSS);
         db.addSizeEntry({"program", "relation", relation, "iteration", iteration, "num-tuples"}, size);
+        addPerfCounters(db, {"program", "relation", relation, "iteration", iteration}, args);
+        addParallelProfile(db, {"program", "relation", relation, "iteration", iteration}, args);
     }
 } recursiveRelationTimingProcessor;
 
@@ -495,6 +555,12 @@ public:
         microseconds start = va_arg(args, microseconds);
         microseconds end = va_arg(args, microseconds);
         db.addDurationEntry({"program", "runtime"}, start, end);
+        // maxRSS before and after, size and iteration
+        for (int i = 0; i < 4; ++i) {
+            va_arg(args, std::size_t);
+        }
+        addPerfCounters(db, {"program"}, args);
+        addParallelProfile(db, {"program"}, args);
     }
 } programRuntimeProcessor;
 
@@ -576,6 +642,55 @@ public:
 
 } relationReadsProcessor;
 
+/**
+ * Index Statistics Processor
+ *
+ * The indexes of the delta and new relations of a recursive relation are
+ * listed with the relation itself.
+ */
+const class IndexStatisticsProcessor : public EventProcessor {
+public:
+    IndexStatisticsProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@index", this);
+    }
+    /** process event input */
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        std::string relation = signature[1];
+        std::string index = signature[2];
+        for (const char* prefix : {"@delta_", "@new_"}) {
+            std::string name(prefix);
+            if (relation.compare(0, name.size(), name) == 0) {
+                relation = relation.substr(name.size());
+                index = name.substr(1, name.size() - 2) + " " + index;
+            }
+        }
+        std::size_t position = va_arg(args, std::size_t);
+        const auto* stats = va_arg(args, const IndexStatistics*);
+        std::vector<std::string> path{"program", "relation", relation, "index", index, ""};
+        auto add = [&](const char* key, std::size_t value) {
+            path.back() = key;
+            db.addSizeEntry(path, value);
+        };
+        add("position", position);
+        add("size", stats->size);
+        add("depth", stats->depth);
+        if (stats->lookupsCounted) {
+            add("lookups", stats->lookups);
+            add("empty-lookups", stats->emptyLookups);
+            add("full-ranges", stats->fullRanges);
+            add("scans", stats->scans);
+            add("tuples", stats->tuples);
+        }
+        const HintStatistics& hints = stats->hints;
+        if (stats->hintsCounted) {
+            add("insert-hint-hits", hints.insertHits);
+            add("insert-hint-misses", hints.insertMisses);
+            add("lookup-hint-hits", hints.lookupHits);
+            add("lookup-hint-misses", hints.lookupMisses);
+        }
+    }
+} indexStatisticsProcessor;
+
 /**
  * Config entry processor
  */
@@ -0,0 +1,87 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2022, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file IndexStatistics.h
+ *
+ * Usage of the indexes of relations, as recorded by --profile-indexes.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "souffle/utility/CacheUtil.h"
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace souffle {
+
+/**
+ * Usage of an index. Lookups, scans and their tuples are only counted by the
+ * interpreter; hint statistics only by data structures compiled with
+ * _SOUFFLE_STATS.
+ */
+struct IndexStatistics {
+    /** number of tuples in the index at the end of the run */
+    std::size_t size = 0;
+    /** number of levels of a B-tree, which every search descends */
+    std::size_t depth = 0;
+    /** number of contains and range queries */
+    std::size_t lookups = 0;
+    /** lookups without any tuple */
+    std::size_t emptyLookups = 0;
+    /** range queries not bounding the first column of the index, hence scanning all of it */
+    std::size_t fullRanges = 0;
+    /** range queries whose tuples were all visited, and the number of these tuples */
+    std::size_t scans = 0;
+    std::size_t tuples = 0;
+    /** whether lookups, scans and their tuples were counted */
+    bool lookupsCounted = false;
+    /** whether the data structure counted the hits of its hints */
+    bool hintsCounted = false;
+    HintStatistics hints;
+};
+
+namespace detail {
+
+template <typename T, typename = void>
+struct has_depth : std::false_type {};
+
+template <typename T>
+struct has_depth<T, std::void_t<decltype(std::declval<const T&>().getDepth())>> : std::true_type {};
+
+template <typename T, typename = void>
+struct has_hint_statistics : std::false_type {};
+
+template <typename T>
+struct has_hint_statistics<T, std::void_t<decltype(std::declval<const T&>().getHintStatistics())>>
+        : std::true_type {};
+
+}  // namespace detail
+
+/**
+ * Add the statistics the data structure of an index keeps itself.
+ */
+template <typename Structure>
+void addStructureStatistics(IndexStatistics& statistics, const Structure& data) {
+    statistics.size = data.size();
+    if constexpr (detail::has_depth<Structure>::value) {
+        statistics.depth = data.getDepth();
+    }
+    if constexpr (detail::has_hint_statistics<Structure>::value) {
+        statistics.hints = data.getHintStatistics();
+#ifdef _SOUFFLE_STATS
+        statistics.hintsCounted = true;
+#endif
+    }
+}
+
+}  // namespace souffle
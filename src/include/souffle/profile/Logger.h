@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include "souffle/profile/ParallelProfile.h"
+#include "souffle/profile/PerfCounters.h"
 #include "souffle/profile/ProfileEvent.h"
 #include "souffle/utility/MiscUtil.h"
 #include <cstddef>
@@ -52,6 +54,10 @@ public:
 #endif  // WIN32
         // Assume that if we are logging the progress of an event then we care about usage during that time.
         ProfileEventSingleton::instance().resetTimerInterval();
+        if (PerfCounters::instance().isEnabled()) {
+            startCounters = PerfCounters::instance().read();
+        }
+        startParallel = ParallelProfile::instance().read();
     }
 
     ~Logger() {
@@ -65,8 +71,20 @@ public:
         getrusage(RUSAGE_SELF, &ru);
         std::size_t endMaxRSS = ru.ru_maxrss;
 #endif  // WIN32
-        ProfileEventSingleton::instance().makeTimingEvent(
-                label, start, now(), startMaxRSS, endMaxRSS, size() - preSize, iteration);
+        ParallelProfileValues parallel = ParallelProfile::instance().read() - startParallel;
+        if (PerfCounters::instance().isEnabled()) {
+            // the counters of all threads are read, so concurrent events count each other's work
+            PerfCounterValues counters = PerfCounters::instance().read();
+            for (std::size_t i = 0; i < counters.size(); ++i) {
+                // scaled counters may decrease slightly
+                counters[i] = counters[i] > startCounters[i] ? counters[i] - startCounters[i] : 0;
+            }
+            ProfileEventSingleton::instance().makeTimingEvent(label, start, now(), startMaxRSS, endMaxRSS,
+                    size() - preSize, iteration, &counters, &parallel);
+        } else {
+            ProfileEventSingleton::instance().makeTimingEvent(label, start, now(), startMaxRSS, endMaxRSS,
+                    size() - preSize, iteration, nullptr, &parallel);
+        }
     }
 
 private:
@@ -76,5 +94,7 @@ private:
     std::size_t iteration;
     std::function<std::size_t()> size;
     std::size_t preSize;
+    PerfCounterValues startCounters{};
+    ParallelProfileValues startParallel;
 };
 }  // end of namespace souffle
@@ -0,0 +1,187 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2022, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file ParallelProfile.h
+ *
+ * Load balance of the parallel loops of the program and contention of its
+ * concurrent data structures, as recorded by the profiler.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "souffle/utility/ParallelUtil.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace souffle {
+
+/**
+ * Totals of the parallel regions and contended locks of the program so far.
+ * Times are in microseconds.
+ */
+struct ParallelProfileValues {
+    /** number of parallel loops run */
+    std::size_t regions = 0;
+    /** time the threads spent on the iterations of the loops, summed over threads */
+    std::size_t busy = 0;
+    /** wall time of the loops times the number of threads running them */
+    std::size_t capacity = 0;
+    /** busy time of the busiest thread of each loop, summed over loops */
+    std::size_t maxBusy = 0;
+    std::size_t lockRestarts = 0;
+    std::size_t laneWaits = 0;
+
+    /** The difference to earlier totals */
+    ParallelProfileValues operator-(const ParallelProfileValues& other) const {
+        auto sub = [](std::size_t a, std::size_t b) { return a > b ? a - b : 0; };
+        return {sub(regions, other.regions), sub(busy, other.busy), sub(capacity, other.capacity),
+                sub(maxBusy, other.maxBusy), sub(lockRestarts, other.lockRestarts),
+                sub(laneWaits, other.laneWaits)};
+    }
+
+    bool empty() const {
+        return regions == 0 && lockRestarts == 0 && laneWaits == 0;
+    }
+};
+
+/**
+ * The totals of all parallel regions of the program.
+ */
+class ParallelProfile {
+public:
+    static ParallelProfile& instance() {
+        static ParallelProfile profile;
+        return profile;
+    }
+
+    ParallelProfileValues read() const {
+        ParallelProfileValues values;
+        values.regions = regions.load(std::memory_order_relaxed);
+        values.busy = busy.load(std::memory_order_relaxed) / 1000;
+        values.capacity = capacity.load(std::memory_order_relaxed) / 1000;
+        values.maxBusy = maxBusy.load(std::memory_order_relaxed) / 1000;
+        values.lockRestarts = contentionCounters.lockRestarts.load(std::memory_order_relaxed);
+        values.laneWaits = contentionCounters.laneWaits.load(std::memory_order_relaxed);
+        return values;
+    }
+
+    /** Add a region, with times in nanoseconds */
+    void addRegion(std::uint64_t regionBusy, std::uint64_t regionCapacity, std::uint64_t regionMaxBusy) {
+        regions.fetch_add(1, std::memory_order_relaxed);
+        busy.fetch_add(regionBusy, std::memory_order_relaxed);
+        capacity.fetch_add(regionCapacity, std::memory_order_relaxed);
+        maxBusy.fetch_add(regionMaxBusy, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<std::size_t> regions{0};
+    std::atomic<std::uint64_t> busy{0};
+    std::atomic<std::uint64_t> capacity{0};
+    std::atomic<std::uint64_t> maxBusy{0};
+
+    ParallelProfile() = default;
+};
+
+/**
+ * Measures the load balance of a parallel loop.
+ *
+ * The region lives from before the parallel section to after its closing
+ * barrier, and every iteration of the loop is timed by a Task. The time of a
+ * thread not spent in tasks is spent waiting at the barrier or scheduling.
+ * A disabled region measures nothing.
+ */
+class ParallelRegion {
+public:
+    explicit ParallelRegion(bool enabled = true) : enabled(enabled) {
+        if (enabled) {
+#ifdef _OPENMP
+            // a loop within a concurrent rule runs on its thread alone, see PARALLEL_START
+            bool nested = omp_in_parallel() != 0;
+            threads.resize(nested ? 1 : static_cast<std::size_t>(omp_get_max_threads()));
+#else
+            threads.resize(1);
+#endif
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ParallelRegion(const ParallelRegion&) = delete;
+    ParallelRegion& operator=(const ParallelRegion&) = delete;
+
+    ~ParallelRegion() {
+        if (!enabled) {
+            return;
+        }
+        auto wall = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start);
+        std::uint64_t busy = 0;
+        std::uint64_t maxBusy = 0;
+        for (const auto& thread : threads) {
+            busy += thread.busy;
+            maxBusy = std::max(maxBusy, thread.busy);
+        }
+        ParallelProfile::instance().addRegion(
+                busy, static_cast<std::uint64_t>(wall.count()) * threads.size(), maxBusy);
+    }
+
+    /** Times an iteration of the loop on the calling thread */
+    class Task {
+    public:
+        explicit Task(ParallelRegion& region) : region(region) {
+            if (region.enabled) {
+                start = std::chrono::steady_clock::now();
+            }
+        }
+
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+
+        ~Task() {
+            if (!region.enabled) {
+                return;
+            }
+#ifdef _OPENMP
+            auto thread = static_cast<std::size_t>(omp_get_thread_num());
+#else
+            std::size_t thread = 0;
+#endif
+            if (thread < region.threads.size()) {
+                region.threads[thread].busy += static_cast<std::uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now() - start)
+                                .count());
+            }
+        }
+
+    private:
+        ParallelRegion& region;
+        std::chrono::steady_clock::time_point start;
+    };
+
+private:
+    /** Busy time of a thread in nanoseconds, on its own cache line */
+    struct alignas(hardware_destructive_interference_size) Thread {
+        std::uint64_t busy = 0;
+    };
+
+    bool enabled;
+    std::chrono::steady_clock::time_point start;
+    std::vector<Thread> threads;
+};
+
+}  // namespace souffle
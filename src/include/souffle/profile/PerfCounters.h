@@ -0,0 +1,198 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2022, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file PerfCounters.h
+ *
+ * Hardware performance counters of the profiler, read with perf_event_open
+ * on Linux.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // __linux__
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace souffle {
+
+/** Values of the hardware counters, in the order of PerfCounters::names */
+using PerfCounterValues = std::array<std::size_t, 4>;
+
+/**
+ * Hardware performance counters of all threads of the program.
+ *
+ * Every thread that evaluates rules needs its own counters: the counters are
+ * opened for the calling thread and the threads of the OpenMP pool. Counters
+ * that cannot be opened, e.g. without permission or in a virtual machine,
+ * are left out, and without any counters the profile has none.
+ */
+class PerfCounters {
+public:
+    static PerfCounters& instance() {
+        static PerfCounters counters;
+        return counters;
+    }
+
+    static const std::array<const char*, 4>& names() {
+        static const std::array<const char*, 4> names{"cycles", "instructions", "llc-misses", "dtlb-misses"};
+        return names;
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    ~PerfCounters() {
+#ifdef __linux__
+        for (const auto& group : groups) {
+            for (int fd : group.fds) {
+                if (fd >= 0) {
+                    ::close(fd);
+                }
+            }
+        }
+#endif  // __linux__
+    }
+
+    /**
+     * Open the counters, returning whether any is available.
+     */
+    bool enable() {
+#if defined(_OPENMP)
+#pragma omp parallel
+        openThread();
+#else
+        openThread();
+#endif
+        std::lock_guard<std::mutex> guard(lock);
+        if (!enabled && !warned) {
+            warned = true;
+            std::cerr << "Warning: hardware performance counters are unavailable: " << error << "\n";
+        }
+        return enabled;
+    }
+
+    bool isEnabled() const {
+        return enabled;
+    }
+
+    /** Whether the counter with the given index is counted */
+    bool isSupported(std::size_t counter) const {
+        return supported[counter];
+    }
+
+    /**
+     * Sum of the counters of all threads so far. Counters that share the
+     * hardware with other events are scaled by the time they were counted.
+     */
+    PerfCounterValues read() const {
+        PerfCounterValues values{};
+#ifdef __linux__
+        std::lock_guard<std::mutex> guard(lock);
+        for (const auto& group : groups) {
+            // read format: number of values, time enabled, time running, values
+            uint64_t data[3 + 4];
+            if (::read(group.fds[0], data, sizeof(data)) < static_cast<ssize_t>(3 * sizeof(uint64_t))) {
+                continue;
+            }
+            double scale = data[2] == 0 ? 0.0 : static_cast<double>(data[1]) / data[2];
+            for (std::size_t i = 0; i < data[0]; ++i) {
+                values[group.counters[i]] += static_cast<std::size_t>(data[3 + i] * scale);
+            }
+        }
+#endif  // __linux__
+        return values;
+    }
+
+private:
+    /** Counters of one thread, in a group read at once */
+    struct Group {
+        std::array<int, 4> fds{-1, -1, -1, -1};
+        /** Index of the counter of each value of the group */
+        std::vector<std::size_t> counters;
+    };
+
+    std::vector<Group> groups;
+    std::array<bool, 4> supported{};
+    std::atomic<bool> enabled{false};
+    bool warned = false;
+    std::string error = "not supported on this platform";
+    mutable std::mutex lock;
+
+    PerfCounters() = default;
+
+    void openThread() {
+#ifdef __linux__
+        static thread_local bool opened = false;
+        if (opened) {
+            return;
+        }
+        opened = true;
+
+        static const std::array<std::pair<uint32_t, uint64_t>, 4> events{{
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+                {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        }};
+
+        Group group;
+        std::string openError;
+        for (std::size_t i = 0; i < events.size(); ++i) {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = events[i].first;
+            attr.config = events[i].second;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format =
+                    PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            int leader = group.counters.empty() ? -1 : group.fds[0];
+            auto fd = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0));
+            if (fd < 0) {
+                openError = std::strerror(errno);
+                continue;
+            }
+            group.fds[group.counters.size()] = fd;
+            group.counters.push_back(i);
+        }
+
+        std::lock_guard<std::mutex> guard(lock);
+        if (group.counters.empty()) {
+            error = openError;
+            return;
+        }
+        for (std::size_t counter : group.counters) {
+            supported[counter] = true;
+        }
+        enabled = true;
+        groups.push_back(std::move(group));
+#endif  // __linux__
+    }
+};
+
+}  // namespace souffle
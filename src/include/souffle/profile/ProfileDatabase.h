@@ -3,10 +3,12 @@
 #include "souffle/utility/ContainerUtil.h"
 #include "souffle/utility/MiscUtil.h"
 #include "souffle/utility/json11.h"
+#include <atomic>
 #include <cassert>
 #include <chrono>
 #include <cstddef>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <iterator>
 #include <map>
@@ -293,9 +295,55 @@ public:
  * Hierarchical databas
  */
 class ProfileDatabase {
+public:
+    using Listener = std::function<void(const std::vector<std::string>& path, const Entry& entry)>;
+
 private:
     Own<DirectoryEntry> root;
 
+    std::map<std::size_t, Listener> listeners;
+    std::size_t lastListener = 0;
+    mutable std::mutex listenersLock;
+
+    /** Whether added entries are kept, or only passed to the listeners */
+    std::atomic<bool> retain{true};
+
+    void addEntry(const std::vector<std::string>& qualifier, Own<Entry> entry) {
+        assert(qualifier.size() > 0 && "no qualifier");
+        if (!retain) {
+            std::lock_guard<std::mutex> guard(listenersLock);
+            for (const auto& cur : listeners) {
+                cur.second(qualifier, *entry);
+            }
+            return;
+        }
+        std::vector<std::string> path(qualifier.begin(), qualifier.end() - 1);
+        DirectoryEntry* dir = lookupPath(path);
+
+        const Entry* added = entry.get();
+        // existing entries are never rewritten, so listeners only see new ones
+        if (dir->writeEntry(std::move(entry)) == added) {
+            std::lock_guard<std::mutex> guard(listenersLock);
+            for (const auto& cur : listeners) {
+                cur.second(qualifier, *added);
+            }
+        }
+    }
+
+    static void forEachEntry(
+            const DirectoryEntry& dir, std::vector<std::string>& path, const Listener& fn) {
+        for (const auto& key : dir.getKeys()) {
+            const Entry* entry = dir.readEntry(key);
+            path.push_back(key);
+            if (auto* subdir = as<DirectoryEntry>(entry)) {
+                forEachEntry(*subdir, path, fn);
+            } else {
+                fn(path, *entry);
+            }
+            path.pop_back();
+        }
+    }
+
 protected:
     /**
      * Find path: if directories along the path do not exist, create them.
@@ -347,6 +395,12 @@ protected:
 public:
     ProfileDatabase() : root(mk<DirectoryEntry>("root")) {}
 
+    /** Replace the entries, but keep the listeners */
+    ProfileDatabase& operator=(ProfileDatabase&& other) {
+        root = std::move(other.root);
+        return *this;
+    }
+
     ProfileDatabase(const std::string& filename) : root(mk<DirectoryEntry>("root")) {
         std::ifstream file(filename);
         if (!file.is_open()) {
@@ -363,46 +417,56 @@ public:
 
     // add size entry
     void addSizeEntry(std::vector<std::string> qualifier, std::size_t size) {
-        assert(qualifier.size() > 0 && "no qualifier");
-        std::vector<std::string> path(qualifier.begin(), qualifier.end() - 1);
-        DirectoryEntry* dir = lookupPath(path);
-
-        const std::string& key = qualifier.back();
-        Own<SizeEntry> entry = mk<SizeEntry>(key, size);
-        dir->writeEntry(std::move(entry));
+        addEntry(qualifier, mk<SizeEntry>(qualifier.back(), size));
     }
 
     // add text entry
     void addTextEntry(std::vector<std::string> qualifier, const std::string& text) {
-        assert(qualifier.size() > 0 && "no qualifier");
-        std::vector<std::string> path(qualifier.begin(), qualifier.end() - 1);
-        DirectoryEntry* dir = lookupPath(path);
-
-        const std::string& key = qualifier.back();
-        Own<TextEntry> entry = mk<TextEntry>(key, text);
-        dir->writeEntry(std::move(entry));
+        addEntry(qualifier, mk<TextEntry>(qualifier.back(), text));
     }
 
     // add duration entry
     void addDurationEntry(std::vector<std::string> qualifier, microseconds start, microseconds end) {
-        assert(qualifier.size() > 0 && "no qualifier");
-        std::vector<std::string> path(qualifier.begin(), qualifier.end() - 1);
-        DirectoryEntry* dir = lookupPath(path);
-
-        const std::string& key = qualifier.back();
-        Own<DurationEntry> entry = mk<DurationEntry>(key, start, end);
-        dir->writeEntry(std::move(entry));
+        addEntry(qualifier, mk<DurationEntry>(qualifier.back(), start, end));
     }
 
     // add time entry
     void addTimeEntry(std::vector<std::string> qualifier, microseconds time) {
-        assert(qualifier.size() > 0 && "no qualifier");
-        std::vector<std::string> path(qualifier.begin(), qualifier.end() - 1);
-        DirectoryEntry* dir = lookupPath(path);
+        addEntry(qualifier, mk<TimeEntry>(qualifier.back(), time));
+    }
 
-        const std::string& key = qualifier.back();
-        Own<TimeEntry> entry = mk<TimeEntry>(key, time);
-        dir->writeEntry(std::move(entry));
+    /**
+     * Register a listener that is called with every entry added from now on.
+     *
+     * Listeners are called on the thread adding the entry, so they must be
+     * thread-safe and cheap. Returns an id for removeListener.
+     */
+    std::size_t addListener(Listener listener) {
+        std::lock_guard<std::mutex> guard(listenersLock);
+        listeners.emplace(++lastListener, std::move(listener));
+        return lastListener;
+    }
+
+    void removeListener(std::size_t id) {
+        std::lock_guard<std::mutex> guard(listenersLock);
+        listeners.erase(id);
+    }
+
+    /**
+     * Keep the added entries, or only pass them to the listeners, which bounds
+     * the memory of a profile that is written by a listener. Without retained
+     * entries, an entry may be passed again with the same path.
+     */
+    void setRetainEntries(bool retainEntries) {
+        retain = retainEntries;
+    }
+
+    /**
+     * Call the given function with the path of every entry that is not a directory.
+     */
+    void forEachEntry(const Listener& fn) const {
+        std::vector<std::string> path;
+        forEachEntry(*root, path, fn);
     }
 
     // compute sum
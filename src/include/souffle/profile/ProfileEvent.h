@@ -17,7 +17,11 @@
 #pragma once
 
 #include "souffle/profile/EventProcessor.h"
+#include "souffle/profile/IndexStatistics.h"
+#include "souffle/profile/ParallelProfile.h"
+#include "souffle/profile/PerfCounters.h"
 #include "souffle/profile/ProfileDatabase.h"
+#include "souffle/profile/ProfileLog.h"
 #include "souffle/utility/MiscUtil.h"
 #include <atomic>
 #include <chrono>
@@ -32,6 +36,7 @@
 #ifdef WIN32
 #include <Psapi.h>
 #else
+#include "souffle/profile/ProfileStream.h"
 #include <sys/resource.h>
 #include <sys/time.h>
 #endif  // WIN32
@@ -45,6 +50,13 @@ class ProfileEventSingleton {
     /** profile database */
     profile::ProfileDatabase database{};
     std::string filename{""};
+    /** binary event log the events are written to as they happen, if any */
+    Own<profile::ProfileLogWriter> log;
+    std::size_t logListener = 0;
+#ifndef WIN32
+    /** publishes the events to souffleprof while the program runs */
+    Own<profile::ProfileStreamWriter> stream;
+#endif  // WIN32
 
     ProfileEventSingleton(){};
 
@@ -52,6 +64,10 @@ public:
     ~ProfileEventSingleton() {
         stopTimer();
         dump();
+#ifndef WIN32
+        // closing the stream tells souffleprof that the program has finished
+        stream = nullptr;
+#endif  // WIN32
     }
 
     /** get instance */
@@ -73,11 +89,27 @@ public:
 
     /** create an event for recording start and end times */
     void makeTimingEvent(const std::string& txt, time_point start, time_point end, std::size_t startMaxRSS,
-            std::size_t endMaxRSS, std::size_t size, std::size_t iteration) {
+            std::size_t endMaxRSS, std::size_t size, std::size_t iteration,
+            const PerfCounterValues* counters = nullptr, const ParallelProfileValues* parallel = nullptr) {
         microseconds start_ms = std::chrono::duration_cast<microseconds>(start.time_since_epoch());
         microseconds end_ms = std::chrono::duration_cast<microseconds>(end.time_since_epoch());
-        profile::EventProcessorSingleton::instance().process(
-                database, txt.c_str(), start_ms, end_ms, startMaxRSS, endMaxRSS, size, iteration);
+        profile::EventProcessorSingleton::instance().process(database, txt.c_str(), start_ms, end_ms,
+                startMaxRSS, endMaxRSS, size, iteration, counters, parallel);
+    }
+
+    /** Count hardware events in the timing events, if the counters are available */
+    void enablePerfCounters() {
+        std::string counters;
+        if (PerfCounters::instance().enable()) {
+            for (std::size_t i = 0; i < PerfCounters::names().size(); ++i) {
+                if (PerfCounters::instance().isSupported(i)) {
+                    counters += (counters.empty() ? "" : " ") + std::string(PerfCounters::names()[i]);
+                }
+            }
+        } else {
+            counters = "unavailable";
+        }
+        makeConfigRecord("perf-counters", counters);
     }
 
     /** create quantity event */
@@ -93,6 +125,13 @@ public:
         profile::EventProcessorSingleton::instance().process(database, txt.c_str(), uniqueKeys, iteration);
     }
 
+    /** create index event, with the position and lexicographical order of the index */
+    void makeIndexEvent(const std::string& relation, std::size_t position, const std::string& order,
+            const IndexStatistics& stats) {
+        profile::EventProcessorSingleton::instance().process(
+                database, ("@index;" + relation + ";" + order).c_str(), position, &stats);
+    }
+
     /** create utilisation event */
     void makeUtilisationEvent(const std::string& txt) {
         /* current time */
@@ -133,12 +172,39 @@ public:
                 database, txt.c_str(), time, systemTime, userTime, maxRSS);
     }
 
-    void setOutputFile(std::string outputFilename) {
+    /**
+     * Set the file the profile is written to. A binary event log is written
+     * while the program runs, so that the events need not be kept in memory.
+     */
+    void setOutputFile(std::string outputFilename, bool binaryLog = false) {
         filename = outputFilename;
+        if (binaryLog) {
+            log = mk<profile::ProfileLogWriter>(filename);
+            auto add = [this](const std::vector<std::string>& path, const profile::Entry& entry) {
+                log->add(path, entry);
+            };
+            database.forEachEntry(add);
+            logListener = database.addListener(add);
+            database.setRetainEntries(false);
+        }
+    }
+
+    /** Publish all events on the given Unix domain socket, see souffleprof -l */
+    void setStreamSocket(const std::string& socketPath) {
+#ifdef WIN32
+        std::cerr << "Profile streams are not supported on Windows\n";
+#else
+        // new clients of the stream receive the entries so far from the database
+        database.setRetainEntries(true);
+        stream = mk<profile::ProfileStreamWriter>(socketPath, database);
+#endif  // WIN32
     }
     /** Dump all events */
     void dump() {
-        if (!filename.empty()) {
+        if (log != nullptr) {
+            database.removeListener(logListener);
+            log->close();
+        } else if (!filename.empty()) {
             std::ofstream os(filename);
             if (!os.is_open()) {
                 std::cerr << "Cannot open profile log file <" + filename + ">";
@@ -148,8 +214,9 @@ public:
         }
     }
 
-    /** Start timer */
+    /** Start timer, and the counting of lock contention */
     void startTimer() {
+        contentionCounters.enable();
         timer.start();
     }
 
@@ -165,8 +232,17 @@ public:
         return database;
     }
 
+    profile::ProfileDatabase& getDB() {
+        return database;
+    }
+
     void setDBFromFile(const std::string& databaseFilename) {
-        database = profile::ProfileDatabase(databaseFilename);
+        if (profile::ProfileLogReader::isProfileLog(databaseFilename)) {
+            database = profile::ProfileDatabase();
+            profile::ProfileLogReader(databaseFilename).read(database);
+        } else {
+            database = profile::ProfileDatabase(databaseFilename);
+        }
     }
 
 private:
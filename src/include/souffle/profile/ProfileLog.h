@@ -0,0 +1,422 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2022, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file ProfileLog.h
+ *
+ * Binary event log of a profile database, written while the program runs.
+ *
+ * The log starts with a magic header, followed by blocks of records and,
+ * once the log is closed, an index and a footer:
+ *
+ *   log    := "SOUFPLG1" block* [ index footer ]
+ *   block  := size:u32 record*
+ *   record := tag:u8 ...
+ *   footer := indexOffset:u64 "SOUFPIDX"
+ *
+ * Numbers in records are LEB128 varints. Every block is self-contained: the
+ * strings of the paths are defined once per block, by a string record, and
+ * are referred to by their number within the block. The index maps every
+ * relation to the offsets of the blocks holding its entries, so that the
+ * entries of a few relations can be read without reading the whole log.
+ * A log that was not closed has no index and is read block by block.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "souffle/profile/ProfileDatabase.h"
+#include "souffle/utility/MiscUtil.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace souffle {
+namespace profile {
+
+namespace detail {
+
+constexpr char profileLogMagic[] = "SOUFPLG1";
+constexpr char profileIndexMagic[] = "SOUFPIDX";
+constexpr std::size_t profileMagicSize = 8;
+
+enum ProfileLogTag : uint8_t {
+    TagString = 0,
+    TagSize = 1,
+    TagText = 2,
+    TagDuration = 3,
+    TagTime = 4,
+    TagIndexKey = 5
+};
+
+inline void writeVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+inline uint64_t readVarint(const std::string& in, std::size_t& pos) {
+    uint64_t value = 0;
+    for (unsigned shift = 0; pos < in.size() && shift < 64; shift += 7) {
+        auto byte = static_cast<uint8_t>(in[pos++]);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    throw std::runtime_error("Truncated profile log record");
+}
+
+inline void writeFixed(std::ostream& os, uint64_t value, std::size_t bytes) {
+    for (std::size_t i = 0; i < bytes; ++i) {
+        os.put(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+inline uint64_t readFixed(const char* in, std::size_t bytes) {
+    uint64_t value = 0;
+    for (std::size_t i = 0; i < bytes; ++i) {
+        value |= static_cast<uint64_t>(static_cast<uint8_t>(in[i])) << (8 * i);
+    }
+    return value;
+}
+
+/** Relation an entry belongs to in the index, or the empty string for entries of the whole program */
+inline std::string indexKey(const std::vector<std::string>& path) {
+    if (path.size() > 3 && path[0] == "program" && path[1] == "relation") {
+        return path[2];
+    }
+    if (path.size() > 4 && path[0] == "program" && path[1] == "statistics" && path[2] == "relation") {
+        return path[3];
+    }
+    return "";
+}
+
+}  // namespace detail
+
+/**
+ * Appends the entries of a profile database to a binary event log.
+ *
+ * Entries are collected in a block of bounded size, which is written once
+ * full; only the index of the blocks is kept until the log is closed.
+ */
+class ProfileLogWriter {
+public:
+    /** Size of the blocks, after which they are written */
+    static constexpr std::size_t blockSize = 1 << 16;
+
+    ProfileLogWriter(const std::string& filename) : os(filename, std::ios::binary) {
+        if (!os.is_open()) {
+            throw std::runtime_error("Cannot open profile log file <" + filename + ">");
+        }
+        os.write(detail::profileLogMagic, detail::profileMagicSize);
+    }
+
+    ProfileLogWriter(const ProfileLogWriter&) = delete;
+    ProfileLogWriter& operator=(const ProfileLogWriter&) = delete;
+
+    ~ProfileLogWriter() {
+        close();
+    }
+
+    /** Append an entry */
+    void add(const std::vector<std::string>& path, const Entry& entry) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (closed) {
+            return;
+        }
+        std::string record;
+        if (auto* size = as<SizeEntry>(entry)) {
+            record.push_back(detail::TagSize);
+            writePath(record, path);
+            detail::writeVarint(record, size->getSize());
+        } else if (auto* text = as<TextEntry>(entry)) {
+            record.push_back(detail::TagText);
+            writePath(record, path);
+            detail::writeVarint(record, stringId(text->getText()));
+        } else if (auto* duration = as<DurationEntry>(entry)) {
+            record.push_back(detail::TagDuration);
+            writePath(record, path);
+            detail::writeVarint(record, duration->getStart().count());
+            detail::writeVarint(record, duration->getEnd().count());
+        } else if (auto* time = as<TimeEntry>(entry)) {
+            record.push_back(detail::TagTime);
+            writePath(record, path);
+            detail::writeVarint(record, time->getTime().count());
+        }
+        // string records were added to the block by writePath and stringId
+        block += record;
+        blockKeys.insert(detail::indexKey(path));
+        if (block.size() >= blockSize) {
+            flushBlock();
+        }
+    }
+
+    /** Write the last block and the index */
+    void close() {
+        std::lock_guard<std::mutex> guard(lock);
+        if (closed) {
+            return;
+        }
+        closed = true;
+        flushBlock();
+
+        std::string index;
+        for (const auto& [key, offsets] : blocks) {
+            index.push_back(detail::TagIndexKey);
+            detail::writeVarint(index, key.size());
+            index += key;
+            detail::writeVarint(index, offsets.size());
+            for (uint64_t offset : offsets) {
+                detail::writeVarint(index, offset);
+            }
+        }
+        auto indexOffset = static_cast<uint64_t>(os.tellp());
+        detail::writeFixed(os, index.size(), 4);
+        os.write(index.data(), index.size());
+        detail::writeFixed(os, indexOffset, 8);
+        os.write(detail::profileIndexMagic, detail::profileMagicSize);
+        os.close();
+    }
+
+private:
+    std::ofstream os;
+    std::mutex lock;
+    bool closed = false;
+
+    /** Records of the current block */
+    std::string block;
+    std::unordered_map<std::string, uint64_t> blockStrings;
+    std::set<std::string> blockKeys;
+
+    /** Offsets of the blocks holding the entries of each relation */
+    std::map<std::string, std::vector<uint64_t>> blocks;
+
+    uint64_t stringId(const std::string& str) {
+        auto it = blockStrings.find(str);
+        if (it != blockStrings.end()) {
+            return it->second;
+        }
+        block.push_back(detail::TagString);
+        detail::writeVarint(block, str.size());
+        block += str;
+        uint64_t id = blockStrings.size();
+        blockStrings.emplace(str, id);
+        return id;
+    }
+
+    void writePath(std::string& record, const std::vector<std::string>& path) {
+        detail::writeVarint(record, path.size());
+        for (const auto& key : path) {
+            detail::writeVarint(record, stringId(key));
+        }
+    }
+
+    void flushBlock() {
+        if (block.empty()) {
+            return;
+        }
+        auto offset = static_cast<uint64_t>(os.tellp());
+        detail::writeFixed(os, block.size(), 4);
+        os.write(block.data(), block.size());
+        os.flush();
+        for (const auto& key : blockKeys) {
+            blocks[key].push_back(offset);
+        }
+        block.clear();
+        blockStrings.clear();
+        blockKeys.clear();
+    }
+};
+
+/**
+ * Reads a binary event log into a profile database.
+ */
+class ProfileLogReader {
+public:
+    /** Whether the file is a binary event log */
+    static bool isProfileLog(const std::string& filename) {
+        std::ifstream is(filename, std::ios::binary);
+        char magic[detail::profileMagicSize];
+        return is.read(magic, sizeof(magic)) &&
+               std::memcmp(magic, detail::profileLogMagic, detail::profileMagicSize) == 0;
+    }
+
+    ProfileLogReader(const std::string& filename) : is(filename, std::ios::binary) {
+        if (!isProfileLog(filename)) {
+            throw std::runtime_error("Not a profile log: " + filename);
+        }
+        readIndex();
+    }
+
+    /** Whether the log was closed, i.e. has an index */
+    bool hasIndex() const {
+        return index.has_value();
+    }
+
+    /** Read all entries */
+    void read(ProfileDatabase& db) {
+        std::string block;
+        uint64_t offset = detail::profileMagicSize;
+        while (offset < end && readBlock(offset, block)) {
+            addRecords(db, block, nullptr);
+            offset += 4 + block.size();
+        }
+    }
+
+    /**
+     * Read the entries of the given relations and of the whole program.
+     *
+     * With an index, only the blocks holding these entries are read.
+     */
+    void read(ProfileDatabase& db, const std::set<std::string>& relations) {
+        std::set<std::string> keys(relations);
+        keys.insert("");
+        if (!index) {
+            std::string block;
+            uint64_t offset = detail::profileMagicSize;
+            while (offset < end && readBlock(offset, block)) {
+                addRecords(db, block, &keys);
+                offset += 4 + block.size();
+            }
+            return;
+        }
+        std::set<uint64_t> offsets;
+        for (const auto& key : keys) {
+            auto it = index->find(key);
+            if (it != index->end()) {
+                offsets.insert(it->second.begin(), it->second.end());
+            }
+        }
+        std::string block;
+        for (uint64_t offset : offsets) {
+            if (readBlock(offset, block)) {
+                addRecords(db, block, &keys);
+            }
+        }
+    }
+
+private:
+    std::ifstream is;
+
+    /** Offset after the last block */
+    uint64_t end = 0;
+    std::optional<std::map<std::string, std::vector<uint64_t>>> index;
+
+    void readIndex() {
+        is.seekg(0, std::ios::end);
+        end = static_cast<uint64_t>(is.tellg());
+        if (end < 2 * detail::profileMagicSize + 8 + 4) {
+            return;
+        }
+        char footer[8 + detail::profileMagicSize];
+        is.seekg(end - sizeof(footer));
+        is.read(footer, sizeof(footer));
+        if (std::memcmp(footer + 8, detail::profileIndexMagic, detail::profileMagicSize) != 0) {
+            return;
+        }
+        uint64_t indexOffset = detail::readFixed(footer, 8);
+        std::string records;
+        if (!readBlock(indexOffset, records)) {
+            return;
+        }
+        index.emplace();
+        std::size_t pos = 0;
+        while (pos < records.size() && records[pos] == detail::TagIndexKey) {
+            ++pos;
+            std::size_t length = detail::readVarint(records, pos);
+            std::string key = records.substr(pos, length);
+            pos += length;
+            auto& offsets = (*index)[key];
+            for (auto count = detail::readVarint(records, pos); count > 0; --count) {
+                offsets.push_back(detail::readVarint(records, pos));
+            }
+        }
+        end = indexOffset;
+    }
+
+    /** Read the block at the offset, failing if it is truncated */
+    bool readBlock(uint64_t offset, std::string& block) {
+        char size[4];
+        is.clear();
+        is.seekg(offset);
+        if (!is.read(size, sizeof(size))) {
+            return false;
+        }
+        block.resize(detail::readFixed(size, 4));
+        return static_cast<bool>(is.read(block.data(), block.size()));
+    }
+
+    /** Add the entries of the block, only those of the given relations if any */
+    static void addRecords(ProfileDatabase& db, const std::string& block, const std::set<std::string>* keys) {
+        std::vector<std::string> strings;
+        std::vector<std::string> path;
+        std::size_t pos = 0;
+        while (pos < block.size()) {
+            auto tag = static_cast<uint8_t>(block[pos++]);
+            if (tag == detail::TagString) {
+                std::size_t length = detail::readVarint(block, pos);
+                strings.push_back(block.substr(pos, length));
+                pos += length;
+                continue;
+            }
+            path.clear();
+            for (auto length = detail::readVarint(block, pos); length > 0; --length) {
+                path.push_back(strings.at(detail::readVarint(block, pos)));
+            }
+            bool wanted = keys == nullptr || keys->count(detail::indexKey(path)) > 0;
+            switch (tag) {
+                case detail::TagSize: {
+                    std::size_t size = detail::readVarint(block, pos);
+                    if (wanted) {
+                        db.addSizeEntry(path, size);
+                    }
+                    break;
+                }
+                case detail::TagText: {
+                    const std::string& text = strings.at(detail::readVarint(block, pos));
+                    if (wanted) {
+                        db.addTextEntry(path, text);
+                    }
+                    break;
+                }
+                case detail::TagDuration: {
+                    microseconds start(detail::readVarint(block, pos));
+                    microseconds end(detail::readVarint(block, pos));
+                    if (wanted) {
+                        db.addDurationEntry(path, start, end);
+                    }
+                    break;
+                }
+                case detail::TagTime: {
+                    microseconds time(detail::readVarint(block, pos));
+                    if (wanted) {
+                        db.addTimeEntry(path, time);
+                    }
+                    break;
+                }
+                default: throw std::runtime_error("Unknown profile log record");
+            }
+        }
+    }
+};
+
+}  // namespace profile
+}  // namespace souffle
@@ -0,0 +1,387 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2022, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file ProfileStream.h
+ *
+ * Streams the entries of a profile database over a Unix domain socket, so
+ * that souffleprof can follow a running program.
+ *
+ * Every entry is sent once, as a line of JSON holding its path and value.
+ * Entries of a profile database are never rewritten, so applying the lines
+ * in any order, and more than once, gives the same database.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "souffle/profile/ProfileDatabase.h"
+#include "souffle/utility/MiscUtil.h"
+#include "souffle/utility/json11.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace souffle {
+namespace profile {
+
+/** Encode an entry as a line of the stream */
+inline std::string encodeEntry(const std::vector<std::string>& path, const Entry& entry) {
+    json11::Json::object record{{"path", json11::Json(path)}};
+    if (auto* size = as<SizeEntry>(entry)) {
+        record["size"] = static_cast<double>(size->getSize());
+    } else if (auto* text = as<TextEntry>(entry)) {
+        record["text"] = text->getText();
+    } else if (auto* duration = as<DurationEntry>(entry)) {
+        record["start"] = static_cast<double>(duration->getStart().count());
+        record["end"] = static_cast<double>(duration->getEnd().count());
+    } else if (auto* time = as<TimeEntry>(entry)) {
+        record["time"] = static_cast<double>(time->getTime().count());
+    }
+    return json11::Json(record).dump() + "\n";
+}
+
+/** Add the entry encoded by a line of the stream to the database */
+inline void decodeEntry(ProfileDatabase& db, const std::string& line) {
+    std::string error;
+    json11::Json record = json11::Json::parse(line, error);
+    if (!error.empty() || record["path"].array_items().empty()) {
+        std::cerr << "Malformed profile stream record: " << line << std::endl;
+        return;
+    }
+    std::vector<std::string> path;
+    for (const auto& key : record["path"].array_items()) {
+        path.push_back(key.string_value());
+    }
+    if (record["size"].is_number()) {
+        db.addSizeEntry(path, static_cast<std::size_t>(record["size"].number_value()));
+    } else if (record["text"].is_string()) {
+        db.addTextEntry(path, record["text"].string_value());
+    } else if (record["start"].is_number()) {
+        db.addDurationEntry(path, microseconds(static_cast<long long>(record["start"].number_value())),
+                microseconds(static_cast<long long>(record["end"].number_value())));
+    } else if (record["time"].is_number()) {
+        db.addTimeEntry(path, microseconds(static_cast<long long>(record["time"].number_value())));
+    }
+}
+
+namespace detail {
+
+inline sockaddr_un socketAddress(const std::string& socketPath) {
+    sockaddr_un addr{};
+    if (socketPath.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Profile socket path is too long: " + socketPath);
+    }
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+    return addr;
+}
+
+/** Whether the path names an existing file that is not a socket */
+inline bool isOtherFile(const std::string& path) {
+    struct stat status {};
+    return ::lstat(path.c_str(), &status) == 0 && !S_ISSOCK(status.st_mode);
+}
+
+}  // namespace detail
+
+/**
+ * Publishes the entries of a profile database to the clients of a Unix domain socket.
+ *
+ * Adding an entry only appends a line to a buffer; a separate thread accepts
+ * clients and sends the buffer, so that a slow or absent client does not slow
+ * down the program. A new client first receives all entries so far.
+ *
+ * Clients are written without blocking. A client whose unsent lines exceed
+ * maxBacklog is dropped. If the buffer exceeds maxPending before the thread
+ * gets to it, the buffer is discarded and the clients are sent all entries
+ * again instead.
+ */
+class ProfileStreamWriter {
+public:
+    /** Bytes of lines that may wait for the sending thread */
+    static constexpr std::size_t maxPending = std::size_t(16) << 20;
+    /** Bytes of lines that may wait for a client to receive them */
+    static constexpr std::size_t maxBacklog = std::size_t(64) << 20;
+    /** Time given to the clients to receive the remaining lines when the stream is closed */
+    static constexpr std::chrono::milliseconds closingTimeout{1000};
+
+    ProfileStreamWriter(std::string socketPath, ProfileDatabase& db)
+            : socketPath(std::move(socketPath)), db(db) {
+        sockaddr_un addr = detail::socketAddress(this->socketPath);
+        if (detail::isOtherFile(this->socketPath)) {
+            throw std::runtime_error("Profile socket path <" + this->socketPath + "> is not a socket");
+        }
+        server = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (server < 0) {
+            throw std::runtime_error("Cannot create profile socket: " + std::string(std::strerror(errno)));
+        }
+        ::unlink(this->socketPath.c_str());
+        if (::bind(server, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+                ::listen(server, 4) < 0) {
+            ::close(server);
+            throw std::runtime_error("Cannot listen on profile socket <" + this->socketPath +
+                                     ">: " + std::strerror(errno));
+        }
+        ::fcntl(server, F_SETFL, ::fcntl(server, F_GETFL) | O_NONBLOCK);
+
+        listener = db.addListener([this](const std::vector<std::string>& path, const Entry& entry) {
+            std::string line = encodeEntry(path, entry);
+            std::lock_guard<std::mutex> guard(pendingLock);
+            if (resend) {
+                return;
+            }
+            if (pending.size() + line.size() > maxPending) {
+                // the clients are sent all entries again, which includes this one
+                pending.clear();
+                pending.shrink_to_fit();
+                resend = true;
+                return;
+            }
+            pending += line;
+        });
+        sender = std::thread([this]() { run(); });
+    }
+
+    ProfileStreamWriter(const ProfileStreamWriter&) = delete;
+    ProfileStreamWriter& operator=(const ProfileStreamWriter&) = delete;
+
+    /** Send the remaining entries, waiting at most closingTimeout, and close the connections */
+    ~ProfileStreamWriter() {
+        db.removeListener(listener);
+        {
+            std::lock_guard<std::mutex> guard(pendingLock);
+            running = false;
+        }
+        wakeup.notify_all();
+        sender.join();
+        for (auto& client : clients) {
+            ::close(client.socket);
+        }
+        ::close(server);
+        if (!detail::isOtherFile(socketPath)) {
+            ::unlink(socketPath.c_str());
+        }
+    }
+
+private:
+    /** Interval in which new clients are accepted and entries are sent */
+    static constexpr std::chrono::milliseconds interval{100};
+
+    struct Client {
+        int socket;
+        /** Lines not yet received by the client */
+        std::string backlog;
+    };
+
+    std::string socketPath;
+    ProfileDatabase& db;
+    std::size_t listener;
+    int server;
+    std::vector<Client> clients;
+
+    /** Lines of the entries added since the last send */
+    std::string pending;
+    /** If lines were discarded, and all entries must be sent again */
+    bool resend = false;
+    std::mutex pendingLock;
+    std::condition_variable wakeup;
+    bool running = true;
+    std::thread sender;
+
+    void run() {
+        bool stop = false;
+        while (!stop) {
+            std::string lines;
+            bool all = false;
+            {
+                std::unique_lock<std::mutex> lock(pendingLock);
+                wakeup.wait_for(lock, interval, [this]() { return !running; });
+                stop = !running;
+                std::swap(lines, pending);
+                std::swap(all, resend);
+            }
+            if (all) {
+                // taken after the buffer, so that no entry is missed
+                lines = snapshot();
+            }
+            for (auto& client : clients) {
+                client.backlog += lines;
+            }
+            acceptClients();
+            flush(false);
+        }
+
+        // give the clients a bounded time to receive the remaining lines
+        flush(true);
+        auto deadline = std::chrono::steady_clock::now() + closingTimeout;
+        while (!clients.empty() && std::chrono::steady_clock::now() < deadline) {
+            std::vector<pollfd> waiting;
+            for (auto& client : clients) {
+                waiting.push_back({client.socket, POLLOUT, 0});
+            }
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now());
+            ::poll(waiting.data(), waiting.size(), static_cast<int>(std::max<long long>(0, left.count())));
+            flush(true);
+        }
+    }
+
+    /** All entries of the database as lines */
+    std::string snapshot() {
+        std::string lines;
+        db.forEachEntry([&](const std::vector<std::string>& path, const Entry& entry) {
+            lines += encodeEntry(path, entry);
+        });
+        return lines;
+    }
+
+    void acceptClients() {
+        int client;
+        while ((client = ::accept(server, nullptr, nullptr)) >= 0) {
+            ::fcntl(client, F_SETFL, ::fcntl(client, F_GETFL) | O_NONBLOCK);
+            // entries added while the snapshot is taken may be sent twice, which is harmless
+            clients.push_back({client, snapshot()});
+        }
+    }
+
+    /**
+     * Send as much of the backlogs as the clients accept without blocking, and close the clients
+     * that failed or fell behind by more than maxBacklog. If closing, clients are also closed as
+     * soon as they have received their backlog.
+     */
+    void flush(bool closing) {
+        clients.erase(std::remove_if(clients.begin(), clients.end(),
+                              [&](Client& client) {
+                                  bool keep = send(client) && client.backlog.size() <= maxBacklog &&
+                                              !(closing && client.backlog.empty());
+                                  if (!keep) {
+                                      ::close(client.socket);
+                                  }
+                                  return !keep;
+                              }),
+                clients.end());
+    }
+
+    /** Send the backlog of the client until it would block, and report whether the client is alive */
+    static bool send(Client& client) {
+        std::size_t sent = 0;
+        while (sent < client.backlog.size()) {
+            ssize_t n = ::send(client.socket, client.backlog.data() + sent, client.backlog.size() - sent,
+                    MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            sent += static_cast<std::size_t>(n);
+        }
+        client.backlog.erase(0, sent);
+        return true;
+    }
+};
+
+/**
+ * Receives the entries published by a ProfileStreamWriter into a profile database.
+ */
+class ProfileStreamReader {
+public:
+    /**
+     * Connect to the socket, waiting for the program to create it if necessary.
+     */
+    ProfileStreamReader(const std::string& socketPath, ProfileDatabase& db,
+            std::chrono::seconds timeout = std::chrono::seconds(10))
+            : db(db) {
+        sockaddr_un addr = detail::socketAddress(socketPath);
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (true) {
+            connection = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if (connection < 0) {
+                throw std::runtime_error("Cannot create socket: " + std::string(std::strerror(errno)));
+            }
+            if (::connect(connection, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) {
+                break;
+            }
+            ::close(connection);
+            if (std::chrono::steady_clock::now() > deadline) {
+                throw std::runtime_error("Cannot connect to profile socket <" + socketPath +
+                                         ">: " + std::strerror(errno));
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        receiver = std::thread([this]() { run(); });
+    }
+
+    ProfileStreamReader(const ProfileStreamReader&) = delete;
+    ProfileStreamReader& operator=(const ProfileStreamReader&) = delete;
+
+    ~ProfileStreamReader() {
+        ::shutdown(connection, SHUT_RDWR);
+        receiver.join();
+        ::close(connection);
+    }
+
+    /** Whether the program is still publishing entries */
+    bool isOpen() const {
+        return open;
+    }
+
+private:
+    ProfileDatabase& db;
+    int connection;
+    std::atomic<bool> open{true};
+    std::thread receiver;
+
+    void run() {
+        std::string buffer;
+        char chunk[1 << 16];
+        ssize_t n;
+        while ((n = ::recv(connection, chunk, sizeof(chunk), 0)) != 0) {
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            buffer.append(chunk, static_cast<std::size_t>(n));
+            std::size_t begin = 0;
+            std::size_t end;
+            while ((end = buffer.find('\n', begin)) != std::string::npos) {
+                decodeEntry(db, buffer.substr(begin, end - begin));
+                begin = end + 1;
+            }
+            buffer.erase(0, begin);
+        }
+        open = false;
+    }
+};
+
+}  // namespace profile
+}  // namespace souffle
@@ -22,6 +22,9 @@
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
 #include <string>
 #include <thread>
 #include <unordered_map>
@@ -60,6 +63,21 @@ public:
 
 protected:
     T& base;
+
+    /** Add the sizes of a counters or parallel directory to the given rule or relation */
+    template <typename S>
+    static void visitStatistics(const DirectoryEntry& directory, S& target) {
+        bool parallel = directory.getKey() == "parallel";
+        for (const auto& key : directory.getKeys()) {
+            if (auto* value = as<SizeEntry>(directory.readEntry(key))) {
+                if (parallel) {
+                    target.addParallel(key, value->getSize());
+                } else {
+                    target.addCounter(key, value->getSize());
+                }
+            }
+        }
+    }
 };
 
 /**
@@ -99,6 +117,8 @@ public:
             for (auto& key : directory.getKeys()) {
                 directory.readDirectoryEntry(key)->accept(atomFrequenciesVisitor);
             }
+        } else if (directory.getKey() == "counters" || directory.getKey() == "parallel") {
+            visitStatistics(directory, base);
         }
     }
 };
@@ -144,6 +164,8 @@ public:
             for (auto& key : directory.getKeys()) {
                 directory.readDirectoryEntry(key)->accept(atomFrequenciesVisitor);
             }
+        } else if (directory.getKey() == "counters" || directory.getKey() == "parallel") {
+            visitStatistics(directory, base);
         }
     }
 };
@@ -195,6 +217,9 @@ public:
             relation.setPreMaxRSS(preMaxRSS->getSize());
             relation.setPostMaxRSS(postMaxRSS->getSize());
         }
+        if (directory.getKey() == "counters" || directory.getKey() == "parallel") {
+            visitStatistics(directory, relation);
+        }
     }
 
 protected:
@@ -254,6 +279,20 @@ public:
             auto* postMaxRSS = as<SizeEntry>(directory.readEntry("post"));
             base.setPreMaxRSS(preMaxRSS->getSize());
             base.setPostMaxRSS(postMaxRSS->getSize());
+        } else if (directory.getKey() == "counters" || directory.getKey() == "parallel") {
+            visitStatistics(directory, base);
+        } else if (directory.getKey() == "index") {
+            for (const auto& index : directory.getKeys()) {
+                auto* statistics = directory.readDirectoryEntry(index);
+                if (statistics == nullptr) {
+                    continue;
+                }
+                for (const auto& key : statistics->getKeys()) {
+                    if (auto* value = as<SizeEntry>(statistics->readEntry(key))) {
+                        base.setIndexStatistic(index, key, value->getSize());
+                    }
+                }
+            }
         }
     }
     void visit(SizeEntry& size) override {
@@ -273,10 +312,27 @@ class Reader {
 private:
     std::string file_loc;
     std::streampos gpos;
-    const ProfileDatabase& db = ProfileEventSingleton::instance().getDB();
+    ProfileDatabase& db = ProfileEventSingleton::instance().getDB();
     bool loaded = false;
     bool online{true};
 
+    /** Id of the listener recording the relations changed since the last processFile, if any */
+    std::optional<std::size_t> listener;
+    std::mutex changesLock;
+    std::set<std::string> changedRelations;
+    bool changedStatistics = false;
+    /** Whether the next processFile must process the whole database */
+    bool processAll = true;
+
+    /** Tuples read by the rules of each relation, by read relation */
+    std::unordered_map<std::string, std::unordered_map<std::string, std::size_t>> readsBy;
+    /** Tuples read from each relation, summed over readsBy */
+    std::unordered_map<std::string, std::size_t> reads;
+
+#ifndef WIN32
+    Own<ProfileStreamReader> stream;
+#endif  // WIN32
+
     std::unordered_map<std::string, std::shared_ptr<Relation>> relationMap{};
     std::unordered_map<std::string, std::unordered_map<std::string, std::size_t>>
             countRecursiveUniqueKeysMap{};
@@ -295,13 +351,70 @@ public:
         }
     }
 
-    Reader(std::shared_ptr<ProgramRun> run) : run(std::move(run)) {}
+    /**
+     * Read the profile of the program running in this process, or of the program
+     * streaming its profile after connect. Only the relations changed since the
+     * last processFile are processed again.
+     */
+    Reader(std::shared_ptr<ProgramRun> run) : run(std::move(run)) {
+        listener = db.addListener([this](const std::vector<std::string>& path, const Entry&) {
+            if (path.size() < 3 || path[0] != "program") {
+                return;
+            }
+            std::lock_guard<std::mutex> guard(changesLock);
+            if (path[1] == "relation") {
+                changedRelations.insert(path[2]);
+            } else if (path[1] == "statistics") {
+                changedStatistics = true;
+            }
+        });
+    }
+
+    ~Reader() {
+#ifndef WIN32
+        stream = nullptr;
+#endif  // WIN32
+        if (listener) {
+            db.removeListener(*listener);
+        }
+    }
+
+    /**
+     * Receive the profile of a program publishing it on the given socket.
+     */
+    void connect(const std::string& socketPath) {
+#ifdef WIN32
+        fatal("profile streams are not supported on Windows");
+#else
+        try {
+            stream = mk<ProfileStreamReader>(socketPath, db);
+        } catch (const std::exception& e) {
+            fatal("exception whilst connecting to profile stream: %s", e.what());
+        }
+#endif  // WIN32
+    }
+
     /**
      * Read the contents from file into the class
      */
     void processFile() {
-        rel_id = 0;
-        relationMap.clear();
+        std::set<std::string> changed;
+        bool all = !listener || processAll;
+        bool statistics = all;
+        {
+            std::lock_guard<std::mutex> guard(changesLock);
+            std::swap(changed, changedRelations);
+            statistics = statistics || changedStatistics;
+            changedStatistics = false;
+            processAll = false;
+        }
+        if (all) {
+            rel_id = 0;
+            relationMap.clear();
+            readsBy.clear();
+            reads.clear();
+        }
+
         auto programDuration = as<DurationEntry>(db.lookupEntry({"program", "runtime"}));
         if (programDuration == nullptr) {
             auto startTimeEntry = as<TimeEntry>(db.lookupEntry({"program", "starttime"}));
@@ -316,8 +429,13 @@ public:
             online = false;
         }
 
+        // the passes of the compiler can be inspected without a program run
+        if (db.lookupEntry({"compile", "pass"}) != nullptr) {
+            loaded = true;
+        }
+
         auto prefix = as<DirectoryEntry>(db.lookupEntry({"program", "statistics", "relation"}));
-        if (prefix != nullptr) {
+        if (statistics && prefix != nullptr) {
             for (const auto& rel : prefix->getKeys()) {
                 auto prefixWithRel = as<DirectoryEntry>(
                         db.lookupEntry({"program", "statistics", "relation", rel, "attributes"}));
@@ -379,35 +497,12 @@ public:
             // or program is empty.
             return;
         }
-        for (const auto& cur : relations->getKeys()) {
+        for (const auto& cur : all ? relations->getKeys() : changed) {
             auto relation = as<DirectoryEntry>(db.lookupEntry({"program", "relation", cur}));
             if (relation != nullptr) {
                 addRelation(*relation);
             }
         }
-        for (const auto& relation : relationMap) {
-            for (const auto& rule : relation.second->getRuleMap()) {
-                for (const auto& atom : rule.second->getAtoms()) {
-                    std::string relationName = extractRelationNameFromAtom(atom);
-                    relationMap[relationName]->addReads(atom.frequency);
-                }
-            }
-            for (const auto& iteration : relation.second->getIterations()) {
-                for (const auto& rule : iteration->getRules()) {
-                    for (const auto& atom : rule.second->getAtoms()) {
-                        std::string relationName = extractRelationNameFromAtom(atom);
-                        if (relationName.substr(0, 6) == "@delta") {
-                            relationName = relationName.substr(7);
-                        }
-                        if (relationName.substr(0, 4) == "@new") {
-                            relationName = relationName.substr(5);
-                        }
-                        assert(relationMap.count(relationName) > 0 || "Relation name for atom not found");
-                        relationMap[relationName]->addReads(atom.frequency);
-                    }
-                }
-            }
-        }
         run->setRelationMap(this->relationMap);
         loaded = true;
     }
@@ -415,6 +510,11 @@ public:
     void save(std::string f_name);
 
     inline bool isLive() {
+#ifndef WIN32
+        if (stream != nullptr && !stream->isOpen()) {
+            return false;
+        }
+#endif  // WIN32
         return online;
     }
 
@@ -446,16 +546,62 @@ public:
         return static_cast<std::size_t>(m.at(iteration));
     }
 
+    /**
+     * Add the relation, or replace it if it was added before, and update the
+     * tuples read from the relations its rules read.
+     */
     void addRelation(const DirectoryEntry& relation) {
         const std::string& name = cleanRelationName(relation.getKey());
 
-        relationMap.emplace(name, std::make_shared<Relation>(name, createId()));
-        auto& rel = *relationMap[name];
-        RelationVisitor relationVisitor(rel);
+        auto existing = relationMap.find(name);
+        std::string id = existing != relationMap.end() ? existing->second->getId() : createId();
+        auto rel = std::make_shared<Relation>(name, id);
+        relationMap[name] = rel;
+        RelationVisitor relationVisitor(*rel);
 
         for (const auto& key : relation.getKeys()) {
             relation.readEntry(key)->accept(relationVisitor);
         }
+
+        std::unordered_map<std::string, std::size_t> relationReads;
+        for (const auto& rule : rel->getRuleMap()) {
+            for (const auto& atom : rule.second->getAtoms()) {
+                relationReads[extractRelationNameFromAtom(atom)] += atom.frequency;
+            }
+        }
+        for (const auto& iteration : rel->getIterations()) {
+            for (const auto& rule : iteration->getRules()) {
+                for (const auto& atom : rule.second->getAtoms()) {
+                    std::string relationName = extractRelationNameFromAtom(atom);
+                    if (relationName.substr(0, 6) == "@delta") {
+                        relationName = relationName.substr(7);
+                    }
+                    if (relationName.substr(0, 4) == "@new") {
+                        relationName = relationName.substr(5);
+                    }
+                    relationReads[relationName] += atom.frequency;
+                }
+            }
+        }
+
+        std::set<std::string> updated{name};
+        for (const auto& [target, count] : readsBy[name]) {
+            reads[target] -= count;
+            updated.insert(target);
+        }
+        for (const auto& [target, count] : relationReads) {
+            reads[target] += count;
+            updated.insert(target);
+        }
+        readsBy[name] = std::move(relationReads);
+
+        // reads from relations that are not added yet are set when they are
+        for (const auto& target : updated) {
+            auto it = relationMap.find(target);
+            if (it != relationMap.end()) {
+                it->second->setReads(reads[target]);
+            }
+        }
     }
 
     inline bool isLoaded() {
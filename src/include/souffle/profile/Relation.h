@@ -13,6 +13,7 @@
 #include <algorithm>
 #include <chrono>
 #include <cstddef>
+#include <map>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -41,6 +42,12 @@ private:
     int ruleId = 0;
     int recursiveId = 0;
     std::size_t tuplesRead = 0;
+    /** hardware performance counters of the relation and its iterations, by name */
+    std::map<std::string, std::size_t> counters;
+    /** load balance of the parallel loops and lock contention, by name */
+    std::map<std::string, std::size_t> parallel;
+    /** usage of the indexes of the relation, by index and name */
+    std::map<std::string, std::map<std::string, std::size_t>> indexes;
 
     std::vector<std::shared_ptr<Iteration>> iterations;
 
@@ -248,6 +255,34 @@ public:
     void addReads(std::size_t tuplesRead) {
         this->tuplesRead += tuplesRead;
     }
+
+    void setReads(std::size_t tuplesRead) {
+        this->tuplesRead = tuplesRead;
+    }
+
+    void addCounter(const std::string& counter, std::size_t value) {
+        counters[counter] += value;
+    }
+
+    const std::map<std::string, std::size_t>& getCounters() const {
+        return counters;
+    }
+
+    void addParallel(const std::string& statistic, std::size_t value) {
+        parallel[statistic] += value;
+    }
+
+    const std::map<std::string, std::size_t>& getParallel() const {
+        return parallel;
+    }
+
+    void setIndexStatistic(const std::string& index, const std::string& statistic, std::size_t value) {
+        indexes[index][statistic] = value;
+    }
+
+    const std::map<std::string, std::map<std::string, std::size_t>>& getIndexes() const {
+        return indexes;
+    }
 };
 
 }  // namespace profile
@@ -9,6 +9,8 @@
 #pragma once
 
 #include <chrono>
+#include <cstddef>
+#include <map>
 #include <set>
 #include <sstream>
 #include <string>
@@ -53,6 +55,10 @@ protected:
     std::string identifier;
     std::string locator{};
     std::set<Atom> atoms;
+    /** hardware performance counters, by name */
+    std::map<std::string, std::size_t> counters;
+    /** load balance of the parallel loops and lock contention, by name */
+    std::map<std::string, std::size_t> parallel;
 
 private:
     bool recursive = false;
@@ -104,6 +110,22 @@ public:
     const std::set<Atom>& getAtoms() const {
         return atoms;
     }
+
+    void addCounter(const std::string& counter, std::size_t value) {
+        counters[counter] += value;
+    }
+
+    const std::map<std::string, std::size_t>& getCounters() const {
+        return counters;
+    }
+
+    void addParallel(const std::string& statistic, std::size_t value) {
+        parallel[statistic] += value;
+    }
+
+    const std::map<std::string, std::size_t>& getParallel() const {
+        return parallel;
+    }
     std::string getName() const {
         return name;
     }
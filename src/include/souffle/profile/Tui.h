@@ -36,6 +36,7 @@
 #include <set>
 #include <string>
 #include <thread>
+#include <tuple>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -96,24 +97,20 @@ public:
         this->loaded = reader->isLoaded();
     }
 
+    /** Follow the program running in this process */
     Tui() {
         const std::shared_ptr<ProgramRun>& run = out.getProgramRun();
         this->reader = std::make_shared<Reader>(run);
-        this->loaded = true;
-        this->alive = true;
-        updateDB();
-        updater = std::thread([this]() {
-            // Update the display every 30s. Check for input every 0.5s
-            std::chrono::milliseconds interval(30000);
-            auto nextUpdateTime = std::chrono::high_resolution_clock::now();
-            do {
-                std::this_thread::sleep_for(std::chrono::milliseconds(500));
-                if (nextUpdateTime < std::chrono::high_resolution_clock::now()) {
-                    runCommand({});
-                    nextUpdateTime = std::chrono::high_resolution_clock::now() + interval;
-                }
-            } while (reader->isLive() && !linereader.hasReceivedInput());
-        });
+        startUpdater();
+    }
+
+    /** Follow a program publishing its profile on the given socket */
+    explicit Tui(const std::string& socketPath) {
+        resultLimit = 20;
+        const std::shared_ptr<ProgramRun>& run = out.getProgramRun();
+        this->reader = std::make_shared<Reader>(run);
+        reader->connect(socketPath);
+        startUpdater();
     }
 
     ~Tui() {
@@ -208,6 +205,14 @@ public:
             }
         } else if (c[0] == "configuration") {
             configuration();
+        } else if (c[0] == "passes") {
+            passes(resultLimit);
+        } else if (c[0] == "counters") {
+            counters(resultLimit);
+        } else if (c[0] == "parallel") {
+            parallel(resultLimit);
+        } else if (c[0] == "indexes") {
+            indexes(resultLimit);
         } else {
             std::cout << "Unknown command. Use \"help\" for a list of commands.\n";
         }
@@ -702,6 +707,12 @@ public:
         std::printf("  %-30s%-5s %s\n", "usage [relation id|rule id]", "-",
                 "display CPU usage graphs for a relation or rule.");
         std::printf("  %-30s%-5s %s\n", "memory", "-", "display memory usage.");
+        std::printf("  %-30s%-5s %s\n", "passes", "-", "display compiler passes recorded by --time-passes.");
+        std::printf("  %-30s%-5s %s\n", "counters", "-",
+                "display hardware counters recorded by --profile-counters.");
+        std::printf("  %-30s%-5s %s\n", "parallel", "-", "display load balance of parallel rules.");
+        std::printf("  %-30s%-5s %s\n", "indexes", "-",
+                "display usage of indexes recorded by --profile-indexes.");
         std::printf("  %-30s%-5s %s\n", "help", "-", "print this.");
 
         std::cout << "\nInteractive mode only commands:" << std::endl;
@@ -992,6 +1003,10 @@ public:
         linereader.appendTabCompletion("limit ");
         linereader.appendTabCompletion("memory");
         linereader.appendTabCompletion("configuration");
+        linereader.appendTabCompletion("passes");
+        linereader.appendTabCompletion("counters");
+        linereader.appendTabCompletion("parallel");
+        linereader.appendTabCompletion("indexes");
 
         // add rel tab completes after the rest so users can see all commands first
         for (auto& row : Tools::formatTable(relationTable, precision)) {
@@ -1017,6 +1032,374 @@ public:
         std::cout << std::endl;
     }
 
+    /**
+     * Display the compiler passes by total time. Passes consisting of other
+     * passes, e.g. pipelines, are left out since their time is already counted.
+     */
+    void passes(std::size_t limit) {
+        struct PassSummary {
+            std::chrono::microseconds time{0};
+            std::size_t runs = 0;
+            std::size_t changed = 0;
+            std::size_t maxRSS = 0;
+        };
+        const ProfileDatabase& db = ProfileEventSingleton::instance().getDB();
+        auto* passesEntry = as<DirectoryEntry>(db.lookupEntry({"compile", "pass"}));
+        if (passesEntry == nullptr) {
+            std::cout << "No compiler passes recorded. Use souffle --time-passes=<FILE>.\n";
+            return;
+        }
+
+        std::map<std::string, PassSummary> summaries;
+        for (const auto& key : passesEntry->getKeys()) {
+            auto* pass = passesEntry->readDirectoryEntry(key);
+            auto* leaf = as<SizeEntry>(pass->readEntry("leaf"));
+            if (leaf == nullptr || leaf->getSize() == 0) {
+                continue;
+            }
+            auto* runtime = as<DurationEntry>(pass->readEntry("runtime"));
+            std::string name = as<TextEntry>(pass->readEntry("stage"))->getText() + "/" +
+                               as<TextEntry>(pass->readEntry("name"))->getText();
+            PassSummary& summary = summaries[name];
+            summary.time += runtime->getEnd() - runtime->getStart();
+            summary.runs++;
+            summary.changed += as<SizeEntry>(pass->readEntry("changed"))->getSize();
+            summary.maxRSS = std::max(summary.maxRSS, as<SizeEntry>(pass->readEntry("maxRSS"))->getSize());
+        }
+
+        std::vector<std::pair<std::string, PassSummary>> sorted(summaries.begin(), summaries.end());
+        std::sort(sorted.begin(), sorted.end(),
+                [](const auto& a, const auto& b) { return a.second.time > b.second.time; });
+
+        std::cout << " ----- Compiler Passes -----\n";
+        std::printf("%8s%8s%8s%10s %s\n\n", "TOT_T", "RUNS", "CHANGED", "MAX_RSS", "NAME");
+        std::size_t count = 0;
+        for (const auto& [name, summary] : sorted) {
+            if (++count > limit) {
+                std::cout << (sorted.size() - limit) << " rows not shown" << std::endl;
+                break;
+            }
+            std::printf("%8s%8zu%8zu%10s %s\n", Tools::formatTime(summary.time).c_str(), summary.runs,
+                    summary.changed, Tools::formatMemory(summary.maxRSS).c_str(), name.c_str());
+        }
+    }
+
+    /**
+     * Display the hardware counters of relations and rules by cycles. The
+     * counters of a recursive rule are summed over its iterations.
+     */
+    void counters(std::size_t limit) {
+        using Counters = std::map<std::string, std::size_t>;
+        auto config = ProfileEventSingleton::instance().getDB().getStringMap({"program", "configuration"});
+        if (config.count("perf-counters") == 0 || config["perf-counters"] == "unavailable") {
+            std::cout << "No hardware counters recorded. Use souffle --profile-counters on Linux.\n";
+            return;
+        }
+
+        std::vector<std::tuple<Counters, std::string, std::string>> relations;
+        for (const auto& rel : out.getProgramRun()->getRelationMap()) {
+            relations.emplace_back(rel.second->getCounters(), rel.second->getId(), rel.second->getName());
+        }
+
+        auto printTable = [&](const std::string& title,
+                                  std::vector<std::tuple<Counters, std::string, std::string>> rows) {
+            std::sort(rows.begin(), rows.end(), [](const auto& a, const auto& b) {
+                return counter(std::get<0>(a), "cycles") > counter(std::get<0>(b), "cycles");
+            });
+            std::cout << " ----- " << title << " -----\n";
+            std::printf("%10s%10s%6s%10s%10s%8s %s\n\n", "CYCLES", "INSTR", "IPC", "LLC_MISS", "DTLB_MISS",
+                    "ID", "NAME");
+            std::size_t count = 0;
+            for (const auto& [values, id, name] : rows) {
+                if (++count > limit) {
+                    std::cout << (rows.size() - limit) << " rows not shown" << std::endl;
+                    break;
+                }
+                std::printf("%10s%10s%6s%10s%10s%8s %s\n", formatCounter(values, "cycles").c_str(),
+                        formatCounter(values, "instructions").c_str(), formatIPC(values).c_str(),
+                        formatCounter(values, "llc-misses").c_str(),
+                        formatCounter(values, "dtlb-misses").c_str(), id.c_str(), name.c_str());
+            }
+        };
+
+        printTable("Relation Counters", relations);
+        std::cout << "\n";
+        printTable("Rule Counters", ruleStatistics([](const Rule& rule) { return rule.getCounters(); }));
+    }
+
+    /**
+     * Display the load balance of the parallel loops of the rules by the time
+     * threads spent waiting in them, and the contention of locks.
+     */
+    void parallel(std::size_t limit) {
+        const ProfileDatabase& db = ProfileEventSingleton::instance().getDB();
+        auto* program = as<DirectoryEntry>(db.lookupEntry({"program", "parallel"}));
+        if (program == nullptr) {
+            std::cout << "No parallel loops recorded. Profile a program run with more than one job.\n";
+            return;
+        }
+        std::map<std::string, std::size_t> total;
+        for (const auto& key : program->getKeys()) {
+            if (auto* value = as<SizeEntry>(program->readEntry(key))) {
+                total[key] = value->getSize();
+            }
+        }
+        std::cout << "Parallel loops: " << counter(total, "regions")
+                  << ", efficiency: " << formatEfficiency(total)
+                  << ", parallelism: " << formatParallelism(total)
+                  << ", lock restarts: " << counter(total, "lock-restarts")
+                  << ", lane waits: " << counter(total, "lane-waits") << "\n\n";
+
+        auto rows = ruleStatistics([](const Rule& rule) { return rule.getParallel(); });
+        rows.erase(std::remove_if(rows.begin(), rows.end(),
+                           [](const auto& row) { return std::get<0>(row).empty(); }),
+                rows.end());
+        std::sort(rows.begin(), rows.end(), [](const auto& a, const auto& b) {
+            return waitTime(std::get<0>(a)) > waitTime(std::get<0>(b));
+        });
+        std::cout << " ----- Parallel Rules -----\n";
+        std::printf("%8s%8s%8s%6s%6s%10s%10s%8s %s\n\n", "LOOPS", "BUSY_T", "WAIT_T", "EFF", "PAR",
+                "RESTARTS", "LANE_W", "ID", "NAME");
+        std::size_t count = 0;
+        for (const auto& [values, id, name] : rows) {
+            if (++count > limit) {
+                std::cout << (rows.size() - limit) << " rows not shown" << std::endl;
+                break;
+            }
+            std::printf("%8zu%8s%8s%6s%6s%10zu%10zu%8s %s\n", counter(values, "regions"),
+                    Tools::formatTime(std::chrono::microseconds(counter(values, "busy"))).c_str(),
+                    Tools::formatTime(std::chrono::microseconds(waitTime(values))).c_str(),
+                    formatEfficiency(values).c_str(), formatParallelism(values).c_str(),
+                    counter(values, "lock-restarts"), counter(values, "lane-waits"), id.c_str(),
+                    name.c_str());
+        }
+    }
+
+    /**
+     * Display the usage of the indexes of the relations by their lookups,
+     * followed by suggestions for indexes that are used poorly.
+     */
+    void indexes(std::size_t limit) {
+        using Statistics = std::map<std::string, std::size_t>;
+        std::vector<std::tuple<Statistics, std::string, std::string, std::string>> rows;
+        for (const auto& rel : out.getProgramRun()->getRelationMap()) {
+            for (const auto& [index, values] : rel.second->getIndexes()) {
+                rows.emplace_back(values, rel.second->getId(), rel.second->getName(), index);
+            }
+        }
+        if (rows.empty()) {
+            std::cout << "No index statistics recorded. Use souffle --profile-indexes.\n";
+            return;
+        }
+        std::sort(rows.begin(), rows.end(), [](const auto& a, const auto& b) {
+            return counter(std::get<0>(a), "lookups") > counter(std::get<0>(b), "lookups");
+        });
+
+        // hints are only counted by compiled programs, so their columns are left out of interpreted runs
+        bool hintsCounted = std::any_of(rows.begin(), rows.end(),
+                [](const auto& row) { return std::get<0>(row).count("lookup-hint-hits") > 0; });
+
+        std::cout << " ----- Indexes -----\n";
+        std::printf("%10s%6s%10s%7s%7s%10s", "SIZE", "DEPTH", "LOOKUPS", "EMPTY", "FULL", "AVG_RANGE");
+        if (hintsCounted) {
+            std::printf("%7s%7s", "L_HIT", "I_HIT");
+        }
+        std::printf("%8s %s %s\n\n", "ID", "NAME", "INDEX");
+        std::size_t count = 0;
+        for (const auto& [values, id, name, index] : rows) {
+            if (++count > limit) {
+                std::cout << (rows.size() - limit) << " rows not shown" << std::endl;
+                break;
+            }
+            bool counted = values.count("lookups") > 0;
+            std::size_t lookups = counter(values, "lookups");
+            std::size_t scans = counter(values, "scans");
+            std::printf("%10zu%6zu%10s%7s%7s%10s", counter(values, "size"), counter(values, "depth"),
+                    counted ? std::to_string(lookups).c_str() : "-",
+                    formatShare(counter(values, "empty-lookups"), lookups).c_str(),
+                    formatShare(counter(values, "full-ranges"), lookups).c_str(),
+                    scans == 0 ? "-" : std::to_string(counter(values, "tuples") / scans).c_str());
+            if (hintsCounted) {
+                std::printf("%7s%7s", formatHitRate(values, "lookup").c_str(),
+                        formatHitRate(values, "insert").c_str());
+            }
+            std::printf("%8s %s %s\n", id.c_str(), name.c_str(), index.c_str());
+        }
+
+        if (!hintsCounted) {
+            std::cout << "\nHint hit rates are only recorded by compiled programs.\n";
+        }
+
+        std::cout << "\n ----- Suggestions -----\n";
+        std::size_t suggestions = 0;
+        for (const auto& [values, id, name, index] : rows) {
+            std::size_t lookups = counter(values, "lookups");
+            std::size_t hintHits = counter(values, "lookup-hint-hits");
+            std::size_t hintAccesses = hintHits + counter(values, "lookup-hint-misses");
+            if (values.count("lookups") > 0 && lookups == 0 && counter(values, "position") > 0) {
+                std::cout << "Index " << index << " of " << name
+                          << " is never searched: it only slows down inserts.\n";
+                ++suggestions;
+            } else if (lookups >= 1000 && counter(values, "full-ranges") == lookups) {
+                std::cout << "Every lookup in index " << index << " of " << name
+                          << " scans the whole index: no search bounds its first column.\n";
+                ++suggestions;
+            }
+            if (hintAccesses >= 1000 && hintHits * 10 < hintAccesses) {
+                std::cout << "Lookups in index " << index << " of " << name << " rarely hit their hints ("
+                          << formatHitRate(values, "lookup")
+                          << "): consecutive searches are far apart in the index.\n";
+                ++suggestions;
+            }
+        }
+        if (suggestions == 0) {
+            std::cout << "None.\n";
+        }
+    }
+
+    /** Share of a total as a percentage */
+    static std::string formatShare(std::size_t part, std::size_t total) {
+        if (total == 0) {
+            return "-";
+        }
+        char share[16];
+        std::snprintf(share, sizeof(share), "%.0f%%", 100.0 * static_cast<double>(part) / total);
+        return share;
+    }
+
+    /** Share of the insert or lookup operations of an index that hit their hints */
+    static std::string formatHitRate(
+            const std::map<std::string, std::size_t>& values, const std::string& kind) {
+        std::size_t hits = counter(values, kind + "-hint-hits");
+        return formatShare(hits, hits + counter(values, kind + "-hint-misses"));
+    }
+
+    /** Time threads of parallel loops spent waiting, in microseconds */
+    static std::size_t waitTime(const std::map<std::string, std::size_t>& parallel) {
+        std::size_t busy = counter(parallel, "busy");
+        std::size_t capacity = counter(parallel, "capacity");
+        return capacity > busy ? capacity - busy : 0;
+    }
+
+    /** Share of the time of the threads of parallel loops spent working */
+    static std::string formatEfficiency(const std::map<std::string, std::size_t>& parallel) {
+        std::size_t capacity = counter(parallel, "capacity");
+        if (capacity == 0) {
+            return "-";
+        }
+        char efficiency[16];
+        double busy = static_cast<double>(counter(parallel, "busy"));
+        std::snprintf(efficiency, sizeof(efficiency), "%.0f%%", 100.0 * busy / capacity);
+        return efficiency;
+    }
+
+    /**
+     * Work of parallel loops divided by the work of their busiest thread: the
+     * speedup the distribution of the work allows, however many threads run it.
+     */
+    static std::string formatParallelism(const std::map<std::string, std::size_t>& parallel) {
+        std::size_t maxBusy = counter(parallel, "max-busy");
+        if (maxBusy == 0) {
+            return "-";
+        }
+        char parallelism[16];
+        double busy = static_cast<double>(counter(parallel, "busy"));
+        std::snprintf(parallelism, sizeof(parallelism), "%.1f", busy / maxBusy);
+        return parallelism;
+    }
+
+    /**
+     * Statistics of all rules with their id and name, summed over the versions
+     * and iterations of a rule.
+     */
+    template <typename F>
+    std::vector<std::tuple<std::map<std::string, std::size_t>, std::string, std::string>> ruleStatistics(
+            F statistics) {
+        std::map<std::string, std::pair<std::map<std::string, std::size_t>, std::string>> rules;
+        auto addRule = [&](const Rule& rule) {
+            auto& entry = rules[rule.getId()];
+            entry.second = rule.getName();
+            for (const auto& [name, value] : statistics(rule)) {
+                entry.first[name] += value;
+            }
+        };
+        for (const auto& rel : out.getProgramRun()->getRelationMap()) {
+            for (const auto& rule : rel.second->getRuleMap()) {
+                addRule(*rule.second);
+            }
+            for (const auto& iteration : rel.second->getIterations()) {
+                for (const auto& rule : iteration->getRules()) {
+                    addRule(*rule.second);
+                }
+            }
+        }
+        std::vector<std::tuple<std::map<std::string, std::size_t>, std::string, std::string>> rows;
+        for (auto& [id, rule] : rules) {
+            rows.emplace_back(std::move(rule.first), id, std::move(rule.second));
+        }
+        return rows;
+    }
+
+    /** Counters of a rule of the relation, summed over its versions and iterations */
+    std::map<std::string, std::size_t> ruleCounters(const std::string& relationName, const std::string& id) {
+        std::map<std::string, std::size_t> counters;
+        const Relation* rel = out.getProgramRun()->getRelation(relationName);
+        if (rel == nullptr) {
+            return counters;
+        }
+        auto add = [&](const Rule& rule) {
+            if (rule.getId() == id) {
+                for (const auto& [name, value] : rule.getCounters()) {
+                    counters[name] += value;
+                }
+            }
+        };
+        for (const auto& rule : rel->getRuleMap()) {
+            add(*rule.second);
+        }
+        for (const auto& iteration : rel->getIterations()) {
+            for (const auto& rule : iteration->getRules()) {
+                add(*rule.second);
+            }
+        }
+        return counters;
+    }
+
+    static std::size_t counter(const std::map<std::string, std::size_t>& counters, const std::string& name) {
+        auto it = counters.find(name);
+        return it == counters.end() ? 0 : it->second;
+    }
+
+    std::string formatCounter(const std::map<std::string, std::size_t>& counters, const std::string& name) {
+        if (counters.count(name) == 0) {
+            return "-";
+        }
+        return Tools::formatNum(precision, counter(counters, name));
+    }
+
+    /** Instructions per cycle */
+    static std::string formatIPC(const std::map<std::string, std::size_t>& counters) {
+        std::size_t cycles = counter(counters, "cycles");
+        if (cycles == 0 || counters.count("instructions") == 0) {
+            return "-";
+        }
+        char ipc[16];
+        double instructions = static_cast<double>(counter(counters, "instructions"));
+        std::snprintf(ipc, sizeof(ipc), "%.2f", instructions / cycles);
+        return ipc;
+    }
+
+    /** Counters of a rule or relation on one line, empty without counters */
+    std::string formatCounters(const std::map<std::string, std::size_t>& counters) {
+        if (counters.empty()) {
+            return "";
+        }
+        return "cycles " + formatCounter(counters, "cycles") + ", instructions " +
+               formatCounter(counters, "instructions") + ", IPC " + formatIPC(counters) + ", LLC misses " +
+               formatCounter(counters, "llc-misses") + ", dTLB misses " +
+               formatCounter(counters, "dtlb-misses");
+    }
+
     void top() {
         const std::shared_ptr<ProgramRun>& run = out.getProgramRun();
         auto* totalRelationsEntry = as<TextEntry>(ProfileEventSingleton::instance().getDB().lookupEntry(
@@ -1161,11 +1544,17 @@ public:
             }
         }
         std::string src = "";
+        std::string hardwareCounters;
         const std::shared_ptr<ProgramRun>& run = out.getProgramRun();
         if (run->getRelation(name) != nullptr) {
             src = run->getRelation(name)->getLocator();
+            hardwareCounters = formatCounters(run->getRelation(name)->getCounters());
+        }
+        std::cout << "\nSrc locator: " << src << "\n";
+        if (!hardwareCounters.empty()) {
+            std::cout << "Counters: " << hardwareCounters << "\n";
         }
-        std::cout << "\nSrc locator: " << src << "\n\n";
+        std::cout << "\n";
         for (auto& row : formattedRuleTable) {
             if (row[7] == name) {
                 std::printf("%7s%2s%s\n", row[6].c_str(), "", row[5].c_str());
@@ -1191,6 +1580,7 @@ public:
         bool found = false;
         std::string ruleName;
         std::string srcLocator;
+        std::string relationName;
         // Check that the rule exists, and print it out if so.
         for (auto& row : formattedRuleTable) {
             if (row[6] == str) {
@@ -1198,6 +1588,7 @@ public:
                 found = true;
                 ruleName = row[5];
                 srcLocator = row[10];
+                relationName = row[7];
             }
         }
 
@@ -1212,6 +1603,10 @@ public:
             } else if (formattedRuleTable.size() > 0) {
                 std::cout << "Src locator-: " << formattedRuleTable[0][10] << "\n\n";
             }
+            std::string hardwareCounters = formatCounters(ruleCounters(relationName, str));
+            if (!hardwareCounters.empty()) {
+                std::cout << "Counters: " << hardwareCounters << "\n\n";
+            }
         }
 
         // Print out the versions of this rule.
@@ -1464,6 +1859,25 @@ protected:
         }
         std::cout << '\n';
     }
+    /** Show the profile of the running program, refreshed until it finishes or input is received */
+    void startUpdater() {
+        this->loaded = true;
+        this->alive = true;
+        updateDB();
+        updater = std::thread([this]() {
+            // Update the display every 30s. Check for input every 0.5s
+            std::chrono::milliseconds interval(30000);
+            auto nextUpdateTime = std::chrono::high_resolution_clock::now();
+            do {
+                std::this_thread::sleep_for(std::chrono::milliseconds(500));
+                if (nextUpdateTime < std::chrono::high_resolution_clock::now()) {
+                    runCommand({});
+                    nextUpdateTime = std::chrono::high_resolution_clock::now() + interval;
+                }
+            } while (reader->isLive() && !linereader.hasReceivedInput());
+        });
+    }
+
     void updateDB() {
         reader->processFile();
         ruleTable = out.getRulTable();
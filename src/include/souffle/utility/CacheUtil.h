@@ -17,6 +17,8 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <cstddef>
 #include <fstream>
 
 // -------------------------------------------------------------------------------
@@ -237,8 +239,6 @@ public:
  */
 #ifdef _SOUFFLE_STATS
 
-#include <atomic>
-
 class CacheAccessCounter {
     std::atomic<std::size_t> hits;
     std::atomic<std::size_t> misses;
@@ -275,17 +275,29 @@ public:
     CacheAccessCounter(const CacheAccessCounter& /* other */) = default;
     inline void addHit() {}
     inline void addMiss() {}
-    inline std::size_t getHits() {
+    inline std::size_t getHits() const {
         return 0;
     }
-    inline std::size_t getMisses() {
+    inline std::size_t getMisses() const {
         return 0;
     }
-    inline std::size_t getAccesses() {
+    inline std::size_t getAccesses() const {
         return 0;
     }
     inline void reset() {}
 };
 
 #endif
+
+/**
+ * The hint hits and misses of the inserts and of the lookups of a data
+ * structure, all zero unless compiled with _SOUFFLE_STATS.
+ */
+struct HintStatistics {
+    std::size_t insertHits = 0;
+    std::size_t insertMisses = 0;
+    std::size_t lookupHits = 0;
+    std::size_t lookupMisses = 0;
+};
+
 }  // end namespace souffle
@@ -20,6 +20,7 @@
 #include "souffle/utility/StringUtil.h"
 #include "souffle/utility/tinyformat.h"
 #include <csignal>
+#include <cstddef>
 
 namespace souffle::evaluator {
 
@@ -64,6 +65,38 @@ void runRange(const A from, const A to, F&& go) {
     }
 }
 
+/**
+ * Intersect the sorted values of several sources by leapfrogging, as done by
+ * leapfrog joins. `seek(i, value, next)` sets `next` to the least value of
+ * source `i` not below `value`, returning false if there is none. Each value
+ * of all sources is passed to `go` in increasing order, until it returns
+ * false.
+ */
+template <typename S /* (std::size_t, RamDomain, RamDomain&) -> bool */,
+        typename F /* RamDomain -> bool */>
+void leapfrog(std::size_t sources, S&& seek, F&& go) {
+    RamDomain value = MIN_RAM_SIGNED;
+    // number of consecutive sources having the value
+    std::size_t agreed = 0;
+    for (std::size_t i = 0;; i = (i + 1) % sources) {
+        RamDomain next;
+        if (!seek(i, value, next)) {
+            return;
+        }
+        if (next != value) {
+            value = next;
+            agreed = 0;
+        }
+        if (++agreed == sources) {
+            if (!go(value) || value == MAX_RAM_SIGNED) {
+                return;
+            }
+            ++value;
+            agreed = 0;
+        }
+    }
+}
+
 template <typename A>
 A symbol2numeric(const std::string& src) {
     try {
@@ -0,0 +1,185 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2022, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file NumaUtil.h
+ *
+ * Placement of threads and memory on the NUMA nodes of the machine, for
+ * --numa. Only Linux is supported; elsewhere the machine is a single node
+ * and placement does nothing.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // __linux__
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace souffle::numa {
+
+/**
+ * Parse a list of CPUs as in /sys/devices/system/node/node0/cpulist, e.g.
+ * "0-3,8,10-11".
+ */
+inline std::vector<int> parseCpuList(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        auto dash = range.find('-');
+        try {
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        } catch (...) {
+            // skip anything that is not a number, like the trailing newline
+        }
+    }
+    return cpus;
+}
+
+/**
+ * The CPUs of each NUMA node, in the order of the nodes. A machine without
+ * NUMA information is a single node without known CPUs.
+ */
+inline const std::vector<std::vector<int>>& getNodes() {
+    static const std::vector<std::vector<int>> nodes = []() {
+        std::vector<std::vector<int>> res;
+#ifdef __linux__
+        for (int node = 0;; ++node) {
+            std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            if (!file) {
+                break;
+            }
+            std::string list;
+            std::getline(file, list);
+            res.push_back(parseCpuList(list));
+        }
+#endif  // __linux__
+        if (res.empty()) {
+            res.emplace_back();
+        }
+        return res;
+    }();
+    return nodes;
+}
+
+/**
+ * The CPU for a thread, such that consecutive threads share a node and the
+ * threads are spread evenly over the nodes. Returns -1 if the CPUs are
+ * unknown.
+ */
+inline int getCpu(const std::vector<std::vector<int>>& nodes, std::size_t thread, std::size_t threads) {
+    std::size_t node = thread * nodes.size() / threads;
+    // the first thread placed on the node
+    std::size_t first = (node * threads + nodes.size() - 1) / nodes.size();
+    const auto& cpus = nodes[node];
+    if (cpus.empty()) {
+        return -1;
+    }
+    return cpus[(thread - first) % cpus.size()];
+}
+
+/**
+ * Pin the worker threads of the OpenMP pool to CPUs, so that they stay on
+ * the node of the memory they touched first. The calling thread, which takes
+ * part in the parallel regions as thread 0, belongs to the host program and
+ * keeps its affinity.
+ */
+inline void pinThreads() {
+#if defined(__linux__) && defined(_OPENMP)
+    const auto& nodes = getNodes();
+#pragma omp parallel
+    {
+        int cpu = getCpu(nodes, static_cast<std::size_t>(omp_get_thread_num()),
+                static_cast<std::size_t>(omp_get_num_threads()));
+        if (omp_get_thread_num() != 0 && cpu >= 0 && cpu < CPU_SETSIZE) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            sched_setaffinity(0, sizeof(set), &set);
+        }
+    }
+#endif
+}
+
+/**
+ * Spread the pages of the given memory over all nodes, round robin as they
+ * are touched first. Only the pages entirely within the memory are spread.
+ * Returns whether the pages were spread.
+ */
+inline bool interleave(void* addr, std::size_t size) {
+#ifdef __linux__
+    const std::size_t nodes = getNodes().size();
+    // a single word of node mask, the kernel reading one bit less than given
+    if (nodes < 2 || nodes >= 64) {
+        return false;
+    }
+    const auto page = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+    auto begin = (reinterpret_cast<std::uintptr_t>(addr) + page - 1) / page * page;
+    auto end = (reinterpret_cast<std::uintptr_t>(addr) + size) / page * page;
+    if (begin >= end) {
+        return false;
+    }
+    unsigned long mask = (1UL << nodes) - 1;
+    return syscall(SYS_mbind, begin, end - begin, MPOL_INTERLEAVE, &mask, nodes + 1, 0) == 0;
+#else
+    (void)addr;
+    (void)size;
+    return false;
+#endif  // __linux__
+}
+
+/**
+ * Obtain memory whose pages are spread over all nodes. The memory is mapped
+ * on its own, so that its pages are shared with no other object and are
+ * only placed when touched first. Returns null if no memory is available.
+ * The memory must be returned by unmapInterleaved.
+ */
+inline void* mapInterleaved(std::size_t size) {
+#ifdef __linux__
+    void* addr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (addr == MAP_FAILED) {
+        return nullptr;
+    }
+    interleave(addr, size);
+    return addr;
+#else
+    return std::malloc(size);
+#endif  // __linux__
+}
+
+/** Return memory obtained by mapInterleaved */
+inline void unmapInterleaved(void* addr, std::size_t size) {
+#ifdef __linux__
+    ::munmap(addr, size);
+#else
+    (void)size;
+    std::free(addr);
+#endif  // __linux__
+}
+
+}  // namespace souffle::numa
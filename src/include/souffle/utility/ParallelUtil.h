@@ -34,6 +34,43 @@ constexpr std::size_t hardware_constructive_interference_size = 2 * sizeof(max_a
 constexpr std::size_t hardware_destructive_interference_size = 2 * sizeof(max_align_t);
 #endif
 
+namespace souffle {
+
+/**
+ * Counts how often threads got in each other's way in the locks below, as
+ * reported by the profiler. Only the slow paths count, so uncontended locks
+ * cost nothing extra, and nothing is counted unless profiling enabled it:
+ * the shared counters would otherwise bounce between the contending cores.
+ */
+struct ContentionCounters {
+    /** whether contention is counted; only written when profiling starts */
+    alignas(hardware_destructive_interference_size) std::atomic<bool> enabled{false};
+    /** failed validations of optimistic read leases, each restarting a B-tree operation or a hint */
+    alignas(hardware_destructive_interference_size) std::atomic<std::size_t> lockRestarts{0};
+    /** acquisitions of a lane lock that had to wait for another thread */
+    alignas(hardware_destructive_interference_size) std::atomic<std::size_t> laneWaits{0};
+
+    void enable() {
+        enabled.store(true, std::memory_order_relaxed);
+    }
+
+    void countLockRestart() {
+        if (enabled.load(std::memory_order_relaxed)) {
+            lockRestarts.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void countLaneWait() {
+        if (enabled.load(std::memory_order_relaxed)) {
+            laneWaits.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+};
+
+inline ContentionCounters contentionCounters;
+
+}  // namespace souffle
+
 #ifdef _OPENMP
 
 /**
@@ -63,8 +100,9 @@ constexpr std::size_t hardware_destructive_interference_size = 2 * sizeof(max_al
 // support for parallel loops
 #define pfor __pragma(omp for schedule(dynamic)) for
 #else
-// support for a parallel region
-#define PARALLEL_START _Pragma("omp parallel") {
+// support for a parallel region; within another one, such as a task of concurrent sections, it runs on
+// the current thread alone, whatever the nesting settings of the runtime
+#define PARALLEL_START _Pragma("omp parallel if(!omp_in_parallel())") {
 #define PARALLEL_END }
 
 // support for parallel loops
@@ -75,17 +113,41 @@ constexpr std::size_t hardware_destructive_interference_size = 2 * sizeof(max_al
 #define task_spawn
 #define task_sync
 
-// section start / end => corresponding OpenMP pragmas
-// NOTE: disabled since it causes performance losses
-//#define SECTIONS_START _Pragma("omp parallel sections") {
-// NOTE: we stick to flat-level parallelism since it is faster due to thread pooling
-#define SECTIONS_START {
+#ifdef _MSC_VER
+// sections are processed sequentially, OpenMP 2.0 has no tasks
+#define SECTIONS_START(COUNT) {
 #define SECTIONS_END }
 
-// the markers for a single section
-//#define SECTION_START _Pragma("omp section") {
 #define SECTION_START {
 #define SECTION_END }
+#else
+namespace souffle {
+
+/**
+ * Whether sections run as tasks: only if there are at least as many as
+ * threads, and not within a parallel region already. Otherwise they run in
+ * turn, leaving the threads to the parallel loops within them, which are
+ * sequential within a task.
+ */
+inline bool runSectionsAsTasks(std::size_t count) {
+    auto threads = static_cast<std::size_t>(omp_get_max_threads());
+    return threads > 1 && count >= threads && !omp_in_parallel();
+}
+
+}  // namespace souffle
+
+#define SECTIONS_START(COUNT)                                                   \
+    {                                                                           \
+        const bool sectionsAsTasks = souffle::runSectionsAsTasks(COUNT);        \
+        _Pragma("omp parallel if(sectionsAsTasks)") _Pragma("omp single nowait") {
+#define SECTIONS_END \
+    }                \
+    }
+
+// the markers for a single section
+#define SECTION_START _Pragma("omp task") {
+#define SECTION_END }
+#endif
 
 // a macro to create an operation context
 #define CREATE_OP_CONTEXT(NAME, INIT) [[maybe_unused]] auto NAME = INIT;
@@ -105,7 +167,7 @@ constexpr std::size_t hardware_destructive_interference_size = 2 * sizeof(max_al
 #define task_sync
 
 // sections are processed sequentially
-#define SECTIONS_START {
+#define SECTIONS_START(COUNT) {
 #define SECTIONS_END }
 
 // sections are inlined
@@ -444,7 +506,11 @@ public:
     bool validate(const Lease& lease) {
         // check whether version number has changed in the mean-while
         std::atomic_thread_fence(std::memory_order_acquire);
-        return lease.version == version.load(std::memory_order_relaxed);
+        if (lease.version == version.load(std::memory_order_relaxed)) {
+            return true;
+        }
+        contentionCounters.countLockRestart();
+        return false;
     }
 
     /**
@@ -502,7 +568,11 @@ public:
         auto v = version.fetch_or(0x1, std::memory_order_acquire);
 
         // check whether write privileges have been gained
-        if (v & 0x1) return false;  // there is another writer already
+        if (v & 0x1) {
+            // there is another writer already
+            contentionCounters.countLockRestart();
+            return false;
+        }
 
         // check whether there was no write since the gain of the read lock
         if (lease.version == v) return true;
@@ -511,6 +581,7 @@ public:
         abort_write();
 
         // operation failed
+        contentionCounters.countLockRestart();
         return false;
     }
 
@@ -580,13 +651,21 @@ struct MutexConcurrentLanes {
     }
 
     unique_lock_type guard(const lane_id Lane) const {
-        return unique_lock_type(Lanes[Lane].Access);
+        unique_lock_type guard(Lanes[Lane].Access, std::try_to_lock);
+        if (!guard.owns_lock()) {
+            contentionCounters.countLaneWait();
+            guard.lock();
+        }
+        return guard;
     }
 
     // Lock the given lane.
     // Must eventually be followed by unlock(Lane).
     void lock(const lane_id Lane) const {
-        Lanes[Lane].Access.lock();
+        if (!Lanes[Lane].Access.try_lock()) {
+            contentionCounters.countLaneWait();
+            Lanes[Lane].Access.lock();
+        }
     }
 
     // Unlock the given lane.
@@ -109,6 +109,14 @@ public:
         return views[id].get();
     }
 
+    /** @brief Return the buffer for the blocks of tuples of a scan, kept for its next range */
+    std::vector<const RamDomain*>& getBlock(std::size_t tupleId) {
+        if (blocks.size() < tupleId + 1) {
+            blocks.resize(tupleId + 1);
+        }
+        return blocks[tupleId];
+    }
+
 private:
     /** @brief Run-time value */
     std::vector<const RamDomain*> data;
@@ -120,6 +128,8 @@ private:
     VecOwn<RamDomain[]> allocatedDataContainer;
     /** @brief Views */
     VecOwn<ViewWrapper> views;
+    /** @brief Blocks of the batched scans, by tuple id */
+    std::vector<std::vector<const RamDomain*>> blocks;
 };
 
 }  // namespace souffle::interpreter
@@ -42,12 +42,14 @@
 #include "ram/IndexAggregate.h"
 #include "ram/IndexIfExists.h"
 #include "ram/IndexScan.h"
+#include "ram/LeapfrogJoin.h"
 #include "ram/Insert.h"
 #include "ram/IntrinsicOperator.h"
 #include "ram/LogRelationTimer.h"
 #include "ram/LogSize.h"
 #include "ram/LogTimer.h"
 #include "ram/Loop.h"
+#include "ram/Merge.h"
 #include "ram/MergeExtend.h"
 #include "ram/Negation.h"
 #include "ram/NestedIntrinsicOperator.h"
@@ -85,11 +87,14 @@
 #include "souffle/SignalHandler.h"
 #include "souffle/SymbolTable.h"
 #include "souffle/TypeAttribute.h"
+#include "souffle/datastructure/KeyStatistics.h"
 #include "souffle/datastructure/SymbolTableImpl.h"
 #include "souffle/io/IOSystem.h"
 #include "souffle/io/ReadStream.h"
+#include "souffle/io/Spill.h"
 #include "souffle/io/WriteStream.h"
 #include "souffle/profile/Logger.h"
+#include "souffle/profile/ParallelProfile.h"
 #include "souffle/profile/ProfileEvent.h"
 #include "souffle/utility/EvaluatorUtil.h"
 #include "souffle/utility/MiscUtil.h"
@@ -111,7 +116,10 @@
 #include <numeric>
 #include <regex>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -283,14 +291,87 @@ RamDomain callStateless(ExecuteFn&& execute, Context& ctxt, Shadow& shadow, souf
     }
 }
 
+/** Keeps the tuples of a block whose given element passes the comparison with the given value */
+template <typename T, typename Compare>
+void filterBlock(
+        std::vector<const RamDomain*>& block, std::size_t element, RamDomain value, Compare compare) {
+    const T fixed = ramBitCast<T>(value);
+    std::size_t passed = 0;
+    for (const RamDomain* tuple : block) {
+        // the tuple is kept without a branch, by advancing past it
+        block[passed] = tuple;
+        passed += compare(ramBitCast<T>(tuple[element]), fixed);
+    }
+    block.resize(passed);
+}
+
+/** Keeps the tuples of a block passing the given comparison with the given value */
+void filterBlock(std::vector<const RamDomain*>& block, const Batch::Comparison& comparison, RamDomain value) {
+    // clang-format off
+#define FILTER_BLOCK(opCode, ty, compare) \
+    case BinaryConstraintOp::opCode: return filterBlock<ty>(block, comparison.element, value, compare<>());
+    // clang-format on
+
+    switch (comparison.op) {
+        FILTER_BLOCK(EQ, RamDomain, std::equal_to)
+        FILTER_BLOCK(FEQ, RamFloat, std::equal_to)
+        FILTER_BLOCK(NE, RamDomain, std::not_equal_to)
+        FILTER_BLOCK(FNE, RamFloat, std::not_equal_to)
+        FILTER_BLOCK(LT, RamSigned, std::less)
+        FILTER_BLOCK(ULT, RamUnsigned, std::less)
+        FILTER_BLOCK(FLT, RamFloat, std::less)
+        FILTER_BLOCK(LE, RamSigned, std::less_equal)
+        FILTER_BLOCK(ULE, RamUnsigned, std::less_equal)
+        FILTER_BLOCK(FLE, RamFloat, std::less_equal)
+        FILTER_BLOCK(GT, RamSigned, std::greater)
+        FILTER_BLOCK(UGT, RamUnsigned, std::greater)
+        FILTER_BLOCK(FGT, RamFloat, std::greater)
+        FILTER_BLOCK(GE, RamSigned, std::greater_equal)
+        FILTER_BLOCK(UGE, RamUnsigned, std::greater_equal)
+        FILTER_BLOCK(FGE, RamFloat, std::greater_equal)
+        default: fatal("unsupported comparison of a block");
+    }
+#undef FILTER_BLOCK
+}
+
+/** Ranges of fewer tuples than this, and fewer than in a block, are evaluated tuple by tuple */
+constexpr std::size_t minBlockSize = 8;
+
+/** The number of tuples of the blocks scans are evaluated over, 0 if tuples are evaluated one by one */
+std::size_t getBatchSize(const MainConfig& config) {
+    // filters peeled off for blocks would not count their frequencies
+    if (!config.has("batch") || config.has("profile-frequency")) {
+        return 0;
+    }
+    // the option is checked by the driver, but may be set by a pragma or a caller of the engine
+    const auto& size = config.get("batch");
+    std::size_t res = 0;
+    if (!size.empty() && isNumber(size.c_str())) {
+        try {
+            res = std::stoul(size);
+        } catch (const std::out_of_range&) {
+        }
+    }
+    if (res == 0) {
+        throw std::runtime_error("--batch may only be set to an integer greater than 0.");
+    }
+    return res;
+}
+
 }  // namespace
 
 Engine::Engine(ram::TranslationUnit& tUnit)
-        : profileEnabled(Global::config().has("profile")),
-          frequencyCounterEnabled(Global::config().has("profile-frequency")),
-          numOfThreads(number_of_threads(std::stoi(Global::config().get("jobs")))), tUnit(tUnit),
+        : config(Global::config()), profileEnabled(config.has("profile")),
+          frequencyCounterEnabled(config.has("profile-frequency")),
+          indexStatisticsEnabled(config.has("profile-indexes")), asyncOutput(config.has("async-output")),
+          batchSize(getBatchSize(config)),
+          numOfThreads(number_of_threads(std::stoi(config.get("jobs")))), tUnit(tUnit),
           isa(tUnit.getAnalysis<ram::analysis::IndexAnalysis>()), recordTable(numOfThreads),
-          symbolTable(numOfThreads) {}
+          symbolTable(numOfThreads) {
+    for (const auto& name : splitString(config.get("numa-interleave"), ',')) {
+        interleavedRelations.insert(name);
+    }
+}
 
 Engine::RelationHandle& Engine::getRelationHandle(const std::size_t idx) {
     return *relations[idx];
@@ -339,11 +420,23 @@ void Engine::createRelation(const ram::Relation& id, const std::size_t idx) {
         res = createEqrelRelation(id, isa.getIndexSelection(id.getName()));
     } else if (id.getRepresentation() == RelationRepresentation::BTREE_DELETE) {
         res = createBTreeDeleteRelation(id, isa.getIndexSelection(id.getName()));
+    } else if (id.getRepresentation() == RelationRepresentation::COMPRESSED) {
+        res = createCompressedRelation(id, isa.getIndexSelection(id.getName()));
+    } else if (id.getRepresentation() == RelationRepresentation::HASH) {
+        res = createHashedRelation(id, isa.getIndexSelection(id.getName()));
     } else if (id.getRepresentation() == RelationRepresentation::PROVENANCE) {
         res = createProvenanceRelation(id, isa.getIndexSelection(id.getName()));
     } else {
         res = createBTreeRelation(id, isa.getIndexSelection(id.getName()));
     }
+    if (indexStatisticsEnabled) {
+        res->enableIndexStatistics();
+    }
+    if (id.isTemp()) {
+        res->recycleNodes();
+    } else if (contains(interleavedRelations, id.getName()) || contains(interleavedRelations, "*")) {
+        res->interleaveNodes();
+    }
     relations[idx] = mk<RelationHandle>(std::move(res));
 }
 
@@ -352,19 +445,17 @@ const std::vector<void*>& Engine::loadDLL() {
         return dll;
     }
 
-    if (!Global::config().has("libraries")) {
-        Global::config().set("libraries", "functors");
-    }
-    if (!Global::config().has("library-dir")) {
-        Global::config().set("library-dir", ".");
-    }
+    const auto libraries =
+            config.has("libraries") ? config.getMany("libraries") : std::vector<std::string>{"functors"};
+    const auto libraryDirs =
+            config.has("library-dir") ? config.getMany("library-dir") : std::vector<std::string>{"."};
 
-    for (auto&& library : Global::config().getMany("libraries")) {
+    for (auto&& library : libraries) {
         // The library may be blank
         if (library.empty()) {
             continue;
         }
-        auto paths = Global::config().getMany("library-dir");
+        auto paths = libraryDirs;
         // Set up our paths to have a library appended
         for (std::string& path : paths) {
             if (path.back() != pathSeparator) {
@@ -402,9 +493,16 @@ void Engine::resetIterationNumber() {
     iteration = 0;
 }
 
-void Engine::executeMain() {
+void Engine::executeMain(std::string inputDirectoryArg, std::string outputDirectoryArg, bool performIOArg,
+        bool pruneImdtRelsArg) {
+    inputDirectory = std::move(inputDirectoryArg);
+    outputDirectory = std::move(outputDirectoryArg);
+    performIO = performIOArg;
+    pruneImdtRels = pruneImdtRelsArg;
+    resetIterationNumber();
+
     SignalHandler::instance()->set();
-    if (Global::config().has("verbose")) {
+    if (config.has("verbose")) {
         SignalHandler::instance()->enableLogging();
     }
 
@@ -418,8 +516,13 @@ void Engine::executeMain() {
     if (!profileEnabled) {
         Context ctxt;
         execute(main.get(), ctxt);
+        waitForOutputs();
     } else {
-        ProfileEventSingleton::instance().setOutputFile(Global::config().get("profile"));
+        ProfileEventSingleton::instance().setOutputFile(
+                config.get("profile"), config.has("profile-format", "binary"));
+        if (config.has("profile-stream")) {
+            ProfileEventSingleton::instance().setStreamSocket(config.get("profile-stream"));
+        }
         // Prepare the frequency table for threaded use
         const ram::Program& program = tUnit.getProgram();
         visit(program, [&](const ram::TupleOperation& node) {
@@ -429,10 +532,13 @@ void Engine::executeMain() {
             }
         });
         // Enable profiling for execution of main
+        if (config.has("profile-counters")) {
+            ProfileEventSingleton::instance().enablePerfCounters();
+        }
         ProfileEventSingleton::instance().startTimer();
         ProfileEventSingleton::instance().makeTimeEvent("@time;starttime");
         // Store configuration
-        for (auto&& [k, vs] : Global::config().data())
+        for (auto&& [k, vs] : config.data())
             for (auto&& v : vs)
                 ProfileEventSingleton::instance().makeConfigRecord(k, v);
 
@@ -453,6 +559,7 @@ void Engine::executeMain() {
 
         Context ctxt;
         execute(main.get(), ctxt);
+        waitForOutputs();
         ProfileEventSingleton::instance().stopTimer();
         for (auto const& cur : frequencies) {
             for (std::size_t i = 0; i < cur.second.size(); ++i) {
@@ -464,6 +571,18 @@ void Engine::executeMain() {
             ProfileEventSingleton::instance().makeQuantityEvent(
                     "@relation-reads;" + cur.first, cur.second, 0);
         }
+        if (indexStatisticsEnabled) {
+            for (const auto& handle : relations) {
+                if (handle == nullptr || *handle == nullptr) {
+                    continue;
+                }
+                const RelationWrapper& rel = **handle;
+                for (std::size_t i = 0; i < rel.getNumIndexes(); ++i) {
+                    ProfileEventSingleton::instance().makeIndexEvent(
+                            rel.getName(), i, toString(rel.getIndexOrder(i)), rel.getIndexStatistics(i));
+                }
+            }
+        }
     }
     SignalHandler::instance()->reset();
 }
@@ -493,6 +612,22 @@ void Engine::executeSubroutine(
     execute(subroutine[i].get(), ctxt);
 }
 
+void Engine::waitForOutputs() {
+    try {
+        writeQueue.wait();
+    } catch (std::exception& e) {
+        fail(e.what());
+    }
+}
+
+void Engine::fail(const std::string& message) const {
+    if (throwOnErrors) {
+        throw std::runtime_error(message);
+    }
+    std::cerr << message;
+    exit(EXIT_FAILURE);
+}
+
 RamDomain Engine::execute(const Node* node, Context& ctxt) {
 #define DEBUG(Kind) std::cout << "Running Node: " << #Kind << "\n";
 #define EVAL_CHILD(ty, idx) ramBitCast<ty>(execute(shadow.getChild(idx), ctxt))
@@ -1108,6 +1243,14 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
         FOR_EACH(PARALLEL_INDEX_SCAN)
 #undef PARALLEL_INDEX_SCAN
 
+#define LEAPFROG_JOIN(Structure, Arity, ...)                 \
+    CASE(LeapfrogJoin, Structure, Arity)                     \
+        return evalLeapfrogJoin<RelType>(cur, shadow, ctxt); \
+    ESAC(LeapfrogJoin)
+
+        FOR_EACH(LEAPFROG_JOIN)
+#undef LEAPFROG_JOIN
+
 #define IFEXISTS(Structure, Arity, ...)                                 \
     CASE(IfExists, Structure, Arity)                                    \
         const auto& rel = *static_cast<RelType*>(shadow.getRelation()); \
@@ -1272,12 +1415,27 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
         ESAC(Sequence)
 
         CASE(Parallel)
-            for (const auto& child : shadow.getChildren()) {
-                if (!execute(child.get(), ctxt)) {
-                    return false;
+            const auto& children = shadow.getChildren();
+            // with fewer statements than threads, the threads are better
+            // spent on the parallel loops of each statement in turn
+            if (children.size() < numOfThreads || numOfThreads == 1) {
+                for (const auto& child : children) {
+                    if (!execute(child.get(), ctxt)) {
+                        return false;
+                    }
                 }
+                return true;
             }
-            return true;
+            std::atomic<bool> result{true};
+            PARALLEL_START
+                pfor(auto it = children.begin(); it < children.end(); ++it) {
+                    Context taskCtxt(ctxt);
+                    if (!execute(it->get(), taskCtxt)) {
+                        result = false;
+                    }
+                }
+            PARALLEL_END
+            return result;
         ESAC(Parallel)
 
         CASE(Loop)
@@ -1309,16 +1467,41 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
             return execute(shadow.getChild(), ctxt);
         ESAC(DebugInfo)
 
-#define CLEAR(Structure, Arity, ...)                              \
-    CASE(Clear, Structure, Arity)                                 \
-        auto& rel = *static_cast<RelType*>(shadow.getRelation()); \
-        rel.__purge();                                            \
-        return true;                                              \
+#define CLEAR(Structure, Arity, ...)                                      \
+    CASE(Clear, Structure, Arity)                                         \
+        auto& rel = *static_cast<RelType*>(shadow.getRelation());         \
+        /* only temporary relations are cleared unless pruning */         \
+        if (!pruneImdtRels && cur.getRelation()[0] != '@') {              \
+            return true;                                                  \
+        }                                                                 \
+        /* expired relations may still have an output job queued */       \
+        if (asyncOutput && cur.getRelation()[0] != '@') {                 \
+            writeQueue.push([&rel]() { rel.__release(); });               \
+        } else if (shadow.isReleasing()) {                                \
+            rel.__release();                                              \
+        } else {                                                          \
+            rel.__purge();                                                \
+        }                                                                 \
+        return true;                                                      \
     ESAC(Clear)
 
         FOR_EACH(CLEAR)
 #undef CLEAR
 
+#define COMPRESS(Structure, Arity, ...)                                                                \
+    CASE(Compress, Structure, Arity)                                                                   \
+        auto& rel = static_cast<CompressedRelation<Arity>&>(*static_cast<RelType*>(shadow.getRelation())); \
+        /* queued outputs may still iterate the relation */                                            \
+        if (asyncOutput) {                                                                             \
+            waitForOutputs();                                                                          \
+        }                                                                                              \
+        rel.compress();                                                                                \
+        return true;                                                                                   \
+    ESAC(Compress)
+
+        FOR_EACH_COMPRESSED(COMPRESS)
+#undef COMPRESS
+
 #define COUNTUNIQUEKEYS(Structure, Arity, ...)                          \
     CASE(CountUniqueKeys, Structure, Arity)                             \
         const auto& rel = *static_cast<RelType*>(shadow.getRelation()); \
@@ -1341,27 +1524,69 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
         ESAC(LogSize)
 
         CASE(IO)
-            const auto& directive = cur.getDirectives();
             const std::string& op = cur.get("operation");
             auto& rel = *shadow.getRelation();
 
+            // moving relations to disk is independent of fact input and output
+            if (op == "spill") {
+                try {
+                    if (spiller.exceedsMemoryLimit(cur.getDirectives())) {
+                        // queued outputs may still read the relation
+                        writeQueue.wait();
+                        spiller.spill(rel, cur.getDirectives(), getSymbolTable(), getRecordTable());
+                    }
+                } catch (std::exception& e) {
+                    fail(e.what());
+                }
+                return true;
+            } else if (op == "restore") {
+                try {
+                    spiller.restore(rel, cur.getDirectives(), getSymbolTable(), getRecordTable());
+                } catch (std::exception& e) {
+                    fail(e.what());
+                }
+                return true;
+            }
+
+            if (!performIO) {
+                return true;
+            }
+            auto directive = cur.getDirectives();
             if (op == "input") {
+                if (!inputDirectory.empty()) {
+                    directive["fact-dir"] = inputDirectory;
+                }
                 try {
                     IOSystem::getInstance()
                             .getReader(directive, getSymbolTable(), getRecordTable())
                             ->readAll(rel);
                 } catch (std::exception& e) {
-                    std::cerr << "Error loading " << rel.getName() << " data: " << e.what() << "\n";
+                    std::string message = "Error loading " + rel.getName() + " data: " + e.what() + "\n";
+                    if (throwOnErrors) {
+                        fail(message);
+                    }
+                    std::cerr << message;
                 }
                 return true;
             } else if (op == "output" || op == "printsize") {
-                try {
+                if (!outputDirectory.empty()) {
+                    directive["output-dir"] = outputDirectory;
+                }
+                directive["jobs"] = std::to_string(numOfThreads);
+                // the job only throws, as fail() may exit, which must not happen on the background thread
+                auto write = [this, directive, &rel]() {
                     IOSystem::getInstance()
                             .getWriter(directive, getSymbolTable(), getRecordTable())
                             ->writeAll(rel);
+                };
+                try {
+                    if (asyncOutput) {
+                        writeQueue.push(write);
+                    } else {
+                        write();
+                    }
                 } catch (std::exception& e) {
-                    std::cerr << e.what();
-                    exit(EXIT_FAILURE);
+                    fail(e.what());
                 }
                 return true;
             } else {
@@ -1408,6 +1633,12 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
             return true;
         ESAC(Query)
 
+        CASE(Merge)
+            auto& src = *getRelationHandle(shadow.getSourceId());
+            getRelationHandle(shadow.getTargetId())->merge(src, numOfThreads);
+            return true;
+        ESAC(Merge)
+
         CASE(MergeExtend)
             auto& src = *static_cast<EqrelRelation*>(getRelationHandle(shadow.getSourceId()).get());
             auto& trg = *static_cast<EqrelRelation*>(getRelationHandle(shadow.getTargetId()).get());
@@ -1517,8 +1748,94 @@ RamDomain Engine::evalProvenanceExistenceCheck(const ProvenanceExistenceCheck& s
     return (*equalRange.begin())[Arity - 1] <= execute(shadow.getChild(), ctxt);
 }
 
+template <typename Rel, typename Range>
+bool Engine::evalBatch(
+        const Range& range, std::size_t tupleId, const Batch& batch, Context& ctxt, std::size_t& visited) {
+    // the block points to the tuples of the relation, or to copies if its iterators assemble them
+    auto& block = ctxt.getBlock(tupleId);
+    block.clear();
+    std::conditional_t<Rel::stableTuples, std::tuple<>, std::deque<souffle::Tuple<RamDomain, Rel::Arity>>>
+            copies;
+    auto sortBlock = [&]() {
+        std::sort(block.begin(), block.end(), [&](const RamDomain* a, const RamDomain* b) {
+            for (std::size_t key : batch.keys) {
+                if (a[key] != b[key]) {
+                    return a[key] < b[key];
+                }
+            }
+            return false;
+        });
+    };
+    auto evalBlock = [&]() {
+        const auto& conditions = batch.conditions;
+        for (std::size_t i = 0; i < conditions.size() && !block.empty(); ++i) {
+            if (i == batch.sortAfter && !batch.keys.empty()) {
+                sortBlock();
+            }
+            if (const auto& comparison = batch.comparisons[i]) {
+                filterBlock(block, *comparison, execute(comparison->value, ctxt));
+                continue;
+            }
+            std::size_t passed = 0;
+            for (const RamDomain* tuple : block) {
+                ctxt[tupleId] = tuple;
+                if (execute(conditions[i], ctxt)) {
+                    block[passed++] = tuple;
+                }
+            }
+            block.resize(passed);
+        }
+        if (batch.sortAfter == conditions.size() && !batch.keys.empty()) {
+            sortBlock();
+        }
+        for (const RamDomain* tuple : block) {
+            ctxt[tupleId] = tuple;
+            if (!execute(batch.operation, ctxt)) {
+                return false;
+            }
+        }
+        block.clear();
+        if constexpr (!Rel::stableTuples) {
+            copies.clear();
+        }
+        return true;
+    };
+
+    bool filled = false;
+    for (const auto& tuple : range) {
+        if constexpr (Rel::stableTuples) {
+            block.push_back(tuple.data());
+        } else {
+            block.push_back(copies.emplace_back(tuple).data());
+        }
+        ++visited;
+        if (block.size() == batchSize) {
+            filled = true;
+            if (!evalBlock()) {
+                return false;
+            }
+        }
+    }
+    if (filled || block.size() >= minBlockSize) {
+        return evalBlock();
+    }
+    // a short range is not worth testing and sorting as a block
+    for (const RamDomain* tuple : block) {
+        ctxt[tupleId] = tuple;
+        if (!execute(batch.nested, ctxt)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 template <typename Rel>
 RamDomain Engine::evalScan(const Rel& rel, const ram::Scan& cur, const Scan& shadow, Context& ctxt) {
+    if (batchSize > 0 && shadow.getBatch().operation != nullptr) {
+        std::size_t visited = 0;
+        evalBatch<Rel>(rel.scan(), cur.getTupleId(), shadow.getBatch(), ctxt, visited);
+        return true;
+    }
     for (const auto& tuple : rel.scan()) {
         ctxt[cur.getTupleId()] = tuple.data();
         if (!execute(shadow.getNestedOperation(), ctxt)) {
@@ -1535,6 +1852,7 @@ RamDomain Engine::evalParallelScan(
 
     auto pStream = rel.partitionScan(numOfThreads);
 
+    ParallelRegion region(profileEnabled);
     PARALLEL_START
         Context newCtxt(ctxt);
         auto viewInfo = viewContext->getViewInfoForNested();
@@ -1549,6 +1867,12 @@ RamDomain Engine::evalParallelScan(
 #else
         pfor(auto it = pStream.begin(); it < pStream.end(); it++) {
 #endif
+            ParallelRegion::Task task(region);
+            if (batchSize > 0 && shadow.getBatch().operation != nullptr) {
+                std::size_t visited = 0;
+                evalBatch<Rel>(*it, cur.getTupleId(), shadow.getBatch(), newCtxt, visited);
+                continue;
+            }
             for (const auto& tuple : *it) {
                 newCtxt[cur.getTupleId()] = tuple.data();
                 if (!execute(shadow.getNestedOperation(), newCtxt)) {
@@ -1609,39 +1933,47 @@ RamDomain Engine::evalCountUniqueKeys(
         keyConstants[inverseOrder[k]] = value;
     }
 
-    // ensure range is non-empty
     auto* index = rel.getIndex(indexPos);
-    // initial values
-    std::size_t total = 0;
-    std::size_t duplicates = 0;
-
-    if (!index->scan().empty()) {
-        // assign first tuple as prev as a dummy
-        bool first = true;
-        Tuple<RamDomain, Arity> prev = *index->scan().begin();
-
-        for (const auto& tuple : index->scan()) {
-            // only if every constant matches do we consider the tuple
-            bool matchesConstants = std::all_of(keyConstants.begin(), keyConstants.end(),
-                    [tuple](const auto& p) { return tuple[p.first] == p.second; });
-            if (!matchesConstants) {
-                continue;
-            }
-            if (first) {
-                first = false;
-            } else {
-                // only if on every column do we have a match do we consider it a duplicate
-                bool matchesPrev = std::all_of(keyColumns.begin(), keyColumns.end(),
-                        [&prev, &tuple](std::size_t column) { return tuple[column] == prev[column]; });
-                if (matchesPrev) {
-                    ++duplicates;
-                }
-            }
-            prev = tuple;
-            ++total;
+    auto matchesConstants = [&](const auto& tuple) {
+        return std::all_of(keyConstants.begin(), keyConstants.end(),
+                [&](const auto& p) { return tuple[p.first] == p.second; });
+    };
+    // exact counts compare the key columns, samples their hashes
+    auto keyOf = [&](const auto& tuple) {
+        Tuple<RamDomain, Arity> key{};
+        for (auto column : keyColumns) {
+            key[column] = tuple[column];
+        }
+        return key;
+    };
+    auto hashKey = [&](const auto& tuple) {
+        uint64_t hash = 0;
+        for (auto column : keyColumns) {
+            hash = KeyStatistics::hash(hash, tuple[column]);
         }
+        return hash;
+    };
+
+    KeyStatistics stats;
+    if (!keyConstants.empty()) {
+        // the constants bound the count to a range of the index, which is scanned exactly
+        Tuple<RamDomain, Arity> low;
+        Tuple<RamDomain, Arity> high;
+        low.fill(MIN_RAM_SIGNED);
+        high.fill(MAX_RAM_SIGNED);
+        for (const auto& [column, value] : keyConstants) {
+            low[column] = value;
+            high[column] = value;
+        }
+        stats = countKeys(index->range(low, high), matchesConstants, keyOf);
+    } else if (index->size() > KeyStatistics::exactCountLimit) {
+        // large relations are sampled in parallel rather than scanned for exact counts
+        stats = sampleKeys(index->partitionScan(std::max(numOfThreads, KeyStatistics::minSampleChunks)),
+                index->size(), matchesConstants, hashKey);
+    } else {
+        stats = countKeys(index->scan(), matchesConstants, keyOf);
     }
-    std::size_t uniqueKeys = (onlyConstants ? total : total - duplicates);
+    std::size_t uniqueKeys = (onlyConstants ? stats.total : stats.unique);
 
     std::stringstream columnsStream;
     columnsStream << cur.getKeyColumns();
@@ -1686,11 +2018,86 @@ RamDomain Engine::evalIndexScan(const ram::IndexScan& cur, const IndexScan& shad
     std::size_t viewId = shadow.getViewId();
     auto view = Rel::castView(ctxt.getView(viewId));
     // conduct range query
+    std::size_t visited = 0;
+    if (batchSize > 0 && shadow.getBatch().operation != nullptr) {
+        if (evalBatch<Rel>(view->range(low, high), cur.getTupleId(), shadow.getBatch(), ctxt, visited)) {
+            view->countScan(visited);
+        }
+        return true;
+    }
     for (const auto& tuple : view->range(low, high)) {
         ctxt[cur.getTupleId()] = tuple.data();
+        ++visited;
         if (!execute(shadow.getNestedOperation(), ctxt)) {
-            break;
+            return true;
+        }
+    }
+    view->countScan(visited);
+    return true;
+}
+
+template <typename Rel>
+RamDomain Engine::evalLeapfrogJoin(const ram::LeapfrogJoin& cur, const LeapfrogJoin& shadow, Context& ctxt) {
+    constexpr std::size_t Arity = Rel::Arity;
+    // create pattern tuple for range query
+    const auto& superInfo = shadow.getSuperInst();
+    souffle::Tuple<RamDomain, Arity> low;
+    souffle::Tuple<RamDomain, Arity> high;
+    CAL_SEARCH_BOUND(superInfo, low, high);
+    auto view = Rel::castView(ctxt.getView(shadow.getViewId()));
+
+    // create the patterns of the filters as for partial existence checks
+    const auto& filters = shadow.getFilters();
+    std::vector<std::vector<RamDomain>> filterLow;
+    std::vector<std::vector<RamDomain>> filterHigh;
+    for (const auto& filter : filters) {
+        const auto& filterInfo = filter.superInst;
+        std::vector<RamDomain> lowPattern(filterInfo.first);
+        std::vector<RamDomain> highPattern(filterInfo.second);
+        for (const auto& tupleElement : filterInfo.tupleFirst) {
+            lowPattern[tupleElement[0]] = ctxt[tupleElement[1]][tupleElement[2]];
+            highPattern[tupleElement[0]] = lowPattern[tupleElement[0]];
         }
+        for (const auto& expr : filterInfo.exprFirst) {
+            lowPattern[expr.first] = execute(expr.second.get(), ctxt);
+            highPattern[expr.first] = lowPattern[expr.first];
+        }
+        filterLow.push_back(std::move(lowPattern));
+        filterHigh.push_back(std::move(highPattern));
+    }
+
+    // the scanned relation is the first source of values of the join column, followed by the filters
+    const std::size_t column = shadow.getColumn();
+    auto seek = [&](std::size_t source, RamDomain value, RamDomain& next) {
+        if (source == 0) {
+            low[column] = value;
+            return view->seek(low.data(), high.data(), column, next);
+        }
+        const auto& filter = filters[source - 1];
+        filterLow[source - 1][filter.column] = value;
+        return ctxt.getView(filter.viewId)
+                ->seek(filterLow[source - 1].data(), filterHigh[source - 1].data(), filter.column, next);
+    };
+
+    // conduct a range query for each value of the join column
+    std::size_t visited = 0;
+    bool complete = true;
+    evaluator::leapfrog(filters.size() + 1, seek, [&](RamDomain value) {
+        low[column] = value;
+        auto highValue = high;
+        highValue[column] = value;
+        for (const auto& tuple : view->range(low, highValue)) {
+            ctxt[cur.getTupleId()] = tuple.data();
+            ++visited;
+            if (!execute(shadow.getNestedOperation(), ctxt)) {
+                complete = false;
+                return false;
+            }
+        }
+        return true;
+    });
+    if (complete) {
+        view->countScan(visited);
     }
     return true;
 }
@@ -1709,6 +2116,7 @@ RamDomain Engine::evalParallelIndexScan(
 
     std::size_t indexPos = shadow.getViewId();
     auto pStream = rel.partitionRange(indexPos, low, high, numOfThreads);
+    ParallelRegion region(profileEnabled);
     PARALLEL_START
         Context newCtxt(ctxt);
         auto viewInfo = viewContext->getViewInfoForNested();
@@ -1723,6 +2131,12 @@ RamDomain Engine::evalParallelIndexScan(
 #else
         pfor(auto it = pStream.begin(); it < pStream.end(); it++) {
 #endif
+            ParallelRegion::Task task(region);
+            if (batchSize > 0 && shadow.getBatch().operation != nullptr) {
+                std::size_t visited = 0;
+                evalBatch<Rel>(*it, cur.getTupleId(), shadow.getBatch(), newCtxt, visited);
+                continue;
+            }
             for (const auto& tuple : *it) {
                 newCtxt[cur.getTupleId()] = tuple.data();
                 if (!execute(shadow.getNestedOperation(), newCtxt)) {
@@ -1755,6 +2169,7 @@ RamDomain Engine::evalParallelIfExists(
 
     auto pStream = rel.partitionScan(numOfThreads);
     auto viewInfo = viewContext->getViewInfoForNested();
+    ParallelRegion region(profileEnabled);
     PARALLEL_START
         Context newCtxt(ctxt);
         for (const auto& info : viewInfo) {
@@ -1768,6 +2183,7 @@ RamDomain Engine::evalParallelIfExists(
 #else
         pfor(auto it = pStream.begin(); it < pStream.end(); it++) {
 #endif
+            ParallelRegion::Task task(region);
             for (const auto& tuple : *it) {
                 newCtxt[cur.getTupleId()] = tuple.data();
                 if (execute(shadow.getCondition(), newCtxt)) {
@@ -1819,6 +2235,7 @@ RamDomain Engine::evalParallelIndexIfExists(const Rel& rel, const ram::ParallelI
     std::size_t indexPos = shadow.getViewId();
     auto pStream = rel.partitionRange(indexPos, low, high, numOfThreads);
 
+    ParallelRegion region(profileEnabled);
     PARALLEL_START
         Context newCtxt(ctxt);
         for (const auto& info : viewInfo) {
@@ -1832,6 +2249,7 @@ RamDomain Engine::evalParallelIndexIfExists(const Rel& rel, const ram::ParallelI
 #else
         pfor(auto it = pStream.begin(); it < pStream.end(); it++) {
 #endif
+            ParallelRegion::Task task(region);
             for (const auto& tuple : *it) {
                 newCtxt[cur.getTupleId()] = tuple.data();
                 if (execute(shadow.getCondition(), newCtxt)) {
@@ -29,12 +29,15 @@
 #include "souffle/SymbolTable.h"
 #include "souffle/datastructure/RecordTableImpl.h"
 #include "souffle/datastructure/SymbolTableImpl.h"
+#include "souffle/io/Spill.h"
+#include "souffle/io/WriteQueue.h"
 #include "souffle/utility/ContainerUtil.h"
 #include <atomic>
 #include <cstddef>
 #include <deque>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 #ifdef _OPENMP
@@ -57,12 +60,24 @@ class Engine {
 public:
     Engine(ram::TranslationUnit& tUnit);
 
-    /** @brief Execute the main program */
-    void executeMain();
+    /**
+     * @brief Execute the main program
+     *
+     * Facts are only read and written if performIO is set, using the given directories if non-empty.
+     * Relations that are no longer needed are only freed if pruneImdtRels is set.
+     * The program can be executed repeatedly; the node tree is generated only once.
+     */
+    void executeMain(std::string inputDirectory = "", std::string outputDirectory = "", bool performIO = true,
+            bool pruneImdtRels = true);
     /** @brief Execute the subroutine program */
     void executeSubroutine(
             const std::string& name, const std::vector<RamDomain>& args, std::vector<RamDomain>& ret);
 
+    /** @brief Report failures to read, write or spill relations by a std::runtime_error instead of exiting */
+    void setThrowOnErrors(bool value = true) {
+        throwOnErrors = value;
+    }
+
 private:
     /** @brief Generate intermediate representation from RAM */
     void generateIR();
@@ -113,6 +128,10 @@ private:
     RamDomain evalParallelScan(
             const Rel& rel, const ram::ParallelScan& cur, const ParallelScan& shadow, Context& ctxt);
 
+    template <typename Rel, typename Range>
+    bool evalBatch(const Range& range, std::size_t tupleId, const Batch& batch, Context& ctxt,
+            std::size_t& visited);
+
     template <typename Rel>
     RamDomain evalCountUniqueKeys(
             const Rel& rel, const ram::CountUniqueKeys& cur, const CountUniqueKeys& shadow, Context& ctxt);
@@ -120,6 +139,9 @@ private:
     template <typename Rel>
     RamDomain evalIndexScan(const ram::IndexScan& cur, const IndexScan& shadow, Context& ctxt);
 
+    template <typename Rel>
+    RamDomain evalLeapfrogJoin(const ram::LeapfrogJoin& cur, const LeapfrogJoin& shadow, Context& ctxt);
+
     template <typename Rel>
     RamDomain evalParallelIndexScan(const Rel& rel, const ram::ParallelIndexScan& cur,
             const ParallelIndexScan& shadow, Context& ctxt);
@@ -162,9 +184,35 @@ private:
     template <typename Rel>
     RamDomain evalErase(Rel& rel, const Erase& shadow, Context& ctxt);
 
+    /** @brief Report a failure that stops the evaluation */
+    [[noreturn]] void fail(const std::string& message) const;
+
+    /** @brief Wait for the queued outputs, reporting the failure of one on the calling thread */
+    void waitForOutputs();
+
+    /** Options of the program, copied when the engine is created */
+    const MainConfig config;
     /** If profile is enable in this program */
     const bool profileEnabled;
     const bool frequencyCounterEnabled;
+    /** If the usage of indexes is profiled */
+    const bool indexStatisticsEnabled;
+    /** If failures are thrown instead of exiting */
+    bool throwOnErrors = false;
+    /** If outputs are written in the background */
+    const bool asyncOutput;
+    /** Number of tuples of the blocks scans are evaluated over, 0 if tuples are evaluated one by one */
+    const std::size_t batchSize;
+    /** Relations whose nodes are spread over the NUMA nodes, "*" for all */
+    std::set<std::string> interleavedRelations;
+    /** If facts are read and written by the current execution */
+    bool performIO = true;
+    /** If relations are freed once no longer needed by the current execution */
+    bool pruneImdtRels = true;
+    /** Overrides the fact directory of inputs if non-empty */
+    std::string inputDirectory;
+    /** Overrides the output directory of outputs if non-empty */
+    std::string outputDirectory;
     /** subroutines */
     VecOwn<Node> subroutine;
     /** main program */
@@ -191,6 +239,10 @@ private:
     VecOwn<RelationHandle> relations;
     /** Symbol table */
     SymbolTableImpl symbolTable;
+    /** Relations moved to disk by --memory-limit */
+    spill::Spiller spiller;
+    /** Background output jobs; declared last so that it is drained before the tables go away */
+    WriteQueue writeQueue;
 };
 
 }  // namespace souffle::interpreter
@@ -38,11 +38,22 @@ NodePtr NodeGenerator::generateTree(const ram::Node& root) {
         if (const auto* countUniqueKeys = as<ram::CountUniqueKeys>(node)) {
             encodeIndexPos(*countUniqueKeys);
             encodeView(countUniqueKeys);
+        } else if (const auto* join = as<ram::LeapfrogJoin>(node)) {
+            encodeIndexPos(*join);
+            encodeView(join);
+            const auto filters = join->getFilters();
+            for (std::size_t i = 0; i < filters.size(); ++i) {
+                encodeIndexPos(*join, i);
+                encodeView(filters[i]);
+            }
         } else if (const auto* indexSearch = as<ram::IndexOperation>(node)) {
             encodeIndexPos(*indexSearch);
             encodeView(indexSearch);
         } else if (const auto* exists = as<ram::ExistenceCheck>(node)) {
-            encodeIndexPos(*exists);
+            // the filters of leapfrog joins are already encoded
+            if (indexTable.count(exists) == 0) {
+                encodeIndexPos(*exists);
+            }
             encodeView(exists);
         } else if (const auto* provExists = as<ram::ProvenanceExistenceCheck>(node)) {
             encodeIndexPos(*provExists);
@@ -259,7 +270,9 @@ NodePtr NodeGenerator::visit_(type_identity<ram::Scan>, const ram::Scan& scan) {
     std::size_t relId = encodeRelation(scan.getRelation());
     auto rel = getRelationHandle(relId);
     NodeType type = constructNodeType("Scan", lookup(scan.getRelation()));
-    return mk<Scan>(type, &scan, rel, visit_(type_identity<ram::TupleOperation>(), scan));
+    auto res = mk<Scan>(type, &scan, rel, visit_(type_identity<ram::TupleOperation>(), scan));
+    res->setBatch(getBatch(scan, res->getNestedOperation()));
+    return res;
 }
 
 NodePtr NodeGenerator::visit_(type_identity<ram::ParallelScan>, const ram::ParallelScan& pScan) {
@@ -269,6 +282,7 @@ NodePtr NodeGenerator::visit_(type_identity<ram::ParallelScan>, const ram::Paral
     NodeType type = constructNodeType("ParallelScan", lookup(pScan.getRelation()));
     auto res = mk<ParallelScan>(type, &pScan, rel, visit_(type_identity<ram::TupleOperation>(), pScan));
     res->setViewContext(parentQueryViewContext);
+    res->setBatch(getBatch(pScan, res->getNestedOperation()));
     return res;
 }
 
@@ -276,8 +290,10 @@ NodePtr NodeGenerator::visit_(type_identity<ram::IndexScan>, const ram::IndexSca
     orderingContext.addTupleWithIndexOrder(iScan.getTupleId(), iScan);
     SuperInstruction indexOperation = getIndexSuperInstInfo(iScan);
     NodeType type = constructNodeType("IndexScan", lookup(iScan.getRelation()));
-    return mk<IndexScan>(type, &iScan, nullptr, visit_(type_identity<ram::TupleOperation>(), iScan),
+    auto res = mk<IndexScan>(type, &iScan, nullptr, visit_(type_identity<ram::TupleOperation>(), iScan),
             encodeView(&iScan), std::move(indexOperation));
+    res->setBatch(getBatch(iScan, res->getNestedOperation()));
+    return res;
 }
 
 NodePtr NodeGenerator::visit_(type_identity<ram::ParallelIndexScan>, const ram::ParallelIndexScan& piscan) {
@@ -289,9 +305,36 @@ NodePtr NodeGenerator::visit_(type_identity<ram::ParallelIndexScan>, const ram::
     auto res = mk<ParallelIndexScan>(type, &piscan, rel, visit_(type_identity<ram::TupleOperation>(), piscan),
             encodeIndexPos(piscan), std::move(indexOperation));
     res->setViewContext(parentQueryViewContext);
+    res->setBatch(getBatch(piscan, res->getNestedOperation()));
     return res;
 }
 
+NodePtr NodeGenerator::visit_(type_identity<ram::LeapfrogJoin>, const ram::LeapfrogJoin& join) {
+    orderingContext.addTupleWithIndexOrder(join.getTupleId(), join);
+    SuperInstruction indexOperation = getIndexSuperInstInfo(join);
+    auto findColumn = [&](const std::string& rel, std::size_t indexId, std::size_t column) {
+        auto order = (*getRelationHandle(encodeRelation(rel)))->getIndexOrder(indexId);
+        std::size_t pos = 0;
+        while (order[pos] != column) {
+            ++pos;
+        }
+        return pos;
+    };
+    std::vector<LeapfrogJoin::JoinFilter> filters;
+    const auto ramFilters = join.getFilters();
+    for (std::size_t i = 0; i < ramFilters.size(); ++i) {
+        const auto& filter = *ramFilters[i];
+        std::size_t indexId = encodeIndexPos(join, i);
+        filters.push_back({encodeView(&filter), getExistenceSuperInstInfo(filter, indexId),
+                findColumn(filter.getRelation(), indexId, join.getFilterColumns()[i])});
+    }
+    std::size_t column = findColumn(join.getRelation(), encodeIndexPos(join), join.getColumn());
+    NodeType type = constructNodeType("LeapfrogJoin", lookup(join.getRelation()));
+    auto nested = visit_(type_identity<ram::TupleOperation>(), join);
+    return mk<LeapfrogJoin>(type, &join, std::move(nested), encodeView(&join), std::move(indexOperation),
+            column, std::move(filters));
+}
+
 NodePtr NodeGenerator::visit_(type_identity<ram::IfExists>, const ram::IfExists& ifexists) {
     orderingContext.addTupleWithDefaultOrder(ifexists.getTupleId(), ifexists);
     std::size_t relId = encodeRelation(ifexists.getRelation());
@@ -454,7 +497,6 @@ NodePtr NodeGenerator::visit_(type_identity<ram::Sequence>, const ram::Sequence&
 }
 
 NodePtr NodeGenerator::visit_(type_identity<ram::Parallel>, const ram::Parallel& parallel) {
-    // Parallel statements are executed in sequence for now.
     NodePtrVec children;
     for (const auto& value : parallel.getStatements()) {
         children.push_back(dispatch(*value));
@@ -463,7 +505,10 @@ NodePtr NodeGenerator::visit_(type_identity<ram::Parallel>, const ram::Parallel&
 }
 
 NodePtr NodeGenerator::visit_(type_identity<ram::Loop>, const ram::Loop& loop) {
-    return mk<Loop>(I_Loop, &loop, dispatch(loop.getBody()));
+    ++loopDepth;
+    auto body = dispatch(loop.getBody());
+    --loopDepth;
+    return mk<Loop>(I_Loop, &loop, std::move(body));
 }
 
 NodePtr NodeGenerator::visit_(type_identity<ram::Exit>, const ram::Exit& exit) {
@@ -499,7 +544,15 @@ NodePtr NodeGenerator::visit_(type_identity<ram::Clear>, const ram::Clear& clear
     std::size_t relId = encodeRelation(clear.getRelation());
     auto rel = getRelationHandle(relId);
     NodeType type = constructNodeType("Clear", lookup(clear.getRelation()));
-    return mk<Clear>(type, &clear, rel);
+    // recycled nodes are kept for the next iteration of a loop only
+    return mk<Clear>(type, &clear, rel, loopDepth == 0);
+}
+
+NodePtr NodeGenerator::visit_(type_identity<ram::Compress>, const ram::Compress& compress) {
+    std::size_t relId = encodeRelation(compress.getRelation());
+    auto rel = getRelationHandle(relId);
+    NodeType type = constructNodeType("Compress", lookup(compress.getRelation()));
+    return mk<Compress>(type, &compress, rel);
 }
 
 NodePtr NodeGenerator::visit_(type_identity<ram::CountUniqueKeys>, const ram::CountUniqueKeys& count) {
@@ -568,6 +621,12 @@ NodePtr NodeGenerator::visit_(type_identity<ram::Query>, const ram::Query& query
     return res;
 }
 
+NodePtr NodeGenerator::visit_(type_identity<ram::Merge>, const ram::Merge& merge) {
+    std::size_t src = encodeRelation(merge.getSourceRelation());
+    std::size_t target = encodeRelation(merge.getTargetRelation());
+    return mk<Merge>(I_Merge, &merge, src, target);
+}
+
 NodePtr NodeGenerator::visit_(type_identity<ram::MergeExtend>, const ram::MergeExtend& extend) {
     std::size_t src = encodeRelation(extend.getFirstRelation());
     std::size_t target = encodeRelation(extend.getSecondRelation());
@@ -610,10 +669,25 @@ std::size_t NodeGenerator::encodeIndexPos(RamNode& node) {
         signature = ram::analysis::SearchSignature::getFullSearchSignature(signature.arity());
     }
     auto i = engine.isa.getIndexSelection(name).getLexOrderNum(signature);
+    // Only the main index of a hashed relation tests full tuples for membership by hashing.
+    if constexpr (std::is_same_v<std::remove_const_t<RamNode>, ram::ExistenceCheck>) {
+        if (lookup(name).getRepresentation() == RelationRepresentation::HASH &&
+                signature == ram::analysis::SearchSignature::getFullSearchSignature(signature.arity())) {
+            i = 0;
+        }
+    }
     indexTable[&node] = i;
     return i;
 };
 
+std::size_t NodeGenerator::encodeIndexPos(const ram::LeapfrogJoin& join, std::size_t filter) {
+    const auto* exists = join.getFilters()[filter];
+    ram::analysis::SearchSignature signature = engine.isa.getSearchSignature(&join, filter);
+    auto i = engine.isa.getIndexSelection(exists->getRelation()).getLexOrderNum(signature);
+    indexTable[exists] = i;
+    return i;
+}
+
 std::size_t NodeGenerator::encodeView(const ram::Node* node) {
     auto pos = viewTable.find(node);
     if (pos != viewTable.end()) {
@@ -739,7 +813,6 @@ SuperInstruction NodeGenerator::getIndexSuperInstInfo(const ram::IndexOperation&
 }
 
 SuperInstruction NodeGenerator::getExistenceSuperInstInfo(const ram::AbstractExistenceCheck& abstractExist) {
-    auto interpreterRel = encodeRelation(abstractExist.getRelation());
     std::size_t indexId = 0;
     if (isA<ram::ExistenceCheck>(&abstractExist)) {
         indexId = encodeIndexPos(*as<ram::ExistenceCheck>(abstractExist));
@@ -748,6 +821,12 @@ SuperInstruction NodeGenerator::getExistenceSuperInstInfo(const ram::AbstractExi
     } else {
         fatal("Unrecognized ram::AbstractExistenceCheck.");
     }
+    return getExistenceSuperInstInfo(abstractExist, indexId);
+}
+
+SuperInstruction NodeGenerator::getExistenceSuperInstInfo(
+        const ram::AbstractExistenceCheck& abstractExist, std::size_t indexId) {
+    auto interpreterRel = encodeRelation(abstractExist.getRelation());
     auto order = (*getRelationHandle(interpreterRel))->getIndexOrder(indexId);
     std::size_t arity = getArity(abstractExist.getRelation());
     SuperInstruction superOp(arity);
@@ -841,6 +920,159 @@ SuperInstruction NodeGenerator::getEraseSuperInstInfo(const ram::Erase& exist) {
     return superOp;
 }
 
+Batch NodeGenerator::getBatch(const ram::TupleOperation& scan, const Node* nested) {
+    // relations written by the nested operation
+    std::set<std::string> written;
+    visit(scan.getOperation(), [&](const ram::Insert& insert) { written.insert(insert.getRelation()); });
+    visit(scan.getOperation(), [&](const ram::Erase& erase) { written.insert(erase.getRelation()); });
+    auto isWritten = [&](const Node* condition) {
+        const ram::Node& ramCondition = *condition->getShadow();
+        return visitExists(ramCondition,
+                       [&](const ram::AbstractExistenceCheck& exists) {
+                           return contains(written, exists.getRelation());
+                       }) ||
+               visitExists(ramCondition,
+                       [&](const ram::EmptinessCheck& empty) {
+                           return contains(written, empty.getRelation());
+                       }) ||
+               visitExists(ramCondition,
+                       [&](const ram::RelationSize& size) { return contains(written, size.getRelation()); });
+    };
+
+    Batch batch;
+    const Node* operation = nested;
+    while (operation->getType() == I_Filter) {
+        const auto* filter = static_cast<const Filter*>(operation);
+        if (isWritten(filter->getCondition())) {
+            break;
+        }
+        addBatchCondition(batch, scan, filter->getCondition());
+        operation = filter->getNestedOperation();
+    }
+
+    // the tuples are sorted by the elements probing the next relation in the order of its index,
+    // the first existence check of the conditions or else the nested operation
+    const ram::Node& ramOperation = *operation->getShadow();
+    bool ordered = visitExists(ramOperation, [](const ram::Break&) { return true; }) ||
+                   visitExists(ramOperation, [](const ram::SubroutineReturn&) { return true; }) ||
+                   visitExists(ramOperation, [](const ram::AutoIncrement&) { return true; });
+    auto getProbeKeys = [&](const ram::ExistenceCheck& exists) {
+        auto order = (*getRelationHandle(encodeRelation(exists.getRelation())))
+                             ->getIndexOrder(encodeIndexPos(exists));
+        const auto& values = exists.getValues();
+        std::vector<std::size_t> keys;
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            const auto* element = as<ram::TupleElement>(values[order[i]]);
+            if (element != nullptr && element->getTupleId() == scan.getTupleId()) {
+                keys.push_back(orderingContext.mapOrder(scan.getTupleId(), element->getElement()));
+            }
+        }
+        return keys;
+    };
+    for (std::size_t i = 0; !ordered && i < batch.conditions.size() && batch.keys.empty(); ++i) {
+        visit(*batch.conditions[i]->getShadow(), [&](const ram::ExistenceCheck& exists) {
+            if (batch.keys.empty()) {
+                batch.keys = getProbeKeys(exists);
+                batch.sortAfter = i;
+            }
+        });
+    }
+    const auto* superOp = dynamic_cast<const SuperOperation*>(operation);
+    if (!ordered && batch.keys.empty() && superOp != nullptr) {
+        for (const auto& tupleElement : superOp->getSuperInst().tupleFirst) {
+            if (tupleElement[1] == scan.getTupleId()) {
+                batch.keys.push_back(tupleElement[2]);
+            }
+        }
+        batch.sortAfter = batch.conditions.size();
+    }
+
+    // blocks only pay off if their tuples are filtered, or reordered for the probes of an outermost
+    // loop; the short ranges of inner loops are already ordered by their index
+    if (!batch.conditions.empty() || (!batch.keys.empty() && scan.getTupleId() == 0)) {
+        batch.operation = operation;
+        batch.nested = nested;
+    }
+    return batch;
+}
+
+void NodeGenerator::addBatchCondition(Batch& batch, const ram::TupleOperation& scan, const Node* condition) {
+    if (condition->getType() == I_Conjunction) {
+        const auto* conjunction = static_cast<const Conjunction*>(condition);
+        addBatchCondition(batch, scan, conjunction->getLhs());
+        addBatchCondition(batch, scan, conjunction->getRhs());
+        return;
+    }
+    batch.conditions.push_back(condition);
+    batch.comparisons.emplace_back();
+
+    const auto* constraint = as<ram::Constraint>(condition->getShadow());
+    if (constraint == nullptr) {
+        return;
+    }
+    auto isScanned = [&](const ram::Expression& expr) {
+        const auto* element = as<ram::TupleElement>(expr);
+        return element != nullptr && element->getTupleId() == scan.getTupleId();
+    };
+    auto isFixed = [&](const ram::Expression& expr) {
+        const auto* element = as<ram::TupleElement>(expr);
+        return isA<ram::NumericConstant>(expr) || isA<ram::StringConstant>(expr) ||
+               (element != nullptr && element->getTupleId() != scan.getTupleId());
+    };
+    // the operator with its operands swapped
+    auto getConverse = [](BinaryConstraintOp op) {
+        switch (op) {
+            case BinaryConstraintOp::LT: return BinaryConstraintOp::GT;
+            case BinaryConstraintOp::ULT: return BinaryConstraintOp::UGT;
+            case BinaryConstraintOp::FLT: return BinaryConstraintOp::FGT;
+            case BinaryConstraintOp::LE: return BinaryConstraintOp::GE;
+            case BinaryConstraintOp::ULE: return BinaryConstraintOp::UGE;
+            case BinaryConstraintOp::FLE: return BinaryConstraintOp::FGE;
+            case BinaryConstraintOp::GT: return BinaryConstraintOp::LT;
+            case BinaryConstraintOp::UGT: return BinaryConstraintOp::ULT;
+            case BinaryConstraintOp::FGT: return BinaryConstraintOp::FLT;
+            case BinaryConstraintOp::GE: return BinaryConstraintOp::LE;
+            case BinaryConstraintOp::UGE: return BinaryConstraintOp::ULE;
+            case BinaryConstraintOp::FGE: return BinaryConstraintOp::FLE;
+            default: return op;
+        }
+    };
+
+    BinaryConstraintOp op = constraint->getOperator();
+    switch (op) {
+        case BinaryConstraintOp::EQ:
+        case BinaryConstraintOp::FEQ:
+        case BinaryConstraintOp::NE:
+        case BinaryConstraintOp::FNE:
+        case BinaryConstraintOp::LT:
+        case BinaryConstraintOp::ULT:
+        case BinaryConstraintOp::FLT:
+        case BinaryConstraintOp::LE:
+        case BinaryConstraintOp::ULE:
+        case BinaryConstraintOp::FLE:
+        case BinaryConstraintOp::GT:
+        case BinaryConstraintOp::UGT:
+        case BinaryConstraintOp::FGT:
+        case BinaryConstraintOp::GE:
+        case BinaryConstraintOp::UGE:
+        case BinaryConstraintOp::FGE: break;
+        default: return;
+    }
+    const auto* node = static_cast<const Constraint*>(condition);
+    const ram::Expression* element = &constraint->getLHS();
+    const Node* value = node->getRhs();
+    if (!isScanned(*element) || !isFixed(constraint->getRHS())) {
+        if (!isScanned(constraint->getRHS()) || !isFixed(constraint->getLHS())) {
+            return;
+        }
+        element = &constraint->getRHS();
+        value = node->getLhs();
+        op = getConverse(op);
+    }
+    std::size_t column = as<ram::TupleElement>(element)->getElement();
+    batch.comparisons.back() = {op, orderingContext.mapOrder(scan.getTupleId(), column), value};
+}
+
 // -- Definition of OrderingContext --
 
 NodeGenerator::OrderingContext::OrderingContext(NodeGenerator& generator) : generator(generator) {}
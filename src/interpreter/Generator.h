@@ -29,12 +29,14 @@
 #include "ram/Break.h"
 #include "ram/Call.h"
 #include "ram/Clear.h"
+#include "ram/Compress.h"
 #include "ram/Condition.h"
 #include "ram/Conjunction.h"
 #include "ram/Constraint.h"
 #include "ram/CountUniqueKeys.h"
 #include "ram/DebugInfo.h"
 #include "ram/EmptinessCheck.h"
+#include "ram/Erase.h"
 #include "ram/ExistenceCheck.h"
 #include "ram/Exit.h"
 #include "ram/Expression.h"
@@ -48,10 +50,12 @@
 #include "ram/IndexScan.h"
 #include "ram/Insert.h"
 #include "ram/IntrinsicOperator.h"
+#include "ram/LeapfrogJoin.h"
 #include "ram/LogRelationTimer.h"
 #include "ram/LogSize.h"
 #include "ram/LogTimer.h"
 #include "ram/Loop.h"
+#include "ram/Merge.h"
 #include "ram/MergeExtend.h"
 #include "ram/Negation.h"
 #include "ram/NestedIntrinsicOperator.h"
@@ -98,6 +102,7 @@
 #include <map>
 #include <memory>
 #include <queue>
+#include <set>
 #include <string>
 #include <typeinfo>
 #include <unordered_map>
@@ -176,6 +181,8 @@ public:
 
     NodePtr visit_(type_identity<ram::ParallelIndexScan>, const ram::ParallelIndexScan& piscan) override;
 
+    NodePtr visit_(type_identity<ram::LeapfrogJoin>, const ram::LeapfrogJoin& join) override;
+
     NodePtr visit_(type_identity<ram::IfExists>, const ram::IfExists& ifexists) override;
 
     NodePtr visit_(type_identity<ram::ParallelIfExists>, const ram::ParallelIfExists& pIfExists) override;
@@ -225,6 +232,7 @@ public:
     NodePtr visit_(type_identity<ram::DebugInfo>, const ram::DebugInfo& dbg) override;
 
     NodePtr visit_(type_identity<ram::Clear>, const ram::Clear& clear) override;
+    NodePtr visit_(type_identity<ram::Compress>, const ram::Compress& compress) override;
 
     NodePtr visit_(type_identity<ram::CountUniqueKeys>, const ram::CountUniqueKeys& count) override;
 
@@ -234,6 +242,8 @@ public:
 
     NodePtr visit_(type_identity<ram::Query>, const ram::Query& query) override;
 
+    NodePtr visit_(type_identity<ram::Merge>, const ram::Merge& merge) override;
+
     NodePtr visit_(type_identity<ram::MergeExtend>, const ram::MergeExtend& extend) override;
 
     NodePtr visit_(type_identity<ram::Swap>, const ram::Swap& swap) override;
@@ -297,6 +307,9 @@ private:
     template <class RamNode>
     std::size_t encodeIndexPos(RamNode& node);
 
+    /** @brief Return index id of a filter of a leapfrog join */
+    std::size_t encodeIndexPos(const ram::LeapfrogJoin& join, std::size_t filter);
+
     /** @brief Encode and return the View id of an operation. */
     std::size_t encodeView(const ram::Node* node);
 
@@ -332,6 +345,8 @@ private:
      * @brief Encode and return the super-instruction information about an existence check operation
      */
     SuperInstruction getExistenceSuperInstInfo(const ram::AbstractExistenceCheck& abstractExist);
+    SuperInstruction getExistenceSuperInstInfo(
+            const ram::AbstractExistenceCheck& abstractExist, std::size_t indexId);
 
     /**
      * @brief Encode and return the super-instruction information about a insert operation
@@ -342,6 +357,22 @@ private:
     SuperInstruction getInsertSuperInstInfo(const ram::Insert& exist);
     SuperInstruction getEraseSuperInstInfo(const ram::Erase& exist);
 
+    /**
+     * @brief Split the nested operation of a scan for the evaluation over blocks of tuples.
+     *
+     * Filters are peeled off as long as their conditions read no relation written by the
+     * nested operation. The tuples are only reordered if nothing depends on their order.
+     */
+    Batch getBatch(const ram::TupleOperation& scan, const Node* nested);
+
+    /**
+     * @brief Add a condition of a peeled filter to the batch of a scan.
+     *
+     * Conjunctions are split into their terms. Terms comparing an element of the scanned tuple
+     * with a constant or an element of an outer tuple are tested over a block as comparisons.
+     */
+    void addBatchCondition(Batch& batch, const ram::TupleOperation& scan, const Node* condition);
+
     /** Environment encoding, store a mapping from ram::Node to its operation index id. */
     std::unordered_map<const ram::Node*, std::size_t> indexTable;
     /** Points to the current viewContext during the generation.
@@ -352,6 +383,8 @@ private:
     std::size_t viewId = 0;
     /** Next available location to encode a relation */
     std::size_t relId = 0;
+    /** Number of loops enclosing the current node */
+    std::size_t loopDepth = 0;
     /** Environment encoding, store a mapping from ram::Node to its View id. */
     std::unordered_map<const ram::Node*, std::size_t> viewTable;
     /** Environment encoding, store a mapping from ram::Relation to its id */
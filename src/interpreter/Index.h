@@ -19,9 +19,12 @@
 #include "souffle/RamTypes.h"
 #include "souffle/datastructure/EquivalenceRelation.h"
 #include "souffle/datastructure/UnionFind.h"
+#include "souffle/profile/IndexStatistics.h"
 #include "souffle/utility/ContainerUtil.h"
 #include "souffle/utility/MiscUtil.h"
+#include "souffle/utility/ParallelUtil.h"
 #include "souffle/utility/StreamUtil.h"
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <cassert>
@@ -30,6 +33,7 @@
 #include <iosfwd>
 #include <iterator>
 #include <memory>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -133,10 +137,68 @@ inline std::ostream& operator<<(std::ostream& out, const Order& order) {
 }
 
 /**
- * A dummy wrapper for indexViews.
+ * A wrapper for indexViews.
  */
 struct ViewWrapper {
     virtual ~ViewWrapper() = default;
+
+    /**
+     * Finds the first tuple within the given bounds and sets value to its
+     * value of the given column, for leapfrog joins of indexes of different
+     * types. Bounds and column are in the order of the index.
+     */
+    virtual bool seek(const RamDomain* low, const RamDomain* high, std::size_t column, RamDomain& value) = 0;
+};
+
+namespace detail {
+
+/** Whether a data structure merges another one of its type itself, like tries and equivalence relations */
+template <typename Data, typename = void>
+struct has_insert_all : std::false_type {};
+
+template <typename Data>
+struct has_insert_all<Data,
+        std::void_t<decltype(std::declval<Data&>().insertAll(std::declval<const Data&>()))>>
+        : std::true_type {};
+
+/** Whether a data structure can recycle its nodes across clears, like b-trees */
+template <typename Data, typename = void>
+struct has_recycle_nodes : std::false_type {};
+
+template <typename Data>
+struct has_recycle_nodes<Data, std::void_t<decltype(std::declval<Data&>().recycleNodes())>>
+        : std::true_type {};
+
+/**
+ * Whether the iterators of a structure yield the tuples stored in it, like b-trees, which stay in place
+ * until the structure is modified, rather than tuples assembled by the iterator, like tries
+ */
+template <template <std::size_t> typename Structure>
+struct has_stable_tuples : std::false_type {};
+
+template <>
+struct has_stable_tuples<Btree> : std::true_type {};
+
+template <>
+struct has_stable_tuples<BtreeDelete> : std::true_type {};
+
+template <>
+struct has_stable_tuples<Hashed> : std::true_type {};
+
+template <>
+struct has_stable_tuples<Provenance> : std::true_type {};
+
+}  // namespace detail
+
+/**
+ * The lookups of an index, counted by its views for --profile-indexes.
+ */
+struct IndexUsage {
+    std::atomic<std::size_t> lookups{0};
+    std::atomic<std::size_t> emptyLookups{0};
+    std::atomic<std::size_t> fullRanges{0};
+    std::atomic<std::size_t> scans{0};
+    std::atomic<std::size_t> tuples{0};
 };
 
 /**
@@ -146,6 +208,7 @@ template <std::size_t _Arity, template <std::size_t> typename Structure>
 class Index {
 public:
     static constexpr std::size_t Arity = _Arity;
+    static constexpr bool stableTuples = detail::has_stable_tuples<Structure>::value;
     using Data = Structure<Arity>;
     using Tuple = typename souffle::Tuple<RamDomain, Arity>;
     using iterator = typename Data::iterator;
@@ -158,24 +221,49 @@ protected:
     Order order;
     Data data;
     Comparator cmp;
+    Own<IndexUsage> usage;
 
 public:
     /**
      * A view on a relation caching local access patterns (not thread safe!).
      * Each thread should create and use its own view for accessing relations
      * to exploit access patterns via operation hints.
+     *
+     * If the usage of the index is counted, the view counts its own lookups and
+     * adds them to the index when it is destroyed.
      */
     class View : public ViewWrapper {
         mutable Hints hints;
         const Data& data;
         Comparator cmp;
+        IndexUsage* usage;
+        std::size_t lookups = 0;
+        std::size_t emptyLookups = 0;
+        std::size_t fullRanges = 0;
+        std::size_t scans = 0;
+        std::size_t tuples = 0;
 
     public:
-        View(const Data& data) : data(data) {}
+        View(const Data& data, IndexUsage* usage = nullptr) : data(data), usage(usage) {}
+
+        ~View() override {
+            if (usage != nullptr && lookups > 0) {
+                usage->lookups += lookups;
+                usage->emptyLookups += emptyLookups;
+                usage->fullRanges += fullRanges;
+                usage->scans += scans;
+                usage->tuples += tuples;
+            }
+        }
 
         /** Tests whether the given entry is contained in this index. */
         bool contains(const Tuple& entry) {
-            return data.contains(entry, hints);
+            bool found = data.contains(entry, hints);
+            if (usage != nullptr) {
+                ++lookups;
+                emptyLookups += found ? 0 : 1;
+            }
+            return found;
         }
 
         /** Tests whether any element in the given range is contained in this index. */
@@ -186,9 +274,45 @@ public:
         /** Obtains a pair of iterators representing the given range within this index. */
         souffle::range<iterator> range(const Tuple& low, const Tuple& high) {
             if (cmp(low, high) > 0) {
+                if (usage != nullptr) {
+                    ++lookups;
+                    ++emptyLookups;
+                }
                 return {data.end(), data.end()};
             }
-            return {data.lower_bound(low, hints), data.upper_bound(high, hints)};
+            souffle::range<iterator> result{data.lower_bound(low, hints), data.upper_bound(high, hints)};
+            if (usage != nullptr) {
+                ++lookups;
+                emptyLookups += result.empty() ? 1 : 0;
+                fullRanges += (low[0] == MIN_RAM_SIGNED && high[0] == MAX_RAM_SIGNED) ? 1 : 0;
+            }
+            return result;
+        }
+
+        bool seek(const RamDomain* low, const RamDomain* high, std::size_t column,
+                RamDomain& value) override {
+            Tuple lowTuple;
+            Tuple highTuple;
+            std::copy_n(low, Arity, lowTuple.begin());
+            std::copy_n(high, Arity, highTuple.begin());
+            auto pos = data.lower_bound(lowTuple, hints);
+            bool found = pos != data.end() && cmp(*pos, highTuple) <= 0;
+            if (usage != nullptr) {
+                ++lookups;
+                emptyLookups += found ? 0 : 1;
+            }
+            if (found) {
+                value = (*pos)[column];
+            }
+            return found;
+        }
+
+        /** Counts a range obtained from this view whose tuples were all visited. */
+        void countScan(std::size_t scanned) {
+            if (usage != nullptr) {
+                ++scans;
+                tuples += scanned;
+            }
         }
     };
 
@@ -197,7 +321,63 @@ public:
      * Requests the creation of a view on this index.
      */
     View createView() {
-        return View(this->data);
+        return View(this->data, usage.get());
+    }
+
+    /**
+     * Counts the lookups of the views created from now on.
+     */
+    void enableStatistics() {
+        if (!usage) {
+            usage = mk<IndexUsage>();
+        }
+    }
+
+    /**
+     * Keeps the nodes of the data structure across purges, if it supports
+     * it, instead of freeing and allocating them again.
+     */
+    void recycleNodes() {
+        if constexpr (detail::has_recycle_nodes<Data>::value) {
+            data.recycleNodes();
+        }
+    }
+
+    /**
+     * Spreads the nodes of the data structure over the NUMA nodes, if it
+     * supports recycled nodes.
+     */
+    void interleaveNodes() {
+        if constexpr (detail::has_recycle_nodes<Data>::value) {
+            data.interleaveNodes();
+        }
+    }
+
+    /**
+     * Returns the memory kept for recycled or interleaved nodes, if the data
+     * structure supports them. The index must have been cleared.
+     */
+    void releaseNodes() {
+        if constexpr (detail::has_recycle_nodes<Data>::value) {
+            data.releaseNodes();
+        }
+    }
+
+    /**
+     * Obtains the usage of this index for the profile.
+     */
+    IndexStatistics getStatistics() const {
+        IndexStatistics statistics;
+        addStructureStatistics(statistics, data);
+        if (usage) {
+            statistics.lookups = usage->lookups;
+            statistics.emptyLookups = usage->emptyLookups;
+            statistics.fullRanges = usage->fullRanges;
+            statistics.scans = usage->scans;
+            statistics.tuples = usage->tuples;
+            statistics.lookupsCounted = true;
+        }
+        return statistics;
     }
 
     iterator begin() const {
@@ -245,6 +425,38 @@ public:
         }
     }
 
+    /**
+     * Merges the given index, which may have another order, into this index.
+     *
+     * The tuples are inserted in the order of this index, in up to the given
+     * number of chunks inserted in parallel. Each chunk covers a range of this
+     * index, so that consecutive insertions hit the hints of the previous one.
+     * Data structures merging their own kind directly do so instead.
+     */
+    void insertAll(const Index& src, std::size_t partitionCount) {
+        if constexpr (detail::has_insert_all<Data>::value) {
+            if (order == src.order) {
+                data.insertAll(src.data);
+            } else {
+                for (const auto& tuple : src.scan()) {
+                    insert(src.order.decode(tuple));
+                }
+            }
+        } else if (order == src.order) {
+            insertChunks(src.partitionScan(partitionCount));
+        } else {
+            std::vector<Tuple> tuples;
+            tuples.reserve(src.size());
+            for (const auto& tuple : src.scan()) {
+                tuples.push_back(order.encode(src.order.decode(tuple)));
+            }
+            std::sort(tuples.begin(), tuples.end(),
+                    [&](const Tuple& a, const Tuple& b) { return cmp.less(a, b); });
+            using vector_range = souffle::range<typename std::vector<Tuple>::const_iterator>;
+            insertChunks(vector_range(tuples.cbegin(), tuples.cend()).partition(partitionCount));
+        }
+    }
+
     /**
      * Tests whether the given tuple is present in this index or not.
      */
@@ -310,6 +522,17 @@ public:
     void clear() {
         data.clear();
     }
+
+protected:
+    /** Inserts sorted chunks of tuples encoded in the order of this index in parallel */
+    template <typename Iter>
+    void insertChunks(const std::vector<souffle::range<Iter>>& chunks) {
+        PARALLEL_START
+            pfor(auto it = chunks.begin(); it < chunks.end(); it++) {
+                data.insert(it->begin(), it->end());
+            }
+        PARALLEL_END
+    }
 };
 
 /**
@@ -320,6 +543,7 @@ template <template <std::size_t> typename Structure>
 class Index<0, Structure> {
 public:
     static constexpr std::size_t Arity = 0;
+    static constexpr bool stableTuples = false;
     using Tuple = typename souffle::Tuple<RamDomain, 0>;
 
 protected:
@@ -390,6 +614,14 @@ public:
         souffle::range<iterator> range(const Tuple& /* l */, const Tuple& /* h */) const {
             return {iterator(data), iterator()};
         }
+
+        bool seek(const RamDomain* /* l */, const RamDomain* /* h */, std::size_t /* column */,
+                RamDomain& /* value */) override {
+            // a nullary relation has no column to join
+            return false;
+        }
+
+        void countScan(std::size_t /* scanned */) {}
     };
 
 public:
@@ -397,6 +629,20 @@ public:
         return View(this->data);
     }
 
+    void enableStatistics() {}
+
+    void recycleNodes() {}
+
+    void interleaveNodes() {}
+
+    void releaseNodes() {}
+
+    IndexStatistics getStatistics() const {
+        IndexStatistics statistics;
+        statistics.size = size();
+        return statistics;
+    }
+
     Order getOrder() const {
         return Order({0});
     }
@@ -417,6 +663,10 @@ public:
         data = src.data;
     }
 
+    void insertAll(const Index& src, std::size_t /* partitionCount */) {
+        data = data || src.data;
+    }
+
     bool contains(const Tuple& /* t */) const {
         return data;
     }
@@ -491,4 +741,38 @@ public:
     }
 };
 
+/**
+ * A compressed index
+ */
+template <std::size_t _Arity>
+class CompressedIndex : public interpreter::Index<_Arity, Compressed> {
+public:
+    using Index<_Arity, Compressed>::Index;
+    using Index<_Arity, Compressed>::data;
+
+    /**
+     * Convert this index into its compact, read-only representation.
+     */
+    void compress() {
+        data.compress();
+    }
+};
+
+/**
+ * A btree index tested for membership by hashing
+ */
+template <std::size_t _Arity>
+class HashedIndex : public interpreter::Index<_Arity, Hashed> {
+public:
+    using Index<_Arity, Hashed>::Index;
+    using Index<_Arity, Hashed>::data;
+
+    /**
+     * Keep this index as a plain btree, its membership tests being left to another index.
+     */
+    void disableHashing() {
+        data.disableHashing();
+    }
+};
+
 }  // namespace souffle::interpreter
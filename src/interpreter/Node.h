@@ -25,6 +25,7 @@
 
 #include "interpreter/Util.h"
 #include "ram/Relation.h"
+#include "souffle/BinaryConstraintOps.h"
 #include "souffle/RamTypes.h"
 #include "souffle/utility/ContainerUtil.h"
 #include "souffle/utility/MiscUtil.h"
@@ -37,6 +38,7 @@
 #include <cassert>
 #include <cstddef>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -81,6 +83,7 @@ struct RelationWrapper;
     FOR_EACH(Expand, ParallelScan)\
     FOR_EACH(Expand, IndexScan)\
     FOR_EACH(Expand, ParallelIndexScan)\
+    FOR_EACH(Expand, LeapfrogJoin)\
     FOR_EACH(Expand, IfExists)\
     FOR_EACH(Expand, ParallelIfExists)\
     FOR_EACH(Expand, IndexIfExists)\
@@ -104,10 +107,12 @@ struct RelationWrapper;
     Forward(LogTimer)\
     Forward(DebugInfo)\
     FOR_EACH(Expand, Clear)\
+    FOR_EACH_COMPRESSED(Expand, Compress)\
     FOR_EACH(Expand, CountUniqueKeys)\
     Forward(LogSize)\
     Forward(IO)\
     Forward(Query)\
+    Forward(Merge)\
     Forward(MergeExtend)\
     Forward(Swap)\
     Forward(Call)
@@ -140,7 +145,7 @@ enum NodeType {
  * Add reflective from string to NodeType.
  */
 inline NodeType constructNodeType(std::string tokBase, const ram::Relation& rel) {
-    static bool isProvenance = Global::config().has("provenance");
+    const bool isProvenance = Global::config().has("provenance");
 
     static const std::unordered_map<std::string, NodeType> map = {
             FOR_EACH_INTERPRETER_TOKEN(SINGLE_TOKEN_ENTRY, EXPAND_TOKEN_ENTRY)
@@ -151,6 +156,10 @@ inline NodeType constructNodeType(std::string tokBase, const ram::Relation& rel)
         return map.at("I_" + tokBase + "_Eqrel_" + arity);
     } else if(rel.getRepresentation() == RelationRepresentation::BTREE_DELETE) { 
         return map.at("I_" + tokBase + "_BtreeDelete_" + arity);
+    } else if (rel.getRepresentation() == RelationRepresentation::COMPRESSED) {
+        return map.at("I_" + tokBase + "_Compressed_" + arity);
+    } else if (rel.getRepresentation() == RelationRepresentation::HASH) {
+        return map.at("I_" + tokBase + "_Hashed_" + arity);
     } else if (isProvenance) {
         return map.at("I_" + tokBase + "_Provenance_" + arity);
     } else  {
@@ -347,7 +356,7 @@ protected:
 /**
  * @class BinRelOperation
  * @brief  operation that involves with two relations should inherit from this class.
- *        E.g. Swap, MergeExtend
+ *        E.g. Swap, Merge, MergeExtend
  */
 class BinRelOperation {
 public:
@@ -629,6 +638,44 @@ class TupleOperation : public UnaryNode {
     using UnaryNode::UnaryNode;
 };
 
+/**
+ * @class Batch
+ * @brief The nested operation of a scan, split for the evaluation over blocks of tuples.
+ *        The conditions of the directly nested filters are tested for all tuples of a
+ *        block in turn, and the operation nested in them is executed for the tuples passing
+ *        all of them. The tuples are sorted by the key elements, the elements of the scanned
+ *        tuple probing the next relation in the order of its index: the relation of an
+ *        existence check in a condition, or the one searched by the nested operation.
+ */
+class Batch {
+public:
+    /**
+     * @brief A condition comparing an element of the scanned tuple with a value that is the
+     *        same for all tuples of a block, a constant or an element of an outer tuple
+     */
+    struct Comparison {
+        /** @brief operator, with the element of the scanned tuple on its left */
+        BinaryConstraintOp op;
+        /** @brief element of the scanned tuple */
+        std::size_t element;
+        /** @brief value compared with, evaluated once per block */
+        const Node* value;
+    };
+
+    /** @brief conditions of the directly nested filters, with conjunctions split into their terms */
+    std::vector<const Node*> conditions;
+    /** @brief for each condition, the comparison tested over a block without dispatching its nodes */
+    std::vector<std::optional<Comparison>> comparisons;
+    /** @brief operation nested in the filters */
+    const Node* operation = nullptr;
+    /** @brief nested operation of the scan, executed tuple by tuple for ranges too short for a block */
+    const Node* nested = nullptr;
+    /** @brief key elements, empty if the order of the tuples must be kept */
+    std::vector<std::size_t> keys;
+    /** @brief number of conditions tested before the tuples are sorted */
+    std::size_t sortAfter = 0;
+};
+
 /**
  * @class Scan
  */
@@ -636,6 +683,19 @@ class Scan : public Node, public NestedOperation, public RelationalOperation {
 public:
     Scan(enum NodeType ty, const ram::Node* sdw, RelationHandle* relHandle, Own<Node> nested)
             : Node(ty, sdw), NestedOperation(std::move(nested)), RelationalOperation(relHandle) {}
+
+    /** @brief get the nested operation split for batch evaluation */
+    inline const Batch& getBatch() const {
+        return batch;
+    }
+
+    /** @brief set the nested operation split for batch evaluation */
+    inline void setBatch(Batch b) {
+        batch = std::move(b);
+    }
+
+protected:
+    Batch batch;
 };
 
 /**
@@ -664,6 +724,38 @@ public:
     using IndexScan::IndexScan;
 };
 
+/**
+ * @class LeapfrogJoin
+ */
+class LeapfrogJoin : public IndexScan {
+public:
+    /** A relation whose values of a column are intersected with the join column */
+    struct JoinFilter {
+        std::size_t viewId;
+        SuperInstruction superInst;
+        /** The joined column, in the order of the index */
+        std::size_t column;
+    };
+
+    LeapfrogJoin(enum NodeType ty, const ram::Node* sdw, Own<Node> nested, std::size_t viewId,
+            SuperInstruction superInst, std::size_t column, std::vector<JoinFilter> filters)
+            : IndexScan(ty, sdw, nullptr, std::move(nested), viewId, std::move(superInst)), column(column),
+              filters(std::move(filters)) {}
+
+    /** @brief get join column, in the order of the index */
+    std::size_t getColumn() const {
+        return column;
+    }
+
+    const std::vector<JoinFilter>& getFilters() const {
+        return filters;
+    }
+
+private:
+    const std::size_t column;
+    const std::vector<JoinFilter> filters;
+};
+
 /**
  * @class IfExists
  */
@@ -874,7 +966,24 @@ class DebugInfo : public UnaryNode {
  */
 class Clear : public Node, public RelationalOperation {
 public:
-    Clear(enum NodeType ty, const ram::Node* sdw, RelationHandle* handle)
+    Clear(enum NodeType ty, const ram::Node* sdw, RelationHandle* handle, bool releasing)
+            : Node(ty, sdw), RelationalOperation(handle), releasing(releasing) {}
+
+    /** Whether the memory kept for recycled nodes is returned, outside of loops */
+    bool isReleasing() const {
+        return releasing;
+    }
+
+private:
+    const bool releasing;
+};
+
+/**
+ * @class Compress
+ */
+class Compress : public Node, public RelationalOperation {
+public:
+    Compress(enum NodeType ty, const ram::Node* sdw, RelationHandle* handle)
             : Node(ty, sdw), RelationalOperation(handle) {}
 };
 
@@ -928,6 +1037,15 @@ class Query : public UnaryNode, public AbstractParallel {
     using UnaryNode::UnaryNode;
 };
 
+/**
+ * @class Merge
+ */
+class Merge : public Node, public BinRelOperation {
+public:
+    Merge(enum NodeType ty, const ram::Node* sdw, std::size_t src, std::size_t target)
+            : Node(ty, sdw), BinRelOperation(src, target) {}
+};
+
 /**
  * @class MergeExtend
  */
@@ -28,11 +28,16 @@
 #include "souffle/RamTypes.h"
 #include "souffle/SouffleInterface.h"
 #include "souffle/SymbolTable.h"
+#include "souffle/io/IOSystem.h"
+#include "souffle/utility/FunctionalUtil.h"
 #include "souffle/utility/MiscUtil.h"
+#include "souffle/utility/json11.h"
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
 #include <iosfwd>
+#include <iostream>
 #include <map>
 #include <memory>
 #include <string>
@@ -207,8 +212,22 @@ public:
     explicit ProgInterface(Engine& interp)
             : prog(interp.getTranslationUnit().getProgram()), exec(interp), symTable(interp.getSymbolTable()),
               recordTable(interp.getRecordTable()) {
+        // relations are created along with the node tree, which may not exist yet
+        exec.loadDLL();
+        exec.generateIR();
+
         std::size_t id = 0;
 
+        // Retrieve fact input and output statements
+        visit(prog, [&](const ram::IO& io) {
+            const std::string& op = io.get("operation");
+            if (op == "input") {
+                loadIOs.push_back(&io);
+            } else if (op == "output" || op == "printsize") {
+                storeIOs.push_back(&io);
+            }
+        });
+
         // Retrieve AST Relations and store them in a map
         std::map<std::string, const ram::Relation*> map;
         visit(prog, [&](const ram::Relation& rel) { map[rel.getName()] = &rel; });
@@ -230,21 +249,11 @@ public:
 
             auto* interface = new RelInterface(interpreterRel, symTable, rel.getName(), types, attrNames, id);
             interfaces.push_back(interface);
-            bool input = false;
-            bool output = false;
-            visit(prog, [&](const ram::IO& io) {
-                if (map[io.getRelation()] == &rel) {
-                    const std::string& op = io.get("operation");
-                    if (op == "input") {
-                        input = true;
-                    } else if (op == "output" || op == "printsize") {
-                        output = true;
-                    } else {
-                        assert("wrong i/o operation");
-                    }
-                }
-            });
+            auto isRel = [&](const ram::IO* io) { return io->getRelation() == name; };
+            bool input = any_of(loadIOs, isRel);
+            bool output = any_of(storeIOs, isRel);
             addRelation(rel.getName(), *interface, input, output);
+            relationMap[name] = &interpreterRel;
             id++;
         }
     }
@@ -254,23 +263,66 @@ public:
         }
     }
 
-    /** Run program instance: not implemented */
-    void run() override {}
+    /** Run program instance without fact input and output */
+    void run() override {
+        exec.executeMain("", "", false, false);
+    }
 
-    /** Load data, run program instance, store data: not implemented */
-    void runAll(std::string, std::string, bool, bool) override {}
+    /** Load data, run program instance, store data */
+    void runAll(std::string inputDirectory, std::string outputDirectory, bool performIO,
+            bool pruneImdtRels) override {
+        exec.executeMain(std::move(inputDirectory), std::move(outputDirectory), performIO, pruneImdtRels);
+    }
 
-    /** Load input data: not implemented */
-    void loadAll(std::string) override {}
+    /** Load input data */
+    void loadAll(std::string inputDirectory) override {
+        for (const auto* io : loadIOs) {
+            auto directive = io->getDirectives();
+            if (!inputDirectory.empty()) {
+                directive["fact-dir"] = inputDirectory;
+            }
+            auto& rel = *relationMap.at(io->getRelation());
+            try {
+                IOSystem::getInstance().getReader(directive, symTable, recordTable)->readAll(rel);
+            } catch (std::exception& e) {
+                std::string message = "Error loading " + io->getRelation() + " data: " + e.what() + "\n";
+                if (exec.throwOnErrors) {
+                    exec.fail(message);
+                }
+                std::cerr << message;
+            }
+        }
+    }
 
-    /** Print output data: not implemented */
-    void printAll(std::string) override {}
+    /** Print output data */
+    void printAll(std::string outputDirectory) override {
+        for (const auto* io : storeIOs) {
+            auto directive = io->getDirectives();
+            if (!outputDirectory.empty()) {
+                directive["output-dir"] = outputDirectory;
+            }
+            auto& rel = *relationMap.at(io->getRelation());
+            try {
+                IOSystem::getInstance().getWriter(directive, symTable, recordTable)->writeAll(rel);
+            } catch (std::exception& e) {
+                exec.fail(e.what());
+            }
+        }
+    }
 
-    /** Dump inputs: not implemented */
-    void dumpInputs() override {}
+    /** Dump inputs */
+    void dumpInputs() override {
+        for (const auto* io : loadIOs) {
+            dumpRelation(io->getRelation());
+        }
+    }
 
-    /** Dump outputs: not implemented */
-    void dumpOutputs() override {}
+    /** Dump outputs */
+    void dumpOutputs() override {
+        for (const auto* io : storeIOs) {
+            dumpRelation(io->getRelation());
+        }
+    }
 
     /** Run subroutine */
     void executeSubroutine(
@@ -288,11 +340,41 @@ public:
     }
 
 private:
+    /** Write the named relation to stdout */
+    void dumpRelation(const std::string& name) {
+        const souffle::Relation* rel = getRelation(name);
+        std::vector<std::string> types;
+        for (std::size_t i = 0; i < rel->getArity(); i++) {
+            types.push_back(rel->getAttrType(i));
+        }
+        json11::Json relJson = json11::Json::object{{"arity", static_cast<long long>(types.size())},
+                {"auxArity", static_cast<long long>(0)},
+                {"types", json11::Json::array(types.begin(), types.end())}};
+
+        std::map<std::string, std::string> rwOperation;
+        rwOperation["IO"] = "stdout";
+        rwOperation["name"] = name;
+        rwOperation["types"] = json11::Json(json11::Json::object{{"relation", relJson}}).dump();
+        try {
+            IOSystem::getInstance()
+                    .getWriter(rwOperation, symTable, recordTable)
+                    ->writeAll(*relationMap.at(name));
+        } catch (std::exception& e) {
+            exec.fail(e.what());
+        }
+    }
+
     const ram::Program& prog;
     Engine& exec;
     SymbolTable& symTable;
     RecordTable& recordTable;
     std::vector<RelInterface*> interfaces;
+    /** Interpreter relations by name */
+    std::map<std::string, RelationWrapper*> relationMap;
+    /** Statements reading input relations */
+    std::vector<const ram::IO*> loadIOs;
+    /** Statements writing output relations */
+    std::vector<const ram::IO*> storeIOs;
 };
 
 }  // namespace souffle::interpreter
@@ -20,6 +20,7 @@
 #include "ram/analysis/Index.h"
 #include "souffle/RamTypes.h"
 #include "souffle/SouffleInterface.h"
+#include "souffle/profile/IndexStatistics.h"
 #include "souffle/utility/MiscUtil.h"
 #include <cstddef>
 #include <cstdint>
@@ -141,6 +142,39 @@ public:
      */
     virtual IndexViewPtr createView(const std::size_t&) const = 0;
 
+    /**
+     * Add all tuples of a relation with the same arity and representation,
+     * merging the indexes one by one.
+     */
+    virtual void merge(const RelationWrapper& source, std::size_t partitionCount) = 0;
+
+    /**
+     * Return the number of indexes.
+     */
+    virtual std::size_t getNumIndexes() const = 0;
+
+    /**
+     * Count the lookups of the indexes of this relation for the profile.
+     */
+    virtual void enableIndexStatistics() = 0;
+
+    /**
+     * Return the usage of an index for the profile.
+     */
+    virtual IndexStatistics getIndexStatistics(std::size_t) const = 0;
+
+    /**
+     * Keep the nodes of the indexes across purges, for temporary relations
+     * filled and purged in every iteration.
+     */
+    virtual void recycleNodes() = 0;
+
+    /**
+     * Spread the nodes of the indexes over the NUMA nodes, for relations read
+     * by the threads of all nodes.
+     */
+    virtual void interleaveNodes() = 0;
+
 protected:
     std::string relName;
 
@@ -158,6 +192,7 @@ public:
     using Attribute = std::size_t;
     using AttributeSet = std::set<Attribute>;
     using Index = interpreter::Index<Arity, Structure>;
+    static constexpr bool stableTuples = Index::stableTuples;
     using Tuple = souffle::Tuple<RamDomain, Arity>;
     using View = typename Index::View;
     using iterator = typename Index::iterator;
@@ -233,6 +268,47 @@ public:
         return indexes[idx]->getOrder();
     }
 
+    void merge(const RelationWrapper& source, std::size_t partitionCount) override {
+        const auto& other = static_cast<const Relation&>(source);
+        for (auto& index : indexes) {
+            // prefer an index of the source that is already sorted in the same order
+            const Index* from = other.main;
+            for (const auto& candidate : other.indexes) {
+                if (candidate->getOrder() == index->getOrder()) {
+                    from = candidate.get();
+                    break;
+                }
+            }
+            index->insertAll(*from, partitionCount);
+        }
+    }
+
+    std::size_t getNumIndexes() const override {
+        return indexes.size();
+    }
+
+    void enableIndexStatistics() override {
+        for (auto& index : indexes) {
+            index->enableStatistics();
+        }
+    }
+
+    IndexStatistics getIndexStatistics(std::size_t idx) const override {
+        return indexes[idx]->getStatistics();
+    }
+
+    void recycleNodes() override {
+        for (auto& index : indexes) {
+            index->recycleNodes();
+        }
+    }
+
+    void interleaveNodes() override {
+        for (auto& index : indexes) {
+            index->interleaveNodes();
+        }
+    }
+
     class iterator_base : public RelationWrapper::iterator_base {
         iterator iter;
         Order order;
@@ -381,6 +457,16 @@ public:
         }
     }
 
+    /**
+     * Clear all indexes, and return the memory they keep for recycled nodes
+     */
+    void __release() {
+        for (auto& idx : indexes) {
+            idx->clear();
+            idx->releaseNodes();
+        }
+    }
+
     /**
      * Check if a tuple exists in relation
      */
@@ -426,6 +512,39 @@ public:
     }
 };
 
+template <std::size_t _Arity>
+class CompressedRelation : public Relation<_Arity, Compressed> {
+public:
+    using Relation<_Arity, Compressed>::Relation;
+    using Relation<_Arity, Compressed>::indexes;
+
+    /**
+     * Compress all indexes of this relation, once it is complete.
+     */
+    void compress() {
+        for (auto& index : indexes) {
+            static_cast<CompressedIndex<_Arity>*>(index.get())->compress();
+        }
+    }
+};
+
+template <std::size_t _Arity>
+class HashedRelation : public Relation<_Arity, Hashed> {
+public:
+    using Relation<_Arity, Hashed>::indexes;
+
+    /**
+     * Only the main index, which is given all existence checks on full tuples, is hashed.
+     */
+    HashedRelation(std::size_t auxiliaryArity, const std::string& name,
+            const ram::analysis::IndexCluster& indexSelection)
+            : Relation<_Arity, Hashed>(auxiliaryArity, name, indexSelection) {
+        for (std::size_t i = 1; i < indexes.size(); ++i) {
+            static_cast<HashedIndex<_Arity>*>(indexes[i].get())->disableHashing();
+        }
+    }
+};
+
 class EqrelRelation : public Relation<2, Eqrel> {
 public:
     using Relation<2, Eqrel>::Relation;
@@ -451,6 +570,14 @@ Own<RelationWrapper> createBTreeRelation(
 Own<RelationWrapper> createBTreeDeleteRelation(
         const ram::Relation& id, const ram::analysis::IndexCluster& indexSelection);
 
+// A factory for compressed BTree based relation.
+Own<RelationWrapper> createCompressedRelation(
+        const ram::Relation& id, const ram::analysis::IndexCluster& indexSelection);
+
+// A factory for hashed BTree based relation.
+Own<RelationWrapper> createHashedRelation(
+        const ram::Relation& id, const ram::analysis::IndexCluster& indexSelection);
+
 // A factory for BTree provenance index.
 Own<RelationWrapper> createProvenanceRelation(
         const ram::Relation& id, const ram::analysis::IndexCluster& indexSelection);
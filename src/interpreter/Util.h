@@ -20,7 +20,9 @@
 #include "souffle/datastructure/BTree.h"
 #include "souffle/datastructure/BTreeDelete.h"
 #include "souffle/datastructure/Brie.h"
+#include "souffle/datastructure/CompressedBTree.h"
 #include "souffle/datastructure/EquivalenceRelation.h"
+#include "souffle/datastructure/HashedBTree.h"
 #include "souffle/utility/ContainerUtil.h"
 #include "souffle/utility/MiscUtil.h"
 
@@ -104,6 +106,50 @@ namespace souffle::interpreter {
     func(BtreeDelete, 19, __VA_ARGS__) \
     func(BtreeDelete, 20, __VA_ARGS__)
 
+#define FOR_EACH_COMPRESSED(func, ...)\
+    func(Compressed, 1, __VA_ARGS__) \
+    func(Compressed, 2, __VA_ARGS__) \
+    func(Compressed, 3, __VA_ARGS__) \
+    func(Compressed, 4, __VA_ARGS__) \
+    func(Compressed, 5, __VA_ARGS__) \
+    func(Compressed, 6, __VA_ARGS__) \
+    func(Compressed, 7, __VA_ARGS__) \
+    func(Compressed, 8, __VA_ARGS__) \
+    func(Compressed, 9, __VA_ARGS__) \
+    func(Compressed, 10, __VA_ARGS__) \
+    func(Compressed, 11, __VA_ARGS__) \
+    func(Compressed, 12, __VA_ARGS__) \
+    func(Compressed, 13, __VA_ARGS__) \
+    func(Compressed, 14, __VA_ARGS__) \
+    func(Compressed, 15, __VA_ARGS__) \
+    func(Compressed, 16, __VA_ARGS__) \
+    func(Compressed, 17, __VA_ARGS__) \
+    func(Compressed, 18, __VA_ARGS__) \
+    func(Compressed, 19, __VA_ARGS__) \
+    func(Compressed, 20, __VA_ARGS__)
+
+#define FOR_EACH_HASHED(func, ...)\
+    func(Hashed, 1, __VA_ARGS__) \
+    func(Hashed, 2, __VA_ARGS__) \
+    func(Hashed, 3, __VA_ARGS__) \
+    func(Hashed, 4, __VA_ARGS__) \
+    func(Hashed, 5, __VA_ARGS__) \
+    func(Hashed, 6, __VA_ARGS__) \
+    func(Hashed, 7, __VA_ARGS__) \
+    func(Hashed, 8, __VA_ARGS__) \
+    func(Hashed, 9, __VA_ARGS__) \
+    func(Hashed, 10, __VA_ARGS__) \
+    func(Hashed, 11, __VA_ARGS__) \
+    func(Hashed, 12, __VA_ARGS__) \
+    func(Hashed, 13, __VA_ARGS__) \
+    func(Hashed, 14, __VA_ARGS__) \
+    func(Hashed, 15, __VA_ARGS__) \
+    func(Hashed, 16, __VA_ARGS__) \
+    func(Hashed, 17, __VA_ARGS__) \
+    func(Hashed, 18, __VA_ARGS__) \
+    func(Hashed, 19, __VA_ARGS__) \
+    func(Hashed, 20, __VA_ARGS__)
+
 // Brie is disabled for now.
 #define FOR_EACH_BRIE(func, ...)
     /* func(Brie, 0, __VA_ARGS__) \ */
@@ -134,6 +180,8 @@ namespace souffle::interpreter {
 #define FOR_EACH(func, ...)                 \
     FOR_EACH_BTREE(func, __VA_ARGS__)       \
     FOR_EACH_BTREE_DELETE(func, __VA_ARGS__)       \
+    FOR_EACH_COMPRESSED(func, __VA_ARGS__)       \
+    FOR_EACH_HASHED(func, __VA_ARGS__)       \
     FOR_EACH_BRIE(func, __VA_ARGS__)        \
     FOR_EACH_PROVENANCE(func, __VA_ARGS__)  \
     FOR_EACH_EQREL(func, __VA_ARGS__)
@@ -152,6 +200,9 @@ struct comparator;
 
 template <unsigned First, unsigned... Rest>
 struct comparator<First, Rest...> {
+    // the column compared first, searched by the vectorized b-tree search
+    static constexpr std::size_t leading_column = First;
+
     template <typename T>
     int operator()(const T& a, const T& b) const {
         return (a[First] < b[First]) ? -1 : ((a[First] > b[First]) ? 1 : comparator<Rest...>()(a, b));
@@ -252,6 +303,14 @@ using Btree = btree_set<t_tuple<Arity>, comparator<Arity>>;
 template <std::size_t Arity>
 using BtreeDelete = btree_delete_set<t_tuple<Arity>, comparator<Arity>>;
 
+// Alias for compressed_btree_set
+template <std::size_t Arity>
+using Compressed = compressed_btree_set<t_tuple<Arity>, comparator<Arity>>;
+
+// Alias for hashed_btree_set
+template <std::size_t Arity>
+using Hashed = hashed_btree_set<t_tuple<Arity>, comparator<Arity>>;
+
 // Alias for Trie
 template <std::size_t Arity>
 using Brie = Trie<Arity>;
@@ -0,0 +1,156 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2022, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file interpreter_library_test.cpp
+ *
+ * Tests programs compiled in-process with compileProgram.
+ *
+ ***********************************************************************/
+
+#include "tests/test.h"
+
+#include "Compiler.h"
+#include "Global.h"
+#include "souffle/RamTypes.h"
+#include "souffle/SouffleInterface.h"
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace souffle::interpreter::test {
+
+const std::string reachability = R"(
+    .decl edge(x:number, y:number)
+    .input edge
+    .decl path(x:number, y:number)
+    .output path
+    path(x, y) :- edge(x, y).
+    path(x, z) :- path(x, y), edge(y, z).
+)";
+
+void insertEdge(SouffleProgram& prog, RamSigned x, RamSigned y) {
+    souffle::Relation* edge = prog.getRelation("edge");
+    tuple t(edge);
+    t << x << y;
+    edge->insert(t);
+}
+
+bool hasPath(SouffleProgram& prog, RamSigned x, RamSigned y) {
+    souffle::Relation* path = prog.getRelation("path");
+    tuple t(path);
+    t << x << y;
+    return path->contains(t);
+}
+
+TEST(CompileProgram, Run) {
+    auto prog = compileProgram(reachability);
+    ASSERT_TRUE(prog->getRelation("edge") != nullptr);
+    ASSERT_TRUE(prog->getRelation("path") != nullptr);
+
+    insertEdge(*prog, 1, 2);
+    insertEdge(*prog, 2, 3);
+    prog->run();
+
+    EXPECT_EQ(3, prog->getRelation("path")->size());
+    EXPECT_TRUE(hasPath(*prog, 1, 3));
+}
+
+TEST(CompileProgram, RunRepeatedly) {
+    auto prog = compileProgram(reachability);
+
+    for (RamSigned n = 2; n < 10; ++n) {
+        prog->purgeInputRelations();
+        prog->purgeInternalRelations();
+        prog->purgeOutputRelations();
+
+        // a chain of n nodes has n * (n - 1) / 2 paths
+        for (RamSigned i = 1; i < n; ++i) {
+            insertEdge(*prog, i, i + 1);
+        }
+        prog->run();
+
+        EXPECT_EQ(std::size_t(n * (n - 1) / 2), prog->getRelation("path")->size());
+        EXPECT_TRUE(hasPath(*prog, 1, n));
+        EXPECT_FALSE(hasPath(*prog, 1, n + 1));
+    }
+}
+
+TEST(CompileProgram, Errors) {
+    bool thrown = false;
+    try {
+        compileProgram(".decl a(x:number)\n a(x) :- b(x).\n");
+    } catch (std::runtime_error& e) {
+        thrown = true;
+        EXPECT_TRUE(std::string(e.what()).find("b") != std::string::npos);
+    }
+    EXPECT_TRUE(thrown);
+}
+
+bool rejects(const std::string& source, const std::map<std::string, std::string>& options = {}) {
+    try {
+        compileProgram(source, options);
+    } catch (std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+TEST(CompileProgram, InvalidOptions) {
+    EXPECT_TRUE(rejects(reachability, {{"batch", "x"}}));
+    EXPECT_TRUE(rejects(reachability, {{"memory-limit", "lots"}}));
+    // options set by pragmas are checked as well
+    EXPECT_TRUE(rejects(".pragma \"batch\" \"0\"\n" + reachability));
+    EXPECT_FALSE(rejects(reachability, {{"batch", "16"}}));
+}
+
+TEST(CompileProgram, ScopedOptions) {
+    auto batched = compileProgram(reachability, {{"batch", "4"}, {"jobs", "2"}});
+    EXPECT_FALSE(Global::config().has("batch"));
+
+    // the options of one program do not carry over into the next
+    auto plain = compileProgram(".pragma \"jobs\" \"3\"\n" + reachability);
+    EXPECT_FALSE(Global::config().has("jobs", "3"));
+
+    for (auto* prog : {batched.get(), plain.get()}) {
+        insertEdge(*prog, 1, 2);
+        insertEdge(*prog, 2, 3);
+        prog->run();
+        EXPECT_EQ(3, prog->getRelation("path")->size());
+    }
+}
+
+TEST(CompileProgram, InputErrors) {
+    auto prog = compileProgram(R"(
+        .decl a(x:number)
+        .input a(filename="/nonexistent/a.facts")
+        .decl b(x:number)
+        b(x) :- a(x).
+    )");
+
+    bool thrown = false;
+    try {
+        prog->loadAll();
+    } catch (std::runtime_error& e) {
+        thrown = true;
+        EXPECT_TRUE(std::string(e.what()).find("Error loading a data") != std::string::npos);
+    }
+    EXPECT_TRUE(thrown);
+
+    thrown = false;
+    try {
+        prog->runAll("", "", true);
+    } catch (std::runtime_error&) {
+        thrown = true;
+    }
+    EXPECT_TRUE(thrown);
+}
+
+}  // namespace souffle::interpreter::test
@@ -287,4 +287,86 @@ TEST(Reordering, Iteration) {
     }
 }
 
+TEST(Merge, Orders) {
+    // the source has a single index, the target one of the same and one of another order
+    SignatureOrderMap mapping;
+    SearchSet searches;
+    LexOrder order = {0, 1};
+    LexOrder reversed = {1, 0};
+    IndexCluster sourceSelection(mapping, searches, {order});
+    IndexCluster targetSelection(mapping, searches, {order, reversed});
+
+    Relation<2, interpreter::Btree> source(0, "source", sourceSelection);
+    Relation<2, interpreter::Btree> target(0, "target", targetSelection);
+    for (RamDomain i = 0; i < 1000; ++i) {
+        source.insert(souffle::Tuple<RamDomain, 2>{i % 7, i});
+        if (i % 3 == 0) {
+            target.insert(souffle::Tuple<RamDomain, 2>{i % 7, i});
+        }
+    }
+    target.insert(souffle::Tuple<RamDomain, 2>{-1, -1});
+
+    target.merge(source, 4);
+    EXPECT_EQ(1001, target.size());
+    EXPECT_EQ(1001, target.getIndex(1)->size());
+    for (RamDomain i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(target.contains(souffle::Tuple<RamDomain, 2>{i % 7, i}));
+    }
+
+    // the index of the other order is sorted by its first column
+    RamDomain last = -1;
+    for (const auto& tuple : target.getIndex(1)->scan()) {
+        EXPECT_TRUE(last <= tuple[0]);
+        last = tuple[0];
+    }
+}
+
+TEST(Merge, Brie) {
+    SignatureOrderMap mapping;
+    SearchSet searches;
+    IndexCluster indexSelection(mapping, searches, {LexOrder{0, 1}});
+
+    Relation<2, interpreter::Brie> source(0, "source", indexSelection);
+    Relation<2, interpreter::Brie> target(0, "target", indexSelection);
+    for (RamDomain i = 0; i < 100; ++i) {
+        source.insert(souffle::Tuple<RamDomain, 2>{i, i + 1});
+        target.insert(souffle::Tuple<RamDomain, 2>{i + 1, i});
+    }
+
+    target.merge(source, 4);
+    EXPECT_EQ(200, target.size());
+    EXPECT_TRUE(target.contains(souffle::Tuple<RamDomain, 2>{0, 1}));
+    EXPECT_TRUE(target.contains(souffle::Tuple<RamDomain, 2>{1, 0}));
+}
+
+TEST(Merge, Hashed) {
+    SignatureOrderMap mapping;
+    SearchSet searches;
+    IndexCluster indexSelection(mapping, searches, {LexOrder{0, 1}, LexOrder{1, 0}});
+
+    HashedRelation<2> source(0, "source", indexSelection);
+    HashedRelation<2> target(0, "target", indexSelection);
+    for (RamDomain i = 0; i < 1000; ++i) {
+        source.insert(souffle::Tuple<RamDomain, 2>{i % 7, i});
+        if (i % 3 == 0) {
+            target.insert(souffle::Tuple<RamDomain, 2>{i % 7, i});
+        }
+    }
+
+    target.merge(source, 4);
+    EXPECT_EQ(1000, target.size());
+    EXPECT_EQ(1000, target.getIndex(1)->size());
+    for (RamDomain i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(target.contains(souffle::Tuple<RamDomain, 2>{i % 7, i}));
+    }
+    EXPECT_FALSE(target.contains(souffle::Tuple<RamDomain, 2>{1, 0}));
+
+    // the index of the other order is sorted by its first column
+    RamDomain last = -1;
+    for (const auto& tuple : target.getIndex(1)->scan()) {
+        EXPECT_TRUE(last < tuple[0]);
+        last = tuple[0];
+    }
+}
+
 }  // namespace souffle::interpreter::test
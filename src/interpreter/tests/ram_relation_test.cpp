@@ -44,6 +44,7 @@
 #include <map>
 #include <memory>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <utility>
 #include <vector>
@@ -618,4 +619,27 @@ meow	-3	3	0.5
     std::cin.rdbuf(backupCin);
 }
 
+TEST(Engine, InvalidBatch) {
+    // the engine checks the batch size itself, as pragmas and library callers bypass the driver
+    Global::config().set("batch", "x");
+
+    VecOwn<ram::Relation> rels;
+    std::map<std::string, Own<Statement>> subs;
+    Own<ram::Program> prog = mk<Program>(std::move(rels), mk<ram::Sequence>(), std::move(subs));
+
+    ErrorReport errReport;
+    DebugReport debugReport;
+
+    TranslationUnit translationUnit(std::move(prog), errReport, debugReport);
+
+    bool thrown = false;
+    try {
+        Engine interpreter(translationUnit);
+    } catch (std::runtime_error&) {
+        thrown = true;
+    }
+    Global::config().unset("batch");
+    EXPECT_TRUE(thrown);
+}
+
 }  // namespace souffle::interpreter::test
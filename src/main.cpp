@@ -14,6 +14,7 @@
  *
  ***********************************************************************/
 
+#include "Compiler.h"
 #include "Global.h"
 #include "ast/Clause.h"
 #include "ast/Node.h"
@@ -22,48 +23,7 @@
 #include "ast/analysis/PrecedenceGraph.h"
 #include "ast/analysis/SCCGraph.h"
 #include "ast/analysis/typesystem/Type.h"
-#include "ast/transform/AddNullariesToAtomlessAggregates.h"
-#include "ast/transform/ComponentChecker.h"
-#include "ast/transform/ComponentInstantiation.h"
-#include "ast/transform/Conditional.h"
-#include "ast/transform/ExecutionPlanChecker.h"
-#include "ast/transform/ExpandEqrels.h"
-#include "ast/transform/Fixpoint.h"
-#include "ast/transform/FoldAnonymousRecords.h"
-#include "ast/transform/GroundWitnesses.h"
-#include "ast/transform/GroundedTermsChecker.h"
-#include "ast/transform/IOAttributes.h"
-#include "ast/transform/IODefaults.h"
-#include "ast/transform/InlineRelations.h"
-#include "ast/transform/MagicSet.h"
-#include "ast/transform/MaterializeAggregationQueries.h"
-#include "ast/transform/MaterializeSingletonAggregation.h"
-#include "ast/transform/MinimiseProgram.h"
-#include "ast/transform/NameUnnamedVariables.h"
-#include "ast/transform/NormaliseGenerators.h"
-#include "ast/transform/PartitionBodyLiterals.h"
-#include "ast/transform/Pipeline.h"
 #include "ast/transform/PragmaChecker.h"
-#include "ast/transform/ReduceExistentials.h"
-#include "ast/transform/RemoveBooleanConstraints.h"
-#include "ast/transform/RemoveEmptyRelations.h"
-#include "ast/transform/RemoveRedundantRelations.h"
-#include "ast/transform/RemoveRedundantSums.h"
-#include "ast/transform/RemoveRelationCopies.h"
-#include "ast/transform/ReplaceSingletonVariables.h"
-#include "ast/transform/ResolveAliases.h"
-#include "ast/transform/ResolveAnonymousRecordAliases.h"
-#include "ast/transform/SemanticChecker.h"
-#include "ast/transform/SimplifyAggregateTargetExpression.h"
-#include "ast/transform/SubsumptionQualifier.h"
-#include "ast/transform/UniqueAggregationVariables.h"
-#include "ast2ram/TranslationStrategy.h"
-#include "ast2ram/UnitTranslator.h"
-#include "ast2ram/provenance/TranslationStrategy.h"
-#include "ast2ram/provenance/UnitTranslator.h"
-#include "ast2ram/seminaive/TranslationStrategy.h"
-#include "ast2ram/seminaive/UnitTranslator.h"
-#include "ast2ram/utility/TranslatorContext.h"
 #include "config.h"
 #include "interpreter/Engine.h"
 #include "interpreter/ProgInterface.h"
@@ -71,25 +31,9 @@
 #include "ram/Node.h"
 #include "ram/Program.h"
 #include "ram/TranslationUnit.h"
-#include "ram/transform/CollapseFilters.h"
-#include "ram/transform/Conditional.h"
-#include "ram/transform/EliminateDuplicates.h"
-#include "ram/transform/ExpandFilter.h"
-#include "ram/transform/HoistAggregate.h"
-#include "ram/transform/HoistConditions.h"
-#include "ram/transform/IfConversion.h"
-#include "ram/transform/IfExistsConversion.h"
-#include "ram/transform/Loop.h"
-#include "ram/transform/MakeIndex.h"
-#include "ram/transform/Parallel.h"
-#include "ram/transform/ReorderConditions.h"
-#include "ram/transform/ReorderFilterBreak.h"
-#include "ram/transform/ReportIndex.h"
-#include "ram/transform/Sequence.h"
-#include "ram/transform/Transformer.h"
-#include "ram/transform/TupleId.h"
 #include "reports/DebugReport.h"
 #include "reports/ErrorReport.h"
+#include "reports/PassTimes.h"
 #include "souffle/RamTypes.h"
 #ifndef _MSC_VER
 #include "souffle/profile/Tui.h"
@@ -98,6 +42,7 @@
 #include "souffle/utility/ContainerUtil.h"
 #include "souffle/utility/FileUtil.h"
 #include "souffle/utility/MiscUtil.h"
+#include "souffle/utility/NumaUtil.h"
 #include "souffle/utility/StreamUtil.h"
 #include "souffle/utility/StringUtil.h"
 #include "souffle/utility/SubProcess.h"
@@ -387,10 +332,33 @@ int main(int argc, char** argv) {
         std::vector<MainOption> options{{"", 0, "", "", false, ""},
                 {"auto-schedule", 'a', "FILE", "", false,
                         "Use profile auto-schedule <FILE> for auto-scheduling."},
+                {"adaptive-plans", 20, "", "", false,
+                        "Give recursive rules that do not scan the delta relation first a second plan "
+                        "that does, and choose between them in every iteration by the sizes of the "
+                        "relations."},
                 {"fact-dir", 'F', "DIR", ".", false, "Specify directory for fact files."},
                 {"include-dir", 'I', "DIR", ".", true, "Specify directory for include files."},
                 {"output-dir", 'D', "DIR", ".", false,
                         "Specify directory for output files. If <DIR> is `-` then stdout is used."},
+                {"async-output", 11, "", "", false,
+                        "Write output relations in the background while evaluation continues, and free "
+                        "relations that are no longer used once written."},
+                {"memory-limit", 12, "SIZE", "", false,
+                        "Move relations that are not needed for a while to disk when memory use exceeds "
+                        "<SIZE>, e.g. 512M or 200G."},
+                {"numa", 18, "", "", false,
+                        "Pin the worker threads to the cores of the NUMA nodes, so that they stay close to "
+                        "the memory they touched first."},
+                {"numa-interleave", 19, "RELATIONS", "", false,
+                        "Spread the memory of the given relations over all NUMA nodes, for large relations "
+                        "read by all threads. Relations are separated by commas, * selects all. Implies "
+                        "--numa."},
+                {"batch", 21, "N", "", false,
+                        "Evaluate loops over blocks of N tuples, probing the next relation in sorted "
+                        "order. The interpreter also tests the conditions of each block in turn."},
+                {"leapfrog", 22, "", "", false,
+                        "Evaluate the scans of cyclic rule bodies, like triangles, as leapfrog joins that "
+                        "intersect the sorted values of the joined relations."},
                 {"jobs", 'j', "N", "1", false,
                         "Run interpreter/compiler in parallel using N threads, N=auto for system "
                         "default."},
@@ -423,8 +391,23 @@ int main(int argc, char** argv) {
                 {"index-stats", '\x9', "", "", false, "Enable collection of index statistics"},
                 {"live-profile", '\1', "", "", false, "Enable live profiling."},
                 {"profile", 'p', "FILE", "", false, "Enable profiling, and write profile data to <FILE>."},
+                {"profile-format", 15, "FORMAT", "json", false,
+                        "Write the profile data as json, or as a compact binary event log, which is "
+                        "written while the program runs."},
+                {"profile-counters", 16, "", "", false,
+                        "Record hardware performance counters of rules and relations in the profile "
+                        "(Linux only)."},
+                {"profile-indexes", 17, "", "", false,
+                        "Record the lookups, hint hit rates and depth of the indexes of relations in the "
+                        "profile."},
+                {"profile-stream", 14, "SOCKET", "", false,
+                        "Publish profile data on the Unix domain socket <SOCKET> while the program runs, "
+                        "to be followed with souffleprof -l <SOCKET>."},
                 {"profile-frequency", '\2', "", "", false, "Enable the frequency counter in the profiler."},
                 {"debug-report", 'r', "FILE", "", false, "Write HTML debug report to <FILE>."},
+                {"time-passes", 13, "FILE", "", false,
+                        "Write the time and memory used by each compiler pass to <FILE>, as a profile "
+                        "that souffleprof can display."},
                 {"pragma", 'P', "OPTIONS", "", true, "Set pragma options."},
                 {"provenance", 't', "[ none | explain | explore ]", "", false,
                         "Enable provenance instrumentation and interaction."},
@@ -543,10 +526,25 @@ int main(int argc, char** argv) {
             Global::config().set("macro", allMacros);
         }
 
-        if (Global::config().has("live-profile") && !Global::config().has("profile")) {
+        if (Global::config().has("numa-interleave") && !Global::config().has("numa")) {
+            Global::config().set("numa");
+        }
+
+        if ((Global::config().has("live-profile") || Global::config().has("profile-stream") ||
+                    Global::config().has("profile-counters") ||
+                    Global::config().has("profile-indexes")) &&
+                !Global::config().has("profile")) {
             Global::config().set("profile");
         }
 
+        if (!Global::config().has("profile-format", "json") &&
+                !Global::config().has("profile-format", "binary")) {
+            throw std::runtime_error("--profile-format may only be set to 'json' or 'binary'.");
+        }
+        if (Global::config().has("profile-format", "binary") && Global::config().has("live-profile")) {
+            throw std::runtime_error("--live-profile requires --profile-format=json");
+        }
+
         /* if index-stats is set then check that the profiler is also set */
         if (Global::config().has("index-stats")) {
             if (!Global::config().has("profile"))
@@ -605,9 +603,13 @@ int main(int argc, char** argv) {
     // parse file
     ErrorReport errReport(Global::config().has("no-warn"));
     DebugReport debugReport;
-    Own<ast::TranslationUnit> astTranslationUnit = ParserDriver::parseTranslationUnit(
-            InputPath.string(), Input->getInputStream(), errReport, debugReport);
-    Input->endInput();
+    Own<ast::TranslationUnit> astTranslationUnit;
+    {
+        PassTimer timer("parser", "parse");
+        astTranslationUnit = ParserDriver::parseTranslationUnit(
+                InputPath.string(), Input->getInputStream(), errReport, debugReport);
+        Input->endInput();
+    }
 
     /* Report run-time of the parser if verbose flag is set */
     if (Global::config().has("verbose")) {
@@ -637,6 +639,14 @@ int main(int argc, char** argv) {
     /* set up additional global options based on pragma declaratives */
     (mk<ast::transform::PragmaChecker>())->apply(*astTranslationUnit);
 
+    /* check the options that may have been set by pragmas */
+    try {
+        checkOptions();
+    } catch (std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
     if (hasShowOpt("initial-ast", "initial-datalog")) {
         std::cout << astTranslationUnit->getProgram() << std::endl;
         // no other show options specified -> bail, we're done.
@@ -644,80 +654,7 @@ int main(int argc, char** argv) {
     }
 
     /* construct the transformation pipeline */
-
-    // Equivalence pipeline
-    auto equivalencePipeline =
-            mk<ast::transform::PipelineTransformer>(mk<ast::transform::NameUnnamedVariablesTransformer>(),
-                    mk<ast::transform::FixpointTransformer>(mk<ast::transform::MinimiseProgramTransformer>()),
-                    mk<ast::transform::ReplaceSingletonVariablesTransformer>(),
-                    mk<ast::transform::RemoveRelationCopiesTransformer>(),
-                    mk<ast::transform::RemoveEmptyRelationsTransformer>(),
-                    mk<ast::transform::RemoveRedundantRelationsTransformer>());
-
-    // Magic-Set pipeline
-    auto magicPipeline = mk<ast::transform::PipelineTransformer>(
-            mk<ast::transform::ConditionalTransformer>(
-                    Global::config().has("magic-transform"), mk<ast::transform::ExpandEqrelsTransformer>()),
-            mk<ast::transform::MagicSetTransformer>(), mk<ast::transform::ResolveAliasesTransformer>(),
-            mk<ast::transform::RemoveRelationCopiesTransformer>(),
-            mk<ast::transform::RemoveEmptyRelationsTransformer>(),
-            mk<ast::transform::RemoveRedundantRelationsTransformer>(), clone(equivalencePipeline));
-
-    // Partitioning pipeline
-    auto partitionPipeline =
-            mk<ast::transform::PipelineTransformer>(mk<ast::transform::NameUnnamedVariablesTransformer>(),
-                    mk<ast::transform::PartitionBodyLiteralsTransformer>(),
-                    mk<ast::transform::ReplaceSingletonVariablesTransformer>());
-
-    // Provenance pipeline
-    auto provenancePipeline = mk<ast::transform::ConditionalTransformer>(Global::config().has("provenance"),
-            mk<ast::transform::PipelineTransformer>(mk<ast::transform::ExpandEqrelsTransformer>(),
-                    mk<ast::transform::NameUnnamedVariablesTransformer>()));
-
-    // Main pipeline
-    auto pipeline = mk<ast::transform::PipelineTransformer>(mk<ast::transform::ComponentChecker>(),
-            mk<ast::transform::ComponentInstantiationTransformer>(),
-            mk<ast::transform::IODefaultsTransformer>(),
-            mk<ast::transform::SimplifyAggregateTargetExpressionTransformer>(),
-            mk<ast::transform::UniqueAggregationVariablesTransformer>(),
-            mk<ast::transform::FixpointTransformer>(mk<ast::transform::PipelineTransformer>(
-                    mk<ast::transform::ResolveAnonymousRecordAliasesTransformer>(),
-                    mk<ast::transform::FoldAnonymousRecords>())),
-            mk<ast::transform::SubsumptionQualifierTransformer>(), mk<ast::transform::SemanticChecker>(),
-            mk<ast::transform::GroundWitnessesTransformer>(),
-            mk<ast::transform::UniqueAggregationVariablesTransformer>(),
-            mk<ast::transform::MaterializeSingletonAggregationTransformer>(),
-            mk<ast::transform::FixpointTransformer>(
-                    mk<ast::transform::MaterializeAggregationQueriesTransformer>()),
-            mk<ast::transform::RemoveRedundantSumsTransformer>(),
-            mk<ast::transform::NormaliseGeneratorsTransformer>(),
-            mk<ast::transform::ResolveAliasesTransformer>(),
-            mk<ast::transform::RemoveBooleanConstraintsTransformer>(),
-            mk<ast::transform::ResolveAliasesTransformer>(), mk<ast::transform::MinimiseProgramTransformer>(),
-            mk<ast::transform::InlineUnmarkExcludedTransform>(),
-            mk<ast::transform::InlineRelationsTransformer>(), mk<ast::transform::GroundedTermsChecker>(),
-            mk<ast::transform::ResolveAliasesTransformer>(),
-            mk<ast::transform::RemoveRedundantRelationsTransformer>(),
-            mk<ast::transform::RemoveRelationCopiesTransformer>(),
-            mk<ast::transform::RemoveEmptyRelationsTransformer>(),
-            mk<ast::transform::ReplaceSingletonVariablesTransformer>(),
-            mk<ast::transform::FixpointTransformer>(mk<ast::transform::PipelineTransformer>(
-                    mk<ast::transform::ReduceExistentialsTransformer>(),
-                    mk<ast::transform::RemoveRedundantRelationsTransformer>())),
-            mk<ast::transform::RemoveRelationCopiesTransformer>(), std::move(partitionPipeline),
-            std::move(equivalencePipeline), mk<ast::transform::RemoveRelationCopiesTransformer>(),
-            std::move(magicPipeline), mk<ast::transform::RemoveEmptyRelationsTransformer>(),
-            mk<ast::transform::AddNullariesToAtomlessAggregatesTransformer>(),
-            mk<ast::transform::ExecutionPlanChecker>(), std::move(provenancePipeline),
-            mk<ast::transform::IOAttributesTransformer>());
-
-    // Disable unwanted transformations
-    if (Global::config().has("disable-transformers")) {
-        std::vector<std::string> givenTransformers =
-                splitString(Global::config().get("disable-transformers"), ',');
-        pipeline->disableTransformers(
-                std::set<std::string>(givenTransformers.begin(), givenTransformers.end()));
-    }
+    auto pipeline = makeAstPipeline();
 
     // Set up the debug report if necessary
     if (Global::config().has("debug-report")) {
@@ -793,12 +730,11 @@ int main(int argc, char** argv) {
     // ------- execution -------------
     /* translate AST to RAM */
     debugReport.startSection();
-    auto translationStrategy =
-            Global::config().has("provenance")
-                    ? mk<ast2ram::TranslationStrategy, ast2ram::provenance::TranslationStrategy>()
-                    : mk<ast2ram::TranslationStrategy, ast2ram::seminaive::TranslationStrategy>();
-    auto unitTranslator = Own<ast2ram::UnitTranslator>(translationStrategy->createUnitTranslator());
-    auto ramTranslationUnit = unitTranslator->translateUnit(*astTranslationUnit);
+    Own<ram::TranslationUnit> ramTranslationUnit;
+    {
+        PassTimer timer("ast2ram", "translate");
+        ramTranslationUnit = translateToRam(*astTranslationUnit);
+    }
     debugReport.endSection("ast-to-ram", "Translate AST to RAM");
 
     if (hasShowOpt("initial-ram")) {
@@ -808,26 +744,7 @@ int main(int argc, char** argv) {
     }
 
     // Apply RAM transforms
-    {
-        using namespace ram::transform;
-        Own<Transformer> ramTransform = mk<TransformerSequence>(
-                mk<LoopTransformer>(mk<TransformerSequence>(mk<ExpandFilterTransformer>(),
-                        mk<HoistConditionsTransformer>(), mk<MakeIndexTransformer>())),
-                mk<IfConversionTransformer>(), mk<IfExistsConversionTransformer>(),
-                mk<CollapseFiltersTransformer>(), mk<TupleIdTransformer>(),
-                mk<LoopTransformer>(
-                        mk<TransformerSequence>(mk<HoistAggregateTransformer>(), mk<TupleIdTransformer>())),
-                mk<ExpandFilterTransformer>(), mk<HoistConditionsTransformer>(),
-                mk<CollapseFiltersTransformer>(), mk<EliminateDuplicatesTransformer>(),
-                mk<ReorderConditionsTransformer>(), mk<LoopTransformer>(mk<ReorderFilterBreak>()),
-                mk<ConditionalTransformer>(
-                        // job count of 0 means all cores are used.
-                        []() -> bool { return std::stoi(Global::config().get("jobs")) != 1; },
-                        mk<ParallelTransformer>()),
-                mk<ReportIndexTransformer>());
-
-        ramTransform->apply(*ramTranslationUnit);
-    }
+    makeRamPipeline()->apply(*ramTranslationUnit);
 
     if (ramTranslationUnit->getErrorReport().getNumIssues() != 0) {
         std::cerr << ramTranslationUnit->getErrorReport();
@@ -862,8 +779,16 @@ int main(int argc, char** argv) {
 #endif
             }
 
-            // configure and execute interpreter
+            if (PassTimes::isEnabled()) {
+                PassTimes::instance().write();
+            }
+
+            // configure and execute interpreter; only the executable pins the threads, which belong to
+            // the host program when the engine is embedded
             Own<interpreter::Engine> interpreter(mk<interpreter::Engine>(*ramTranslationUnit));
+            if (Global::config().has("numa")) {
+                numa::pinThreads();
+            }
             interpreter->executeMain();
             // If the profiler was started, join back here once it exits.
             if (profiler.joinable()) {
@@ -914,12 +839,15 @@ int main(int argc, char** argv) {
             bool withSharedLibrary;
             auto synthesisStart = std::chrono::high_resolution_clock::now();
             const bool emitToStdOut = Global::config().has("generate", "-");
-            if (emitToStdOut)
-                synthesiser->generateCode(std::cout, baseIdentifier, withSharedLibrary);
-            else {
-                std::ofstream os{sourceFilename};
-                synthesiser->generateCode(os, baseIdentifier, withSharedLibrary);
-                os.close();
+            {
+                PassTimer timer("synthesiser", "generateCode");
+                if (emitToStdOut)
+                    synthesiser->generateCode(std::cout, baseIdentifier, withSharedLibrary);
+                else {
+                    std::ofstream os{sourceFilename};
+                    synthesiser->generateCode(os, baseIdentifier, withSharedLibrary);
+                    os.close();
+                }
             }
             if (Global::config().has("verbose")) {
                 auto synthesisEnd = std::chrono::high_resolution_clock::now();
@@ -942,7 +870,10 @@ int main(int argc, char** argv) {
                 if (!souffle_compile) throw std::runtime_error("failed to locate souffle-compile.py");
 
                 auto t_bgn = std::chrono::high_resolution_clock::now();
-                compileToBinary(*souffle_compile, sourceFilename);
+                {
+                    PassTimer timer("compiler", "compileToBinary");
+                    compileToBinary(*souffle_compile, sourceFilename);
+                }
                 auto t_end = std::chrono::high_resolution_clock::now();
 
                 if (Global::config().has("verbose")) {
@@ -951,6 +882,10 @@ int main(int argc, char** argv) {
                 }
             }
 
+            if (PassTimes::isEnabled()) {
+                PassTimes::instance().write();
+            }
+
             // run compiled C++ program if requested.
             if (must_execute) {
                 std::string binaryFilename = baseFilename;
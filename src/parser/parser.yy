@@ -136,6 +136,8 @@
 %token BTREE_MAX_QUALIFIER       "BTREE_MAX datastructure qualifier"
 %token BTREE_SUM_QUALIFIER       "BTREE_SUM datastructure qualifier"
 %token BTREE_DELETE_QUALIFIER    "BTREE_DELETE datastructure qualifier"
+%token COMPRESSED_QUALIFIER      "compressed btree datastructure qualifier"
+%token HASH_QUALIFIER            "hashed btree datastructure qualifier"
 %token EQREL_QUALIFIER           "equivalence relation qualifier"
 %token OVERRIDABLE_QUALIFIER     "relation qualifier overidable"
 %token INLINE_QUALIFIER          "relation qualifier inline"
@@ -586,6 +588,14 @@ relation_tags
     {
       $$ = driver.addReprTag(RelationTag::BTREE_DELETE, @2, $1);
     }
+  | relation_tags COMPRESSED_QUALIFIER
+    {
+      $$ = driver.addReprTag(RelationTag::COMPRESSED, @2, $1);
+    }
+  | relation_tags HASH_QUALIFIER
+    {
+      $$ = driver.addReprTag(RelationTag::HASH, @2, $1);
+    }
   | relation_tags EQREL_QUALIFIER
     {
       $$ = driver.addReprTag(RelationTag::EQREL, @2, $1);
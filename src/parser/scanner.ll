@@ -191,6 +191,8 @@ WS [ \t\r\v\f]
 "btree_max"                           { return yy::parser::make_BTREE_MAX_QUALIFIER(yylloc); }
 "btree_sum"                           { return yy::parser::make_BTREE_SUM_QUALIFIER(yylloc); }
 "btree"                               { return yy::parser::make_BTREE_QUALIFIER(yylloc); }
+"compressed"                          { return yy::parser::make_COMPRESSED_QUALIFIER(yylloc); }
+"hash"                                { return yy::parser::make_HASH_QUALIFIER(yylloc); }
 "min"                                 { return yy::parser::make_MIN(yylloc); }
 "max"                                 { return yy::parser::make_MAX(yylloc); }
 "as"                                  { return yy::parser::make_AS(yylloc); }
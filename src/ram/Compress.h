@@ -0,0 +1,51 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2022, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file Compress.h
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ram/RelationStatement.h"
+#include "souffle/utility/StreamUtil.h"
+#include <ostream>
+#include <string>
+
+namespace souffle::ram {
+
+/**
+ * @class Compress
+ * @brief Convert a complete relation into its compact, read-only representation
+ *
+ * Emitted once no more tuples are inserted into a relation with the
+ * compressed representation. Later insertions remain valid, but expensive.
+ *
+ * For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * COMPRESS A
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class Compress : public RelationStatement {
+public:
+    Compress(std::string rel) : RelationStatement(rel) {}
+
+    Compress* cloning() const override {
+        return new Compress(relation);
+    }
+
+protected:
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos);
+        os << "COMPRESS " << relation << std::endl;
+    }
+};
+
+}  // namespace souffle::ram
@@ -0,0 +1,159 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2022, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file LeapfrogJoin.h
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ram/ExistenceCheck.h"
+#include "ram/Expression.h"
+#include "ram/IndexOperation.h"
+#include "ram/Node.h"
+#include "ram/Operation.h"
+#include "ram/utility/Utils.h"
+#include "souffle/utility/ContainerUtil.h"
+#include "souffle/utility/MiscUtil.h"
+#include "souffle/utility/StreamUtil.h"
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace souffle::ram {
+
+/**
+ * @class LeapfrogJoin
+ * @brief Search for tuples of a relation whose value of a column occurs in other relations
+ *
+ * The tuples of the relation matching the index are searched for the values
+ * of the join column that also occur in each filter. A filter is an
+ * existence check leaving one column undefined, the column joined with the
+ * join column. Instead of checking the filters tuple by tuple, the sorted
+ * indexes of the relation and of the filters are intersected by leapfrogging:
+ * each index in turn seeks the least value not below the largest value any
+ * index has seen, until all of them agree on a value. The tuples of the
+ * relation with that value are then searched as by an index scan.
+ *
+ * For example, for the triangles of the edge relation E:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   FOR t0 IN E
+ *    FOR t1 IN E ON INDEX t1.0 = t0.1 LEAPFROG t1.1 WITH (t1.1,t0.0) IN E
+ *     ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class LeapfrogJoin : public IndexOperation {
+public:
+    LeapfrogJoin(std::string rel, std::size_t ident, RamPattern queryPattern, std::size_t column,
+            VecOwn<ExistenceCheck> filters, std::vector<std::size_t> filterColumns, Own<Operation> nested,
+            std::string profileText = "")
+            : IndexOperation(rel, ident, std::move(queryPattern), std::move(nested), std::move(profileText)),
+              column(column), filters(std::move(filters)), filterColumns(std::move(filterColumns)) {
+        assert(allValidPtrs(this->filters));
+        assert(this->filters.size() == this->filterColumns.size() && "column for each filter");
+    }
+
+    /** @brief Get join column of the relation */
+    std::size_t getColumn() const {
+        return column;
+    }
+
+    /** @brief Get filters, each leaving its join column undefined */
+    std::vector<ExistenceCheck*> getFilters() const {
+        return toPtrVector(filters);
+    }
+
+    /** @brief Get join column of each filter */
+    const std::vector<std::size_t>& getFilterColumns() const {
+        return filterColumns;
+    }
+
+    void apply(const NodeMapper& map) override {
+        IndexOperation::apply(map);
+        for (auto& filter : filters) {
+            filter = map(std::move(filter));
+        }
+    }
+
+    LeapfrogJoin* cloning() const override {
+        RamPattern resQueryPattern;
+        for (const auto& i : queryPattern.first) {
+            resQueryPattern.first.emplace_back(i->cloning());
+        }
+        for (const auto& i : queryPattern.second) {
+            resQueryPattern.second.emplace_back(i->cloning());
+        }
+        VecOwn<ExistenceCheck> resFilters;
+        for (const auto& filter : filters) {
+            resFilters.emplace_back(filter->cloning());
+        }
+        return new LeapfrogJoin(relation, getTupleId(), std::move(resQueryPattern), column,
+                std::move(resFilters), filterColumns, clone(getOperation()), getProfileText());
+    }
+
+protected:
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos);
+        os << "FOR t" << getTupleId() << " IN " << relation;
+        printIndex(os);
+        os << " LEAPFROG t" << getTupleId() << "." << column << " WITH ";
+        for (std::size_t i = 0; i < filters.size(); ++i) {
+            if (i > 0) {
+                os << " AND ";
+            }
+            // print the join column as the value it is joined with
+            const auto values = filters[i]->getValues();
+            os << "(";
+            for (std::size_t j = 0; j < values.size(); ++j) {
+                if (j > 0) {
+                    os << ",";
+                }
+                if (j == filterColumns[i]) {
+                    os << "t" << getTupleId() << "." << column;
+                } else {
+                    os << *values[j];
+                }
+            }
+            os << ") IN " << filters[i]->getRelation();
+        }
+        os << std::endl;
+        IndexOperation::print(os, tabpos + 1);
+    }
+
+    bool equal(const Node& node) const override {
+        const auto& other = asAssert<LeapfrogJoin>(node);
+        return IndexOperation::equal(other) && column == other.column &&
+               equal_targets(filters, other.filters) && filterColumns == other.filterColumns;
+    }
+
+    NodeVec getChildren() const override {
+        auto res = IndexOperation::getChildren();
+        for (const auto& filter : filters) {
+            res.push_back(filter.get());
+        }
+        return res;
+    }
+
+    /** Join column of the relation */
+    const std::size_t column;
+
+    /** Relations intersected with the join column */
+    VecOwn<ExistenceCheck> filters;
+
+    /** Join column of each filter */
+    const std::vector<std::size_t> filterColumns;
+};
+
+}  // namespace souffle::ram
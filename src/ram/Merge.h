@@ -0,0 +1,68 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2022, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file Merge.h
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ram/BinRelationStatement.h"
+#include "ram/Relation.h"
+#include "souffle/utility/MiscUtil.h"
+#include "souffle/utility/StreamUtil.h"
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+
+namespace souffle::ram {
+
+/**
+ * @class Merge
+ * @brief Insert all tuples of a relation into another relation of the same arity and representation
+ *
+ * Unlike a scan of the source relation inserting every tuple, the merge
+ * inserts the source into each index of the target separately, in the
+ * order of that index, so that consecutive insertions are close to each
+ * other.
+ *
+ * The following example merges A into B:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * MERGE B WITH A
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class Merge : public BinRelationStatement {
+public:
+    Merge(std::string tRef, const std::string& sRef) : BinRelationStatement(sRef, tRef) {}
+
+    /** @brief Get source relation */
+    const std::string& getSourceRelation() const {
+        return getFirstRelation();
+    }
+
+    /** @brief Get target relation */
+    const std::string& getTargetRelation() const {
+        return getSecondRelation();
+    }
+
+    Merge* cloning() const override {
+        return new Merge(second, first);
+    }
+
+protected:
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos);
+        os << "MERGE " << getTargetRelation() << " WITH " << getSourceRelation();
+        os << std::endl;
+    }
+};
+
+}  // namespace souffle::ram
@@ -19,6 +19,7 @@
 #include "RelationTag.h"
 #include "ram/CountUniqueKeys.h"
 #include "ram/Expression.h"
+#include "ram/LeapfrogJoin.h"
 #include "ram/Node.h"
 #include "ram/Program.h"
 #include "ram/Relation.h"
@@ -392,6 +393,16 @@ void IndexAnalysis::run(const TranslationUnit& translationUnit) {
     // 0-arity relation in a provenance program still need to be revisited.
     // visit all nodes to collect searches of each relation
 
+    // the filters of leapfrog joins are not checked on their own, but sought by the join
+    std::set<const Node*> leapfrogFilters;
+    visit(translationUnit.getProgram(), [&](const LeapfrogJoin& join) {
+        const auto filters = join.getFilters();
+        for (std::size_t i = 0; i < filters.size(); ++i) {
+            relationToSearches[filters[i]->getRelation()].insert(getSearchSignature(&join, i));
+            leapfrogFilters.insert(filters[i]);
+        }
+    });
+
     // visit all nodes to collect searches of each relation
     visit(translationUnit.getProgram(), [&](const Node& node) {
         if (const auto* countUniqueKeys = as<CountUniqueKeys>(node)) {
@@ -399,7 +410,9 @@ void IndexAnalysis::run(const TranslationUnit& translationUnit) {
         } else if (const auto* indexSearch = as<IndexOperation>(node)) {
             relationToSearches[indexSearch->getRelation()].insert(getSearchSignature(indexSearch));
         } else if (const auto* exists = as<ExistenceCheck>(node)) {
-            relationToSearches[exists->getRelation()].insert(getSearchSignature(exists));
+            if (leapfrogFilters.count(exists) == 0) {
+                relationToSearches[exists->getRelation()].insert(getSearchSignature(exists));
+            }
         } else if (const auto* provExists = as<ProvenanceExistenceCheck>(node)) {
             relationToSearches[provExists->getRelation()].insert(getSearchSignature(provExists));
         } else if (const auto* aggExists = as<AggregateExistenceCheck>(node)) {
@@ -524,6 +537,10 @@ SearchSignature IndexAnalysis::getSearchSignature(const IndexOperation* search)
             keys[i] = AttributeConstraint::Inequal;
         }
     }
+    // the join column of a leapfrog join follows the bound columns, to be sought in order
+    if (const auto* join = as<LeapfrogJoin>(search)) {
+        keys[join->getColumn()] = AttributeConstraint::Inequal;
+    }
     return keys;
 }
 
@@ -576,10 +593,52 @@ SearchSignature IndexAnalysis::getSearchSignature(const ExistenceCheck* existChe
     return searchSignature(rel->getArity(), existCheck->getValues());
 }
 
+SearchSignature IndexAnalysis::getSearchSignature(const LeapfrogJoin* join, std::size_t filter) const {
+    const auto* exists = join->getFilters()[filter];
+    const Relation* rel = &relAnalysis->lookup(exists->getRelation());
+    auto keys = searchSignature(rel->getArity(), exists->getValues());
+    keys[join->getFilterColumns()[filter]] = AttributeConstraint::Inequal;
+    return keys;
+}
+
 SearchSignature IndexAnalysis::getSearchSignature(const Relation* ramRel) const {
     return SearchSignature::getFullSearchSignature(ramRel->getArity());
 }
 
+bool IndexAnalysis::isSoughtInOrder(
+        const std::string& relation, const SearchSignature& search, std::size_t column) const {
+    const LexOrder order = getIndexSelection(relation).getLexOrder(search);
+    std::size_t bound = 0;
+    for (std::size_t i = 0; i < search.arity(); ++i) {
+        if (search[i] == AttributeConstraint::Equal) {
+            ++bound;
+        }
+    }
+    if (order.size() <= bound || order[bound] != column) {
+        return false;
+    }
+    for (std::size_t i = 0; i < bound; ++i) {
+        if (search[order[i]] != AttributeConstraint::Equal) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool IndexAnalysis::isSoughtInOrder(const LeapfrogJoin* join) const {
+    if (!isSoughtInOrder(join->getRelation(), getSearchSignature(join), join->getColumn())) {
+        return false;
+    }
+    const auto filters = join->getFilters();
+    for (std::size_t i = 0; i < filters.size(); ++i) {
+        if (!isSoughtInOrder(
+                    filters[i]->getRelation(), getSearchSignature(join, i), join->getFilterColumns()[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool IndexAnalysis::isTotalSignature(const AbstractExistenceCheck* existCheck) const {
     for (const auto& cur : existCheck->getValues()) {
         if (isUndefValue(cur)) {
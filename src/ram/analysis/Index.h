@@ -20,6 +20,7 @@
 #include "ram/CountUniqueKeys.h"
 #include "ram/ExistenceCheck.h"
 #include "ram/IndexOperation.h"
+#include "ram/LeapfrogJoin.h"
 #include "ram/ProvenanceExistenceCheck.h"
 #include "ram/AggregateExistenceCheck.h"
 #include "ram/Relation.h"
@@ -523,6 +524,14 @@ public:
      */
     SearchSignature getSearchSignature(const ExistenceCheck* existCheck) const;
 
+    /**
+     * @Brief Get the index signature for a filter of a leapfrog join
+     * @param Leapfrog join
+     * @param Position of the filter
+     * @result index signature of the filter, seeking its join column
+     */
+    SearchSignature getSearchSignature(const LeapfrogJoin* join, std::size_t filter) const;
+
     /**
      * @Brief Get the index signature for a aggregate existence check
      * @param Aggregate-existence check
@@ -553,6 +562,18 @@ public:
      */
     bool isTotalSignature(const AbstractExistenceCheck* existCheck) const;
 
+    /**
+     * @Brief whether the index of a search orders the given column right after the bound columns,
+     * so that the values of the column are sought in order, as leapfrog joins require
+     */
+    bool isSoughtInOrder(
+            const std::string& relation, const SearchSignature& search, std::size_t column) const;
+
+    /**
+     * @Brief whether the indexes of a leapfrog join and of its filters seek the join columns in order
+     */
+    bool isSoughtInOrder(const LeapfrogJoin* join) const;
+
 private:
     /** relation analysis for looking up relations by name */
     RelationAnalysis* relAnalysis;
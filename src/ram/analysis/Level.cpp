@@ -32,6 +32,7 @@
 #include "ram/IndexScan.h"
 #include "ram/Insert.h"
 #include "ram/IntrinsicOperator.h"
+#include "ram/LeapfrogJoin.h"
 #include "ram/Negation.h"
 #include "ram/Node.h"
 #include "ram/NumericConstant.h"
@@ -39,6 +40,7 @@
 #include "ram/PackRecord.h"
 #include "ram/ProvenanceExistenceCheck.h"
 #include "ram/AggregateExistenceCheck.h"
+#include "ram/RelationSize.h"
 #include "ram/Scan.h"
 #include "ram/StringConstant.h"
 #include "ram/SubroutineArgument.h"
@@ -118,6 +120,21 @@ std::optional<std::size_t> LevelAnalysis::getLevel(const Node* node) const {
             return level;
         }
 
+        // leapfrog join
+        maybe_level visit_(type_identity<LeapfrogJoin>, const LeapfrogJoin& join) override {
+            maybe_level level = std::nullopt;
+            for (auto& index : join.getRangePattern().first) {
+                level = max(level, dispatch(*index));
+            }
+            for (auto& index : join.getRangePattern().second) {
+                level = max(level, dispatch(*index));
+            }
+            for (const auto* filter : join.getFilters()) {
+                level = max(level, dispatch(*filter));
+            }
+            return level;
+        }
+
         // choice
         maybe_level visit_(type_identity<IfExists>, const IfExists& choice) override {
             return max(-1, dispatch(choice.getCondition()));
@@ -287,6 +304,11 @@ std::optional<std::size_t> LevelAnalysis::getLevel(const Node* node) const {
             return std::nullopt;  // can be in the top level
         }
 
+        // relation size
+        maybe_level visit_(type_identity<RelationSize>, const RelationSize&) override {
+            return std::nullopt;  // can be in the top level
+        }
+
         // default rule
         maybe_level visit_(type_identity<Node>, const Node&) override {
             fatal("Node not implemented!");
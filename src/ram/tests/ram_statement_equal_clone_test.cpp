@@ -20,6 +20,7 @@
 #include "RelationTag.h"
 #include "ram/Break.h"
 #include "ram/Clear.h"
+#include "ram/Compress.h"
 #include "ram/Condition.h"
 #include "ram/Constraint.h"
 #include "ram/DebugInfo.h"
@@ -35,6 +36,7 @@
 #include "ram/LogSize.h"
 #include "ram/LogTimer.h"
 #include "ram/Loop.h"
+#include "ram/Merge.h"
 #include "ram/MergeExtend.h"
 #include "ram/Negation.h"
 #include "ram/Operation.h"
@@ -92,6 +94,38 @@ TEST(Clear, CloneAndEquals) {
     delete c;
 }
 
+TEST(Compress, CloneAndEquals) {
+    // COMPRESS A
+    Relation A("A", 1, 1, {"x"}, {"i"}, RelationRepresentation::COMPRESSED);
+    Compress a("A");
+    Compress b("A");
+    EXPECT_EQ(a, b);
+    EXPECT_NE(&a, &b);
+
+    Compress* c = a.cloning();
+    EXPECT_EQ(a, *c);
+    EXPECT_NE(&a, c);
+    delete c;
+}
+
+TEST(Merge, CloneAndEquals) {
+    // MERGE B WITH A
+    Relation A("A", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
+    Relation B("B", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
+    Merge a("B", "A");
+    Merge b("B", "A");
+    EXPECT_EQ(a, b);
+    EXPECT_NE(&a, &b);
+
+    Merge* c = a.cloning();
+    EXPECT_EQ(a, *c);
+    EXPECT_NE(&a, c);
+    delete c;
+
+    Merge d("A", "B");
+    EXPECT_NE(a, d);
+}
+
 TEST(MergeExtend, CloneAndEquals) {
     // MERGE B WITH A
     Relation A("A", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
@@ -18,6 +18,7 @@
 #include "ram/TranslationUnit.h"
 #include "ram/analysis/Level.h"
 #include "ram/transform/Transformer.h"
+#include <set>
 #include <string>
 
 namespace souffle::ram::transform {
@@ -37,6 +38,11 @@ public:
         return "HoistAggregateTransformer";
     }
 
+    /** Only moves aggregates within a query */
+    std::set<std::string> getPreservedAnalyses() const override {
+        return relationAnalyses();
+    }
+
     /**
      * @brief Apply hoistAggregate to the whole program
      * @param RAM program
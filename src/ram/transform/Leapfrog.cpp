@@ -0,0 +1,196 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2022, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file Leapfrog.cpp
+ *
+ ***********************************************************************/
+
+#include "ram/transform/Leapfrog.h"
+#include "RelationTag.h"
+#include "ram/Break.h"
+#include "ram/Condition.h"
+#include "ram/ExistenceCheck.h"
+#include "ram/Expression.h"
+#include "ram/Filter.h"
+#include "ram/LeapfrogJoin.h"
+#include "ram/Node.h"
+#include "ram/TupleElement.h"
+#include "ram/UndefValue.h"
+#include "ram/utility/NodeMapper.h"
+#include "ram/utility/Utils.h"
+#include "ram/analysis/Index.h"
+#include "ram/utility/Visitor.h"
+#include "souffle/utility/MiscUtil.h"
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace souffle::ram::transform {
+
+bool LeapfrogTransformer::isJoinable(const Relation& rel, std::size_t column) const {
+    auto rep = rel.getRepresentation();
+    if (rep != RelationRepresentation::DEFAULT && rep != RelationRepresentation::BTREE &&
+            rep != RelationRepresentation::HASH) {
+        return false;
+    }
+    if (rel.isNullary() || rel.getAuxiliaryArity() > 0) {
+        return false;
+    }
+    // floats and unsigned numbers are ordered differently by the synthesiser than by the interpreter
+    char type = rel.getAttributeTypes()[column][0];
+    return type != 'f' && type != 'u';
+}
+
+Own<Operation> LeapfrogTransformer::rewriteIndexScan(const IndexScan* iscan) {
+    std::size_t identifier = iscan->getTupleId();
+    const auto* filter = as<Filter>(iscan->getOperation());
+    if (identifier == 0 || filter == nullptr) {
+        return nullptr;
+    }
+
+    // a break would only leave the tuples of one value of the join column
+    if (visitExists(filter->getOperation(), [](const Break&) { return true; })) {
+        return nullptr;
+    }
+
+    // the index may only bind columns by equalities, the join column being free
+    const Relation& rel = relAnalysis->lookup(iscan->getRelation());
+    const auto& lower = iscan->getRangePattern().first;
+    const auto& upper = iscan->getRangePattern().second;
+    std::vector<bool> free(lower.size());
+    for (std::size_t i = 0; i < lower.size(); ++i) {
+        free[i] = isUndefValue(lower[i]) && isUndefValue(upper[i]);
+        if (!free[i] && *lower[i] != *upper[i]) {
+            return nullptr;
+        }
+    }
+
+    // the columns joined by an existence check, which must not refer to the tuple otherwise, and
+    // which closes a cycle of the body by also referring to an outer tuple
+    auto getJoin = [&](const Condition* condition) -> std::optional<std::pair<std::size_t, std::size_t>> {
+        const auto* exists = as<ExistenceCheck>(condition);
+        if (exists == nullptr) {
+            return std::nullopt;
+        }
+        std::optional<std::pair<std::size_t, std::size_t>> join;
+        bool cyclic = false;
+        const auto values = exists->getValues();
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            const auto* element = as<TupleElement>(values[i]);
+            if (!join && element != nullptr && element->getTupleId() == identifier) {
+                join = std::make_pair(element->getElement(), i);
+            } else if (visitExists(*values[i], [&](const TupleElement& other) {
+                           return other.getTupleId() == identifier;
+                       })) {
+                return std::nullopt;
+            } else if (visitExists(*values[i], [](const TupleElement&) { return true; })) {
+                cyclic = true;
+            }
+        }
+        if (!join || !cyclic || !free[join->first] || !isJoinable(rel, join->first) ||
+                !isJoinable(relAnalysis->lookup(exists->getRelation()), join->second)) {
+            return std::nullopt;
+        }
+        return join;
+    };
+
+    // join the column of the first existence check with all checks on that column
+    std::optional<std::size_t> column;
+    VecOwn<ExistenceCheck> filters;
+    std::vector<std::size_t> filterColumns;
+    VecOwn<Condition> remaining;
+    for (auto& condition : toConjunctionList(&filter->getCondition())) {
+        auto join = getJoin(condition.get());
+        if (join && (!column || *column == join->first)) {
+            column = join->first;
+            auto values = clone(as<ExistenceCheck>(condition)->getValues());
+            values[join->second] = mk<UndefValue>();
+            filters.push_back(
+                    mk<ExistenceCheck>(as<ExistenceCheck>(condition)->getRelation(), std::move(values)));
+            filterColumns.push_back(join->second);
+        } else {
+            remaining.push_back(std::move(condition));
+        }
+    }
+    if (!column) {
+        return nullptr;
+    }
+
+    Own<Operation> nested = clone(filter->getOperation());
+    if (!remaining.empty()) {
+        nested = mk<Filter>(toCondition(remaining), std::move(nested), filter->getProfileText());
+    }
+    return mk<LeapfrogJoin>(iscan->getRelation(), identifier, clone(iscan->getRangePattern()), *column,
+            std::move(filters), std::move(filterColumns), std::move(nested), iscan->getProfileText());
+}
+
+bool LeapfrogTransformer::convertIndexScans(Program& program) {
+    bool changed = false;
+    forEachQueryMap(program, [&](auto&& go, Own<Node> node) -> Own<Node> {
+        if (const IndexScan* iscan = as<IndexScan>(node)) {
+            if (auto op = rewriteIndexScan(iscan)) {
+                changed = true;
+                node = std::move(op);
+            }
+        }
+        node->apply(go);
+        return node;
+    });
+    return changed;
+}
+
+Own<Operation> LeapfrogTransformer::revertLeapfrogJoin(const LeapfrogJoin* join) {
+    VecOwn<Condition> conditions;
+    const auto filters = join->getFilters();
+    for (std::size_t i = 0; i < filters.size(); ++i) {
+        auto values = clone(filters[i]->getValues());
+        values[join->getFilterColumns()[i]] = mk<TupleElement>(join->getTupleId(), join->getColumn());
+        conditions.push_back(mk<ExistenceCheck>(filters[i]->getRelation(), std::move(values)));
+    }
+
+    // the other conditions of the filter were left in a filter of their own
+    const Operation* nested = &join->getOperation();
+    std::string profileText;
+    if (const auto* filter = as<Filter>(nested)) {
+        for (auto& condition : toConjunctionList(&filter->getCondition())) {
+            conditions.push_back(std::move(condition));
+        }
+        nested = &filter->getOperation();
+        profileText = filter->getProfileText();
+    }
+    return mk<IndexScan>(join->getRelation(), join->getTupleId(), clone(join->getRangePattern()),
+            mk<Filter>(toCondition(conditions), clone(nested), profileText), join->getProfileText());
+}
+
+bool LeapfrogTransformer::revertUnorderedJoins(TranslationUnit& translationUnit) {
+    // the index selection may merge the search of a join with other searches of the relation into an
+    // index ordering another column first; reverting a join changes the searches, so check again
+    bool reverted = false;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        translationUnit.invalidateAnalyses(relationAnalyses());
+        const auto& indexAnalysis = translationUnit.getAnalysis<analysis::IndexAnalysis>();
+        forEachQueryMap(translationUnit.getProgram(), [&](auto&& go, Own<Node> node) -> Own<Node> {
+            if (const auto* join = as<LeapfrogJoin>(node)) {
+                if (!indexAnalysis.isSoughtInOrder(join)) {
+                    changed = true;
+                    node = revertLeapfrogJoin(join);
+                }
+            }
+            node->apply(go);
+            return node;
+        });
+        reverted = reverted || changed;
+    }
+    return reverted;
+}
+
+}  // namespace souffle::ram::transform
@@ -0,0 +1,130 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2022, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file Leapfrog.h
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ram/IndexScan.h"
+#include "ram/LeapfrogJoin.h"
+#include "ram/Operation.h"
+#include "ram/Program.h"
+#include "ram/Relation.h"
+#include "ram/TranslationUnit.h"
+#include "ram/analysis/Relation.h"
+#include "ram/transform/Transformer.h"
+#include <cstddef>
+#include <memory>
+#include <set>
+#include <string>
+
+namespace souffle::ram::transform {
+
+/**
+ * @class LeapfrogTransformer
+ * @brief Convert index scans filtered by existence checks on a column of the scanned tuple to leapfrog joins
+ *
+ * Cyclic rule bodies, like triangles and other cycles of a graph, close the
+ * cycle by checking the existence of a tuple joining a column of the last
+ * scanned tuple. Such an index scan visits every tuple of its range, even
+ * if few of them pass the checks. The leapfrog join instead intersects the
+ * sorted values of the column with those of the checked relations, which
+ * visits no more values than the smallest of them.
+ *
+ * For example,
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   FOR t0 IN E
+ *    FOR t1 IN E ON INDEX t1.0 = t0.1
+ *     IF (t1.1,t0.0) IN E /\ C
+ *      ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * will be rewritten to
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   FOR t0 IN E
+ *    FOR t1 IN E ON INDEX t1.0 = t0.1 LEAPFROG t1.1 WITH (t1.1,t0.0) IN E
+ *     IF C
+ *      ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * Only existence checks that close a cycle are joined, i.e. that refer to
+ * the scanned tuple and to an outer tuple; other checks are left as filters.
+ * The transformation is enabled by --leapfrog.
+ *
+ * The index of the scan may only bind columns by equalities. Only b-tree
+ * relations with columns ordered as signed numbers take part, which sort
+ * the values of the join column alike in the interpreter and the
+ * synthesiser. The outer-most scan of a query is left to be parallelised.
+ * The index analysis asserts that the indexes of the join order the join
+ * column right after the bound columns.
+ */
+class LeapfrogTransformer : public Transformer {
+public:
+    std::string getName() const override {
+        return "LeapfrogTransformer";
+    }
+
+    /** Only replaces index scans by leapfrog joins */
+    std::set<std::string> getPreservedAnalyses() const override {
+        return relationAnalyses();
+    }
+
+    /**
+     * @brief Rewrite an index scan to a leapfrog join
+     * @param An index scan followed by a filter
+     * @result The result is null if the index scan has no column to join;
+     *         otherwise the leapfrog join is returned.
+     */
+    Own<Operation> rewriteIndexScan(const IndexScan* iscan);
+
+    /**
+     * @brief Convert the index scans of all queries
+     * @param RAM program that is transformed
+     * @result Flag that indicates whether the input program has changed
+     */
+    bool convertIndexScans(Program& program);
+
+    /**
+     * @brief Rewrite a leapfrog join back to an index scan followed by a filter
+     * @param A leapfrog join
+     * @result The index scan checking the filters of the join tuple by tuple
+     */
+    Own<Operation> revertLeapfrogJoin(const LeapfrogJoin* join);
+
+    /**
+     * @brief Revert the leapfrog joins whose indexes do not seek the join columns in order
+     * @param Translation unit whose program is transformed
+     * @result Flag that indicates whether a leapfrog join was reverted
+     */
+    bool revertUnorderedJoins(TranslationUnit& translationUnit);
+
+protected:
+    /** Whether the column of the relation can be sought in the order of a leapfrog join */
+    bool isJoinable(const Relation& rel, std::size_t column) const;
+
+    bool transform(TranslationUnit& translationUnit) override {
+        relAnalysis = &translationUnit.getAnalysis<analysis::RelationAnalysis>();
+        if (!convertIndexScans(translationUnit.getProgram())) {
+            return false;
+        }
+        revertUnorderedJoins(translationUnit);
+        return true;
+    }
+
+    analysis::RelationAnalysis* relAnalysis{nullptr};
+};
+
+}  // namespace souffle::ram::transform
@@ -94,7 +94,8 @@ ExpressionPair MakeIndexTransformer::getLowerUpperExpression(Condition* c, std::
                            !Global::config().has("generate") && !Global::config().has("swig");
         bool provenance = rep == RelationRepresentation::PROVENANCE;
         bool btree = (rep == RelationRepresentation::BTREE || rep == RelationRepresentation::DEFAULT ||
-                      rep == RelationRepresentation::BTREE_DELETE);
+                      rep == RelationRepresentation::BTREE_DELETE ||
+                      rep == RelationRepresentation::COMPRESSED || rep == RelationRepresentation::HASH);
         auto op = binRelOp->getOperator();
 
         // don't index FEQ in interpreter mode
@@ -29,6 +29,7 @@
 #include "ram/transform/Transformer.h"
 #include <cstddef>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -67,6 +68,11 @@ public:
         return "MakeIndexTransformer";
     }
 
+    /** Only replaces scans by index operations */
+    std::set<std::string> getPreservedAnalyses() const override {
+        return relationAnalyses();
+    }
+
     /**
      * @brief Get expression of RAM element access
      *
@@ -17,6 +17,7 @@
 #include "ram/Program.h"
 #include "ram/TranslationUnit.h"
 #include "ram/transform/Transformer.h"
+#include <set>
 #include <string>
 
 namespace souffle::ram::transform {
@@ -52,6 +53,11 @@ public:
         return "ReorderFilterBreak";
     }
 
+    /** Only swaps filters and breaks */
+    std::set<std::string> getPreservedAnalyses() const override {
+        return relationAnalyses();
+    }
+
     /**
      * @brief reorder filter-break nesting to break-filter nesting
      * @param program Program that is transform
@@ -19,13 +19,19 @@
 #include "ram/Node.h"
 #include "ram/Program.h"
 #include "ram/TranslationUnit.h"
+#include "ram/analysis/Complexity.h"
+#include "ram/analysis/Level.h"
+#include "ram/analysis/Relation.h"
 #include "ram/transform/Meta.h"
 #include "reports/DebugReport.h"
 #include "reports/ErrorReport.h"
+#include "reports/PassTimes.h"
 #include "souffle/utility/StringUtil.h"
 #include <chrono>
 #include <cstdlib>
 #include <iostream>
+#include <set>
+#include <string>
 #include <type_traits>
 
 namespace souffle::ram::transform {
@@ -36,13 +42,16 @@ bool Transformer::apply(TranslationUnit& translationUnit) {
     std::string ramProgStrOld = debug ? toString(translationUnit.getProgram()) : "";
 
     // invoke the transformation
+    PassTimer timer("ram", getName(), !isA<MetaTransformer>(this));
     auto start = std::chrono::high_resolution_clock::now();
     bool changed = transform(translationUnit);
     auto end = std::chrono::high_resolution_clock::now();
+    timer.setChanged(changed);
 
-    // invalidate analyses in case the program has changed
-    if (changed) {
-        translationUnit.invalidateAnalyses();
+    // invalidate analyses in case the program has changed; sub-transformers
+    // of a meta-transformer have already done so
+    if (changed && !isA<MetaTransformer>(this)) {
+        translationUnit.invalidateAnalyses(getPreservedAnalyses());
     }
 
     // print runtime & change info for transformer in verbose mode
@@ -66,14 +75,14 @@ bool Transformer::apply(TranslationUnit& translationUnit) {
     }
 
     // abort evaluation of the program if errors were encountered
-    if (translationUnit.getErrorReport().getNumErrors() != 0) {
-        std::cerr << translationUnit.getErrorReport();
-        std::cerr << translationUnit.getErrorReport().getNumErrors()
-                  << " errors generated, evaluation aborted" << std::endl;
-        exit(EXIT_FAILURE);
-    }
+    translationUnit.getErrorReport().exitIfErrors();
 
     return changed;
 }
 
+std::set<std::string> Transformer::relationAnalyses() {
+    return {analysis::RelationAnalysis::name, analysis::LevelAnalysis::name,
+            analysis::ComplexityAnalysis::name};
+}
+
 }  // namespace souffle::ram::transform
@@ -17,6 +17,7 @@
 #pragma once
 
 #include "ram/TranslationUnit.h"
+#include <set>
 #include <string>
 
 namespace souffle::ram::transform {
@@ -57,7 +58,20 @@ public:
      */
     virtual std::string getName() const = 0;
 
+    /**
+     * @Brief get names of the analyses that remain valid when the program has changed
+     */
+    virtual std::set<std::string> getPreservedAnalyses() const {
+        return {};
+    }
+
 protected:
+    /**
+     * @Brief get names of the analyses of relation declarations,
+     * which are not affected by rewriting statements and operations
+     */
+    static std::set<std::string> relationAnalyses();
+
     /**
      * @Brief transform the translation unit / used by apply
      * @Param translationUnit that will be transformed.
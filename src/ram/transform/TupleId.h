@@ -17,6 +17,7 @@
 #include "ram/Program.h"
 #include "ram/TranslationUnit.h"
 #include "ram/transform/Transformer.h"
+#include <set>
 #include <string>
 
 namespace souffle::ram::transform {
@@ -48,6 +49,11 @@ public:
         return "TupleIdTransformer";
     }
 
+    /** Only renumbers tuple identifiers */
+    std::set<std::string> getPreservedAnalyses() const override {
+        return relationAnalyses();
+    }
+
     /**
      * @brief Apply tupleId reordering to the whole program
      * @param RAM program
@@ -26,6 +26,7 @@
 #include "ram/Break.h"
 #include "ram/Call.h"
 #include "ram/Clear.h"
+#include "ram/Compress.h"
 #include "ram/Condition.h"
 #include "ram/Conjunction.h"
 #include "ram/Constraint.h"
@@ -48,11 +49,13 @@
 #include "ram/IndexScan.h"
 #include "ram/Insert.h"
 #include "ram/IntrinsicOperator.h"
+#include "ram/LeapfrogJoin.h"
 #include "ram/ListStatement.h"
 #include "ram/LogRelationTimer.h"
 #include "ram/LogSize.h"
 #include "ram/LogTimer.h"
 #include "ram/Loop.h"
+#include "ram/Merge.h"
 #include "ram/MergeExtend.h"
 #include "ram/Negation.h"
 #include "ram/NestedIntrinsicOperator.h"
@@ -155,6 +158,7 @@ struct Visitor : souffle::detail::VisitorBase<R, NodeType, Params...> {
         SOUFFLE_VISITOR_FORWARD(Scan);
         SOUFFLE_VISITOR_FORWARD(ParallelIndexScan);
         SOUFFLE_VISITOR_FORWARD(IndexScan);
+        SOUFFLE_VISITOR_FORWARD(LeapfrogJoin);
         SOUFFLE_VISITOR_FORWARD(ParallelIfExists);
         SOUFFLE_VISITOR_FORWARD(IfExists);
         SOUFFLE_VISITOR_FORWARD(ParallelIndexIfExists);
@@ -168,10 +172,12 @@ struct Visitor : souffle::detail::VisitorBase<R, NodeType, Params...> {
         SOUFFLE_VISITOR_FORWARD(IO);
         SOUFFLE_VISITOR_FORWARD(Query);
         SOUFFLE_VISITOR_FORWARD(Clear);
+        SOUFFLE_VISITOR_FORWARD(Compress);
         SOUFFLE_VISITOR_FORWARD(LogSize);
         SOUFFLE_VISITOR_FORWARD(CountUniqueKeys);
 
         SOUFFLE_VISITOR_FORWARD(Swap);
+        SOUFFLE_VISITOR_FORWARD(Merge);
         SOUFFLE_VISITOR_FORWARD(MergeExtend);
 
         // Control-flow
@@ -194,12 +200,14 @@ protected:
     SOUFFLE_VISITOR_LINK(IO, RelationStatement);
     SOUFFLE_VISITOR_LINK(Query, Statement);
     SOUFFLE_VISITOR_LINK(Clear, RelationStatement);
+    SOUFFLE_VISITOR_LINK(Compress, RelationStatement);
     SOUFFLE_VISITOR_LINK(LogSize, RelationStatement);
     SOUFFLE_VISITOR_LINK(CountUniqueKeys, RelationStatement);
 
     SOUFFLE_VISITOR_LINK(RelationStatement, Statement);
 
     SOUFFLE_VISITOR_LINK(Swap, BinRelationStatement);
+    SOUFFLE_VISITOR_LINK(Merge, BinRelationStatement);
     SOUFFLE_VISITOR_LINK(MergeExtend, BinRelationStatement);
     SOUFFLE_VISITOR_LINK(BinRelationStatement, Statement);
 
@@ -226,6 +234,7 @@ protected:
     SOUFFLE_VISITOR_LINK(ParallelScan, Scan);
     SOUFFLE_VISITOR_LINK(IndexScan, IndexOperation);
     SOUFFLE_VISITOR_LINK(ParallelIndexScan, IndexScan);
+    SOUFFLE_VISITOR_LINK(LeapfrogJoin, IndexOperation);
     SOUFFLE_VISITOR_LINK(IfExists, RelationOperation);
     SOUFFLE_VISITOR_LINK(ParallelIfExists, IfExists);
     SOUFFLE_VISITOR_LINK(IndexIfExists, IndexOperation);
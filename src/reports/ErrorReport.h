@@ -22,6 +22,8 @@
 #include <cstdlib>
 #include <iostream>
 #include <set>
+#include <sstream>
+#include <stdexcept>
 #include <string>
 #include <utility>
 #include <vector>
@@ -181,11 +183,21 @@ public:
         diagnostics.insert(diagnostic);
     }
 
+    /** Report errors by throwing a std::runtime_error instead of terminating the process */
+    void setThrowOnErrors(bool value = true) {
+        throwOnErrors = value;
+    }
+
     void exitIfErrors() {
         if (getNumErrors() == 0) {
             return;
         }
 
+        if (throwOnErrors) {
+            std::stringstream ss;
+            ss << *this << getNumErrors() << " errors generated, evaluation aborted\n";
+            throw std::runtime_error(ss.str());
+        }
         std::cerr << *this << getNumErrors() << " errors generated, evaluation aborted\n";
         exit(EXIT_FAILURE);
     }
@@ -204,6 +216,7 @@ public:
 private:
     std::set<Diagnostic> diagnostics;
     bool nowarn;
+    bool throwOnErrors = false;
 };
 
 }  // end of namespace souffle
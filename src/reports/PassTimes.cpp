@@ -0,0 +1,123 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2022, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file reports/PassTimes.cpp
+ *
+ * Implements the report of the time and memory spent in each compiler pass.
+ *
+ ***********************************************************************/
+
+#include "reports/PassTimes.h"
+#include "Global.h"
+#include "souffle/profile/ProfileDatabase.h"
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace souffle {
+
+namespace {
+
+/** Maximum resident set size of the process so far, in KiB */
+std::size_t getMaxRSS() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize / 1024;
+#else
+    struct rusage ru {};
+    getrusage(RUSAGE_SELF, &ru);
+    return static_cast<std::size_t>(ru.ru_maxrss);
+#endif
+}
+
+microseconds sinceEpoch(const time_point& time) {
+    return std::chrono::duration_cast<microseconds>(time.time_since_epoch());
+}
+
+}  // namespace
+
+PassTimes& PassTimes::instance() {
+    static PassTimes times;
+    return times;
+}
+
+bool PassTimes::isEnabled() {
+    return Global::config().has("time-passes");
+}
+
+void PassTimes::write() const {
+    profile::ProfileDatabase db;
+    for (std::size_t i = 0; i < passes.size(); ++i) {
+        const Pass& pass = passes[i];
+        // zero-padded keys keep the passes in order
+        std::stringstream key;
+        key << std::setw(5) << std::setfill('0') << i;
+        std::vector<std::string> path{"compile", "pass", key.str()};
+
+        auto entry = [&](const std::string& name) {
+            auto res = path;
+            res.push_back(name);
+            return res;
+        };
+        db.addTextEntry(entry("stage"), pass.stage);
+        db.addTextEntry(entry("name"), pass.name);
+        db.addSizeEntry(entry("depth"), pass.depth);
+        db.addSizeEntry(entry("leaf"), pass.leaf ? 1 : 0);
+        db.addSizeEntry(entry("changed"), pass.changed ? 1 : 0);
+        db.addDurationEntry(entry("runtime"), sinceEpoch(pass.start), sinceEpoch(pass.end));
+        db.addSizeEntry(entry("maxRSS"), pass.maxRSS);
+    }
+    db.addSizeEntry({"compile", "maxRSS"}, getMaxRSS());
+
+    std::ofstream os(Global::config().get("time-passes"));
+    if (!os.is_open()) {
+        std::cerr << "Cannot open pass times file <" << Global::config().get("time-passes") << ">\n";
+        return;
+    }
+    db.print(os);
+}
+
+PassTimer::PassTimer(const std::string& stage, const std::string& name, bool leaf)
+        : enabled(PassTimes::isEnabled()) {
+    if (!enabled) {
+        return;
+    }
+    auto& times = PassTimes::instance();
+    index = times.passes.size();
+    times.passes.push_back({stage, name, times.depth, leaf, false, now(), {}, 0});
+    times.depth++;
+}
+
+PassTimer::~PassTimer() {
+    if (!enabled) {
+        return;
+    }
+    auto& times = PassTimes::instance();
+    times.depth--;
+    auto& pass = times.passes[index];
+    pass.end = now();
+    pass.maxRSS = getMaxRSS();
+}
+
+void PassTimer::setChanged(bool changed) {
+    if (enabled) {
+        PassTimes::instance().passes[index].changed = changed;
+    }
+}
+
+}  // namespace souffle
@@ -0,0 +1,91 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2022, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file reports/PassTimes.h
+ *
+ * Defines the report of the time and memory spent in each compiler pass,
+ * which is enabled by --time-passes.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "souffle/utility/MiscUtil.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * Times of the passes of the compiler.
+ *
+ * Passes are recorded in the order they are started, with their nesting depth,
+ * so that the passes of a meta-transformer follow it at a greater depth.
+ * The report is written as a profile database, which can be opened with souffleprof.
+ */
+class PassTimes {
+public:
+    struct Pass {
+        /** Stage of the compiler, e.g. ast or ram */
+        std::string stage;
+        std::string name;
+        std::size_t depth;
+        /** Whether the pass does not consist of other passes */
+        bool leaf;
+        bool changed;
+        time_point start;
+        time_point end;
+        /** Maximum resident set size at the end of the pass, in kilobytes */
+        std::size_t maxRSS;
+    };
+
+    static PassTimes& instance();
+
+    /** Whether passes are recorded, i.e. --time-passes was given */
+    static bool isEnabled();
+
+    const std::vector<Pass>& getPasses() const {
+        return passes;
+    }
+
+    /** Write the recorded passes to the file given by --time-passes */
+    void write() const;
+
+private:
+    friend class PassTimer;
+
+    std::vector<Pass> passes;
+
+    /** Number of passes currently running */
+    std::size_t depth = 0;
+};
+
+/**
+ * Records a pass from its construction until its destruction.
+ * Nothing is recorded unless --time-passes was given.
+ */
+class PassTimer {
+public:
+    PassTimer(const std::string& stage, const std::string& name, bool leaf = true);
+    ~PassTimer();
+
+    PassTimer(const PassTimer&) = delete;
+    PassTimer& operator=(const PassTimer&) = delete;
+
+    /** Record whether the pass changed the program */
+    void setChanged(bool changed);
+
+private:
+    bool enabled;
+    std::size_t index = 0;
+};
+
+}  // namespace souffle
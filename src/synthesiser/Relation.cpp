@@ -27,6 +27,45 @@ using namespace ram;
 using ram::analysis::LexOrder;
 using ram::analysis::SearchSignature;
 
+namespace {
+
+/**
+ * Generate the method adding the statistics of the indexes of a relation to
+ * the profile. It only exists if the data structures keep their statistics.
+ */
+void generateMakeIndexEvents(std::ostream& out, const std::vector<LexOrder>& inds) {
+    out << "#ifdef _SOUFFLE_STATS\n";
+    out << "void makeIndexEvents(const std::string& relation) const {\n";
+    for (std::size_t i = 0; i < inds.size(); i++) {
+        out << "{\n";
+        out << "IndexStatistics statistics;\n";
+        out << "addStructureStatistics(statistics, ind_" << i << ");\n";
+        out << "ProfileEventSingleton::instance().makeIndexEvent(relation, " << i << ", \"" << inds[i]
+            << "\", statistics);\n";
+        out << "}\n";
+    }
+    out << "}\n";
+    out << "#endif\n";
+}
+
+/** Generate a merge method inserting the chunks of another relation in parallel */
+void generateMergeByChunks(std::ostream& out) {
+    out << "template <typename Source>\n";
+    out << "void merge(const Source& source, bool /* sorted */) {\n";
+    out << "auto chunks = source.partition();\n";
+    out << "PARALLEL_START\n";
+    out << "pfor(auto it = chunks.begin(); it < chunks.end(); ++it) {\n";
+    out << "context h;\n";
+    out << "for (const auto& t : *it) {\n";
+    out << "insert(t, h);\n";
+    out << "}\n";
+    out << "}\n";
+    out << "PARALLEL_END\n";
+    out << "}\n";
+}
+
+}  // namespace
+
 std::string Relation::getTypeAttributeString(const std::vector<std::string>& attributeTypes,
         const std::unordered_set<std::size_t>& attributesUsed) const {
     std::stringstream type;
@@ -63,6 +102,10 @@ Own<Relation> Relation::getSynthesiserRelation(
         rel = new AggregateRelation(ramRel, indexSelection, "sum");
     } else if (ramRel.getRepresentation() == RelationRepresentation::BTREE_DELETE) {
         rel = new EraseRelation(ramRel, indexSelection);
+    } else if (ramRel.getRepresentation() == RelationRepresentation::COMPRESSED) {
+        rel = new CompressedRelation(ramRel, indexSelection);
+    } else if (ramRel.getRepresentation() == RelationRepresentation::HASH) {
+        rel = new HashRelation(ramRel, indexSelection);
     } else if (ramRel.getRepresentation() == RelationRepresentation::BRIE) {
         rel = new BrieRelation(ramRel, indexSelection);
     } else if (ramRel.getRepresentation() == RelationRepresentation::EQREL) {
@@ -305,6 +348,16 @@ std::string EraseRelation::getTypeName() {
     return res.str();
 }
 
+std::string CompressedRelation::getTypeName() {
+    // same layout as a direct relation, with compressible indexes
+    return "t_compressed_" + DirectRelation::getTypeName().substr(2);
+}
+
+std::string HashRelation::getTypeName() {
+    // same layout as a direct relation, with a hashed master index
+    return "t_hashed_" + DirectRelation::getTypeName().substr(2);
+}
+
 std::string AggregateRelation::getTypeName() {
     std::unordered_set<std::size_t> attributesUsed;
     for (auto& ind : getIndices()) {
@@ -416,6 +469,12 @@ void DirectRelation::generateTypeStruct(std::ostream& out) {
 
         auto genstruct = [&](std::string name, std::size_t bound) {
             out << "struct " << name << "{\n";
+            // a leading column of signed numbers is searched by vectorized comparisons
+            bool reversed = bound == 2 && isA<AggregateRelation>(this) &&
+                            asAssert<AggregateRelation>(*this).aggregateOp == "max";
+            if (bound > 0 && typecasts[ind[0]] == "ramBitCast<RamSigned>" && !reversed) {
+                out << "static constexpr std::size_t leading_column = " << ind[0] << ";\n";
+            }
             out << " int operator()(const t_tuple& a, const t_tuple& b) const {\n";
             out << "  return ";
             std::function<void(std::size_t)> gencmp = [&](std::size_t i) {
@@ -507,6 +566,11 @@ void DirectRelation::generateTypeStruct(std::ostream& out) {
             std::string btree_name = "btree";
             if (isA<EraseRelation>(this)) {
                 btree_name = "btree_delete";
+            } else if (isA<CompressedRelation>(this)) {
+                btree_name = "compressed_btree";
+            } else if (isA<HashRelation>(this) && i == masterIndex) {
+                // only the master index is tested for membership
+                btree_name = "hashed_btree";
             }
             if (ind.size() == arity) {
                 out << "using t_ind_" << i << " = " << btree_name << "_set<t_tuple," << comparator << ">;\n";
@@ -548,6 +612,15 @@ void DirectRelation::generateTypeStruct(std::ostream& out) {
         out << "}\n";  // end of erase(t_tuple&)
     }
 
+    // compress method
+    if (isA<CompressedRelation>(this)) {
+        out << "void compress() {\n";
+        for (std::size_t i = 0; i < numIndexes; i++) {
+            out << "ind_" << i << ".compress();\n";
+        }
+        out << "}\n";  // end of compress()
+    }
+
     // insert methods
     out << "bool insert(const t_tuple& t) {\n";
     out << "context h;\n";
@@ -682,7 +755,72 @@ void DirectRelation::generateTypeStruct(std::ostream& out) {
 
     // partition method for parallelism
     out << "std::vector<range<iterator>> partition() const {\n";
-    out << "return ind_" << masterIndex << ".getChunks(400);\n";
+    out << "return ind_" << masterIndex << ".getChunks(" << partitionCount << ");\n";
+    out << "}\n";
+
+    // merge methods: insert sorted chunks into the master index, then the
+    // new tuples into each other index, sorted in the order of that index
+    std::vector<std::size_t> secondaryIndexes;
+    for (std::size_t i = 0; i < numIndexes; i++) {
+        if (i != masterIndex && provenanceIndexNumbers.find(i) == provenanceIndexNumbers.end()) {
+            secondaryIndexes.push_back(i);
+        }
+    }
+    out << "template <typename Source>\n";
+    out << "void merge(const Source& source, bool sorted) {\n";
+    out << "if (sorted) {\n";
+    out << "mergeChunks(source.partition());\n";
+    out << "return;\n";
+    out << "}\n";
+    out << "std::vector<t_tuple> tuples(source.begin(), source.end());\n";
+    out << "std::sort(tuples.begin(), tuples.end(), [](const t_tuple& a, const t_tuple& b) {\n";
+    out << "return t_comparator_" << masterIndex << "().less(a, b);\n";
+    out << "});\n";
+    out << "mergeChunks(make_range(tuples.cbegin(), tuples.cend()).partition(" << partitionCount << "));\n";
+    out << "}\n";
+
+    out << "template <typename Chunk>\n";
+    out << "void mergeChunks(const std::vector<Chunk>& chunks) {\n";
+    if (!secondaryIndexes.empty()) {
+        out << "std::vector<std::vector<t_tuple>> fresh(chunks.size());\n";
+    }
+    out << "PARALLEL_START\n";
+    out << "pfor(std::size_t c = 0; c < chunks.size(); ++c) {\n";
+    out << "t_ind_" << masterIndex << "::operation_hints hints;\n";
+    out << "for (const auto& t : chunks[c]) {\n";
+    if (secondaryIndexes.empty()) {
+        out << "ind_" << masterIndex << ".insert(t, hints);\n";
+    } else {
+        out << "if (ind_" << masterIndex << ".insert(t, hints)) {\n";
+        out << "fresh[c].push_back(t);\n";
+        out << "}\n";
+    }
+    out << "}\n";
+    out << "}\n";
+    out << "PARALLEL_END\n";
+    if (!secondaryIndexes.empty()) {
+        out << "std::vector<t_tuple> added;\n";
+        out << "for (const auto& cur : fresh) {\n";
+        out << "added.insert(added.end(), cur.begin(), cur.end());\n";
+        out << "}\n";
+        for (std::size_t i : secondaryIndexes) {
+            out << "{\n";
+            out << "std::sort(added.begin(), added.end(), [](const t_tuple& a, const t_tuple& b) {\n";
+            out << "return t_comparator_" << i << "().less(a, b);\n";
+            out << "});\n";
+            out << "auto parts = make_range(added.cbegin(), added.cend()).partition(" << partitionCount
+                << ");\n";
+            out << "PARALLEL_START\n";
+            out << "pfor(auto it = parts.begin(); it < parts.end(); ++it) {\n";
+            out << "t_ind_" << i << "::operation_hints hints;\n";
+            out << "for (const auto& t : *it) {\n";
+            out << "ind_" << i << ".insert(t, hints);\n";
+            out << "}\n";
+            out << "}\n";
+            out << "PARALLEL_END\n";
+            out << "}\n";
+        }
+    }
     out << "}\n";
 
     // purge method
@@ -692,6 +830,19 @@ void DirectRelation::generateTypeStruct(std::ostream& out) {
     }
     out << "}\n";
 
+    // recycleNodes method, for temporary relations purged over and over,
+    // interleaveNodes method, for relations read on all NUMA nodes, and
+    // releaseNodes method, returning the memory kept by either once purged
+    for (const char* method : {"recycleNodes", "interleaveNodes", "releaseNodes"}) {
+        out << "void " << method << "() {\n";
+        if (!isA<EraseRelation>(this) && !isA<CompressedRelation>(this)) {
+            for (std::size_t i = 0; i < numIndexes; i++) {
+                out << "ind_" << i << "." << method << "();\n";
+            }
+        }
+        out << "}\n";
+    }
+
     // begin and end iterators
     out << "iterator begin() const {\n";
     out << "return ind_" << masterIndex << ".begin();\n";
@@ -721,6 +872,9 @@ void DirectRelation::generateTypeStruct(std::ostream& out) {
     }
     out << "}\n";
 
+    // makeIndexEvents method
+    generateMakeIndexEvents(out, inds);
+
     // end struct
     out << "};\n";
 }  // namespace souffle
@@ -1023,12 +1177,15 @@ void IndirectRelation::generateTypeStruct(std::ostream& out) {
     // partition method
     out << "std::vector<range<iterator>> partition() const {\n";
     out << "std::vector<range<iterator>> res;\n";
-    out << "for (const auto& cur : ind_" << masterIndex << ".getChunks(400)) {\n";
+    out << "for (const auto& cur : ind_" << masterIndex << ".getChunks(" << partitionCount << ")) {\n";
     out << "    res.push_back(make_range(derefIter(cur.begin()), derefIter(cur.end())));\n";
     out << "}\n";
     out << "return res;\n";
     out << "}\n";
 
+    // merge method
+    generateMergeByChunks(out);
+
     // purge method
     out << "void purge() {\n";
     for (std::size_t i = 0; i < numIndexes; i++) {
@@ -1037,6 +1194,15 @@ void IndirectRelation::generateTypeStruct(std::ostream& out) {
     out << "dataTable.clear();\n";
     out << "}\n";
 
+    // recycleNodes, interleaveNodes and releaseNodes methods
+    for (const char* method : {"recycleNodes", "interleaveNodes", "releaseNodes"}) {
+        out << "void " << method << "() {\n";
+        for (std::size_t i = 0; i < numIndexes; i++) {
+            out << "ind_" << i << "." << method << "();\n";
+        }
+        out << "}\n";
+    }
+
     // begin and end iterators
     out << "iterator begin() const {\n";
     out << "return ind_" << masterIndex << ".begin();\n";
@@ -1055,6 +1221,9 @@ void IndirectRelation::generateTypeStruct(std::ostream& out) {
     }
     out << "}\n";
 
+    // makeIndexEvents method
+    generateMakeIndexEvents(out, inds);
+
     // end struct
     out << "};\n";
 }
@@ -1302,6 +1471,9 @@ void BrieRelation::generateTypeStruct(std::ostream& out) {
     out << "return res;\n";
     out << "}\n";
 
+    // merge method
+    generateMergeByChunks(out);
+
     // purge method
     out << "void purge() {\n";
     for (std::size_t i = 0; i < numIndexes; i++) {
@@ -1309,6 +1481,11 @@ void BrieRelation::generateTypeStruct(std::ostream& out) {
     }
     out << "}\n";
 
+    // recycleNodes, interleaveNodes and releaseNodes methods: only b-trees place their nodes
+    out << "void recycleNodes() {}\n";
+    out << "void interleaveNodes() {}\n";
+    out << "void releaseNodes() {}\n";
+
     // begin and end iterators
     out << "iterator begin() const {\n";
     out << "return iterator_" << masterIndex << "(ind_" << masterIndex << ".begin());\n";
@@ -1327,6 +1504,9 @@ void BrieRelation::generateTypeStruct(std::ostream& out) {
     }
     out << "}\n";
 
+    // makeIndexEvents method
+    generateMakeIndexEvents(out, inds);
+
     // orderOut and orderIn methods for reordering tuples according to index orders
     for (std::size_t i = 0; i < numIndexes; i++) {
         auto ind = inds[i];
@@ -28,6 +28,9 @@ public:
 
     virtual ~Relation() = default;
 
+    /** The number of chunks generated code partitions relations into for parallel loops */
+    static constexpr std::size_t partitionCount = 400;
+
     /** Compute the final list of indices to be used */
     virtual void computeIndices() = 0;
 
@@ -48,6 +51,11 @@ public:
         return computedIndices;
     }
 
+    /** Get the number of the full index the others are derived from */
+    std::size_t getMasterIndex() const {
+        return masterIndex;
+    }
+
     std::set<std::size_t> getProvenenceIndexNumbers() const {
         return provenanceIndexNumbers;
     }
@@ -151,6 +159,22 @@ public:
     std::string getTypeName() override;
 };
 
+class CompressedRelation : public DirectRelation {
+public:
+    CompressedRelation(const ram::Relation& ramRel, const ram::analysis::IndexCluster& indexSelection)
+            : DirectRelation(ramRel, indexSelection) {}
+
+    std::string getTypeName() override;
+};
+
+class HashRelation : public DirectRelation {
+public:
+    HashRelation(const ram::Relation& ramRel, const ram::analysis::IndexCluster& indexSelection)
+            : DirectRelation(ramRel, indexSelection) {}
+
+    std::string getTypeName() override;
+};
+
 class IndirectRelation : public Relation {
 public:
     IndirectRelation(const ram::Relation& ramRel, const ram::analysis::IndexCluster& indexSelection)
@@ -25,6 +25,7 @@
 #include "ram/Break.h"
 #include "ram/Call.h"
 #include "ram/Clear.h"
+#include "ram/Compress.h"
 #include "ram/Condition.h"
 #include "ram/Conjunction.h"
 #include "ram/Constraint.h"
@@ -44,10 +45,12 @@
 #include "ram/IndexScan.h"
 #include "ram/Insert.h"
 #include "ram/IntrinsicOperator.h"
+#include "ram/LeapfrogJoin.h"
 #include "ram/LogRelationTimer.h"
 #include "ram/LogSize.h"
 #include "ram/LogTimer.h"
 #include "ram/Loop.h"
+#include "ram/Merge.h"
 #include "ram/MergeExtend.h"
 #include "ram/Negation.h"
 #include "ram/NestedIntrinsicOperator.h"
@@ -106,6 +109,7 @@
 #include <iterator>
 #include <limits>
 #include <map>
+#include <set>
 #include <sstream>
 #include <tuple>
 #include <type_traits>
@@ -251,6 +255,10 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
 
         std::ostringstream preamble;
         bool preambleIssued = false;
+        /** whether the iterations of the parallel loop of the query are timed */
+        bool parallelRegion = false;
+        /** number of loops enclosing the current statement */
+        std::size_t loopDepth = 0;
 
     public:
         CodeEmitter(Synthesiser& syn) : synthesiser(syn) {
@@ -327,6 +335,110 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
             return std::make_pair(std::move(low), std::move(high));
         }
 
+        /**
+         * Elements of the tuple of a scan probing the next relation, in the order of the probed
+         * index: the relation of the first existence check of the directly nested filters, or else
+         * the one searched by the nested operation. Empty unless the scan is batched, which it is
+         * not if the order of its tuples is observable. Only outermost loops are batched, as the
+         * short ranges of inner loops are already ordered by their index.
+         */
+        std::vector<std::size_t> getProbeKeys(const TupleOperation& scan) {
+            std::vector<std::size_t> keys;
+            bool ordered = visitExists(scan.getOperation(), [](const Node& node) {
+                return isA<Break>(node) || isA<SubroutineReturn>(node) || isA<AutoIncrement>(node);
+            });
+            if (!Global::config().has("batch") || scan.getTupleId() != 0 || ordered) {
+                return keys;
+            }
+            auto addKeys = [&](const std::string& relation, const analysis::SearchSignature& signature,
+                                   const std::vector<Expression*>& values) {
+                for (auto column : isa->getIndexSelection(relation).getLexOrder(signature)) {
+                    const auto* element = as<TupleElement>(values[column]);
+                    if (element != nullptr && element->getTupleId() == scan.getTupleId()) {
+                        keys.push_back(element->getElement());
+                    }
+                }
+            };
+            const Operation* operation = &scan.getOperation();
+            while (const auto* filter = as<Filter>(operation)) {
+                visit(filter->getCondition(), [&](const ExistenceCheck& exists) {
+                    if (keys.empty()) {
+                        addKeys(exists.getRelation(), isa->getSearchSignature(&exists), exists.getValues());
+                    }
+                });
+                if (!keys.empty()) {
+                    return keys;
+                }
+                operation = &filter->getOperation();
+            }
+            if (const auto* search = as<IndexOperation>(operation)) {
+                addKeys(search->getRelation(), isa->getSearchSignature(search),
+                        search->getRangePattern().first);
+            }
+            return keys;
+        }
+
+        /**
+         * Emits the declaration of the batch of a scan, if it is batched. Parallel scans declare it
+         * once per thread, ahead of their loop over the partitions of the range.
+         */
+        void emitBatchDeclaration(const TupleOperation& scan, std::size_t arity, std::ostream& out) {
+            if (getProbeKeys(scan).empty()) {
+                return;
+            }
+            auto id = std::to_string(scan.getTupleId());
+            out << "std::vector<Tuple<RamDomain," << arity << ">> batch" << id << ";\n";
+            out << "batch" << id << ".reserve(" << Global::config().get("batch") << ");\n";
+        }
+
+        /**
+         * Emits the loop binding the tuples of a range to the tuple of a scan. With --batch, the
+         * tuples are gathered into batches sorted by the elements probing the next relation, such
+         * that each probe starts from the b-tree node the previous one ended in. The batch is
+         * declared here unless the caller already did.
+         */
+        void emitTupleLoop(const TupleOperation& scan, const std::string& range, std::size_t arity,
+                std::ostream& out, bool declared = false) {
+            auto keys = getProbeKeys(scan);
+            auto id = std::to_string(scan.getTupleId());
+            if (keys.empty()) {
+                out << "for(const auto& env" << id << " : " << range << ") {\n";
+                visit_(type_identity<TupleOperation>(), scan, out);
+                out << "}\n";
+                return;
+            }
+
+            auto type = "Tuple<RamDomain," + std::to_string(arity) + ">";
+            auto elements = [&](const std::string& tuple) {
+                std::stringstream list;
+                list << join(keys, ",",
+                        [&](std::ostream& os, std::size_t key) { os << tuple << "[" << key << "]"; });
+                return list.str();
+            };
+            out << "{\n";
+            if (!declared) {
+                emitBatchDeclaration(scan, arity, out);
+            }
+            out << "auto sweep" << id << " = [&]() {\n";
+            out << "std::sort(batch" << id << ".begin(), batch" << id << ".end(), [](const " << type
+                << "& a, const " << type << "& b) {\n";
+            out << "return std::tie(" << elements("a") << ") < std::tie(" << elements("b") << ");\n";
+            out << "});\n";
+            out << "for(const auto& env" << id << " : batch" << id << ") {\n";
+            visit_(type_identity<TupleOperation>(), scan, out);
+            out << "}\n";
+            out << "batch" << id << ".clear();\n";
+            out << "};\n";
+            out << "for(const auto& tuple" << id << " : " << range << ") {\n";
+            out << "batch" << id << ".push_back(tuple" << id << ");\n";
+            out << "if (batch" << id << ".size() == " << Global::config().get("batch") << ") {\n";
+            out << "sweep" << id << "();\n";
+            out << "}\n";
+            out << "}\n";
+            out << "sweep" << id << "();\n";
+            out << "}\n";
+        }
+
         // -- relation statements --
 
         void visit_(type_identity<IO>, const IO& io, std::ostream& out) override {
@@ -348,6 +460,29 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
 
             const auto& directives = io.getDirectives();
             const std::string& op = io.get("operation");
+
+            // moving relations to disk is independent of fact input and output
+            if (op == "spill" || op == "restore") {
+                const std::string relName = synthesiser.getRelationName(synthesiser.lookup(io.getRelation()));
+                out << "try {";
+                out << "std::map<std::string, std::string> directiveMap(";
+                printDirectives(directives);
+                out << ");\n";
+                if (op == "spill") {
+                    out << "if (spiller.exceedsMemoryLimit(directiveMap)) {\n";
+                    if (Global::config().has("async-output")) {
+                        out << "writeQueue.wait();\n";
+                    }
+                    out << "spiller.spill(*" << relName << ", directiveMap, symTable, recordTable);\n";
+                    out << "}\n";
+                } else {
+                    out << "spiller.restore(*" << relName << ", directiveMap, symTable, recordTable);\n";
+                }
+                out << "} catch (std::exception& e) {std::cerr << e.what();exit(1);}\n";
+                PRINT_END_COMMENT(out);
+                return;
+            }
+
             out << "if (performIO) {\n";
 
             // get some table details
@@ -368,17 +503,26 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
                        "<< "
                        "'\\n';}\n";
             } else if (op == "output" || op == "printsize") {
+                // a queued job only throws, to exit on the main thread once the queue is waited for
+                const bool async = Global::config().has("async-output");
                 out << "try {";
+                if (async) {
+                    out << "writeQueue.push([this]() {\n";
+                }
                 out << "std::map<std::string, std::string> directiveMap(";
                 printDirectives(directives);
                 out << ");\n";
                 out << R"_(if (!outputDirectory.empty()) {)_";
                 out << R"_(directiveMap["output-dir"] = outputDirectory;)_";
                 out << "}\n";
+                out << R"_(directiveMap["jobs"] = std::to_string(getNumThreads());)_";
                 out << "IOSystem::getInstance().getWriter(";
                 out << "directiveMap, symTable, recordTable";
                 out << ")->writeAll(*" << synthesiser.getRelationName(synthesiser.lookup(io.getRelation()))
                     << ");\n";
+                if (async) {
+                    out << "});\n";
+                }
                 out << "} catch (std::exception& e) {std::cerr << e.what();exit(1);}\n";
             } else {
                 assert("Wrong i/o operation");
@@ -434,6 +578,17 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
             preamble.clear();
             preambleIssued = false;
 
+            // profile the load balance of parallel loops; aggregates are left out, their
+            // iterations being too small to time
+            parallelRegion = isParallel && Global::config().has("profile") &&
+                             visitExists(*next, [&](const Node& n) {
+                                 return isA<ParallelScan>(n) || isA<ParallelIndexScan>(n) ||
+                                        isA<ParallelIfExists>(n) || isA<ParallelIndexIfExists>(n);
+                             });
+            if (parallelRegion) {
+                out << "ParallelRegion parallelRegion;\n";
+            }
+
             // create operation contexts for this operation
             for (const ram::Relation* rel : synthesiser.getReferencedRelations(query.getOperation())) {
                 preamble << "CREATE_OP_CONTEXT(" << synthesiser.getOpContextName(*rel);
@@ -482,15 +637,36 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
         void visit_(type_identity<Clear>, const Clear& clear, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
 
-            if (!synthesiser.lookup(clear.getRelation())->isTemp()) {
-                out << "if (pruneImdtRels) ";
+            const auto* rel = synthesiser.lookup(clear.getRelation());
+            const std::string relName = synthesiser.getRelationName(rel);
+            // recycled nodes are kept for the next iteration of a loop only
+            const std::string purge = (loopDepth > 0)
+                                              ? relName + "->purge();"
+                                              : relName + "->purge(); " + relName + "->releaseNodes();";
+            if (rel->isTemp()) {
+                out << purge << "\n";
+            } else if (Global::config().has("async-output")) {
+                // expired relations may still have an output job queued
+                out << "if (pruneImdtRels) writeQueue.push([this]() { " << purge << " });\n";
+            } else {
+                out << "if (pruneImdtRels) { " << purge << " }\n";
             }
-            out << synthesiser.getRelationName(synthesiser.lookup(clear.getRelation())) << "->"
-                << "purge();\n";
 
             PRINT_END_COMMENT(out);
         }
 
+        void visit_(type_identity<Compress>, const Compress& compress, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            const auto* rel = synthesiser.lookup(compress.getRelation());
+            if (Global::config().has("async-output")) {
+                // queued output jobs may still iterate the relation
+                out << "try {writeQueue.wait();} ";
+                out << "catch (std::exception& e) {std::cerr << e.what();exit(1);}\n";
+            }
+            out << synthesiser.getRelationName(rel) << "->compress();\n";
+            PRINT_END_COMMENT(out);
+        }
+
         void visit_(type_identity<LogSize>, const LogSize& size, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
             out << "ProfileEventSingleton::instance().makeQuantityEvent( R\"(";
@@ -529,7 +705,7 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
             // more than one => parallel sections
 
             // start parallel section
-            out << "SECTIONS_START;\n";
+            out << "SECTIONS_START(" << stmts.size() << ");\n";
 
             // put each thread in another section
             for (const auto& cur : stmts) {
@@ -547,7 +723,9 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
             PRINT_BEGIN_COMMENT(out);
             out << "iter = 0;\n";
             out << "for(;;) {\n";
+            ++loopDepth;
             dispatch(loop.getBody(), out);
+            --loopDepth;
             out << "iter++;\n";
             out << "}\n";
             out << "iter = 0;\n";
@@ -565,6 +743,22 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
             PRINT_END_COMMENT(out);
         }
 
+        void visit_(type_identity<Merge>, const Merge& merge, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            const auto* source = synthesiser.lookup(merge.getSourceRelation());
+            const auto* target = synthesiser.lookup(merge.getTargetRelation());
+            // tuples of the source arrive in the order of the master index of the target if they agree
+            auto sourceRel =
+                    Relation::getSynthesiserRelation(*source, isa->getIndexSelection(source->getName()));
+            auto targetRel =
+                    Relation::getSynthesiserRelation(*target, isa->getIndexSelection(target->getName()));
+            bool sorted = sourceRel->getIndices()[sourceRel->getMasterIndex()] ==
+                          targetRel->getIndices()[targetRel->getMasterIndex()];
+            out << synthesiser.getRelationName(target) << "->merge(*" << synthesiser.getRelationName(source)
+                << ", " << (sorted ? "true" : "false") << ");\n";
+            PRINT_END_COMMENT(out);
+        }
+
         void visit_(type_identity<MergeExtend>, const MergeExtend& extend, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
             out << synthesiser.getRelationName(synthesiser.lookup(extend.getSourceRelation())) << "->"
@@ -675,6 +869,7 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
             out << "auto part = " << relName << "->partition();\n";
             out << "PARALLEL_START\n";
             out << preamble.str();
+            emitBatchDeclaration(pscan, rel->getArity(), out);
             out << R"cpp(
                    #if defined _OPENMP && _OPENMP < 200805
                            auto count = std::distance(part.begin(), part.end());
@@ -685,12 +880,11 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
                            pfor(auto it = part.begin(); it < part.end(); it++) {
                    #endif
                    )cpp";
+            if (parallelRegion) {
+                out << "ParallelRegion::Task parallelTask(parallelRegion);\n";
+            }
             out << "try{\n";
-            out << "for(const auto& env0 : *it) {\n";
-
-            visit_(type_identity<TupleOperation>(), pscan, out);
-
-            out << "}\n";
+            emitTupleLoop(pscan, "*it", rel->getArity(), out, true);
             out << "} catch(std::exception &e) { signalHandler->error(e.what());}\n";
             out << "}\n";
 
@@ -700,18 +894,12 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
         void visit_(type_identity<Scan>, const Scan& scan, std::ostream& out) override {
             const auto* rel = synthesiser.lookup(scan.getRelation());
             auto relName = synthesiser.getRelationName(rel);
-            auto id = scan.getTupleId();
 
             PRINT_BEGIN_COMMENT(out);
 
             assert(rel->getArity() > 0 && "AstToRamTranslator failed/no scans for nullaries");
 
-            out << "for(const auto& env" << id << " : "
-                << "*" << relName << ") {\n";
-
-            visit_(type_identity<TupleOperation>(), scan, out);
-
-            out << "}\n";
+            emitTupleLoop(scan, "*" + relName, rel->getArity(), out);
 
             PRINT_END_COMMENT(out);
         }
@@ -769,6 +957,9 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
                            pfor(auto it = part.begin(); it < part.end(); it++) {
                    #endif
                    )cpp";
+            if (parallelRegion) {
+                out << "ParallelRegion::Task parallelTask(parallelRegion);\n";
+            }
             out << "try{\n";
             out << "for(const auto& env0 : *it) {\n";
             out << "if( ";
@@ -791,7 +982,6 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
         void visit_(type_identity<IndexScan>, const IndexScan& iscan, std::ostream& out) override {
             const auto* rel = synthesiser.lookup(iscan.getRelation());
             auto relName = synthesiser.getRelationName(rel);
-            auto identifier = iscan.getTupleId();
             auto keys = isa->getSearchSignature(&iscan);
 
             const auto& rangePatternLower = iscan.getRangePattern().first;
@@ -806,11 +996,80 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
             out << "auto range = " << relName << "->"
                 << "lowerUpperRange_" << keys << "(" << rangeBounds.first.str() << ","
                 << rangeBounds.second.str() << "," << ctxName << ");\n";
+            emitTupleLoop(iscan, "range", rel->getArity(), out);
+            PRINT_END_COMMENT(out);
+        }
+
+        void visit_(type_identity<LeapfrogJoin>, const LeapfrogJoin& join, std::ostream& out) override {
+            const auto* rel = synthesiser.lookup(join.getRelation());
+            auto relName = synthesiser.getRelationName(rel);
+            auto identifier = join.getTupleId();
+            auto keys = isa->getSearchSignature(&join);
+            const auto filters = join.getFilters();
+            const auto& filterColumns = join.getFilterColumns();
+
+            assert(0 < rel->getArity() && "AstToRamTranslator failed/no leapfrog joins for nullaries");
+
+            PRINT_BEGIN_COMMENT(out);
+            auto ctxName = "READ_OP_CONTEXT(" + synthesiser.getOpContextName(*rel) + ")";
+            auto rangeBounds =
+                    getPaddedRangeBounds(*rel, join.getRangePattern().first, join.getRangePattern().second);
+            std::string suffix = std::to_string(identifier);
+
+            out << "auto lower" << suffix << " = " << rangeBounds.first.str() << ";\n";
+            out << "auto upper" << suffix << " = " << rangeBounds.second.str() << ";\n";
+            for (std::size_t i = 0; i < filters.size(); ++i) {
+                const auto* filterRel = synthesiser.lookup(filters[i]->getRelation());
+                auto filterBounds =
+                        getPaddedRangeBounds(*filterRel, filters[i]->getValues(), filters[i]->getValues());
+                out << "auto lower" << suffix << "_" << i << " = " << filterBounds.first.str() << ";\n";
+                out << "auto upper" << suffix << "_" << i << " = " << filterBounds.second.str() << ";\n";
+            }
+
+            // seek the least value of the join column of a source, the scanned relation being the first
+            auto emitSeek = [&](const std::string& name, const ram::analysis::SearchSignature& signature,
+                                    const std::string& context, const std::string& bounds,
+                                    std::size_t column) {
+                out << "lower" << bounds << "[" << column << "] = value" << suffix << ";\n";
+                out << "auto range = " << name << "->lowerUpperRange_" << signature << "(lower" << bounds
+                    << ",upper" << bounds << "," << context << ");\n";
+                out << "if (range.empty()) return false;\n";
+                out << "next" << suffix << " = (*range.begin())[" << column << "];\n";
+                out << "return true;\n";
+            };
+            out << "souffle::evaluator::leapfrog(" << filters.size() + 1 << ",";
+            out << "[&](std::size_t source" << suffix << ", RamDomain value" << suffix << ", RamDomain& next"
+                << suffix << ") -> bool {\n";
+            out << "switch (source" << suffix << ") {\n";
+            out << "case 0: {\n";
+            emitSeek(relName, keys, ctxName, suffix, join.getColumn());
+            out << "}\n";
+            for (std::size_t i = 0; i < filters.size(); ++i) {
+                const auto* filterRel = synthesiser.lookup(filters[i]->getRelation());
+                out << "case " << i + 1 << ": {\n";
+                emitSeek(synthesiser.getRelationName(filterRel), isa->getSearchSignature(&join, i),
+                        "READ_OP_CONTEXT(" + synthesiser.getOpContextName(*filterRel) + ")",
+                        suffix + "_" + std::to_string(i), filterColumns[i]);
+                out << "}\n";
+            }
+            out << "default: return false;\n";
+            out << "}\n";
+            out << "}, [&](RamDomain value" << suffix << ") -> bool {\n";
+
+            // search the tuples with the value of the join column
+            out << "auto lowerValue = lower" << suffix << ";\n";
+            out << "auto upperValue = upper" << suffix << ";\n";
+            out << "lowerValue[" << join.getColumn() << "] = value" << suffix << ";\n";
+            out << "upperValue[" << join.getColumn() << "] = value" << suffix << ";\n";
+            out << "auto range = " << relName << "->"
+                << "lowerUpperRange_" << keys << "(lowerValue,upperValue," << ctxName << ");\n";
             out << "for(const auto& env" << identifier << " : range) {\n";
 
-            visit_(type_identity<TupleOperation>(), iscan, out);
+            visit_(type_identity<TupleOperation>(), join, out);
 
             out << "}\n";
+            out << "return true;\n";
+            out << "});\n";
             PRINT_END_COMMENT(out);
         }
 
@@ -881,41 +1140,77 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
             PRINT_BEGIN_COMMENT(out);
             auto ctxName = "READ_OP_CONTEXT(" + synthesiser.getOpContextName(*rel) + ")";
             out << "{\n";
-            out << "std::size_t total = 0;\n";
-            out << "std::size_t duplicates = 0;\n";
-
-            out << "if (!" << indexName << ".empty()) {\n";
-            out << "bool first = true;\n";
-            out << "auto prev = *" << indexName << ".begin();\n";
-            out << "for(const auto& tup : " << indexName << ") {\n";
-            out << "    bool matchesConstants = true;\n";
+            // the constants bound the count to a range of the index, which is scanned exactly; the range
+            // methods of brie and eqrel relations only take the equal columns of the lower bound
+            const auto representation = rel->getRepresentation();
+            const bool bounded = !keyConstants.empty() && representation != RelationRepresentation::BRIE &&
+                                 representation != RelationRepresentation::EQREL;
+            auto column = [&](std::size_t k) {
+                return (!bounded && rel->getArity() > 6 ? "tup[0][" : "tup[") + std::to_string(k) + "]";
+            };
+            out << "auto matchesConstants = [&]([[maybe_unused]] const auto& tup) {\n";
+            out << "return true";
             for (auto& [k, constant] : keyConstants) {
-                if (rel->getArity() > 6) {
-                    out << "matchesConstants &= (tup[0][" << k << "] == " << constant << ");\n";
-                } else {
-                    out << "matchesConstants &= (tup[" << k << "] == " << constant << ");\n";
-                }
+                out << " && " << column(k) << " == " << constant;
             }
-            out << "if (!matchesConstants) {\n";
-            out << "    continue;\n";
-            out << "}\n";
-            out << "if (first) { first = false; }\n";
-            out << "else {\n";
-            out << "    bool matchesPrev = true;\n";
-            for (auto k : count.getKeyColumns()) {
-                if (rel->getArity() > 6) {
-                    out << "matchesPrev &= (tup[0][" << k << "] == prev[0][" << k << "]);\n";
-                } else {
-                    out << "matchesPrev &= (tup[" << k << "] == prev[" << k << "]);\n";
+            out << ";\n";
+            out << "};\n";
+            // exact counts compare the key columns, samples their hashes
+            const std::string keyColumns = toString(
+                    join(count.getKeyColumns(), ",", [&](auto& os, std::size_t k) { os << column(k); }));
+            out << "auto keyOf = [&](const auto& tup) {\n";
+            out << "return std::array<RamDomain," << count.getKeyColumns().size() << ">{{" << keyColumns
+                << "}};\n";
+            out << "};\n";
+            if (keyConstants.empty()) {
+                out << "auto hashKey = [&](const auto& tup) {\n";
+                out << "return KeyStatistics::hash({" << keyColumns << "});\n";
+                out << "};\n";
+            }
+            out << "KeyStatistics stats;\n";
+            if (bounded) {
+                std::stringstream low;
+                std::stringstream high;
+                for (std::size_t k = 0; k < rel->getArity(); k++) {
+                    low << (k == 0 ? "" : ",");
+                    high << (k == 0 ? "" : ",");
+                    auto pos = keyConstants.find(k);
+                    if (pos != keyConstants.end()) {
+                        low << pos->second;
+                        high << pos->second;
+                        continue;
+                    }
+                    switch (rel->getAttributeTypes()[k][0]) {
+                        case 'f':
+                            low << "ramBitCast<RamDomain>(MIN_RAM_FLOAT)";
+                            high << "ramBitCast<RamDomain>(MAX_RAM_FLOAT)";
+                            break;
+                        case 'u':
+                            low << "ramBitCast<RamDomain>(MIN_RAM_UNSIGNED)";
+                            high << "ramBitCast<RamDomain>(MAX_RAM_UNSIGNED)";
+                            break;
+                        default:
+                            low << "ramBitCast<RamDomain>(MIN_RAM_SIGNED)";
+                            high << "ramBitCast<RamDomain>(MAX_RAM_SIGNED)";
+                    }
+                }
+                out << "stats = countKeys(" << relName << "->lowerUpperRange_" << keys << "(Tuple<RamDomain,"
+                    << rel->getArity() << ">{{" << low.str() << "}},Tuple<RamDomain," << rel->getArity()
+                    << ">{{" << high.str() << "}}," << ctxName << "), matchesConstants, keyOf);\n";
+            } else {
+                // large relations are sampled in parallel rather than scanned for exact counts
+                if (keyConstants.empty()) {
+                    out << "if (" << indexName << ".size() > KeyStatistics::exactCountLimit) {\n";
+                    out << "stats = sampleKeys(" << indexName << ".partition(" << Relation::partitionCount
+                        << "), " << indexName << ".size(), matchesConstants, hashKey);\n";
+                    out << "} else {\n";
+                }
+                out << "stats = countKeys(" << indexName << ", matchesConstants, keyOf);\n";
+                if (keyConstants.empty()) {
+                    out << "}\n";
                 }
             }
-            out << "if (matchesPrev) { ++duplicates; }\n";
-            out << "}\n";
-            out << "prev = tup; ++total;\n";
-            out << "\n";
-            out << "}\n";
-            out << "}\n";
-            out << "std::size_t uniqueKeys = (" << (onlyConstants ? "total" : "total - duplicates") << ");\n";
+            out << "std::size_t uniqueKeys = (" << (onlyConstants ? "stats.total" : "stats.unique") << ");\n";
             if (count.isRecursiveRelation()) {
                 out << "ProfileEventSingleton::instance().makeRecursiveCountEvent(\"" << profilerText
                     << "\", uniqueKeys, iter);\n";
@@ -953,6 +1248,7 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
             out << "auto part = range.partition();\n";
             out << "PARALLEL_START\n";
             out << preamble.str();
+            emitBatchDeclaration(piscan, rel->getArity(), out);
             out << R"cpp(
                    #if defined _OPENMP && _OPENMP < 200805
                            auto count = std::distance(part.begin(), part.end());
@@ -963,12 +1259,11 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
                            pfor(auto it = part.begin(); it < part.end(); it++) {
                    #endif
                    )cpp";
+            if (parallelRegion) {
+                out << "ParallelRegion::Task parallelTask(parallelRegion);\n";
+            }
             out << "try{\n";
-            out << "for(const auto& env0 : *it) {\n";
-
-            visit_(type_identity<TupleOperation>(), piscan, out);
-
-            out << "}\n";
+            emitTupleLoop(piscan, "*it", rel->getArity(), out, true);
             out << "} catch(std::exception &e) { signalHandler->error(e.what());}\n";
             out << "}\n";
 
@@ -1043,6 +1338,9 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
                            pfor(auto it = part.begin(); it < part.end(); it++) {
                    #endif
                    )cpp";
+            if (parallelRegion) {
+                out << "ParallelRegion::Task parallelTask(parallelRegion);\n";
+            }
             out << "try{";
             out << "for(const auto& env0 : *it) {\n";
             out << "if( ";
@@ -1330,7 +1628,9 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
             const auto* tupleElem = as<TupleElement>(aggregate.getExpression());
             return tupleElem && tupleElem->getTupleId() == identifier &&
                    keys[tupleElem->getElement()] != ram::analysis::AttributeConstraint::None &&
-                   (repr == RelationRepresentation::BTREE || repr == RelationRepresentation::DEFAULT);
+                   (repr == RelationRepresentation::BTREE || repr == RelationRepresentation::DEFAULT ||
+                           repr == RelationRepresentation::COMPRESSED ||
+                           repr == RelationRepresentation::HASH);
         }
 
         void visit_(
@@ -2662,7 +2962,7 @@ void Synthesiser::generateCode(std::ostream& sos, const std::string& id, bool& w
 
     // generate C++ program
 
-    if (Global::config().has("verbose")) {
+    if (Global::config().has("verbose") || Global::config().has("profile-indexes")) {
         os << "#define _SOUFFLE_STATS\n";
         os << "#include \"souffle/profile/ProfileEvent.h\"";
     }
@@ -2677,6 +2977,18 @@ void Synthesiser::generateCode(std::ostream& sos, const std::string& id, bool& w
         os << "#include \"souffle/profile/Tui.h\"\n";
     }
 
+    if (Global::config().has("async-output")) {
+        os << "#include \"souffle/io/WriteQueue.h\"\n";
+    }
+
+    if (Global::config().has("memory-limit")) {
+        os << "#include \"souffle/io/Spill.h\"\n";
+    }
+
+    if (Global::config().has("numa")) {
+        os << "#include \"souffle/utility/NumaUtil.h\"\n";
+    }
+
     {
         auto _os = os.delayed_if(UsingStdRegex);
         *_os << "#include <regex>\n";
@@ -2684,6 +2996,7 @@ void Synthesiser::generateCode(std::ostream& sos, const std::string& id, bool& w
 
     if (Global::config().has("profile") || Global::config().has("live-profile")) {
         os << "#include \"souffle/profile/Logger.h\"\n";
+        os << "#include \"souffle/profile/ParallelProfile.h\"\n";
         os << "#include \"souffle/profile/ProfileEvent.h\"\n";
     }
 
@@ -2817,6 +3130,11 @@ void Synthesiser::generateCode(std::ostream& sos, const std::string& id, bool& w
     // print relation definitions
     std::stringstream initCons;     // initialization of constructor
     std::stringstream registerRel;  // registration of relations
+    std::stringstream placeRel;     // placement of the nodes of relations
+    std::set<std::string> interleaved;
+    for (const auto& name : splitString(Global::config().get("numa-interleave"), ',')) {
+        interleaved.insert(name);
+    }
     auto initConsSep = [&, empty = true]() mutable -> std::stringstream& {
         initCons << (empty ? "\n: " : "\n, ");
         empty = false;
@@ -2843,6 +3161,8 @@ void Synthesiser::generateCode(std::ostream& sos, const std::string& id, bool& w
         } else if (op == "printsize" || op == "output") {
             storeRelations.insert(io.getRelation());
             storeIOs.insert(&io);
+        } else if (op == "spill" || op == "restore") {
+            // memory management only; not part of the program's inputs and outputs
         } else {
             assert("wrong I/O operation");
         }
@@ -2861,7 +3181,13 @@ void Synthesiser::generateCode(std::ostream& sos, const std::string& id, bool& w
         os << "// -- Table: " << datalogName << "\n";
 
         os << "Own<" << type << "> " << cppName << " = mk<" << type << ">();\n";
-        if (!rel->isTemp()) {
+        if (rel->isTemp()) {
+            // temporaries are purged in every iteration of their stratum
+            placeRel << cppName << "->recycleNodes();\n";
+        } else {
+            if (contains(interleaved, datalogName) || contains(interleaved, "*")) {
+                placeRel << cppName << "->interleaveNodes();\n";
+            }
             tfm::format(os, "souffle::RelationWrapper<%s> wrapper_%s;\n", type, cppName);
 
             auto strLitAry = [](auto&& xs) {
@@ -2880,6 +3206,14 @@ void Synthesiser::generateCode(std::ostream& sos, const std::string& id, bool& w
                     foundIn(loadRelations), foundIn(storeRelations));
         }
     }
+    // declared after the relations, so that queued output jobs finish before they are destroyed
+    if (Global::config().has("memory-limit")) {
+        os << "spill::Spiller spiller;\n";
+    }
+    if (Global::config().has("async-output")) {
+        os << "WriteQueue writeQueue;\n";
+    }
+
     os << "public:\n";
 
     // -- constructor --
@@ -2889,9 +3223,15 @@ void Synthesiser::generateCode(std::ostream& sos, const std::string& id, bool& w
     os << initCons.str() << '\n';
     os << "{\n";
     if (Global::config().has("profile")) {
-        os << "ProfileEventSingleton::instance().setOutputFile(profiling_fname);\n";
+        os << "ProfileEventSingleton::instance().setOutputFile(profiling_fname"
+           << (Global::config().has("profile-format", "binary") ? ", true" : "") << ");\n";
+        if (Global::config().has("profile-stream")) {
+            os << "ProfileEventSingleton::instance().setStreamSocket(\""
+               << escape(Global::config().get("profile-stream")) << "\");\n";
+        }
     }
     os << registerRel.str();
+    os << placeRel.str();
     os << "}\n";
     // -- destructor --
 
@@ -2935,6 +3275,9 @@ void runFunction(std::string  inputDirectoryArg,
     // add actual program body
     os << "// -- query evaluation --\n";
     if (Global::config().has("profile")) {
+        if (Global::config().has("profile-counters")) {
+            os << "ProfileEventSingleton::instance().enablePerfCounters();\n";
+        }
         os << "ProfileEventSingleton::instance().startTimer();\n";
         os << R"_(ProfileEventSingleton::instance().makeTimeEvent("@time;starttime");)_" << '\n';
         os << "{\n"
@@ -2954,10 +3297,19 @@ void runFunction(std::string  inputDirectoryArg,
     // emit code
     emitCode(os, prog.getMain());
 
+    if (Global::config().has("async-output")) {
+        os << "try {writeQueue.wait();} catch (std::exception& e) {std::cerr << e.what();exit(1);}\n";
+    }
+
     if (Global::config().has("profile")) {
         os << "}\n";
         os << "ProfileEventSingleton::instance().stopTimer();\n";
         os << "dumpFreqs();\n";
+        if (Global::config().has("profile-indexes")) {
+            for (auto rel : prog.getRelations()) {
+                os << getRelationName(*rel) << "->makeIndexEvents(R\"_(" << rel->getName() << ")_\");\n";
+            }
+        }
     }
 
     // add code printing hint statistics
@@ -3016,6 +3368,7 @@ void runFunction(std::string  inputDirectoryArg,
         os << R"_(if (!outputDirectoryArg.empty()) {)_";
         os << R"_(directiveMap["output-dir"] = outputDirectoryArg;)_";
         os << "}\n";
+        os << R"_(directiveMap["jobs"] = std::to_string(getNumThreads());)_";
         os << "IOSystem::getInstance().getWriter(";
         os << "directiveMap, symTable, recordTable";
         os << ")->writeAll(*" << getRelationName(lookup(store->getRelation())) << ");\n";
@@ -3220,6 +3573,10 @@ void runFunction(std::string  inputDirectoryArg,
     os << "#if defined(_OPENMP) \n";
     os << "obj.setNumThreads(opt.getNumJobs());\n";
     os << "\n#endif\n";
+    // only the executable pins the threads, which belong to the host program when the program is embedded
+    if (Global::config().has("numa")) {
+        os << "souffle::numa::pinThreads();\n";
+    }
 
     if (Global::config().has("profile")) {
         os << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("", opt.getSourceFileName());)_"
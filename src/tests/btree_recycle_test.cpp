@@ -0,0 +1,211 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2022, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file btree_recycle_test.cpp
+ *
+ * Tests B-trees recycling their nodes. The test has its own executable,
+ * since it replaces the global operator new to count the allocations.
+ *
+ ***********************************************************************/
+
+#include "tests/test.h"
+
+#include "souffle/datastructure/BTree.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <vector>
+
+// count the allocations of the test, to observe recycled nodes
+static std::atomic<std::size_t> allocations{0};
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t /* size */) noexcept {
+    std::free(p);
+}
+
+namespace souffle::test {
+
+TEST(BTreeRecycle, RecycleNodes) {
+    using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
+
+    test_set t;
+    t.recycleNodes();
+    EXPECT_TRUE(t.recyclesNodes());
+    EXPECT_TRUE(t.empty());
+
+    // refill the recycled nodes with different amounts of elements
+    for (int round = 0; round < 10; round++) {
+        int n = (round % 3 + 1) * 1000;
+        for (int i = n - 1; i >= 0; i--) {
+            t.insert(i);
+        }
+        EXPECT_EQ(std::size_t(n), t.size());
+        int last = -1;
+        for (int i : t) {
+            EXPECT_EQ(last + 1, i);
+            last = i;
+        }
+        EXPECT_EQ(n - 1, last);
+        EXPECT_TRUE(t.contains(n / 2));
+        EXPECT_FALSE(t.contains(n));
+        t.clear();
+        EXPECT_TRUE(t.empty());
+        EXPECT_FALSE(t.contains(0));
+    }
+
+    // swapped and copied trees keep their elements
+    test_set s;
+    for (int i = 0; i < 1000; i++) {
+        t.insert(i);
+    }
+    t.swap(s);
+    EXPECT_TRUE(t.empty());
+    EXPECT_TRUE(s.recyclesNodes());
+    EXPECT_FALSE(t.recyclesNodes());
+    EXPECT_EQ(1000, s.size());
+
+    test_set c(s);
+    s.clear();
+    EXPECT_EQ(1000, c.size());
+    EXPECT_TRUE(c.contains(999));
+}
+
+TEST(BTreeRecycle, NodeArena) {
+    detail::node_arena arena(1024);
+    for (int i = 0; i < 100; i++) {
+        arena.allocate(100);
+    }
+    std::size_t chunks = arena.getChunkCount();
+    EXPECT_LT(1, chunks);
+
+    // reset chunks are handed out again
+    arena.reset();
+    for (int i = 0; i < 100; i++) {
+        arena.allocate(100);
+    }
+    EXPECT_EQ(chunks, arena.getChunkCount());
+
+    // released chunks are returned, and obtained anew
+    arena.release();
+    EXPECT_EQ(0, arena.getChunkCount());
+    arena.allocate(100);
+    EXPECT_EQ(1, arena.getChunkCount());
+}
+
+TEST(BTreeRecycle, ParallelNodeArena) {
+    detail::node_arena arena(1024);
+    const int N = 10000;
+    std::vector<int*> nodes(N);
+
+    // every thread fills chunks of its own, which must not overlap
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < N; i++) {
+        nodes[i] = static_cast<int*>(arena.allocate(100));
+        *nodes[i] = i;
+    }
+    for (int i = 0; i < N; i++) {
+        EXPECT_EQ(i, *nodes[i]);
+    }
+    EXPECT_LT(std::size_t(N / 10), arena.getChunkCount());
+}
+
+TEST(BTreeRecycle, ReleaseNodes) {
+    using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
+
+    test_set t;
+    t.recycleNodes();
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 10000; i++) {
+            t.insert(i);
+        }
+        EXPECT_EQ(std::size_t(10000), t.size());
+        EXPECT_TRUE(t.contains(9999));
+
+        // released trees are empty, and still recycle the nodes they obtain afterwards
+        t.releaseNodes();
+        EXPECT_TRUE(t.empty());
+        EXPECT_FALSE(t.contains(0));
+        EXPECT_TRUE(t.recyclesNodes());
+    }
+}
+
+/**
+ * Runs a semi-naive transitive closure over a chain of the given length,
+ * with delta and new sets filled and cleared in every iteration like the
+ * @delta and @new relations of a recursive stratum.
+ */
+std::size_t transitiveClosure(int length, bool recycle) {
+    using tuple_set = btree_set<std::tuple<int, int>>;
+
+    tuple_set path;
+    tuple_set delta;
+    tuple_set fresh;
+    if (recycle) {
+        delta.recycleNodes();
+        fresh.recycleNodes();
+    }
+
+    for (int i = 0; i + 1 < length; i++) {
+        path.insert(std::make_tuple(i, i + 1));
+        delta.insert(std::make_tuple(i, i + 1));
+    }
+    while (!delta.empty()) {
+        // path(x, z) :- path(x, y), edge(y, z)
+        for (const auto& cur : delta) {
+            auto next = std::make_tuple(std::get<0>(cur), std::get<1>(cur) + 1);
+            if (std::get<1>(next) < length && !path.contains(next)) {
+                fresh.insert(next);
+            }
+        }
+        path.insert(fresh.begin(), fresh.end());
+        delta.swap(fresh);
+        fresh.clear();
+    }
+    return path.size();
+}
+
+TEST(BTreeRecycle, Allocations) {
+    const int N = 1500;
+    const std::size_t expected = static_cast<std::size_t>(N) * (N - 1) / 2;
+
+    std::size_t size = 0;
+    std::size_t before = allocations;
+    size = transitiveClosure(N, false);
+    std::size_t allocated = allocations - before;
+    EXPECT_EQ(expected, size);
+
+    before = allocations;
+    size = transitiveClosure(N, true);
+    std::size_t recycled = allocations - before;
+    EXPECT_EQ(expected, size);
+
+    std::cout << "\tallocations: " << allocated << " allocated, " << recycled << " recycled\n";
+    EXPECT_LT(recycled, allocated);
+}
+
+}  // namespace souffle::test
@@ -20,7 +20,9 @@
 #include "souffle/utility/ContainerUtil.h"
 #include "souffle/utility/StreamUtil.h"
 #include <algorithm>
+#include <array>
 #include <chrono>
+#include <cstdint>
 #include <cstdlib>
 #include <functional>
 #include <iomanip>
@@ -458,6 +460,45 @@ TEST(BTreeSet, BoundaryEmpty) {
     EXPECT_NE(t.lower_bound(5), t.upper_bound(5));
 }
 
+TEST(BTreeSet, SortedSearches) {
+    using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
+
+    test_set t;
+    std::set<int> should;
+    std::mt19937 rand(7);
+    for (int i = 0; i < 10000; ++i) {
+        int value = static_cast<int>(rand() % 40000);
+        t.insert(value);
+        should.insert(value);
+    }
+
+    std::vector<int> keys;
+    for (int i = -10; i < 40010; i += 3) {
+        keys.push_back(i);
+    }
+
+    // searches sharing hints start from the closest node covering the key, in sorted and random order
+    for (int round = 0; round < 2; ++round) {
+        test_set::operation_hints hints;
+        for (int key : keys) {
+            EXPECT_EQ(should.count(key) > 0, t.contains(key, hints));
+            auto lower = t.lower_bound(key, hints);
+            auto upper = t.upper_bound(key, hints);
+            auto shouldLower = should.lower_bound(key);
+            auto shouldUpper = should.upper_bound(key);
+            EXPECT_EQ(shouldLower == should.end(), lower == t.end());
+            EXPECT_EQ(shouldUpper == should.end(), upper == t.end());
+            if (lower != t.end() && shouldLower != should.end()) {
+                EXPECT_EQ(*shouldLower, *lower);
+            }
+            if (upper != t.end() && shouldUpper != should.end()) {
+                EXPECT_EQ(*shouldUpper, *upper);
+            }
+        }
+        std::shuffle(keys.begin(), keys.end(), rand);
+    }
+}
+
 TEST(BTreeSet, Load) {
     using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
 
@@ -576,6 +617,69 @@ TEST(BTreeSet, ChunkSplitStress) {
     }
 }
 
+using Triple = std::array<int32_t, 3>;
+
+/**
+ * Orders triples by their second, first and third column, declaring the
+ * second one as leading column like the comparators of relation indexes.
+ */
+struct TripleComparator {
+    static constexpr std::size_t leading_column = 1;
+
+    int operator()(const Triple& a, const Triple& b) const {
+        for (std::size_t i : {1, 0, 2}) {
+            if (a[i] != b[i]) {
+                return a[i] < b[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+    bool less(const Triple& a, const Triple& b) const {
+        return (*this)(a, b) < 0;
+    }
+    bool equal(const Triple& a, const Triple& b) const {
+        return a == b;
+    }
+};
+
+TEST(BTreeSet, SimdSearch) {
+    using test_set = btree_set<Triple, TripleComparator, std::allocator<Triple>, 256, detail::simd_search>;
+    auto less = [](const Triple& a, const Triple& b) { return TripleComparator().less(a, b); };
+    std::set<Triple, decltype(less)> should(less);
+    test_set set;
+
+    // few values of the leading column, with negative ones among them
+    std::mt19937 generator(3);
+    for (int i = 0; i < 20000; ++i) {
+        Triple t{static_cast<int32_t>(generator() % 100), static_cast<int32_t>(generator() % 40) - 20,
+                static_cast<int32_t>(generator() % 10)};
+        EXPECT_EQ(should.insert(t).second, set.insert(t));
+    }
+    EXPECT_EQ(should.size(), set.size());
+    EXPECT_TRUE(std::equal(should.begin(), should.end(), set.begin(), set.end()));
+
+    for (int32_t x = -1; x <= 100; x += 3) {
+        for (int32_t y = -22; y <= 22; ++y) {
+            for (int32_t z : {-1, 0, 5, 10}) {
+                Triple t{x, y, z};
+                EXPECT_EQ(should.count(t) > 0, set.contains(t));
+                auto lower = set.lower_bound(t);
+                auto upper = set.upper_bound(t);
+                auto shouldLower = should.lower_bound(t);
+                auto shouldUpper = should.upper_bound(t);
+                EXPECT_EQ(shouldLower == should.end(), lower == set.end());
+                EXPECT_EQ(shouldUpper == should.end(), upper == set.end());
+                if (lower != set.end() && shouldLower != should.end()) {
+                    EXPECT_EQ(*shouldLower, *lower);
+                }
+                if (upper != set.end() && shouldUpper != should.end()) {
+                    EXPECT_EQ(*shouldUpper, *upper);
+                }
+            }
+        }
+    }
+}
+
 using Entry = std::tuple<int, int64_t>;
 
 std::vector<Entry> getData(unsigned numEntries) {
@@ -712,6 +816,34 @@ TEST(Performance, Basic) {
     checkPerformance(t3, "souffle btree_set - 256 - binary", in, out);
 }
 
+TEST(Performance, SearchStrategies) {
+    int N = 1 << 18;
+
+    // triples whose leading column is shared by a few hundred of them
+    std::vector<Triple> in;
+    std::vector<Triple> out;
+    time("generating data", [&]() {
+        std::mt19937 generator(5);
+        std::set<Triple> seen;
+        while (in.size() < static_cast<std::size_t>(N) || out.size() < static_cast<std::size_t>(N)) {
+            Triple t{static_cast<int32_t>(generator() % 1000), static_cast<int32_t>(generator() % 1000),
+                    static_cast<int32_t>(generator() % 1000)};
+            if (seen.insert(t).second) {
+                (in.size() <= out.size() ? in : out).push_back(t);
+            }
+        }
+    });
+
+    using t1 = btree_set<Triple, TripleComparator, std::allocator<Triple>, 256, detail::linear_search>;
+    checkPerformance(t1, "souffle btree_set - 256 - linear", in, out);
+
+    using t2 = btree_set<Triple, TripleComparator, std::allocator<Triple>, 256, detail::binary_search>;
+    checkPerformance(t2, "souffle btree_set - 256 - binary", in, out);
+
+    using t3 = btree_set<Triple, TripleComparator, std::allocator<Triple>, 256, detail::simd_search>;
+    checkPerformance(t3, "souffle btree_set - 256 - simd", in, out);
+}
+
 TEST(Performance, Load) {
     //        int N = 1<<24;
     int N = 1 << 20;
@@ -0,0 +1,138 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2022, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file compressed_btree_test.cpp
+ *
+ * Test cases for the delta-coded key sequence of compressed b-trees.
+ *
+ ***********************************************************************/
+
+#include "tests/test.h"
+
+#include "souffle/RamTypes.h"
+#include "souffle/datastructure/CompressedBTree.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace souffle {
+
+namespace test {
+
+template <std::size_t N>
+using Key = std::array<RamDomain, N>;
+
+template <std::size_t N>
+using Sequence = detail::compressed_key_sequence<Key<N>, detail::comparator<Key<N>>>;
+
+/** Check that the sequence holds exactly the given sorted keys, and finds each of them */
+template <std::size_t N>
+bool roundTrips(const std::vector<Key<N>>& keys) {
+    Sequence<N> seq;
+    seq.assign(keys.begin(), keys.end());
+    std::vector<Key<N>> decoded(seq.begin(), seq.end());
+    return seq.size() == keys.size() && decoded == keys &&
+           std::all_of(keys.begin(), keys.end(), [&](const Key<N>& key) { return seq.contains(key); });
+}
+
+TEST(CompressedKeySequence, Empty) {
+    Sequence<2> seq;
+    std::vector<Key<2>> keys;
+    seq.assign(keys.begin(), keys.end());
+    EXPECT_TRUE(seq.empty());
+    EXPECT_TRUE(seq.begin() == seq.end());
+    EXPECT_FALSE(seq.contains({0, 0}));
+}
+
+TEST(CompressedKeySequence, BlockBoundaries) {
+    constexpr std::size_t block = Sequence<2>::keysPerBlock;
+    for (std::size_t n : {block - 1, block, block + 1, 2 * block, 2 * block + 1, 10 * block + 7}) {
+        std::vector<Key<2>> keys;
+        for (std::size_t i = 0; i < n; ++i) {
+            keys.push_back({static_cast<RamDomain>(i / 3), static_cast<RamDomain>(i % 3)});
+        }
+        EXPECT_TRUE(roundTrips(keys));
+
+        Sequence<2> seq;
+        seq.assign(keys.begin(), keys.end());
+        // bounds of the first and last key of each block
+        for (std::size_t i = 0; i < n; i += block) {
+            for (std::size_t j : {i, std::min(n - 1, i + block - 1)}) {
+                EXPECT_TRUE(keys[j] == *seq.lower_bound(keys[j]));
+                auto next = seq.upper_bound(keys[j]);
+                if (j + 1 < n) {
+                    EXPECT_TRUE(keys[j + 1] == *next);
+                } else {
+                    EXPECT_TRUE(next == seq.end());
+                }
+            }
+        }
+    }
+}
+
+TEST(CompressedKeySequence, WideKeys) {
+    // more columns than fit in a single byte of the column mask
+    std::vector<Key<11>> keys;
+    for (RamDomain i = 0; i < 500; ++i) {
+        Key<11> key{};
+        for (std::size_t c = 0; c < key.size(); ++c) {
+            key[c] = (c == 0) ? i : (i * static_cast<RamDomain>(c + 1)) % 7;
+        }
+        keys.push_back(key);
+    }
+    EXPECT_TRUE(roundTrips(keys));
+}
+
+TEST(CompressedKeySequence, NegativeDeltas) {
+    const RamDomain min = std::numeric_limits<RamDomain>::min();
+    const RamDomain max = std::numeric_limits<RamDomain>::max();
+    // later columns decrease from one key to the next, including across the full value range
+    std::vector<Key<3>> keys;
+    for (RamDomain i = -200; i < 200; ++i) {
+        keys.push_back({i, (i % 2 == 0) ? max : min, -i});
+    }
+    std::sort(keys.begin(), keys.end());
+    EXPECT_TRUE(roundTrips(keys));
+
+    std::vector<Key<2>> extremes = {{min, max}, {min + 1, min}, {0, max}, {1, min}, {max, min}, {max, max}};
+    EXPECT_TRUE(roundTrips(extremes));
+}
+
+TEST(CompressedKeySequence, Random) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<RamDomain> dist(-1000, 1000);
+    std::set<Key<4>> keys;
+    while (keys.size() < 5000) {
+        keys.insert({dist(rng), dist(rng), dist(rng), dist(rng)});
+    }
+    std::vector<Key<4>> sorted(keys.begin(), keys.end());
+    EXPECT_TRUE(roundTrips(sorted));
+
+    Sequence<4> seq;
+    seq.assign(sorted.begin(), sorted.end());
+    for (int i = 0; i < 1000; ++i) {
+        Key<4> probe{dist(rng), dist(rng), dist(rng), dist(rng)};
+        auto lower = seq.lower_bound(probe);
+        auto expected = keys.lower_bound(probe);
+        EXPECT_EQ(expected == keys.end(), lower == seq.end());
+        if (expected != keys.end() && lower != seq.end()) {
+            EXPECT_TRUE(*expected == *lower);
+        }
+        EXPECT_EQ(keys.count(probe) == 1, seq.contains(probe));
+    }
+}
+
+}  // namespace test
+
+}  // namespace souffle
@@ -0,0 +1,125 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2022, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file gzfstream_test.cpp
+ *
+ * Round-trip tests for the gzip file streams.
+ *
+ ***********************************************************************/
+
+#include "tests/test.h"
+
+#include "souffle/io/gzfstream.h"
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <zlib.h>
+
+namespace souffle {
+
+namespace test {
+
+std::string tempFile(const std::string& name) {
+    return "/tmp/souffle_gzfstream_" + name + "_" + std::to_string(::getpid()) + ".gz";
+}
+
+/** Text spanning several compression blocks */
+std::string sampleText(std::size_t lines) {
+    std::stringstream text;
+    for (std::size_t i = 0; i < lines; ++i) {
+        text << i << "\t" << (i * 7919) % 104729 << "\tsymbol" << i % 97 << "\n";
+    }
+    return text.str();
+}
+
+std::string readAll(const std::string& filename) {
+    gzfstream::igzfstream in(filename);
+    std::stringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+TEST(GzfStream, RoundTripMultipleBlocks) {
+    const std::string filename = tempFile("blocks");
+    const std::string text = sampleText(200000);
+    EXPECT_LT(1 << 20, text.size());
+    {
+        gzfstream::ogzfstream out(filename);
+        out << text;
+    }
+    EXPECT_EQ(text, readAll(filename));
+    std::remove(filename.c_str());
+}
+
+TEST(GzfStream, RoundTripParallel) {
+    const std::string filename = tempFile("parallel");
+    const std::string text = sampleText(200000);
+    {
+        gzfstream::ogzfstream out(filename);
+        out.setThreads(4);
+        out << text;
+    }
+    EXPECT_EQ(text, readAll(filename));
+    std::remove(filename.c_str());
+}
+
+TEST(GzfStream, RoundTripEmpty) {
+    const std::string filename = tempFile("empty");
+    { gzfstream::ogzfstream out(filename); }
+    EXPECT_EQ("", readAll(filename));
+    std::remove(filename.c_str());
+}
+
+TEST(GzfStream, FlushEmitsMembers) {
+    const std::string filename = tempFile("flush");
+    const std::string text = sampleText(50000);
+    {
+        gzfstream::ogzfstream out(filename);
+        for (std::size_t i = 0; i < text.size(); i += 100000) {
+            out << text.substr(i, 100000);
+            out.flush();
+            // everything written so far is readable before the stream is closed
+            gzFile partial = gzopen(filename.c_str(), "rb");
+            std::string prefix(i + 100000, '\0');
+            const int charsRead = gzread(partial, prefix.data(), static_cast<unsigned int>(prefix.size()));
+            gzclose(partial);
+            EXPECT_EQ(text.substr(0, i + 100000), prefix.substr(0, charsRead));
+        }
+    }
+    EXPECT_EQ(text, readAll(filename));
+    std::remove(filename.c_str());
+}
+
+TEST(GzfStream, ReadMultiMemberStream) {
+    const std::string filename = tempFile("members");
+    const std::string text = sampleText(100000);
+    // append members of uneven sizes with plain zlib
+    std::size_t offset = 0;
+    for (std::size_t size : {10, 300000, 1, 700000}) {
+        gzFile member = gzopen(filename.c_str(), offset == 0 ? "wb" : "ab");
+        const std::string part = text.substr(offset, size);
+        gzwrite(member, part.data(), static_cast<unsigned int>(part.size()));
+        gzclose(member);
+        offset += part.size();
+    }
+    {
+        gzFile member = gzopen(filename.c_str(), "ab");
+        const std::string rest = text.substr(offset);
+        gzwrite(member, rest.data(), static_cast<unsigned int>(rest.size()));
+        gzclose(member);
+    }
+    EXPECT_EQ(text, readAll(filename));
+    std::remove(filename.c_str());
+}
+
+}  // namespace test
+
+}  // namespace souffle
@@ -0,0 +1,169 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2022, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file hashed_btree_test.cpp
+ *
+ * Test cases for the b-tree set testing membership by hashing.
+ *
+ ***********************************************************************/
+
+#include "tests/test.h"
+
+#include "souffle/RamTypes.h"
+#include "souffle/datastructure/HashedBTree.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace souffle {
+
+namespace test {
+
+using tuple = std::array<RamDomain, 2>;
+using test_set = hashed_btree_set<tuple>;
+
+TEST(HashedBTreeSet, Basic) {
+    test_set set;
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(0, set.size());
+    EXPECT_FALSE(set.contains({1, 2}));
+
+    EXPECT_TRUE(set.insert({1, 2}));
+    EXPECT_FALSE(set.insert({1, 2}));
+    EXPECT_TRUE(set.insert({2, 1}));
+    EXPECT_FALSE(set.empty());
+    EXPECT_EQ(2, set.size());
+    EXPECT_TRUE(set.contains({1, 2}));
+    EXPECT_TRUE(set.contains({2, 1}));
+    EXPECT_FALSE(set.contains({1, 1}));
+
+    set.clear();
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(0, set.size());
+    EXPECT_FALSE(set.contains({1, 2}));
+    EXPECT_TRUE(set.insert({1, 2}));
+}
+
+TEST(HashedBTreeSet, Ordered) {
+    test_set set;
+    std::set<tuple> should;
+    std::mt19937 rand(3);
+    for (int i = 0; i < 100000; ++i) {
+        tuple t{static_cast<RamDomain>(rand() % 1000) - 500, static_cast<RamDomain>(rand() % 1000)};
+        EXPECT_EQ(should.insert(t).second, set.insert(t));
+    }
+    EXPECT_EQ(should.size(), set.size());
+    EXPECT_TRUE(std::equal(should.begin(), should.end(), set.begin(), set.end()));
+    for (RamDomain i = -600; i < 600; i += 7) {
+        for (RamDomain j = 0; j < 1100; j += 13) {
+            EXPECT_EQ(should.count({i, j}) > 0, set.contains({i, j}));
+        }
+    }
+
+    // ranges are taken from the b-tree
+    auto it = set.lower_bound({0, 0});
+    EXPECT_TRUE(*it == *should.lower_bound({0, 0}));
+    EXPECT_EQ(std::distance(should.lower_bound({0, 0}), should.end()), std::distance(it, set.end()));
+}
+
+TEST(HashedBTreeSet, DisableHashing) {
+    test_set set;
+    set.disableHashing();
+    for (RamDomain i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(set.insert({i % 100, i}));
+    }
+    EXPECT_FALSE(set.insert({5, 5}));
+    EXPECT_EQ(1000, set.size());
+    EXPECT_TRUE(set.contains({5, 105}));
+    EXPECT_FALSE(set.contains({5, 106}));
+}
+
+TEST(HashedBTreeSet, Swap) {
+    test_set a;
+    test_set b;
+    a.insert({1, 1});
+    b.insert({2, 2});
+    b.insert({3, 3});
+    a.swap(b);
+    EXPECT_EQ(2, a.size());
+    EXPECT_EQ(1, b.size());
+    EXPECT_TRUE(a.contains({3, 3}));
+    EXPECT_FALSE(a.contains({1, 1}));
+    EXPECT_TRUE(b.contains({1, 1}));
+}
+
+/** Orders tuples by their first column as a float, like the comparators of float columns */
+struct float_comparator {
+    int operator()(const tuple& a, const tuple& b) const {
+        return less(b, a) - less(a, b);
+    }
+    bool less(const tuple& a, const tuple& b) const {
+        return ramBitCast<RamFloat>(a[0]) < ramBitCast<RamFloat>(b[0]) ||
+               (ramBitCast<RamFloat>(a[0]) == ramBitCast<RamFloat>(b[0]) && a[1] < b[1]);
+    }
+    bool equal(const tuple& a, const tuple& b) const {
+        return ramBitCast<RamFloat>(a[0]) == ramBitCast<RamFloat>(b[0]) && a[1] == b[1];
+    }
+};
+
+TEST(HashedBTreeSet, FloatZero) {
+    hashed_btree_set<tuple, float_comparator> set;
+    const RamDomain zero = ramBitCast(RamFloat(0.0));
+    const RamDomain negativeZero = ramBitCast(RamFloat(-0.0));
+    EXPECT_NE(zero, negativeZero);
+
+    EXPECT_TRUE(set.insert({negativeZero, 1}));
+    EXPECT_FALSE(set.insert({zero, 1}));
+    EXPECT_TRUE(set.contains({zero, 1}));
+    EXPECT_TRUE(set.contains({negativeZero, 1}));
+    EXPECT_FALSE(set.contains({zero, 2}));
+    EXPECT_EQ(1, set.size());
+    EXPECT_EQ(1, std::distance(set.begin(), set.end()));
+}
+
+TEST(HashedBTreeSet, ParallelInsert) {
+    const RamDomain n = 200000;
+    std::vector<tuple> data;
+    for (RamDomain i = 0; i < n; ++i) {
+        // every tuple twice
+        data.push_back({i % 1000, i / 1000});
+        data.push_back({i % 1000, i / 1000});
+    }
+    std::shuffle(data.begin(), data.end(), std::mt19937(5));
+
+    test_set set;
+    std::size_t inserted = 0;
+    std::size_t missing = 0;
+#pragma omp parallel for reduction(+ : inserted, missing)
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        if (set.insert(data[i])) {
+            ++inserted;
+        }
+        // a tuple is contained once inserted
+        if (!set.contains(data[i])) {
+            ++missing;
+        }
+    }
+    EXPECT_EQ(static_cast<std::size_t>(n), inserted);
+    EXPECT_EQ(0, missing);
+    EXPECT_EQ(static_cast<std::size_t>(n), set.size());
+    EXPECT_EQ(static_cast<std::size_t>(n), static_cast<std::size_t>(std::distance(set.begin(), set.end())));
+    for (RamDomain i = 0; i < n; ++i) {
+        EXPECT_TRUE(set.contains({i % 1000, i / 1000}));
+    }
+    EXPECT_FALSE(set.contains({1000, 0}));
+}
+
+}  // namespace test
+
+}  // namespace souffle
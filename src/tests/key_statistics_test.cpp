@@ -0,0 +1,141 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2022, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file key_statistics_test.cpp
+ *
+ * Test cases for the sampled unique key statistics.
+ *
+ ***********************************************************************/
+
+#include "tests/test.h"
+
+#include "souffle/RamTypes.h"
+#include "souffle/datastructure/KeyStatistics.h"
+#include "souffle/utility/Iteration.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace souffle {
+
+namespace test {
+
+using tuple = std::array<RamDomain, 2>;
+
+/** Relative error of an estimate */
+double error(std::size_t estimate, std::size_t exact) {
+    return std::abs(static_cast<double>(estimate) - static_cast<double>(exact)) / exact;
+}
+
+/** Split a sorted index of (key, position in group) pairs into chunks of roughly equal size */
+std::vector<std::vector<tuple>> sortedChunks(std::size_t size, std::size_t groupSize, std::size_t numChunks) {
+    std::vector<std::vector<tuple>> chunks(numChunks);
+    const std::size_t chunkSize = (size + numChunks - 1) / numChunks;
+    for (std::size_t i = 0; i < size; ++i) {
+        chunks[i / chunkSize].push_back(
+                {static_cast<RamDomain>(i / groupSize), static_cast<RamDomain>(i % groupSize)});
+    }
+    return chunks;
+}
+
+uint64_t hashKey(const tuple& t) {
+    return KeyStatistics::hash({t[0]});
+}
+
+TEST(KeyStatistics, Hash) {
+    EXPECT_EQ(KeyStatistics::hash({1, 2}), KeyStatistics::hash(KeyStatistics::hash(0, 1), 2));
+    EXPECT_NE(KeyStatistics::hash({1, 2}), KeyStatistics::hash({2, 1}));
+}
+
+TEST(KeyStatistics, Empty) {
+    std::vector<std::vector<tuple>> chunks;
+    auto stats = sampleKeys(chunks, 0, [](const tuple&) { return true; }, hashKey);
+    EXPECT_EQ(0, stats.total);
+    EXPECT_EQ(0, stats.unique);
+}
+
+TEST(KeyStatistics, Complete) {
+    // chunks small enough to be scanned completely are counted exactly
+    auto chunks = sortedChunks(5000, 7, 10);
+    auto stats = sampleKeys(chunks, 5000, [](const tuple&) { return true; }, hashKey);
+    EXPECT_EQ(5000, stats.total);
+    EXPECT_EQ(715, stats.unique);
+}
+
+TEST(KeyStatistics, Sampled) {
+    const std::size_t size = 1000000;
+    // from all keys distinct to groups spanning several chunks; the chunks of a b-tree do not line
+    // up with the groups, hence the odd number of chunks
+    for (std::size_t groupSize : {1, 3, 40, 1000, 100000, 1000000}) {
+        auto chunks = sortedChunks(size, groupSize, 397);
+        auto stats = sampleKeys(chunks, size, [](const tuple&) { return true; }, hashKey);
+        EXPECT_LT(error(stats.total, size), 0.05);
+        EXPECT_LT(error(stats.unique, size / groupSize), 0.1);
+    }
+}
+
+TEST(KeyStatistics, SampledFiltered) {
+    const std::size_t size = 1000000;
+    auto chunks = sortedChunks(size, 10, 199);
+    // only the first half of every group passes the filter
+    auto stats = sampleKeys(chunks, size, [](const tuple& t) { return t[1] < 5; }, hashKey);
+    EXPECT_LT(error(stats.total, size / 2), 0.05);
+    EXPECT_LT(error(stats.unique, size / 10), 0.1);
+}
+
+TEST(KeyStatistics, SampledMixedGroups) {
+    // groups of 1 to 2000 tuples
+    std::vector<tuple> index;
+    uint64_t state = 42;
+    RamDomain key = 0;
+    while (index.size() < 1000000) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        const std::size_t groupSize = 1 + (state >> 33) % 2000;
+        for (std::size_t i = 0; i < groupSize; ++i) {
+            index.push_back({key, static_cast<RamDomain>(i)});
+        }
+        ++key;
+    }
+    std::vector<std::vector<tuple>> chunks(400);
+    for (std::size_t i = 0; i < index.size(); ++i) {
+        chunks[i * chunks.size() / index.size()].push_back(index[i]);
+    }
+    auto stats = sampleKeys(chunks, index.size(), [](const tuple&) { return true; }, hashKey);
+    EXPECT_LT(error(stats.total, index.size()), 0.05);
+    EXPECT_LT(error(stats.unique, key), 0.1);
+}
+
+TEST(KeyStatistics, ConstantPrefix) {
+    // 1000 tuples for each constant, far fewer than in a chunk of a sampled index
+    std::vector<tuple> index;
+    for (RamDomain c = 0; c < 1000; ++c) {
+        for (RamDomain i = 0; i < 1000; ++i) {
+            index.push_back({c, i});
+        }
+    }
+    auto pairKey = [](const tuple& t) { return tuple{t[0], t[1] / 2}; };
+    for (RamDomain c : {0, 3, 420, 777, 999}) {
+        auto matches = [&](const tuple& t) { return t[0] == c; };
+        auto low = std::lower_bound(index.begin(), index.end(), tuple{c, MIN_RAM_SIGNED});
+        auto high = std::upper_bound(index.begin(), index.end(), tuple{c, MAX_RAM_SIGNED});
+        auto stats = countKeys(make_range(low, high), matches, pairKey);
+        EXPECT_EQ(1000, stats.total);
+        EXPECT_EQ(500, stats.unique);
+    }
+    // a constant without tuples
+    auto stats = countKeys(index, [](const tuple& t) { return t[0] == 1000; }, pairKey);
+    EXPECT_EQ(0, stats.total);
+    EXPECT_EQ(0, stats.unique);
+}
+
+}  // namespace test
+}  // namespace souffle
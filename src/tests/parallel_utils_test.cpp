@@ -16,8 +16,15 @@
 
 #include "tests/test.h"
 
+#include "souffle/datastructure/BTree.h"
+#include "souffle/utility/NumaUtil.h"
 #include "souffle/utility/ParallelUtil.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
 #include <string>
+#include <vector>
 
 namespace souffle {
 
@@ -99,5 +106,125 @@ TEST(ParallelUtils, OptimisticReadWriteLock) {
 
     EXPECT_EQ(2 * (N / K), c);
 }
+
+TEST(ParallelUtils, NestedRegions) {
+#ifdef _OPENMP
+    // even if the runtime would start nested teams, a region within a region runs on one thread
+    const int levels = omp_get_max_active_levels();
+    const int threads = omp_get_max_threads();
+    omp_set_max_active_levels(4);
+    omp_set_num_threads(4);
+    std::atomic<int> maxInnerThreads{0};
+    std::atomic<int> sectionsAsTasks{0};
+    PARALLEL_START
+        pfor(int i = 0; i < 16; ++i) {
+            PARALLEL_START
+                int inner = omp_get_num_threads();
+                int seen = maxInnerThreads.load();
+                while (seen < inner && !maxInnerThreads.compare_exchange_weak(seen, inner)) {
+                }
+            PARALLEL_END
+            sectionsAsTasks += runSectionsAsTasks(16);
+        }
+    PARALLEL_END
+    EXPECT_EQ(1, maxInnerThreads);
+    EXPECT_EQ(0, sectionsAsTasks);
+    omp_set_max_active_levels(levels);
+    omp_set_num_threads(threads);
+#endif
+}
+
+TEST(Numa, CpuList) {
+    EXPECT_EQ(std::vector<int>({0, 1, 2, 3, 8, 10, 11}), numa::parseCpuList("0-3,8,10-11\n"));
+    EXPECT_EQ(std::vector<int>({5}), numa::parseCpuList("5"));
+    EXPECT_TRUE(numa::parseCpuList("").empty());
+}
+
+TEST(Numa, Placement) {
+    std::vector<std::vector<int>> nodes{{0, 1, 2, 3}, {4, 5, 6, 7}};
+
+    // consecutive threads share a node, and the nodes get the same number of threads
+    EXPECT_EQ(0, numa::getCpu(nodes, 0, 4));
+    EXPECT_EQ(1, numa::getCpu(nodes, 1, 4));
+    EXPECT_EQ(4, numa::getCpu(nodes, 2, 4));
+    EXPECT_EQ(5, numa::getCpu(nodes, 3, 4));
+
+    // more threads than cores share them
+    EXPECT_EQ(0, numa::getCpu(nodes, 0, 10));
+    EXPECT_EQ(3, numa::getCpu(nodes, 3, 10));
+    EXPECT_EQ(0, numa::getCpu(nodes, 4, 10));
+    EXPECT_EQ(4, numa::getCpu(nodes, 5, 10));
+    EXPECT_EQ(4, numa::getCpu(nodes, 9, 10));
+
+    // without known cores the threads are not pinned
+    EXPECT_EQ(-1, numa::getCpu({{}}, 0, 2));
+    EXPECT_FALSE(numa::getNodes().empty());
+}
+
+TEST(Numa, PinThreads) {
+#ifdef __linux__
+    cpu_set_t before;
+    cpu_set_t after;
+    ASSERT_TRUE(sched_getaffinity(0, sizeof(before), &before) == 0);
+    numa::pinThreads();
+    ASSERT_TRUE(sched_getaffinity(0, sizeof(after), &after) == 0);
+    // only the workers are pinned, the calling thread keeps its affinity
+    EXPECT_TRUE(CPU_EQUAL(&before, &after));
+#endif
+}
+
+TEST(Numa, MapInterleaved) {
+    const std::size_t size = 1 << 21;
+    auto* chunk = static_cast<unsigned char*>(numa::mapInterleaved(size));
+    ASSERT_TRUE(chunk != nullptr);
+    chunk[0] = 1;
+    chunk[size - 1] = 2;
+    EXPECT_EQ(3, chunk[0] + chunk[size - 1]);
+    numa::unmapInterleaved(chunk, size);
+}
+
+/**
+ * Scans the partitions of a large b-tree in parallel loops, with threads
+ * pinned as with --numa. Run it under e.g.
+ * `numactl --cpunodebind=0,1` on a machine with several NUMA nodes to
+ * compare nodes allocated by a single thread with interleaved ones.
+ */
+TEST(Performance, NumaPlacement) {
+    using tree = btree_set<int>;
+    const int N = 1 << 21;
+    const int rounds = 20;
+
+    numa::pinThreads();
+    for (bool interleaved : {false, true}) {
+        tree t;
+        if (interleaved) {
+            t.interleaveNodes();
+        }
+        for (int i = 0; i < N; i++) {
+            t.insert(i);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        long long sum = 0;
+        for (int r = 0; r < rounds; r++) {
+            auto parts = t.getChunks(400);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) reduction(+ : sum)
+#endif
+            for (std::size_t i = 0; i < parts.size(); i++) {
+                for (int x : parts[i]) {
+                    sum += x;
+                }
+            }
+        }
+        auto time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start);
+
+        EXPECT_EQ(rounds * (static_cast<long long>(N) * (N - 1) / 2), sum);
+        std::cout << "\t" << (interleaved ? "interleaved" : "single-node") << " nodes on "
+                  << numa::getNodes().size() << " NUMA nodes: " << time.count() << "ms\n";
+    }
+}
+
 }  // namespace test
 }  // end namespace souffle
@@ -17,12 +17,28 @@
 #include "tests/test.h"
 
 #include "souffle/profile/CellInterface.h"
+#include "souffle/profile/IndexStatistics.h"
+#include "souffle/profile/ParallelProfile.h"
+#include "souffle/profile/ProfileDatabase.h"
+#include "souffle/profile/ProfileLog.h"
+#include "souffle/profile/ProfileStream.h"
+#include "souffle/profile/ProgramRun.h"
+#include "souffle/profile/Reader.h"
 #include "souffle/profile/StringUtils.h"
+#include "souffle/utility/FunctionalUtil.h"
 #include <chrono>
 #include <cmath>
+#include <cstdio>
+#include <fstream>
 #include <iosfwd>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
 
 using namespace souffle;
 using namespace souffle::profile;
@@ -138,3 +154,258 @@ TEST(StringUtil, cleanJsonOutDouble) {
     EXPECT_EQ("NaN", Tools::cleanJsonOut(NAN));
     EXPECT_EQ("1.234567e+02", Tools::cleanJsonOut(123.4567));
 }
+
+TEST(ProfileStream, Records) {
+    ProfileDatabase db;
+    std::vector<std::string> lines;
+    db.addListener([&](const std::vector<std::string>& path, const Entry& entry) {
+        lines.push_back(encodeEntry(path, entry));
+    });
+    db.addSizeEntry({"program", "relation", "a", "num-tuples"}, 1234567890123);
+    db.addTextEntry({"program", "relation", "a", "source-locator"}, "a.dl [1:1-2:\"3\"]\n");
+    db.addDurationEntry({"program", "runtime"}, microseconds(10), microseconds(20));
+    db.addTimeEntry({"program", "starttime"}, microseconds(5));
+    // existing entries are not rewritten and not reported again
+    db.addSizeEntry({"program", "relation", "a", "num-tuples"}, 1);
+    EXPECT_EQ(4, lines.size());
+
+    ProfileDatabase copy;
+    for (const auto& line : lines) {
+        decodeEntry(copy, line);
+        decodeEntry(copy, line);
+    }
+    std::stringstream original;
+    std::stringstream decoded;
+    db.print(original);
+    copy.print(decoded);
+    EXPECT_EQ(original.str(), decoded.str());
+}
+
+TEST(ProfileStream, Socket) {
+    std::string socketPath = "/tmp/souffle_profile_stream_" + std::to_string(::getpid());
+    ProfileDatabase db;
+    ProfileDatabase received;
+    db.addSizeEntry({"program", "relation", "a", "num-tuples"}, 1);
+    auto writer = mk<ProfileStreamWriter>(socketPath, db);
+    ProfileStreamReader reader(socketPath, received);
+    db.addSizeEntry({"program", "relation", "b", "num-tuples"}, 2);
+    // the writer sends the remaining entries and closes the stream when it is destroyed
+    writer = nullptr;
+    while (reader.isOpen()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    auto* a = as<SizeEntry>(received.lookupEntry({"program", "relation", "a", "num-tuples"}));
+    auto* b = as<SizeEntry>(received.lookupEntry({"program", "relation", "b", "num-tuples"}));
+    ASSERT_TRUE(a != nullptr);
+    ASSERT_TRUE(b != nullptr);
+    EXPECT_EQ(1, a->getSize());
+    EXPECT_EQ(2, b->getSize());
+}
+
+TEST(ProfileStream, SlowClient) {
+    std::string socketPath = "/tmp/souffle_profile_stream_slow_" + std::to_string(::getpid());
+    ProfileDatabase db;
+    auto writer = mk<ProfileStreamWriter>(socketPath, db);
+
+    // a client that never reads
+    int client = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr = souffle::profile::detail::socketAddress(socketPath);
+    ASSERT_TRUE(::connect(client, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+    for (std::size_t i = 0; i < 100000; ++i) {
+        db.addSizeEntry({"program", "relation", "a", "iteration", std::to_string(i), "num-tuples"}, i);
+    }
+
+    // closing the stream gives up on the client instead of blocking
+    auto start = std::chrono::steady_clock::now();
+    writer = nullptr;
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    ::close(client);
+}
+
+TEST(ProfileStream, NotASocket) {
+    std::string path = "/tmp/souffle_profile_stream_file_" + std::to_string(::getpid());
+    std::ofstream(path) << "data";
+    ProfileDatabase db;
+    bool thrown = false;
+    try {
+        ProfileStreamWriter writer(path, db);
+    } catch (std::runtime_error&) {
+        thrown = true;
+    }
+    EXPECT_TRUE(thrown);
+    // the file is left alone
+    EXPECT_TRUE(std::ifstream(path).good());
+    std::remove(path.c_str());
+}
+
+namespace {
+
+void addRelationEntries(ProfileDatabase& db, const std::string& rel, std::size_t iterations) {
+    db.addTextEntry({"program", "relation", rel, "source-locator"}, rel + ".dl [1:1-2:1]");
+    for (std::size_t i = 0; i < iterations; ++i) {
+        std::vector<std::string> path{"program", "relation", rel, "iteration", std::to_string(i)};
+        path.push_back("num-tuples");
+        db.addSizeEntry(path, i * 1000);
+        path.back() = "runtime";
+        db.addDurationEntry(path, microseconds(1600000000000000 + i), microseconds(1600000000000100 + i));
+    }
+}
+
+std::string printed(const ProfileDatabase& db) {
+    std::stringstream ss;
+    db.print(ss);
+    return ss.str();
+}
+
+}  // namespace
+
+TEST(ProfileLog, ReadAll) {
+    std::string filename = "/tmp/souffle_profile_log_" + std::to_string(::getpid());
+    ProfileDatabase db;
+    db.addTimeEntry({"program", "starttime"}, microseconds(1600000000000000));
+    // enough entries for several blocks
+    addRelationEntries(db, "a", 5000);
+    addRelationEntries(db, "b", 10);
+    {
+        ProfileLogWriter writer(filename);
+        db.forEachEntry([&](const std::vector<std::string>& path, const Entry& entry) {
+            writer.add(path, entry);
+        });
+    }
+    EXPECT_TRUE(ProfileLogReader::isProfileLog(filename));
+
+    ProfileDatabase read;
+    ProfileLogReader reader(filename);
+    EXPECT_TRUE(reader.hasIndex());
+    reader.read(read);
+    EXPECT_EQ(printed(db), printed(read));
+    std::remove(filename.c_str());
+}
+
+TEST(ProfileLog, ReadRelations) {
+    std::string filename = "/tmp/souffle_profile_log_" + std::to_string(::getpid());
+    ProfileDatabase all;
+    ProfileDatabase expected;
+    for (ProfileDatabase* db : {&all, &expected}) {
+        db->addTimeEntry({"program", "starttime"}, microseconds(1600000000000000));
+        addRelationEntries(*db, "b", 10);
+    }
+    addRelationEntries(all, "a", 5000);
+    {
+        // entries are written as they are added, without keeping them
+        ProfileLogWriter writer(filename);
+        ProfileDatabase db;
+        db.setRetainEntries(false);
+        db.addListener([&](const std::vector<std::string>& path, const Entry& entry) {
+            writer.add(path, entry);
+        });
+        addRelationEntries(db, "a", 2500);
+        db.addTimeEntry({"program", "starttime"}, microseconds(1600000000000000));
+        addRelationEntries(db, "b", 10);
+        addRelationEntries(db, "a", 5000);
+        EXPECT_TRUE(db.lookupEntry({"program", "starttime"}) == nullptr);
+    }
+
+    ProfileDatabase read;
+    ProfileLogReader(filename).read(read, {"b"});
+    EXPECT_EQ(printed(expected), printed(read));
+    std::remove(filename.c_str());
+}
+
+TEST(Reader, Counters) {
+    ProfileDatabase& db = ProfileEventSingleton::instance().getDB();
+    db.addTimeEntry({"program", "starttime"}, microseconds(1600000000000000));
+    db.addSizeEntry({"program", "relation", "r", "counters", "cycles"}, 100);
+    db.addSizeEntry({"program", "relation", "r", "iteration", "0", "counters", "cycles"}, 50);
+    db.addSizeEntry({"program", "relation", "r", "iteration", "1", "counters", "cycles"}, 70);
+    for (std::string iteration : {"0", "1"}) {
+        std::vector<std::string> rule{"program", "relation", "r", "iteration", iteration, "recursive-rule",
+                "r(x) :- r(x).", "0"};
+        db.addTextEntry(concat(rule, "source-locator"), "[test.dl:1.1-1.13]");
+        db.addDurationEntry(concat(rule, "runtime"), microseconds(0), microseconds(10));
+        db.addSizeEntry(concat(rule, "num-tuples"), 1);
+        db.addSizeEntry(concat(concat(rule, "counters"), "instructions"), 30);
+    }
+
+    auto run = std::make_shared<ProgramRun>();
+    Reader reader(run);
+    reader.processFile();
+    const Relation* rel = run->getRelation("r");
+    EXPECT_TRUE(rel != nullptr);
+    EXPECT_EQ(220, rel->getCounters().at("cycles"));
+    std::size_t instructions = 0;
+    for (const auto& iteration : rel->getIterations()) {
+        for (const auto& rule : iteration->getRules()) {
+            instructions += rule.second->getCounters().at("instructions");
+        }
+    }
+    EXPECT_EQ(60, instructions);
+}
+
+TEST(Reader, Indexes) {
+    ProfileDatabase& db = ProfileEventSingleton::instance().getDB();
+    db.addTimeEntry({"program", "starttime"}, microseconds(1600000000000000));
+    IndexStatistics stats;
+    stats.size = 10;
+    stats.depth = 2;
+    stats.lookups = 5;
+    stats.lookupsCounted = true;
+    ProfileEventSingleton::instance().makeIndexEvent("s", 0, "[0,1]", stats);
+    stats.hintsCounted = true;
+    stats.hints.lookupHits = 3;
+    stats.hints.lookupMisses = 1;
+    ProfileEventSingleton::instance().makeIndexEvent("@delta_s", 1, "[1,0]", stats);
+
+    auto run = std::make_shared<ProgramRun>();
+    Reader reader(run);
+    reader.processFile();
+    const Relation* rel = run->getRelation("s");
+    EXPECT_TRUE(rel != nullptr);
+    const auto& indexes = rel->getIndexes();
+    EXPECT_EQ(2, indexes.size());
+    EXPECT_EQ(10, indexes.at("[0,1]").at("size"));
+    EXPECT_EQ(5, indexes.at("[0,1]").at("lookups"));
+    EXPECT_EQ(0, indexes.at("[0,1]").count("lookup-hint-hits"));
+    EXPECT_EQ(1, indexes.at("delta [1,0]").at("position"));
+    EXPECT_EQ(3, indexes.at("delta [1,0]").at("lookup-hint-hits"));
+    EXPECT_EQ(0, indexes.at("delta [1,0]").at("insert-hint-hits"));
+}
+
+TEST(ParallelProfile, Region) {
+    ParallelProfileValues before = ParallelProfile::instance().read();
+    {
+        ParallelRegion region;
+        PARALLEL_START
+            pfor(int i = 0; i < 8; i++) {
+                ParallelRegion::Task task(region);
+                std::this_thread::sleep_for(std::chrono::milliseconds(i < 4 ? 10 : 1));
+            }
+        PARALLEL_END
+    }
+    {
+        ParallelRegion disabled(false);
+        ParallelRegion::Task task(disabled);
+    }
+    ParallelProfileValues values = ParallelProfile::instance().read() - before;
+    EXPECT_EQ(1, values.regions);
+    EXPECT_LT(43999, values.busy);
+    EXPECT_FALSE(values.busy < values.maxBusy);
+    EXPECT_FALSE(values.capacity < values.busy);
+}
+
+TEST(ParallelProfile, ContentionCounting) {
+    ContentionCounters counters;
+    // nothing is counted unless profiling enabled it
+    counters.countLockRestart();
+    counters.countLaneWait();
+    EXPECT_EQ(0, counters.lockRestarts.load());
+    EXPECT_EQ(0, counters.laneWaits.load());
+
+    counters.enable();
+    counters.countLockRestart();
+    counters.countLaneWait();
+    counters.countLaneWait();
+    EXPECT_EQ(1, counters.lockRestarts.load());
+    EXPECT_EQ(2, counters.laneWaits.load());
+}
@@ -0,0 +1,111 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2022, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file sqlite_writer_test.cpp
+ *
+ * Tests the symbol tables written in bulk by the SQLite writer.
+ *
+ ***********************************************************************/
+
+#include "tests/test.h"
+
+#include "souffle/RamTypes.h"
+#include "souffle/datastructure/RecordTableImpl.h"
+#include "souffle/datastructure/SymbolTableImpl.h"
+#include "souffle/io/WriteStreamSQLite.h"
+#include "souffle/utility/span.h"
+#include <cstdio>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sqlite3.h>
+#include <unistd.h>
+
+namespace souffle {
+
+namespace test {
+
+std::string tempDatabase(const std::string& name) {
+    return "/tmp/souffle_sqlite_" + name + "_" + std::to_string(::getpid()) + ".sqlite";
+}
+
+/** Write the given symbols as a unary relation with bulk symbols */
+void writeSymbols(const std::string& filename, const std::string& relation, SymbolTable& symbolTable,
+        const std::vector<std::string>& symbols) {
+    std::map<std::string, std::string> rwOperation = {{"IO", "sqlite"}, {"name", relation},
+            {"filename", filename}, {"symbols", "bulk"},
+            {"types", R"({"relation": {"arity": 1, "types": ["s:symbol"]}})"},
+            {"params", R"({"relation": {"arity": 1, "params": ["x"]}})"}};
+    std::vector<Tuple<RamDomain, 1>> tuples;
+    for (const auto& symbol : symbols) {
+        tuples.push_back({symbolTable.encode(symbol)});
+    }
+    SpecializedRecordTable<0> recordTable;
+    WriteStreamSQLite writer(rwOperation, symbolTable, recordTable);
+    writer.writeAll(tuples);
+}
+
+/** The symbols of a relation, as resolved by its view */
+std::set<std::string> readSymbols(const std::string& filename, const std::string& relation) {
+    sqlite3* db = nullptr;
+    std::set<std::string> symbols;
+    sqlite3_stmt* statement = nullptr;
+    std::string sql = "SELECT x FROM '" + relation + "';";
+    sqlite3_open(filename.c_str(), &db);
+    sqlite3_prepare_v2(db, sql.c_str(), -1, &statement, nullptr);
+    while (statement != nullptr && sqlite3_step(statement) == SQLITE_ROW) {
+        symbols.insert(reinterpret_cast<const char*>(sqlite3_column_text(statement, 0)));
+    }
+    sqlite3_finalize(statement);
+    sqlite3_close(db);
+    return symbols;
+}
+
+TEST(SQLiteWriter, ReplacedDatabase) {
+    const std::string filename = tempDatabase("replaced");
+    SymbolTableImpl symbolTable;
+    writeSymbols(filename, "A", symbolTable, {"a", "b"});
+    EXPECT_EQ((std::set<std::string>{"a", "b"}), readSymbols(filename, "A"));
+
+    // the symbols written before are gone with the database
+    std::remove(filename.c_str());
+    writeSymbols(filename, "A", symbolTable, {"a", "b"});
+    EXPECT_EQ((std::set<std::string>{"a", "b"}), readSymbols(filename, "A"));
+    std::remove(filename.c_str());
+}
+
+TEST(SQLiteWriter, OtherSymbolTable) {
+    const std::string filename = tempDatabase("other");
+    SymbolTableImpl first;
+    writeSymbols(filename, "A", first, {"a", "b"});
+
+    // the same symbols at the same indexes can be shared
+    SymbolTableImpl same;
+    writeSymbols(filename, "B", same, {"a", "b", "c"});
+    EXPECT_EQ((std::set<std::string>{"a", "b", "c"}), readSymbols(filename, "B"));
+
+    // other symbols at the same indexes would change the symbols of A
+    SymbolTableImpl other;
+    bool thrown = false;
+    try {
+        writeSymbols(filename, "C", other, {"b", "a"});
+    } catch (std::invalid_argument&) {
+        thrown = true;
+    }
+    EXPECT_TRUE(thrown);
+    EXPECT_EQ((std::set<std::string>{"a", "b"}), readSymbols(filename, "A"));
+    std::remove(filename.c_str());
+}
+
+}  // namespace test
+
+}  // namespace souffle
@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+# Souffle - A Datalog Compiler
+# Copyright (c) 2022 The Souffle Developers. All rights reserved
+# Licensed under the Universal Permissive License v 1.0 as shown at:
+# - https://opensource.org/licenses/UPL
+# - <souffle root>/licenses/SOUFFLE-UPL.txt
+
+"""Generate the large Datalog programs of the frontend benchmark suite.
+
+The programs are deterministic for a given scale, so that timings of
+different commits can be compared.
+"""
+
+import argparse
+import os
+
+
+def components(scale):
+    """Many parametrised components, instantiated several times each."""
+    out = [".type Node <: number", ""]
+    count = 40 * scale
+    for c in range(count):
+        out.append(f".comp C{c}<T> {{")
+        out.append("    .decl edge(x:T, y:T)")
+        out.append("    .decl path(x:T, y:T)")
+        out.append("    .decl loop(x:T)")
+        out.append("    path(x, y) :- edge(x, y).")
+        out.append("    path(x, z) :- path(x, y), edge(y, z).")
+        out.append("    loop(x) :- path(x, x).")
+        # chains of nested components are at most ten deep
+        if c % 10 != 0:
+            out.append(f"    .init inner = C{c - 1}<T>")
+            out.append("    edge(x, y) :- inner.path(x, y), x < y.")
+        out.append("}")
+    for i in range(4 * scale):
+        c = (i * 7) % count
+        out.append(f".init i{i} = C{c}<Node>")
+        out.append(f"i{i}.edge({i}, {i + 1}).")
+    out.append(".decl result(x:Node)")
+    out.append(".output result")
+    for i in range(4 * scale):
+        out.append(f"result(x) :- i{i}.loop(x).")
+    return out
+
+
+def clauses(scale):
+    """Many relations, each defined by many clauses joining its predecessors."""
+    out = [".decl r0(x:number, y:number)", ".input r0"]
+    relations = 200 * scale
+    for r in range(1, relations):
+        out.append(f".decl r{r}(x:number, y:number)")
+        for k in range(1, 11):
+            a = max(0, r - k)
+            b = (r * 31 + k * 17) % r
+            out.append(f"r{r}(x, z) :- r{a}(x, y), r{b}(y, z), x != z, y < {k * 100}.")
+    out.append(f".output r{relations - 1}")
+    return out
+
+
+def aggregates(scale):
+    """Clauses with deeply nested aggregates."""
+    out = [
+        ".decl weight(x:number, y:number, w:number)",
+        ".input weight",
+    ]
+    depth = 8
+    for r in range(50 * scale):
+        out.append(f".decl a{r}(x:number, v:number)")
+        expr = "count : { weight(x, _, _) }"
+        for d in range(1, depth + 1):
+            op = ("sum", "max", "min", "count")[d % 4]
+            target = "" if op == "count" else f" v{d}"
+            expr = f"{op}{target} : {{ weight(x, _, v{d}), v{d} <= {expr} }}"
+        out.append(f"a{r}(x, v) :- weight(x, _, _), v = {expr}, v != {r}.")
+        out.append(f".output a{r}")
+    return out
+
+
+PROGRAMS = {
+    "components": components,
+    "clauses": clauses,
+    "aggregates": aggregates,
+}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("outdir", help="directory to write the programs to")
+    parser.add_argument("--scale", type=int, default=10, help="size factor of the programs")
+    args = parser.parse_args()
+
+    os.makedirs(args.outdir, exist_ok=True)
+    for name, generate in PROGRAMS.items():
+        with open(os.path.join(args.outdir, f"{name}.dl"), "w") as f:
+            f.write("\n".join(generate(args.scale)) + "\n")
+
+
+if __name__ == "__main__":
+    main()
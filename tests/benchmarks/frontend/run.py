@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+# Souffle - A Datalog Compiler
+# Copyright (c) 2022 The Souffle Developers. All rights reserved
+# Licensed under the Universal Permissive License v 1.0 as shown at:
+# - https://opensource.org/licenses/UPL
+# - <souffle root>/licenses/SOUFFLE-UPL.txt
+
+"""Run the frontend benchmark suite and record its results.
+
+Every generated program is compiled to C++ with `souffle -g`, without
+compiling the C++ code, and with `--time-passes` to obtain the time of each
+stage and the peak memory. One line of JSON per program is appended to the
+history file, tagged with the current git commit, and compared with the
+previous result of the same program at the same scale. The history file is
+kept in the current directory, which should be the build directory, unless
+given with --history.
+
+Example:
+    cd build && ../tests/benchmarks/frontend/run.py src/souffle --scale 10
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+import generate
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+
+def commit():
+    try:
+        return subprocess.check_output(
+            ["git", "rev-parse", "--short", "HEAD"], cwd=HERE, text=True
+        ).strip()
+    except (OSError, subprocess.CalledProcessError):
+        return "unknown"
+
+
+def stage_times(report):
+    """Seconds spent in each stage, counting the leaf passes only."""
+    times = {}
+    for p in report["root"]["compile"]["pass"].values():
+        if p["leaf"]:
+            seconds = (p["runtime"]["end"] - p["runtime"]["start"]) / 1e6
+            times[p["stage"]] = times.get(p["stage"], 0.0) + seconds
+    return times
+
+
+def run(souffle, program, workdir):
+    passes = os.path.join(workdir, "passes.json")
+    start = time.monotonic()
+    subprocess.run(
+        [souffle, f"--time-passes={passes}", "-g", os.path.join(workdir, "out.cpp"), program],
+        check=True,
+        stdout=subprocess.DEVNULL,
+    )
+    wall = time.monotonic() - start
+    with open(passes) as f:
+        report = json.load(f)
+    return {
+        "wall": round(wall, 3),
+        "maxRSS": report["root"]["compile"]["maxRSS"],
+        "stages": {k: round(v, 3) for k, v in stage_times(report).items()},
+    }
+
+
+def previous(history, name, scale):
+    if not os.path.exists(history):
+        return None
+    last = None
+    with open(history) as f:
+        for line in f:
+            entry = json.loads(line)
+            if entry["program"] == name and entry["scale"] == scale:
+                last = entry
+    return last
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter
+    )
+    parser.add_argument("souffle", help="souffle executable to benchmark")
+    parser.add_argument("--scale", type=int, default=10, help="size factor of the programs")
+    parser.add_argument("--history", default="frontend-history.jsonl", help="file to append the results to")
+    args = parser.parse_args()
+
+    rev = commit()
+    with tempfile.TemporaryDirectory() as workdir:
+        for name, gen in generate.PROGRAMS.items():
+            program = os.path.join(workdir, f"{name}.dl")
+            with open(program, "w") as f:
+                f.write("\n".join(gen(args.scale)) + "\n")
+
+            last = previous(args.history, name, args.scale)
+            result = run(args.souffle, program, workdir)
+            entry = {"commit": rev, "program": name, "scale": args.scale, **result}
+            with open(args.history, "a") as f:
+                f.write(json.dumps(entry, sort_keys=True) + "\n")
+
+            line = f"{name:12} {result['wall']:8.2f}s {result['maxRSS'] / 1024:8.1f}MB"
+            if last is not None:
+                line += f"   was {last['wall']:.2f}s {last['maxRSS'] / 1024:.1f}MB at {last['commit']}"
+            print(line)
+            for stage, seconds in sorted(result["stages"].items()):
+                print(f"    {stage:12} {seconds:8.2f}s")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())